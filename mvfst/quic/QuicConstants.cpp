@@ -38,6 +38,8 @@ std::string_view congestionControlTypeToString(CongestionControlType type) {
       return kCongestionControlStaticCwndStr;
     case CongestionControlType::None:
       return kCongestionControlNoneStr;
+    case CongestionControlType::Tunnel:
+      return kCongestionControlTunnelStr;
     case CongestionControlType::MAX:
       return "MAX";
     default:
@@ -65,6 +67,8 @@ std::optional<CongestionControlType> congestionControlStrToType(
     return quic::CongestionControlType::StaticCwnd;
   } else if (str == kCongestionControlNoneStr) {
     return quic::CongestionControlType::None;
+  } else if (str == kCongestionControlTunnelStr) {
+    return quic::CongestionControlType::Tunnel;
   }
   return std::nullopt;
 }
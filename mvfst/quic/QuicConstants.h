@@ -35,6 +35,10 @@ extern uint16_t kDefaultMaxUDPPayload;
 // maximum QUIC packet size.
 constexpr uint16_t kMinMaxUDPPayload = 1200;
 
+// The max_udp_payload_size a peer allows when it omits the transport
+// parameter, per RFC 9000 section 18.2.
+constexpr uint64_t kDefaultPeerMaxUDPPayload = 65527;
+
 // How many bytes to reduce from udpSendPacketLen when socket write leads to
 // EMSGSIZE.
 constexpr uint16_t kDefaultMsgSizeBackOffSize = 50;
@@ -116,7 +120,8 @@ BETTER_ENUM(
     CLIENT_SHUTDOWN,
     INVALID_SRC_PORT,
     UNKNOWN_CID_VERSION,
-    CANNOT_FORWARD_DATA)
+    CANNOT_FORWARD_DATA,
+    HANDSHAKE_LIMITED)
 
 BETTER_ENUM(
     TransportKnobParamId,
@@ -378,6 +383,10 @@ constexpr uint64_t kDefaultMinBurstPackets = 5;
 // Default tick interval for pacing timer. This is the smallest interval the
 // pacer will use as its interval.
 constexpr std::chrono::microseconds kDefaultPacingTickInterval{1000};
+
+// Number of pacer bursts written per wakeup with earliest departure time
+// pacing. The kernel spaces them one pacing interval apart.
+constexpr uint32_t kDefaultEdtPacingBursts = 4;
 // Default pacing timer resolution. This is the size of the buckets in the timer
 // triggering the pacing callbacks. For pacing to work accurately, this should
 // be reasonably smaller than kDefaultPacingTickInterval.
@@ -395,6 +404,7 @@ constexpr std::string_view kCongestionControlCopa2Str = "copa2";
 constexpr std::string_view kCongestionControlNewRenoStr = "newreno";
 constexpr std::string_view kCongestionControlStaticCwndStr = "staticcwnd";
 constexpr std::string_view kCongestionControlNoneStr = "none";
+constexpr std::string_view kCongestionControlTunnelStr = "tunnel";
 
 constexpr DurationRep kPersistentCongestionThreshold = 3;
 enum class CongestionControlType : uint8_t {
@@ -407,6 +417,7 @@ enum class CongestionControlType : uint8_t {
   BBRTesting,
   StaticCwnd,
   None,
+  Tunnel,
   // NOTE: MAX should always be at the end
   MAX
 };
@@ -500,6 +511,8 @@ constexpr double kAckTimerFactor = 0.25;
 constexpr std::chrono::microseconds kMaxAckTimeout = 25000us;
 // max_ack_delay cannot be equal or greater that 2^14
 constexpr uint64_t kMaxAckDelay = 1ULL << 14;
+// min_ack_delay to announce for accepting ACK_FREQUENCY frames
+constexpr std::chrono::microseconds kDefaultMinAckDelay = 1000us;
 
 constexpr uint64_t kAckPurgingThresh = 10;
 
@@ -698,4 +711,12 @@ constexpr size_t kShortHeaderPaddingModulo = 32;
 constexpr uint8_t kMaxReceivedPktsTimestampsStored = 25;
 constexpr uint8_t kDefaultReceiveTimestampsExponent = 3;
 
+// ECN codepoints carried in the two low bits of the IP TOS / traffic class
+// byte (RFC 3168).
+constexpr uint8_t kEcnMask = 0x03;
+constexpr uint8_t kEcnNotECT = 0x00;
+constexpr uint8_t kEcnECT1 = 0x01;
+constexpr uint8_t kEcnECT0 = 0x02;
+constexpr uint8_t kEcnCE = 0x03;
+
 } // namespace quic
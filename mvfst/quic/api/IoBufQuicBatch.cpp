@@ -7,10 +7,56 @@
 
 #include <quic/api/IoBufQuicBatch.h>
 
+#include <quic/codec/Decode.h>
 #include <quic/common/SocketUtil.h>
 #include <quic/happyeyeballs/QuicHappyEyeballsFunctions.h>
 
 namespace quic {
+void BatchHeaderEncryptor::add(
+    uint8_t* packet,
+    size_t headerLen,
+    size_t encryptedBodyLen,
+    HeaderForm headerForm) {
+  pending_.push_back({packet, headerLen, encryptedBodyLen, headerForm});
+}
+
+void BatchHeaderEncryptor::encryptPending() {
+  if (pending_.empty()) {
+    return;
+  }
+  samples_.resize(pending_.size());
+  for (size_t i = 0; i < pending_.size(); i++) {
+    const auto& pending = pending_[i];
+    auto packetNumberLength = parsePacketNumberLength(*pending.packet);
+    // If there were less than 4 bytes in the packet number, some of the
+    // payload bytes will also be skipped during sampling.
+    size_t sampleBytesToUse = kMaxPacketNumEncodingSize - packetNumberLength;
+    CHECK_GE(pending.encryptedBodyLen, sampleBytesToUse + samples_[i].size());
+    memcpy(
+        samples_[i].data(),
+        pending.packet + pending.headerLen + sampleBytesToUse,
+        samples_[i].size());
+  }
+  masks_.resize(pending_.size());
+  headerCipher_.batchMask(folly::range(samples_), masks_.data());
+  for (size_t i = 0; i < pending_.size(); i++) {
+    const auto& pending = pending_[i];
+    auto packetNumberLength = parsePacketNumberLength(*pending.packet);
+    folly::MutableByteRange initialByteRange(pending.packet, 1);
+    folly::MutableByteRange packetNumByteRange(
+        pending.packet + pending.headerLen - packetNumberLength,
+        packetNumberLength);
+    if (pending.headerForm == HeaderForm::Short) {
+      headerCipher_.encryptShortHeaderWithMask(
+          masks_[i], initialByteRange, packetNumByteRange);
+    } else {
+      headerCipher_.encryptLongHeaderWithMask(
+          masks_[i], initialByteRange, packetNumByteRange);
+    }
+  }
+  pending_.clear();
+}
+
 IOBufQuicBatch::IOBufQuicBatch(
     BatchWriterPtr&& batchWriter,
     bool threadLocal,
@@ -28,14 +74,20 @@ IOBufQuicBatch::IOBufQuicBatch(
 bool IOBufQuicBatch::write(
     std::unique_ptr<folly::IOBuf>&& buf,
     size_t encodedSize) {
+  auto packetIndex = result_.packetsSent;
   result_.packetsSent++;
   result_.bytesSent += encodedSize;
 
   // see if we need to flush the prev buffer(s)
-  if (batchWriter_->needsFlush(encodedSize)) {
+  if (batchWriter_->needsFlush(encodedSize) ||
+      (burstPackets_ && packetIndex % burstPackets_ == 0 &&
+       !batchWriter_->empty())) {
     // continue even if we get an error here
     flush(FlushType::FLUSH_TYPE_ALWAYS);
   }
+  if (batchWriter_->empty()) {
+    batchFirstPacket_ = packetIndex;
+  }
 
   // try to append the new buffers
   if (batchWriter_->append(
@@ -66,13 +118,21 @@ void IOBufQuicBatch::reset() {
 }
 
 bool IOBufQuicBatch::isRetriableError(int err) {
-  return err == EAGAIN || err == EWOULDBLOCK || err == ENOBUFS;
+  return err == EAGAIN || err == EWOULDBLOCK || err == ENOBUFS ||
+      (err == EMSGSIZE && tolerateMsgSize_);
 }
 
 bool IOBufQuicBatch::flushInternal() {
+  if (headerEncryptor_) {
+    headerEncryptor_->encryptPending();
+  }
   if (batchWriter_->empty()) {
     return true;
   }
+  if (burstPackets_) {
+    batchWriter_->setTxTime(
+        burstInterval_ * (batchFirstPacket_ / burstPackets_));
+  }
 
   bool written = false;
   folly::Optional<int> firstSocketErrno;
@@ -80,6 +140,7 @@ bool IOBufQuicBatch::flushInternal() {
     auto consumed = batchWriter_->write(sock_, peerAddress_);
     if (consumed < 0) {
       firstSocketErrno = errno;
+      msgSizeError_ |= (errno == EMSGSIZE);
     }
     written = (consumed >= 0);
     if (happyEyeballsState_) {
@@ -107,6 +168,7 @@ bool IOBufQuicBatch::flushInternal() {
         happyEyeballsState_->secondPeerAddress);
     if (consumed < 0) {
       secondSocketErrno = errno;
+      msgSizeError_ |= (errno == EMSGSIZE);
     }
 
     // written is marked true if either socket write succeeds
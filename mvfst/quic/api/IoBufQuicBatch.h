@@ -9,6 +9,7 @@
 #include <quic/QuicException.h>
 #include <quic/api/QuicBatchWriter.h>
 #include <quic/client/state/ClientStateMachine.h>
+#include <quic/codec/PacketNumberCipher.h>
 #include <quic/state/QuicTransportStatsCallback.h>
 
 namespace quic {
@@ -18,6 +19,49 @@ struct BufQuicBatchResult {
   uint64_t bytesSent{0};
 };
 
+/**
+ * Defers header protection of the packets of a write loop until the batch is
+ * flushed, so that the masks of the whole batch come from one batchMask()
+ * call. Packets must stay at the same address until the flush, which holds
+ * for both the in place and the chained data path as long as the batch writer
+ * is not thread local.
+ */
+class BatchHeaderEncryptor {
+ public:
+  explicit BatchHeaderEncryptor(const PacketNumberCipher& headerCipher)
+      : headerCipher_(headerCipher) {}
+
+  /**
+   * Queues an encrypted packet. packet points at the unprotected header,
+   * which is followed by encryptedBodyLen bytes of ciphertext and tag.
+   */
+  void add(
+      uint8_t* packet,
+      size_t headerLen,
+      size_t encryptedBodyLen,
+      HeaderForm headerForm);
+
+  // Protects the headers of all queued packets with one batch of masks.
+  void encryptPending();
+
+  bool empty() const {
+    return pending_.empty();
+  }
+
+ private:
+  struct PendingPacket {
+    uint8_t* packet;
+    size_t headerLen;
+    size_t encryptedBodyLen;
+    HeaderForm headerForm;
+  };
+
+  const PacketNumberCipher& headerCipher_;
+  std::vector<PendingPacket> pending_;
+  std::vector<Sample> samples_;
+  std::vector<HeaderProtectionMask> masks_;
+};
+
 class IOBufQuicBatch {
  public:
   enum class FlushType {
@@ -49,6 +93,32 @@ class IOBufQuicBatch {
     return result_;
   }
 
+  // Queued headers are protected by headerEncryptor right before each flush.
+  void setHeaderEncryptor(BatchHeaderEncryptor* headerEncryptor) {
+    headerEncryptor_ = headerEncryptor;
+  }
+
+  // Earliest departure time pacing: every burstPackets packets are flushed
+  // on their own and stamped to leave one interval after the previous ones.
+  void setDepartureSchedule(
+      uint64_t burstPackets,
+      std::chrono::microseconds interval) {
+    burstPackets_ = burstPackets;
+    burstInterval_ = interval;
+  }
+
+  // Lets a packet too large for the path (EMSGSIZE) be dropped like a lost
+  // packet instead of failing the write. Only used while path MTU discovery
+  // runs, which then has to lower the packet size, see msgSizeError().
+  void setTolerateMsgSize(bool tolerateMsgSize) {
+    tolerateMsgSize_ = tolerateMsgSize;
+  }
+
+  // Whether a flush failed with EMSGSIZE.
+  bool msgSizeError() const {
+    return msgSizeError_;
+  }
+
  private:
   void reset();
 
@@ -67,6 +137,13 @@ class IOBufQuicBatch {
   QuicTransportStatsCallback* statsCallback_{nullptr};
   QuicClientConnectionState::HappyEyeballsState* happyEyeballsState_;
   BufQuicBatchResult result_;
+  BatchHeaderEncryptor* headerEncryptor_{nullptr};
+  uint64_t burstPackets_{0};
+  std::chrono::microseconds burstInterval_{0};
+  // index of the first packet of the pending batch
+  uint64_t batchFirstPacket_{0};
+  bool tolerateMsgSize_{false};
+  bool msgSizeError_{false};
 };
 
 } // namespace quic
@@ -161,6 +161,9 @@ bool SinglePacketBatchWriter::append(
 ssize_t SinglePacketBatchWriter::write(
     folly::AsyncUDPSocket& sock,
     const folly::SocketAddress& address) {
+  if (hasTxTime()) {
+    return sock.writeGSO(address, buf_, writeOptions(0));
+  }
   return sock.write(address, buf_);
 }
 
@@ -218,6 +221,12 @@ bool GSOPacketBatchWriter::append(
 ssize_t GSOPacketBatchWriter::write(
     folly::AsyncUDPSocket& sock,
     const folly::SocketAddress& address) {
+  if (hasTxTime()) {
+    return sock.writeGSO(
+        address,
+        buf_,
+        writeOptions((currBufs_ > 1) ? static_cast<int>(prevSize_) : 0));
+  }
   return (currBufs_ > 1)
       ? sock.writeGSO(address, buf_, static_cast<int>(prevSize_))
       : sock.write(address, buf_);
@@ -297,9 +306,17 @@ ssize_t GSOInplacePacketBatchWriter::write(
   }
   uint64_t diffToStart = lastPacketEnd_ - buf->data();
   buf->trimEnd(diffToEnd);
-  auto bytesWritten = (numPackets_ > 1)
-      ? sock.writeGSO(address, buf, static_cast<int>(prevSize_))
-      : sock.write(address, buf);
+  ssize_t bytesWritten;
+  if (hasTxTime()) {
+    bytesWritten = sock.writeGSO(
+        address,
+        buf,
+        writeOptions((numPackets_ > 1) ? static_cast<int>(prevSize_) : 0));
+  } else {
+    bytesWritten = (numPackets_ > 1)
+        ? sock.writeGSO(address, buf, static_cast<int>(prevSize_))
+        : sock.write(address, buf);
+  }
   /**
    * If there is one more bytes after lastPacketEnd_, that means there is a
    * packet we choose not to write in this batch (e.g., it has a size larger
@@ -387,11 +404,23 @@ ssize_t SendmmsgPacketBatchWriter::write(
     const folly::SocketAddress& address) {
   CHECK_GT(bufs_.size(), 0);
   if (bufs_.size() == 1) {
-    return sock.write(address, bufs_[0]);
+    return hasTxTime() ? sock.writeGSO(address, bufs_[0], writeOptions(0))
+                       : sock.write(address, bufs_[0]);
   }
 
-  int ret = sock.writem(
-      folly::range(&address, &address + 1), bufs_.data(), bufs_.size());
+  int ret;
+  if (hasTxTime()) {
+    std::vector<folly::AsyncUDPSocket::WriteOptions> options(
+        bufs_.size(), writeOptions(0));
+    ret = sock.writemGSO(
+        folly::range(&address, &address + 1),
+        bufs_.data(),
+        bufs_.size(),
+        options.data());
+  } else {
+    ret = sock.writem(
+        folly::range(&address, &address + 1), bufs_.data(), bufs_.size());
+  }
 
   if (ret <= 0) {
     return ret;
@@ -481,16 +510,33 @@ ssize_t SendmmsgGSOPacketBatchWriter::write(
     folly::AsyncUDPSocket& sock,
     const folly::SocketAddress& /*unused*/) {
   CHECK_GT(bufs_.size(), 0);
+  std::vector<folly::AsyncUDPSocket::WriteOptions> options;
+  if (hasTxTime()) {
+    options.reserve(gso_.size());
+    for (auto gso : gso_) {
+      options.push_back(writeOptions(gso));
+    }
+  }
+
   if (bufs_.size() == 1) {
+    if (hasTxTime()) {
+      return sock.writeGSO(addrs_[0], bufs_[0], options[0]);
+    }
     return (currBufs_ > 1) ? sock.writeGSO(addrs_[0], bufs_[0], gso_[0])
                            : sock.write(addrs_[0], bufs_[0]);
   }
 
-  int ret = sock.writemGSO(
-      folly::range(addrs_.data(), addrs_.data() + addrs_.size()),
-      bufs_.data(),
-      bufs_.size(),
-      gso_.data());
+  int ret = hasTxTime()
+      ? sock.writemGSO(
+            folly::range(addrs_.data(), addrs_.data() + addrs_.size()),
+            bufs_.data(),
+            bufs_.size(),
+            options.data())
+      : sock.writemGSO(
+            folly::range(addrs_.data(), addrs_.data() + addrs_.size()),
+            bufs_.data(),
+            bufs_.size(),
+            gso_.data());
 
   if (ret <= 0) {
     return ret;
@@ -66,9 +66,27 @@ class BatchWriter {
       folly::AsyncUDPSocket& sock,
       const folly::SocketAddress& address) = 0;
 
+  // Departure time of the following writes relative to the time they are
+  // made. It is handed to the kernel in an SCM_TXTIME cmsg, 0 sends now.
+  void setTxTime(std::chrono::microseconds txTime) {
+    txTime_ = txTime;
+  }
+
  protected:
+  FOLLY_NODISCARD bool hasTxTime() const {
+    return txTime_.count() > 0;
+  }
+
+  FOLLY_NODISCARD folly::AsyncUDPSocket::WriteOptions writeOptions(
+      int gso) const {
+    folly::AsyncUDPSocket::WriteOptions options(gso, false /* zerocopy */);
+    options.txTime = txTime_;
+    return options;
+  }
+
   QuicEventBase evb_;
   int fd_{-1};
+  std::chrono::microseconds txTime_{0};
 };
 
 class IOBufBatchWriter : public BatchWriter {
@@ -608,9 +608,14 @@ folly::Optional<PacketNum> AckScheduler::writeNextAcks(
       : 0;
 
   // If ack_receive_timestamps are not enabled on *either* end-points OR
-  // the peer requests 0 timestamps, we fall-back to using FrameType::ACK
+  // the peer requests 0 timestamps, we fall-back to using FrameType::ACK, or
+  // FrameType::ACK_ECN once we have ECN counts to report.
   if (!isAckReceiveTimestampsSupported || !peerRequestedTimestampsCount) {
-    ackWriteResult = writeAckFrame(meta, builder, FrameType::ACK);
+    bool hasEcnCounts = conn_.transportSettings.readEcnOnIngress &&
+        (ackState_.ecnECT0CountReceived || ackState_.ecnECT1CountReceived ||
+         ackState_.ecnCECountReceived);
+    ackWriteResult = writeAckFrame(
+        meta, builder, hasEcnCounts ? FrameType::ACK_ECN : FrameType::ACK);
   } else {
     ackWriteResult = writeAckFrameWithReceivedTimestamps(
         meta,
@@ -694,26 +699,55 @@ bool DatagramFrameScheduler::hasPendingDatagramFrames() const {
 
 bool DatagramFrameScheduler::writeDatagramFrames(
     PacketBuilderInterface& builder) {
+  auto& writeBuffer = conn_.datagramState.writeBuffer;
+  const auto& config = conn_.transportSettings.datagramConfig;
+  const size_t window = std::max<uint32_t>(config.packingWindow, 1);
   bool sent = false;
-  for (size_t i = 0; i <= conn_.datagramState.writeBuffer.size(); ++i) {
-    auto& payload = conn_.datagramState.writeBuffer.front();
-    auto len = payload.chainLength();
+  while (!writeBuffer.empty()) {
     uint64_t spaceLeft = builder.remainingSpaceInPkt();
-    QuicInteger frameTypeQuicInt(static_cast<uint8_t>(FrameType::DATAGRAM_LEN));
-    QuicInteger datagramLenInt(len);
-    auto datagramFrameLength =
-        frameTypeQuicInt.getSize() + len + datagramLenInt.getSize();
-    if (folly::to<uint64_t>(datagramFrameLength) <= spaceLeft) {
-      auto datagramFrame = DatagramFrame(len, payload.move());
-      auto res = writeFrame(datagramFrame, builder);
-      // Must always succeed since we have already checked that there is enough
-      // space to write the frame
-      CHECK_GT(res, 0);
-      QUIC_STATS(conn_.statsCallback, onDatagramWrite, len);
-      conn_.datagramState.writeBuffer.pop_front();
-      sent = true;
-    }
-    if (conn_.transportSettings.datagramConfig.framePerPacket) {
+    // Best fit: the largest datagram within the window that fits in what is
+    // left of the packet. Ties go to the older datagram.
+    folly::Optional<size_t> best;
+    uint64_t bestLen = 0;
+    // Once the head has been overtaken packingWindow - 1 times it is the
+    // only candidate, so it cannot starve behind smaller datagrams.
+    auto candidates = conn_.datagramState.headSkips + 1 >= window
+        ? size_t(1)
+        : std::min(window, writeBuffer.size());
+    for (size_t i = 0; i < candidates; ++i) {
+      auto len = writeBuffer[i].chainLength();
+      if (sent && config.framePerPacket && len > config.coalesceMaxSize) {
+        continue;
+      }
+      QuicInteger frameTypeQuicInt(
+          static_cast<uint8_t>(FrameType::DATAGRAM_LEN));
+      QuicInteger datagramLenInt(len);
+      auto datagramFrameLength =
+          frameTypeQuicInt.getSize() + len + datagramLenInt.getSize();
+      if (folly::to<uint64_t>(datagramFrameLength) <= spaceLeft &&
+          (!best || len > bestLen)) {
+        best = i;
+        bestLen = len;
+      }
+    }
+    if (!best) {
+      break;
+    }
+    auto it = writeBuffer.begin() + *best;
+    auto datagramFrame = DatagramFrame(bestLen, it->move());
+    auto res = writeFrame(datagramFrame, builder);
+    // Must always succeed since we have already checked that there is enough
+    // space to write the frame
+    CHECK_GT(res, 0);
+    QUIC_STATS(conn_.statsCallback, onDatagramWrite, bestLen);
+    writeBuffer.erase(it);
+    if (*best == 0) {
+      conn_.datagramState.headSkips = 0;
+    } else {
+      conn_.datagramState.headSkips++;
+    }
+    sent = true;
+    if (config.framePerPacket && config.coalesceMaxSize == 0) {
       break;
     }
   }
@@ -969,4 +1003,28 @@ folly::StringPiece CloningScheduler::name() const {
   return name_;
 }
 
+PmtuProbeScheduler::PmtuProbeScheduler(const folly::StringPiece name)
+    : name_(name) {}
+
+bool PmtuProbeScheduler::hasData() const {
+  return true;
+}
+
+SchedulingResult PmtuProbeScheduler::scheduleFramesForPacket(
+    PacketBuilderInterface&& builder,
+    uint32_t /* writableBytes */) {
+  builder.encodePacketHeader();
+  if (writeFrame(PingFrame(), builder) == 0) {
+    return SchedulingResult(folly::none, folly::none);
+  }
+  while (builder.remainingSpaceInPkt() > 0) {
+    writeFrame(PaddingFrame(), builder);
+  }
+  return SchedulingResult(folly::none, std::move(builder).buildPacket());
+}
+
+folly::StringPiece PmtuProbeScheduler::name() const {
+  return name_;
+}
+
 } // namespace quic
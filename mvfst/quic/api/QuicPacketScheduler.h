@@ -370,4 +370,24 @@ class CloningScheduler : public QuicPacketScheduler {
   uint64_t cipherOverhead_;
 };
 
+/**
+ * Builds path MTU probes: a PING frame padded to fill the whole packet, so the
+ * size of the packet is the size the builder was created with.
+ */
+class PmtuProbeScheduler : public QuicPacketScheduler {
+ public:
+  explicit PmtuProbeScheduler(const folly::StringPiece name);
+
+  bool hasData() const override;
+
+  SchedulingResult scheduleFramesForPacket(
+      PacketBuilderInterface&& builder,
+      uint32_t writableBytes) override;
+
+  folly::StringPiece name() const override;
+
+ private:
+  folly::StringPiece name_;
+};
+
 } // namespace quic
@@ -9,6 +9,7 @@
 
 #include <folly/Expected.h>
 #include <folly/Optional.h>
+#include <folly/Range.h>
 #include <folly/io/IOBuf.h>
 #include <folly/io/async/AsyncTransportCertificate.h>
 #include <quic/QuicConstants.h>
@@ -1406,6 +1407,23 @@ class QuicSocket {
      * Notifies the DatagramCallback that datagrams are available for read.
      */
     virtual void onDatagramsAvailable() noexcept = 0;
+
+    /**
+     * Return true to have received datagrams handed to onDatagramsReceived()
+     * once per read burst instead of being buffered for readDatagrams(). This
+     * avoids the read buffer and the vector allocated by every readDatagrams()
+     * call. Queried when the callback is set.
+     */
+    virtual bool wantsDatagramBursts() const noexcept {
+      return false;
+    }
+
+    /**
+     * Datagrams received since the previous call, in arrival order. The
+     * payloads may be moved out; the range is only valid during the call.
+     */
+    virtual void onDatagramsReceived(
+        folly::Range<ReadDatagram*> /* datagrams */) noexcept {}
   };
 
   /**
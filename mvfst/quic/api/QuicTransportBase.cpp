@@ -36,6 +36,8 @@ QuicTransportBase::QuicTransportBase(
       pathValidationTimeout_(this),
       idleTimeout_(this),
       keepaliveTimeout_(this),
+      hibernateTimeout_(this),
+      writableTimeout_(this),
       drainTimeout_(this),
       pingTimeout_(this),
       readLooper_(new FunctionLooper(
@@ -344,6 +346,8 @@ void QuicTransportBase::closeImpl(
   pathValidationTimeout_.cancelTimeout();
   idleTimeout_.cancelTimeout();
   keepaliveTimeout_.cancelTimeout();
+  hibernateTimeout_.cancelTimeout();
+  writableTimeout_.cancelTimeout();
   pingTimeout_.cancelTimeout();
 
   VLOG(10) << "Stopping read looper due to immediate close " << *this;
@@ -367,7 +371,9 @@ void QuicTransportBase::closeImpl(
 
   // Clear out all the buffered datagrams
   conn_->datagramState.readBuffer.clear();
+  conn_->datagramState.burstBuffer.clear();
   conn_->datagramState.writeBuffer.clear();
+  conn_->datagramState.headSkips = 0;
 
   // Clear out all the pending events.
   conn_->pendingEvents = QuicConnectionStateBase::PendingEvents();
@@ -894,6 +900,14 @@ void QuicTransportBase::invokeReadDataAndCallbacks() {
       }
     }
   }
+  if (self->datagramCallback_ && !conn_->datagramState.burstBuffer.empty()) {
+    // Swap buffers so datagrams that arrive or get rerouted while the
+    // callback runs do not touch the range being delivered.
+    std::swap(self->datagramBurst_, conn_->datagramState.burstBuffer);
+    self->datagramCallback_->onDatagramsReceived(
+        folly::range(self->datagramBurst_));
+    self->datagramBurst_.clear();
+  }
   if (self->datagramCallback_ && !conn_->datagramState.readBuffer.empty()) {
     self->datagramCallback_->onDatagramsAvailable();
   }
@@ -918,7 +932,8 @@ void QuicTransportBase::updateReadLooper() {
         return readCb->second.readCb && readCb->second.resumed;
       });
   if (iter != conn_->streamManager->readableStreams().end() ||
-      !conn_->datagramState.readBuffer.empty()) {
+      !conn_->datagramState.readBuffer.empty() ||
+      !conn_->datagramState.burstBuffer.empty()) {
     VLOG(10) << "Scheduling read looper " << *this;
     readLooper_->run();
   } else {
@@ -1132,6 +1147,8 @@ void QuicTransportBase::updateWriteLooper(bool thisIteration) {
       conn_->writeDebugState.needsWriteLoopDetect = false;
       conn_->writeDebugState.currentEmptyLoopCount = 0;
     }
+    // no ack may come to reopen the congestion window
+    scheduleWritableTimeout();
   }
   if (conn_->loopDetectorCallback) {
     conn_->writeDebugState.writeDataReason = writeDataReason;
@@ -1887,10 +1904,22 @@ void QuicTransportBase::onNetworkData(
               });
     }
 
-    for (auto& packet : networkData.packets) {
+    if (networkData.packets.size() > 1 && conn_->readCodec) {
+      // Derive the header protection masks of a GRO/recvmmsg batch together.
+      auto dstConnIdSize = conn_->nodeType == QuicNodeType::Client &&
+              conn_->clientConnectionId
+          ? conn_->clientConnectionId->size()
+          : kDefaultConnectionIdSize;
+      conn_->readCodec->prepareShortHeaderMasks(
+          networkData.packets, dstConnIdSize);
+    }
+    for (size_t i = 0; i < networkData.packets.size(); ++i) {
       onReadData(
           peer,
-          NetworkDataSingle(std::move(packet), networkData.receiveTimePoint));
+          NetworkDataSingle(
+              std::move(networkData.packets[i]),
+              networkData.receiveTimePoint,
+              networkData.getTosValue(i)));
       if (conn_->peerConnectionError) {
         closeImpl(QuicError(
             QuicErrorCode(TransportErrorCode::NO_ERROR), "Peer closed"));
@@ -1957,6 +1986,11 @@ void QuicTransportBase::setIdleTimer() {
   }
   idleTimeout_.cancelTimeout();
   keepaliveTimeout_.cancelTimeout();
+  hibernateTimeout_.cancelTimeout();
+  if (conn_->transportSettings.hibernateTimeout > 0ms) {
+    getEventBase()->timer().scheduleTimeout(
+        &hibernateTimeout_, conn_->transportSettings.hibernateTimeout);
+  }
   auto localIdleTimeout = conn_->transportSettings.idleTimeout;
   // The local idle timeout being zero means it is disabled.
   if (localIdleTimeout == 0ms) {
@@ -2730,6 +2764,19 @@ void QuicTransportBase::keepaliveTimeoutExpired() noexcept {
   updateWriteLooper(true);
 }
 
+void QuicTransportBase::hibernateTimeoutExpired() noexcept {
+  if (closeState_ != CloseState::OPEN) {
+    return;
+  }
+  VLOG(10) << "Hibernating idle connection " << *this;
+  hibernateConnection(*conn_);
+}
+
+void QuicTransportBase::writableTimeoutExpired() noexcept {
+  VLOG(10) << __func__ << " " << *this;
+  updateWriteLooper(true);
+}
+
 void QuicTransportBase::scheduleLossTimeout(std::chrono::milliseconds timeout) {
   if (closeState_ == CloseState::CLOSED) {
     return;
@@ -2809,6 +2856,22 @@ void QuicTransportBase::schedulePathValidationTimeout() {
   }
 }
 
+void QuicTransportBase::scheduleWritableTimeout() {
+  if (writableTimeout_.isScheduled() || !conn_->congestionController) {
+    return;
+  }
+  auto timeUntilWritable =
+      conn_->congestionController->getTimeUntilWritable();
+  if (!timeUntilWritable ||
+      hasNonAckDataToWrite(*conn_) == WriteDataReason::NO_WRITE) {
+    return;
+  }
+  auto timeoutMs = std::max(
+      1ms, folly::chrono::ceil<std::chrono::milliseconds>(*timeUntilWritable));
+  VLOG(10) << __func__ << " timeout=" << timeoutMs.count() << "ms " << *this;
+  getEventBase()->timer().scheduleTimeout(&writableTimeout_, timeoutMs);
+}
+
 void QuicTransportBase::cancelLossTimeout() {
   lossTimeout_.cancelTimeout();
 }
@@ -2986,6 +3049,16 @@ QuicTransportBase::setDatagramCallback(DatagramCallback* cb) {
           << " cb=" << cb << " " << *this;
 
   datagramCallback_ = cb;
+  auto& datagramState = conn_->datagramState;
+  datagramState.deliverBursts = cb && cb->wantsDatagramBursts();
+  if (!datagramState.deliverBursts && !datagramState.burstBuffer.empty()) {
+    // Leave an undelivered burst to readDatagrams().
+    std::move(
+        datagramState.burstBuffer.begin(),
+        datagramState.burstBuffer.end(),
+        std::back_inserter(datagramState.readBuffer));
+    datagramState.burstBuffer.clear();
+  }
   updateReadLooper();
   return folly::unit;
 }
@@ -3016,6 +3089,7 @@ folly::Expected<folly::Unit, LocalErrorCode> QuicTransportBase::writeDatagram(
       return folly::makeUnexpected(LocalErrorCode::INVALID_WRITE_DATA);
     } else {
       conn_->datagramState.writeBuffer.pop_front();
+      conn_->datagramState.headSkips = 0;
     }
   }
   conn_->datagramState.writeBuffer.emplace_back(std::move(buf));
@@ -3445,6 +3519,8 @@ void QuicTransportBase::detachEventBase() {
   pathValidationTimeout_.cancelTimeout();
   idleTimeout_.cancelTimeout();
   keepaliveTimeout_.cancelTimeout();
+  hibernateTimeout_.cancelTimeout();
+  writableTimeout_.cancelTimeout();
   drainTimeout_.cancelTimeout();
   readLooper_->detachEventBase();
   peekLooper_->detachEventBase();
@@ -572,6 +572,40 @@ class QuicTransportBase : public QuicSocket, QuicStreamPrioritiesObserver {
     QuicTransportBase* transport_;
   };
 
+  class HibernateTimeout : public folly::HHWheelTimer::Callback {
+   public:
+    ~HibernateTimeout() override = default;
+
+    explicit HibernateTimeout(QuicTransportBase* transport)
+        : transport_(transport) {}
+
+    void timeoutExpired() noexcept override {
+      transport_->hibernateTimeoutExpired();
+    }
+    void callbackCanceled() noexcept override {}
+
+   private:
+    QuicTransportBase* transport_;
+  };
+
+  // Restarts the write looper when the congestion controller becomes
+  // writable without an ack, e.g. when its shaper refills
+  class WritableTimeout : public folly::HHWheelTimer::Callback {
+   public:
+    ~WritableTimeout() override = default;
+
+    explicit WritableTimeout(QuicTransportBase* transport)
+        : transport_(transport) {}
+
+    void timeoutExpired() noexcept override {
+      transport_->writableTimeoutExpired();
+    }
+    void callbackCanceled() noexcept override {}
+
+   private:
+    QuicTransportBase* transport_;
+  };
+
   // DrainTimeout is a bit different from other timeouts. It needs to hold a
   // shared_ptr to the transport, since if a DrainTimeout is scheduled,
   // transport cannot die.
@@ -772,12 +806,15 @@ class QuicTransportBase : public QuicSocket, QuicStreamPrioritiesObserver {
   void pathValidationTimeoutExpired() noexcept;
   void idleTimeoutExpired(bool drain) noexcept;
   void keepaliveTimeoutExpired() noexcept;
+  void hibernateTimeoutExpired() noexcept;
+  void writableTimeoutExpired() noexcept;
   void drainTimeoutExpired() noexcept;
   void pingTimeoutExpired() noexcept;
 
   void setIdleTimer();
   void scheduleAckTimeout();
   void schedulePathValidationTimeout();
+  void scheduleWritableTimeout();
   void schedulePingTimeout(
       PingCallback* callback,
       std::chrono::milliseconds pingTimeout);
@@ -877,6 +914,8 @@ class QuicTransportBase : public QuicSocket, QuicStreamPrioritiesObserver {
   ByteEventMap txCallbacks_;
 
   DatagramCallback* datagramCallback_{nullptr};
+  // Burst being handed to DatagramCallback::onDatagramsReceived().
+  std::vector<ReadDatagram> datagramBurst_;
   PingCallback* pingCallback_{nullptr};
 
   WriteCallback* connWriteCallback_{nullptr};
@@ -890,6 +929,8 @@ class QuicTransportBase : public QuicSocket, QuicStreamPrioritiesObserver {
   PathValidationTimeout pathValidationTimeout_;
   IdleTimeout idleTimeout_;
   KeepaliveTimeout keepaliveTimeout_;
+  HibernateTimeout hibernateTimeout_;
+  WritableTimeout writableTimeout_;
   DrainTimeout drainTimeout_;
   PingTimeout pingTimeout_;
   FunctionLooper::Ptr readLooper_;
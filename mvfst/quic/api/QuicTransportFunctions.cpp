@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <folly/ScopeGuard.h>
 #include <quic/QuicConstants.h>
 #include <quic/QuicException.h>
 #include <quic/api/QuicTransportFunctions.h>
@@ -16,6 +17,7 @@
 #include <quic/happyeyeballs/QuicHappyEyeballsFunctions.h>
 
 #include <quic/state/AckHandlers.h>
+#include <quic/state/PmtuDiscovery.h>
 #include <quic/state/QuicAckFrequencyFunctions.h>
 #include <quic/state/QuicStateFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
@@ -211,6 +213,41 @@ WriteQuicDataResult writeQuicDataToSocketImpl(
       writeLoopBeginTime);
   packetsWritten += connectionDataResult.packetsWritten;
   bytesWritten += connectionDataResult.bytesWritten;
+  // A path MTU probe goes out after the data, when the congestion window has
+  // room for it. It carries a PING, so it must not swallow one the connection
+  // wants to send.
+  auto pmtuProbeSize = getNextPmtuProbeSize(connection, Clock::now());
+  if (pmtuProbeSize && connectionDataResult.packetsWritten < packetLimit &&
+      !connection.pendingEvents.sendPing &&
+      congestionControlWritableBytes(connection) >= *pmtuProbeSize) {
+    auto probePacketNum =
+        getNextPacketNum(connection, PacketNumberSpace::AppData);
+    auto packetLen = connection.udpSendPacketLen;
+    connection.udpSendPacketLen = *pmtuProbeSize;
+    SCOPE_EXIT {
+      connection.udpSendPacketLen = packetLen;
+    };
+    PmtuProbeScheduler pmtuProbeScheduler("PmtuProbeScheduler");
+    auto pmtuProbeResult = writeConnectionDataToSocket(
+        sock,
+        connection,
+        srcConnId,
+        dstConnId,
+        ShortHeaderBuilder(),
+        PacketNumberSpace::AppData,
+        pmtuProbeScheduler,
+        unlimitedWritableBytes,
+        1,
+        aead,
+        headerCipher,
+        version,
+        writeLoopBeginTime);
+    if (pmtuProbeResult.packetsWritten > 0) {
+      onPmtuProbeSent(connection, probePacketNum, *pmtuProbeSize);
+      packetsWritten += pmtuProbeResult.packetsWritten;
+      bytesWritten += pmtuProbeResult.bytesWritten;
+    }
+  }
   VLOG_IF(10, packetsWritten || probesWritten)
       << nodeToString(connection.nodeType) << " written data "
       << (exceptCryptoStream ? "without crypto data " : "")
@@ -229,7 +266,8 @@ DataPathResult continuousMemoryBuildScheduleEncrypt(
     uint64_t writableBytes,
     IOBufQuicBatch& ioBufBatch,
     const Aead& aead,
-    const PacketNumberCipher& headerCipher) {
+    const PacketNumberCipher& headerCipher,
+    BatchHeaderEncryptor* headerEncryptor) {
   auto buf = connection.bufAccessor->obtain();
   auto prevSize = buf->length();
   connection.bufAccessor->release(std::move(buf));
@@ -289,13 +327,21 @@ DataPathResult continuousMemoryBuildScheduleEncrypt(
   packetBuf->prepend(headerLen);
 
   HeaderForm headerForm = packet->packet.header.getHeaderForm();
-  encryptPacketHeader(
-      headerForm,
-      packetBuf->writableData(),
-      headerLen,
-      packetBuf->data() + headerLen,
-      packetBuf->length() - headerLen,
-      headerCipher);
+  if (headerEncryptor) {
+    headerEncryptor->add(
+        packetBuf->writableData(),
+        headerLen,
+        packetBuf->length() - headerLen,
+        headerForm);
+  } else {
+    encryptPacketHeader(
+        headerForm,
+        packetBuf->writableData(),
+        headerLen,
+        packetBuf->data() + headerLen,
+        packetBuf->length() - headerLen,
+        headerCipher);
+  }
   CHECK(!packetBuf->isChained());
   auto encodedSize = packetBuf->length();
   auto encodedBodySize = encodedSize - headerLen;
@@ -327,7 +373,8 @@ DataPathResult iobufChainBasedBuildScheduleEncrypt(
     uint64_t writableBytes,
     IOBufQuicBatch& ioBufBatch,
     const Aead& aead,
-    const PacketNumberCipher& headerCipher) {
+    const PacketNumberCipher& headerCipher,
+    BatchHeaderEncryptor* headerEncryptor) {
   RegularQuicPacketBuilder pktBuilder(
       connection.udpSendPacketLen,
       std::move(header),
@@ -370,13 +417,21 @@ DataPathResult iobufChainBasedBuildScheduleEncrypt(
   packetBuf->append(headerLen + bodyLen + aead.getCipherOverhead());
 
   HeaderForm headerForm = packet->packet.header.getHeaderForm();
-  encryptPacketHeader(
-      headerForm,
-      packetBuf->writableData(),
-      headerLen,
-      packetBuf->data() + headerLen,
-      packetBuf->length() - headerLen,
-      headerCipher);
+  if (headerEncryptor) {
+    headerEncryptor->add(
+        packetBuf->writableData(),
+        headerLen,
+        packetBuf->length() - headerLen,
+        headerForm);
+  } else {
+    encryptPacketHeader(
+        headerForm,
+        packetBuf->writableData(),
+        headerLen,
+        packetBuf->data() + headerLen,
+        packetBuf->length() - headerLen,
+        headerCipher);
+  }
   auto encodedSize = packetBuf->computeChainDataLength();
   auto encodedBodySize = encodedSize - headerLen;
   if (encodedSize > connection.udpSendPacketLen) {
@@ -1397,6 +1452,9 @@ WriteQuicDataResult writeConnectionDataToSocket(
       connection.transportSettings.dataPathType = DataPathType::ChainedMemory;
     }
   }
+  if (!connection.txTimeSupported.hasValue()) {
+    connection.txTimeSupported = sock.getTXTime().clockid >= 0;
+  }
 
   auto batchWriter = BatchWriterFactory::makeBatchWriter(
       connection.transportSettings.batchingMode,
@@ -1410,6 +1468,8 @@ WriteQuicDataResult writeConnectionDataToSocket(
   auto happyEyeballsState = connection.nodeType == QuicNodeType::Server
       ? nullptr
       : &static_cast<QuicClientConnectionState&>(connection).happyEyeballsState;
+  // Declared ahead of ioBufBatch, which keeps a pointer to it.
+  folly::Optional<BatchHeaderEncryptor> headerEncryptor;
   IOBufQuicBatch ioBufBatch(
       std::move(batchWriter),
       connection.transportSettings.useThreadLocalBatching,
@@ -1417,6 +1477,29 @@ WriteQuicDataResult writeConnectionDataToSocket(
       connection.peerAddress,
       connection.statsCallback,
       happyEyeballsState);
+  // EMSGSIZE only fails the connection when path MTU discovery can not lower
+  // the packet size.
+  ioBufBatch.setTolerateMsgSize(connection.pmtuDiscovery.has_value());
+  SCOPE_EXIT {
+    if (ioBufBatch.msgSizeError()) {
+      onPmtuMsgSizeError(connection, connection.udpSendPacketLen, Clock::now());
+    }
+  };
+  if (connection.transportSettings.batchHeaderProtection &&
+      !connection.transportSettings.useThreadLocalBatching) {
+    headerEncryptor.emplace(headerCipher);
+    ioBufBatch.setHeaderEncryptor(headerEncryptor.get_pointer());
+  }
+  if (connection.transportSettings.edtPacing && *connection.txTimeSupported &&
+      !connection.transportSettings.useThreadLocalBatching &&
+      isConnectionPaced(connection) &&
+      connection.pacer->getWriteInterval() > 0us) {
+    // The pacer allowed several bursts for this write; let the kernel
+    // space them out instead of the pacing timer.
+    ioBufBatch.setDepartureSchedule(
+        std::max<uint64_t>(connection.pacer->getCachedWriteBatchSize(), 1),
+        connection.pacer->getWriteInterval());
+  }
 
   auto batchSize = connection.transportSettings.batchingMode ==
           QuicBatchingMode::BATCHING_MODE_NONE
@@ -1453,7 +1536,8 @@ WriteQuicDataResult writeConnectionDataToSocket(
         writableBytes,
         ioBufBatch,
         aead,
-        headerCipher);
+        headerCipher,
+        headerEncryptor.get_pointer());
 
     if (!ret.buildSuccess) {
       // If we're returning because we couldn't schedule more packets,
@@ -59,5 +59,150 @@ TEST(QuicBatch, TestBatchingNoFlush) {
 TEST(QuicBatch, TestBatching) {
   RunTest(kMaxBufs);
 }
+
+// Records the departure time of every write.
+class TxTimeBatchWriter : public BatchWriter {
+ public:
+  explicit TxTimeBatchWriter(std::vector<std::chrono::microseconds>& txTimes)
+      : txTimes_(txTimes) {}
+
+  bool empty() const override {
+    return numBufs_ == 0;
+  }
+
+  size_t size() const override {
+    return size_;
+  }
+
+  void reset() override {
+    numBufs_ = 0;
+    size_ = 0;
+  }
+
+  bool append(
+      std::unique_ptr<folly::IOBuf>&& /*unused*/,
+      size_t size,
+      const folly::SocketAddress& /*unused*/,
+      folly::AsyncUDPSocket* /*unused*/) override {
+    numBufs_++;
+    size_ += size;
+    return false;
+  }
+
+  ssize_t write(
+      folly::AsyncUDPSocket& /*unused*/,
+      const folly::SocketAddress& /*unused*/) override {
+    txTimes_.push_back(txTime_);
+    return size_;
+  }
+
+ private:
+  std::vector<std::chrono::microseconds>& txTimes_;
+  size_t numBufs_{0};
+  size_t size_{0};
+};
+
+TEST(QuicBatch, TestDepartureSchedule) {
+  folly::EventBase evb;
+  folly::AsyncUDPSocket sock(&evb);
+  std::vector<std::chrono::microseconds> txTimes;
+  folly::SocketAddress peerAddress{"127.0.0.1", 1234};
+  QuicClientConnectionState conn(
+      FizzClientQuicHandshakeContext::Builder().build());
+
+  IOBufQuicBatch ioBufBatch(
+      BatchWriterPtr(new TxTimeBatchWriter(txTimes)),
+      false,
+      sock,
+      peerAddress,
+      conn.statsCallback,
+      nullptr /* happyEyeballsState */);
+  ioBufBatch.setDepartureSchedule(3, std::chrono::microseconds(100));
+
+  std::string strTest("Test");
+  for (size_t i = 0; i < 8; i++) {
+    auto buf = folly::IOBuf::copyBuffer(strTest.c_str(), strTest.length());
+    CHECK(ioBufBatch.write(std::move(buf), strTest.length()));
+  }
+  CHECK(ioBufBatch.flush());
+  EXPECT_EQ(ioBufBatch.getPktSent(), 8);
+  // bursts of 3, 3 and 2 packets, one interval apart
+  ASSERT_EQ(txTimes.size(), 3);
+  EXPECT_EQ(txTimes[0], std::chrono::microseconds(0));
+  EXPECT_EQ(txTimes[1], std::chrono::microseconds(100));
+  EXPECT_EQ(txTimes[2], std::chrono::microseconds(200));
+}
+
+// Fails every write with EMSGSIZE.
+class MsgSizeBatchWriter : public BatchWriter {
+ public:
+  bool empty() const override {
+    return size_ == 0;
+  }
+
+  size_t size() const override {
+    return size_;
+  }
+
+  void reset() override {
+    size_ = 0;
+  }
+
+  bool append(
+      std::unique_ptr<folly::IOBuf>&& /*unused*/,
+      size_t size,
+      const folly::SocketAddress& /*unused*/,
+      folly::AsyncUDPSocket* /*unused*/) override {
+    size_ = size;
+    return true;
+  }
+
+  ssize_t write(
+      folly::AsyncUDPSocket& /*unused*/,
+      const folly::SocketAddress& /*unused*/) override {
+    errno = EMSGSIZE;
+    return -1;
+  }
+
+ private:
+  size_t size_{0};
+};
+
+TEST(QuicBatch, TestMsgSizeError) {
+  folly::EventBase evb;
+  folly::AsyncUDPSocket sock(&evb);
+  folly::SocketAddress peerAddress{"127.0.0.1", 1234};
+  QuicClientConnectionState conn(
+      FizzClientQuicHandshakeContext::Builder().build());
+  std::string strTest("Test");
+
+  IOBufQuicBatch fatalBatch(
+      BatchWriterPtr(new MsgSizeBatchWriter()),
+      false,
+      sock,
+      peerAddress,
+      conn.statsCallback,
+      nullptr /* happyEyeballsState */);
+  EXPECT_THROW(
+      fatalBatch.write(
+          folly::IOBuf::copyBuffer(strTest.c_str(), strTest.length()),
+          strTest.length()),
+      QuicTransportException);
+
+  IOBufQuicBatch ioBufBatch(
+      BatchWriterPtr(new MsgSizeBatchWriter()),
+      false,
+      sock,
+      peerAddress,
+      conn.statsCallback,
+      nullptr /* happyEyeballsState */);
+  ioBufBatch.setTolerateMsgSize(true);
+  EXPECT_FALSE(ioBufBatch.msgSizeError());
+  // dropped like a lost packet
+  EXPECT_FALSE(ioBufBatch.write(
+      folly::IOBuf::copyBuffer(strTest.c_str(), strTest.length()),
+      strTest.length()));
+  EXPECT_TRUE(ioBufBatch.msgSizeError());
+}
 } // namespace testing
 } // namespace quic
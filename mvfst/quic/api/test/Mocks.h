@@ -74,6 +74,12 @@ class MockDatagramCallback : public QuicSocket::DatagramCallback {
  public:
   ~MockDatagramCallback() override = default;
   MOCK_METHOD((void), onDatagramsAvailable, (), (noexcept));
+  MOCK_METHOD((bool), wantsDatagramBursts, (), (const, noexcept));
+  MOCK_METHOD(
+      (void),
+      onDatagramsReceived,
+      (folly::Range<ReadDatagram*>),
+      (noexcept));
 };
 
 class MockWriteCallback : public QuicSocket::WriteCallback {
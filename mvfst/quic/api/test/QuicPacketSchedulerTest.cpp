@@ -2347,6 +2347,92 @@ TEST_F(QuicPacketSchedulerTest, DatagramFrameWriteWhenRoomAvailable) {
   ASSERT_EQ(frames.size(), 1);
 }
 
+TEST_F(QuicPacketSchedulerTest, DatagramFrameSchedulerBestFitWithinWindow) {
+  QuicClientConnectionState conn(
+      FizzClientQuicHandshakeContext::Builder().build());
+  conn.transportSettings.datagramConfig.framePerPacket = false;
+  conn.transportSettings.datagramConfig.packingWindow = 3;
+  DatagramFrameScheduler scheduler(conn);
+  // The head doesn't fit, the third datagram is the best fit and the fourth
+  // is outside the window.
+  for (size_t len : {900, 300, 500, 550}) {
+    conn.datagramState.writeBuffer.emplace_back(
+        folly::IOBuf::copyBuffer(std::string(len, '*')));
+  }
+  NiceMock<MockQuicPacketBuilder> builder;
+  uint64_t spaceLeft = 850;
+  EXPECT_CALL(builder, remainingSpaceInPkt()).WillRepeatedly(Invoke([&]() {
+    return spaceLeft;
+  }));
+  EXPECT_CALL(builder, appendFrame(_)).WillRepeatedly(Invoke([&](auto f) {
+    spaceLeft -= f.asDatagramFrame()->length + 3;
+    builder.frames_.push_back(f);
+  }));
+  EXPECT_TRUE(scheduler.writeDatagramFrames(builder));
+  auto& frames = builder.frames_;
+  ASSERT_EQ(frames.size(), 2);
+  EXPECT_EQ(frames[0].asDatagramFrame()->length, 500);
+  EXPECT_EQ(frames[1].asDatagramFrame()->length, 300);
+  ASSERT_EQ(conn.datagramState.writeBuffer.size(), 2);
+  EXPECT_EQ(conn.datagramState.writeBuffer.front().chainLength(), 900);
+}
+
+TEST_F(QuicPacketSchedulerTest, DatagramFrameSchedulerHeadNotStarved) {
+  QuicClientConnectionState conn(
+      FizzClientQuicHandshakeContext::Builder().build());
+  conn.transportSettings.datagramConfig.framePerPacket = true;
+  conn.transportSettings.datagramConfig.packingWindow = 3;
+  DatagramFrameScheduler scheduler(conn);
+  // Each later datagram is a better fit than the head.
+  for (size_t len : {1000, 1100, 1100, 1100, 1100}) {
+    conn.datagramState.writeBuffer.emplace_back(
+        folly::IOBuf::copyBuffer(std::string(len, '*')));
+  }
+  NiceMock<MockQuicPacketBuilder> builder;
+  EXPECT_CALL(builder, remainingSpaceInPkt()).WillRepeatedly(Return(1200));
+  EXPECT_CALL(builder, appendFrame(_)).WillRepeatedly(Invoke([&](auto f) {
+    builder.frames_.push_back(f);
+  }));
+  auto& frames = builder.frames_;
+  for (size_t packet = 0; packet < 4; packet++) {
+    EXPECT_TRUE(scheduler.writeDatagramFrames(builder));
+  }
+  // The head is overtaken packingWindow - 1 times, then goes out.
+  ASSERT_EQ(frames.size(), 4);
+  EXPECT_EQ(frames[0].asDatagramFrame()->length, 1100);
+  EXPECT_EQ(frames[1].asDatagramFrame()->length, 1100);
+  EXPECT_EQ(frames[2].asDatagramFrame()->length, 1000);
+  EXPECT_EQ(frames[3].asDatagramFrame()->length, 1100);
+  EXPECT_EQ(conn.datagramState.headSkips, 0);
+  EXPECT_EQ(conn.datagramState.writeBuffer.size(), 1);
+}
+
+TEST_F(QuicPacketSchedulerTest, DatagramFrameSchedulerCoalesceSmall) {
+  QuicClientConnectionState conn(
+      FizzClientQuicHandshakeContext::Builder().build());
+  conn.transportSettings.datagramConfig.framePerPacket = true;
+  conn.transportSettings.datagramConfig.coalesceMaxSize = 100;
+  DatagramFrameScheduler scheduler(conn);
+  for (size_t len : {600, 50, 80, 400, 20}) {
+    conn.datagramState.writeBuffer.emplace_back(
+        folly::IOBuf::copyBuffer(std::string(len, '*')));
+  }
+  NiceMock<MockQuicPacketBuilder> builder;
+  EXPECT_CALL(builder, remainingSpaceInPkt()).WillRepeatedly(Return(4096));
+  EXPECT_CALL(builder, appendFrame(_)).WillRepeatedly(Invoke([&](auto f) {
+    builder.frames_.push_back(f);
+  }));
+  // The first datagram may be of any size, the ones that join it must be
+  // small. A large datagram stops coalescing in FIFO order.
+  scheduler.writeDatagramFrames(builder);
+  auto& frames = builder.frames_;
+  ASSERT_EQ(frames.size(), 3);
+  EXPECT_EQ(frames[0].asDatagramFrame()->length, 600);
+  EXPECT_EQ(frames[1].asDatagramFrame()->length, 50);
+  EXPECT_EQ(frames[2].asDatagramFrame()->length, 80);
+  EXPECT_EQ(conn.datagramState.writeBuffer.size(), 2);
+}
+
 TEST_F(QuicPacketSchedulerTest, ShortHeaderPaddingWithSpaceForPadding) {
   QuicServerConnectionState conn(
       FizzServerQuicHandshakeContext::Builder().build());
@@ -4210,6 +4210,48 @@ TEST_P(QuicTransportImplTestBase, ZeroLengthDatagramBufs) {
   EXPECT_EQ(datagrams->front().bufQueue().front()->computeChainDataLength(), 0);
 }
 
+TEST_P(QuicTransportImplTestBase, DatagramBursts) {
+  NiceMock<MockDatagramCallback> datagramCb;
+  EXPECT_CALL(datagramCb, wantsDatagramBursts()).WillRepeatedly(Return(true));
+  transport->enableDatagram();
+  transport->setDatagramCallback(&datagramCb);
+  auto recvTime = Clock::now() + 5000ns;
+  transport->addDatagram(folly::IOBuf::copyBuffer("first"), recvTime);
+  transport->addDatagram(folly::IOBuf::copyBuffer("second"), recvTime);
+  EXPECT_CALL(datagramCb, onDatagramsAvailable()).Times(0);
+  EXPECT_CALL(datagramCb, onDatagramsReceived(_))
+      .WillOnce(Invoke([&](folly::Range<ReadDatagram*> datagrams) {
+        ASSERT_EQ(datagrams.size(), 2);
+        EXPECT_EQ(datagrams[0].receiveTimePoint(), recvTime);
+        EXPECT_EQ(
+            datagrams[0].bufQueue().move()->moveToFbString().toStdString(),
+            "first");
+        EXPECT_EQ(
+            datagrams[1].bufQueue().move()->moveToFbString().toStdString(),
+            "second");
+      }));
+  transport->driveReadCallbacks();
+  auto datagrams = transport->readDatagrams();
+  EXPECT_FALSE(datagrams.hasError());
+  EXPECT_TRUE(datagrams->empty());
+}
+
+TEST_P(QuicTransportImplTestBase, DatagramBurstFallsBackToReadBuffer) {
+  NiceMock<MockDatagramCallback> burstCb;
+  NiceMock<MockDatagramCallback> datagramCb;
+  EXPECT_CALL(burstCb, wantsDatagramBursts()).WillRepeatedly(Return(true));
+  transport->enableDatagram();
+  transport->setDatagramCallback(&burstCb);
+  transport->addDatagram(folly::IOBuf::copyBuffer("datagram payload"));
+  EXPECT_CALL(burstCb, onDatagramsReceived(_)).Times(0);
+  transport->setDatagramCallback(&datagramCb);
+  EXPECT_CALL(datagramCb, onDatagramsAvailable());
+  transport->driveReadCallbacks();
+  auto datagrams = transport->readDatagramBufs();
+  EXPECT_FALSE(datagrams.hasError());
+  EXPECT_EQ(datagrams->size(), 1);
+}
+
 TEST_P(QuicTransportImplTestBase, Cmsgs) {
   transport->setServerConnectionId();
   folly::SocketOptionMap cmsgs;
@@ -2939,7 +2939,7 @@ TEST_F(QuicTransportFunctionsTest, NothingWritten) {
 }
 
 const QuicWriteFrame& getFirstFrameInOutstandingPackets(
-    const std::deque<OutstandingPacketWrapper>& outstandingPackets,
+    const OutstandingPacketList& outstandingPackets,
     QuicWriteFrame::Type frameType) {
   for (const auto& packet : outstandingPackets) {
     for (const auto& frame : packet.packet.frames) {
@@ -4443,6 +4443,67 @@ TEST_F(QuicTransportFunctionsTest, WriteWithInplaceBuilderGSOMultiplePackets) {
   EXPECT_EQ(0, bufPtr->headroom());
 }
 
+TEST_F(QuicTransportFunctionsTest, WriteWithInplaceBuilderBatchHeaders) {
+  auto conn = createConn();
+  conn->transportSettings.dataPathType = DataPathType::ContinuousMemory;
+  conn->transportSettings.batchHeaderProtection = true;
+  auto simpleBufAccessor =
+      std::make_unique<SimpleBufAccessor>(conn->udpSendPacketLen * 16);
+  auto outputBuf = simpleBufAccessor->obtain();
+  auto bufPtr = outputBuf.get();
+  simpleBufAccessor->release(std::move(outputBuf));
+  conn->bufAccessor = simpleBufAccessor.get();
+  conn->transportSettings.batchingMode = QuicBatchingMode::BATCHING_MODE_GSO;
+  EventBase evb;
+  folly::test::MockAsyncUDPSocket mockSock(&evb);
+  EXPECT_CALL(mockSock, getGSO()).WillRepeatedly(Return(true));
+  auto stream = conn->streamManager->createNextBidirectionalStream().value();
+  auto buf = buildRandomInputData(conn->udpSendPacketLen * 10);
+  writeDataToQuicStream(*stream, buf->clone(), true);
+  size_t numEncrypted = 0;
+  EXPECT_CALL(*aead, _inplaceEncrypt(_, _, _))
+      .WillRepeatedly(Invoke([&](auto& plaintext, auto, auto) {
+        numEncrypted++;
+        return std::move(plaintext);
+      }));
+  auto mockHeaderCipher = test::createNoOpHeaderCipher();
+  folly::Optional<size_t> encryptedAtFirstMask;
+  size_t numMasks = 0;
+  EXPECT_CALL(*mockHeaderCipher, mask(_))
+      .WillRepeatedly(Invoke([&](auto) {
+        if (!encryptedAtFirstMask) {
+          encryptedAtFirstMask = numEncrypted;
+        }
+        numMasks++;
+        return HeaderProtectionMask{};
+      }));
+  EXPECT_CALL(mockSock, writeGSO(_, _, _))
+      .Times(1)
+      .WillOnce(Invoke([&](const folly::SocketAddress&,
+                           const std::unique_ptr<folly::IOBuf>& sockBuf,
+                           int gso) {
+        // Every header in the batch is protected before it hits the socket.
+        EXPECT_EQ(numMasks, (sockBuf->length() + gso - 1) / gso);
+        EXPECT_EQ(sockBuf.get(), bufPtr);
+        return sockBuf->length();
+      }));
+  writeQuicDataToSocket(
+      mockSock,
+      *conn,
+      *conn->clientConnectionId,
+      *conn->serverConnectionId,
+      *aead,
+      *mockHeaderCipher,
+      getVersion(*conn),
+      conn->transportSettings.writeConnectionDataPacketsLimit);
+  // Packets are encrypted as they are built, their headers at the flush.
+  ASSERT_TRUE(encryptedAtFirstMask.has_value());
+  EXPECT_EQ(*encryptedAtFirstMask, conn->outstandings.packets.size());
+  EXPECT_EQ(numMasks, conn->outstandings.packets.size());
+  EXPECT_EQ(0, bufPtr->length());
+  EXPECT_EQ(0, bufPtr->headroom());
+}
+
 TEST_F(QuicTransportFunctionsTest, WriteProbingWithInplaceBuilder) {
   auto conn = createConn();
   conn->transportSettings.dataPathType = DataPathType::ContinuousMemory;
@@ -325,6 +325,38 @@ TEST_F(QuicTransportTest, NotAppLimitedWithNoWritableBytes) {
   transport_->close(folly::none);
 }
 
+TEST_F(QuicTransportTest, WriteWhenCongestionControllerRefills) {
+  auto& conn = transport_->getConnectionState();
+  auto mockCongestionController =
+      std::make_unique<NiceMock<MockCongestionController>>();
+  auto rawCongestionController = mockCongestionController.get();
+  conn.congestionController = std::move(mockCongestionController);
+  // a drained shaper with nothing in flight, so no ack reopens the window
+  bool drained = true;
+  EXPECT_CALL(*rawCongestionController, getWritableBytes())
+      .WillRepeatedly(Invoke([&]() -> uint64_t { return drained ? 0 : 5000; }));
+  EXPECT_CALL(*rawCongestionController, getTimeUntilWritable())
+      .WillRepeatedly(
+          Invoke([&]() -> folly::Optional<std::chrono::microseconds> {
+            if (drained) {
+              return 2ms;
+            }
+            return folly::none;
+          }));
+
+  auto stream = transport_->createBidirectionalStream().value();
+  transport_->writeChain(
+      stream, IOBuf::copyBuffer("An elephant sitting still"), false, nullptr);
+  loopForWrites();
+  EXPECT_TRUE(conn.outstandings.packets.empty());
+
+  drained = false;
+  evb_.runAfterDelay([&] { evb_.terminateLoopSoon(); }, 50);
+  evb_.loop();
+  EXPECT_FALSE(conn.outstandings.packets.empty());
+  transport_->close(folly::none);
+}
+
 TEST_F(QuicTransportTest, NotAppLimitedWithLargeBuffer) {
   auto& conn = transport_->getConnectionState();
   auto mockCongestionController =
@@ -15,6 +15,7 @@
 #include <quic/client/handshake/ClientHandshakeFactory.h>
 #include <quic/client/handshake/ClientTransportParametersExtension.h>
 #include <quic/client/state/ClientStateMachine.h>
+#include <quic/common/BusyPoller.h>
 #include <quic/flowcontrol/QuicFlowController.h>
 #include <quic/handshake/CryptoFactory.h>
 #include <quic/happyeyeballs/QuicHappyEyeballsFunctions.h>
@@ -143,7 +144,8 @@ void QuicClientTransport::processUDPData(
   for (uint16_t processedPackets = 0;
        !udpData.empty() && processedPackets < kMaxNumCoalescedPackets;
        processedPackets++) {
-    processPacketData(peer, networkData.receiveTimePoint, udpData);
+    processPacketData(
+        peer, networkData.receiveTimePoint, networkData.tosValue, udpData);
   }
   VLOG_IF(4, !udpData.empty())
       << "Leaving " << udpData.chainLength()
@@ -159,6 +161,7 @@ void QuicClientTransport::processUDPData(
       processPacketData(
           pendingData.peer,
           pendingData.networkData.receiveTimePoint,
+          pendingData.networkData.tosValue,
           pendingPacket);
       pendingPacket.move();
     }
@@ -172,6 +175,7 @@ void QuicClientTransport::processUDPData(
       processPacketData(
           pendingData.peer,
           pendingData.networkData.receiveTimePoint,
+          pendingData.networkData.tosValue,
           pendingPacket);
       pendingPacket.move();
     }
@@ -182,6 +186,7 @@ void QuicClientTransport::processUDPData(
 void QuicClientTransport::processPacketData(
     const folly::SocketAddress& peer,
     TimePoint receiveTimePoint,
+    uint8_t tosValue,
     BufQueue& packetQueue) {
   auto packetSize = packetQueue.chainLength();
   if (packetSize == 0) {
@@ -270,7 +275,7 @@ void QuicClientTransport::processPacketData(
         : clientConn_->pendingHandshakeData;
     pendingData.emplace_back(
         NetworkDataSingle(
-            std::move(cipherUnavailable->packet), receiveTimePoint),
+            std::move(cipherUnavailable->packet), receiveTimePoint, tosValue),
         peer);
     if (conn_->qLogger) {
       conn_->qLogger->addPacketBuffered(
@@ -383,6 +388,7 @@ void QuicClientTransport::processPacketData(
   auto& ackState = getAckState(*conn_, pnSpace);
   uint64_t distanceFromExpectedPacketNum = updateLargestReceivedPacketNum(
       *conn_, ackState, packetNum, receiveTimePoint);
+  updateEcnCountsOnRecvPacket(*conn_, ackState, tosValue);
   if (distanceFromExpectedPacketNum > 0) {
     QUIC_STATS(conn_->statsCallback, onOutOfOrderPacketReceived);
   }
@@ -1151,6 +1157,7 @@ void QuicClientTransport::onDataAvailable(
     bool truncated,
     OnDataAvailableParams params) noexcept {
   VLOG(10) << "Got data from socket peer=" << server << " len=" << len;
+  BusyPoller::noteActivity();
   auto packetReceiveTime = Clock::now();
   Buf data = std::move(readBuffer_);
 
@@ -1172,7 +1179,7 @@ void QuicClientTransport::onDataAvailable(
     }
     data->append(len);
     trackDatagramReceived(len);
-    NetworkData networkData(std::move(data), packetReceiveTime);
+    NetworkData networkData(std::move(data), packetReceiveTime, params.tos);
     onNetworkData(server, std::move(networkData));
   } else {
     // if we receive a truncated packet
@@ -1220,6 +1227,7 @@ void QuicClientTransport::onDataAvailable(
         networkData.packets.emplace_back(std::move(data));
       }
     }
+    networkData.setTosValues(0, params.tos);
 
     onNetworkData(server, std::move(networkData));
   }
@@ -1262,10 +1270,11 @@ void QuicClientTransport::recvMsg(
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
     bool useGRO = sock.getGRO() > 0;
     bool useTS = sock.getTimestamping() > 0;
+    bool useTos = sock.getRecvTos();
     char control[folly::AsyncUDPSocket::ReadCallback::OnDataAvailableParams::
                      kCmsgSpace] = {};
 
-    if (useGRO || useTS) {
+    if (useGRO || useTS || useTos) {
       msg.msg_control = control;
       msg.msg_controllen = sizeof(control);
 
@@ -1297,7 +1306,7 @@ void QuicClientTransport::recvMsg(
       break;
     }
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
-    if (useGRO) {
+    if (useGRO || useTos) {
       folly::AsyncUDPSocket::fromMsg(params, msg);
 
       // truncated
@@ -1317,6 +1326,7 @@ void QuicClientTransport::recvMsg(
     }
     VLOG(10) << "Got data from socket peer=" << *server << " len=" << bytesRead;
     readBuffer->append(bytesRead);
+    auto firstPacket = networkData.packets.size();
     if (params.gro > 0) {
       size_t len = bytesRead;
       size_t remaining = len;
@@ -1349,6 +1359,7 @@ void QuicClientTransport::recvMsg(
     } else {
       networkData.packets.emplace_back(std::move(readBuffer));
     }
+    networkData.setTosValues(firstPacket, params.tos);
     trackDatagramReceived(bytesRead);
   }
 }
@@ -1365,10 +1376,11 @@ void QuicClientTransport::recvMmsg(
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
   bool useGRO = sock.getGRO() > 0;
   bool useTS = sock.getTimestamping() > 0;
+  bool useTos = sock.getRecvTos();
   std::vector<std::array<
       char,
       folly::AsyncUDPSocket::ReadCallback::OnDataAvailableParams::kCmsgSpace>>
-      controlVec(useGRO ? numPackets : 0);
+      controlVec(useGRO || useTS || useTos ? numPackets : 0);
 
   // we need to consider MSG_TRUNC too
   if (useGRO) {
@@ -1395,7 +1407,7 @@ void QuicClientTransport::recvMmsg(
     msg->msg_name = rawAddr;
     msg->msg_namelen = kAddrLen;
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
-    if (useGRO || useTS) {
+    if (useGRO || useTS || useTos) {
       ::memset(controlVec[i].data(), 0, controlVec[i].size());
       msg->msg_control = controlVec[i].data();
       msg->msg_controllen = controlVec[i].size();
@@ -1440,7 +1452,7 @@ void QuicClientTransport::recvMmsg(
     }
     folly::AsyncUDPSocket::ReadCallback::OnDataAvailableParams params;
 #ifdef FOLLY_HAVE_MSG_ERRQUEUE
-    if (useGRO || useTS) {
+    if (useGRO || useTS || useTos) {
       folly::AsyncUDPSocket::fromMsg(params, msg.msg_hdr);
 
       // truncated
@@ -1462,6 +1474,7 @@ void QuicClientTransport::recvMmsg(
 
     VLOG(10) << "Got data from socket peer=" << *server << " len=" << bytesRead;
     readBuffer->append(bytesRead);
+    auto firstPacket = networkData.packets.size();
     if (params.gro > 0) {
       size_t len = bytesRead;
       size_t remaining = len;
@@ -1494,6 +1507,7 @@ void QuicClientTransport::recvMmsg(
     } else {
       networkData.packets.emplace_back(std::move(readBuffer));
     }
+    networkData.setTosValues(firstPacket, params.tos);
 
     trackDatagramReceived(bytesRead);
   }
@@ -1502,6 +1516,7 @@ void QuicClientTransport::recvMmsg(
 void QuicClientTransport::onNotifyDataAvailable(
     folly::AsyncUDPSocket& sock) noexcept {
   DCHECK(conn_) << "trying to receive packets without a connection";
+  BusyPoller::noteActivity();
   auto readBufferSize =
       conn_->transportSettings.maxRecvPacketSize * numGROBuffers_;
   const uint16_t numPackets = conn_->transportSettings.maxRecvBatchSize;
@@ -219,6 +219,7 @@ class QuicClientTransport
   void processPacketData(
       const folly::SocketAddress& peer,
       TimePoint receiveTimePoint,
+      uint8_t tosValue,
       BufQueue& packetQueue);
 
   void startCryptoHandshake();
@@ -17,6 +17,7 @@
 #include <quic/congestion_control/QuicCubic.h>
 #include <quic/flowcontrol/QuicFlowController.h>
 #include <quic/handshake/TransportParameters.h>
+#include <quic/state/PmtuDiscovery.h>
 #include <quic/state/QuicStateFunctions.h>
 #include <quic/state/QuicStreamUtilities.h>
 #include <quic/state/StateData.h>
@@ -173,16 +174,23 @@ void processServerInitialParams(
 
   // TODO Validate active_connection_id_limit
 
-  if (!packetSize || *packetSize == 0) {
-    packetSize = kDefaultUDPSendPacketLen;
+  if (packetSize && *packetSize == 0) {
+    packetSize.reset();
   }
-  if (*packetSize < kMinMaxUDPPayload) {
+  if (packetSize && *packetSize < kMinMaxUDPPayload) {
     throw QuicTransportException(
         folly::to<std::string>(
             "Max packet size too small. received max_packetSize = ",
             *packetSize),
         TransportErrorCode::TRANSPORT_PARAMETER_ERROR);
   }
+  // An omitted max_udp_payload_size means the protocol default, which is the
+  // upper bound of PMTU discovery. Without PMTU discovery we keep sending
+  // kDefaultUDPSendPacketLen.
+  conn.peerMaxUdpPayloadSize = packetSize.value_or(kDefaultPeerMaxUDPPayload);
+  if (!packetSize) {
+    packetSize = kDefaultUDPSendPacketLen;
+  }
 
   VLOG(10) << "Client advertised flow control ";
   VLOG(10) << "conn=" << maxData.value_or(0);
@@ -223,6 +231,7 @@ void processServerInitialParams(
     }
     conn.udpSendPacketLen = *packetSize;
   }
+  startPmtuDiscovery(conn);
 
   // Currently no-op for a client; it doesn't issue connection ids
   // to the server.
@@ -189,6 +189,28 @@ TEST_F(ClientStateMachineTest, TestProcessMaxDatagramSizeOk) {
       kMaxDatagramPacketOverhead + 1);
 }
 
+TEST_F(ClientStateMachineTest, TestProcessMaxUdpPayloadSizeOmitted) {
+  QuicClientConnectionState clientConn(
+      FizzClientQuicHandshakeContext::Builder().build());
+  ServerTransportParameters serverTransportParams;
+  processServerInitialParams(clientConn, serverTransportParams, 0);
+  EXPECT_EQ(clientConn.peerMaxUdpPayloadSize, kDefaultPeerMaxUDPPayload);
+  EXPECT_EQ(clientConn.udpSendPacketLen, kDefaultUDPSendPacketLen);
+}
+
+TEST_F(ClientStateMachineTest, TestProcessMaxUdpPayloadSize) {
+  QuicClientConnectionState clientConn(
+      FizzClientQuicHandshakeContext::Builder().build());
+  std::vector<TransportParameter> transportParams;
+  transportParams.push_back(
+      encodeIntegerParameter(TransportParameterId::max_packet_size, 1400));
+  ServerTransportParameters serverTransportParams = {
+      std::move(transportParams)};
+  processServerInitialParams(clientConn, serverTransportParams, 0);
+  EXPECT_EQ(clientConn.peerMaxUdpPayloadSize, 1400);
+  EXPECT_EQ(clientConn.udpSendPacketLen, kDefaultUDPSendPacketLen);
+}
+
 TEST_F(ClientStateMachineTest, TestProcessKnobFramesSupportedParamEnabled) {
   QuicClientConnectionState clientConn(
       FizzClientQuicHandshakeContext::Builder().build());
@@ -337,9 +337,8 @@ ReadAckFrame decodeAckFrameWithECN(
     folly::io::Cursor& cursor,
     const PacketHeader& header,
     const CodecParameters& params) {
-  // TODO this is incomplete
-  auto readAckFrame = decodeAckFrame(cursor, header, params);
-  // TODO we simply ignore ECN blocks in ACK-ECN frames for now.
+  auto readAckFrame =
+      decodeAckFrame(cursor, header, params, FrameType::ACK_ECN);
   auto ect_0 = decodeQuicInteger(cursor);
   if (!ect_0) {
     throw QuicTransportException(
@@ -361,6 +360,9 @@ ReadAckFrame decodeAckFrameWithECN(
         quic::TransportErrorCode::FRAME_ENCODING_ERROR,
         quic::FrameType::ACK_ECN);
   }
+  readAckFrame.ecnECT0Count = ect_0->first;
+  readAckFrame.ecnECT1Count = ect_1->first;
+  readAckFrame.ecnCECount = ect_ce->first;
   return readAckFrame;
 }
 
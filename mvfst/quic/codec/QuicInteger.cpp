@@ -46,7 +46,23 @@ uint8_t decodeQuicIntegerLength(uint8_t firstByte) {
 folly::Optional<std::pair<uint64_t, size_t>> decodeQuicInteger(
     folly::io::Cursor& cursor,
     uint64_t atMost) {
-  // checks
+  // fast path: the integer is within the current buffer
+  auto contiguous = cursor.peekBytes();
+  if (LIKELY(!contiguous.empty())) {
+    auto result = decodeQuicInteger(contiguous, atMost);
+    if (result) {
+      cursor.skip(result->second);
+      return result;
+    }
+    if (atMost == 0 ||
+        contiguous.size() >= decodeQuicIntegerLength(contiguous.front())) {
+      VLOG(10) << "Could not decode integer numBytes="
+               << (int)decodeQuicIntegerLength(contiguous.front());
+      return folly::none;
+    }
+  }
+
+  // the integer straddles buffers of a chain
   if (atMost == 0 || !cursor.canAdvance(1)) {
     VLOG(10) << "Not enough bytes to decode integer, cursor len="
              << cursor.totalLength();
@@ -277,8 +277,13 @@ CodecResult QuicReadCodec::tryParseShortHeaderPacket(
   folly::ByteRange sampleByteRange(
       data->writableData() + sampleOffset, sample.size());
 
-  oneRttHeaderCipher_->decryptShortHeader(
-      sampleByteRange, initialByteRange, packetNumberByteRange);
+  if (auto preparedMask = takePreparedMask(sampleByteRange)) {
+    oneRttHeaderCipher_->decryptShortHeaderWithMask(
+        *preparedMask, initialByteRange, packetNumberByteRange);
+  } else {
+    oneRttHeaderCipher_->decryptShortHeader(
+        sampleByteRange, initialByteRange, packetNumberByteRange);
+  }
   std::pair<PacketNum, size_t> packetNum = parsePacketNumber(
       initialByteRange.data()[0], packetNumberByteRange, expectedNextPacketNum);
   auto shortHeader =
@@ -323,6 +328,48 @@ CodecResult QuicReadCodec::tryParseShortHeaderPacket(
       std::move(*shortHeader), params_, std::move(decrypted));
 }
 
+void QuicReadCodec::prepareShortHeaderMasks(
+    const std::vector<Buf>& datagrams,
+    size_t dstConnIdSize) {
+  preparedSamples_.clear();
+  preparedMasks_.clear();
+  nextPreparedMask_ = 0;
+  if (!oneRttHeaderCipher_) {
+    return;
+  }
+  size_t sampleOffset = 1 + dstConnIdSize + kMaxPacketNumEncodingSize;
+  for (const auto& datagram : datagrams) {
+    if (!datagram || datagram->length() < sampleOffset + sizeof(Sample) ||
+        getHeaderForm(*datagram->data()) != HeaderForm::Short) {
+      continue;
+    }
+    preparedSamples_.emplace_back();
+    memcpy(
+        preparedSamples_.back().data(),
+        datagram->data() + sampleOffset,
+        sizeof(Sample));
+  }
+  if (preparedSamples_.empty()) {
+    return;
+  }
+  preparedMasks_.resize(preparedSamples_.size());
+  oneRttHeaderCipher_->batchMask(
+      folly::range(preparedSamples_), preparedMasks_.data());
+}
+
+const HeaderProtectionMask* QuicReadCodec::takePreparedMask(
+    folly::ByteRange sample) {
+  // Packets that were dropped before parsing leave their masks behind, so
+  // look ahead for the sample rather than only at the next mask.
+  for (size_t i = nextPreparedMask_; i < preparedSamples_.size(); i++) {
+    if (folly::range(preparedSamples_[i]) == sample) {
+      nextPreparedMask_ = i + 1;
+      return &preparedMasks_[i];
+    }
+  }
+  return nullptr;
+}
+
 CodecResult QuicReadCodec::parsePacket(
     BufQueue& queue,
     const AckStates& ackStates,
@@ -431,6 +478,9 @@ void QuicReadCodec::setInitialHeaderCipher(
 void QuicReadCodec::setOneRttHeaderCipher(
     std::unique_ptr<PacketNumberCipher> oneRttHeaderCipher) {
   oneRttHeaderCipher_ = std::move(oneRttHeaderCipher);
+  preparedSamples_.clear();
+  preparedMasks_.clear();
+  nextPreparedMask_ = 0;
 }
 
 void QuicReadCodec::setZeroRttHeaderCipher(
@@ -498,6 +548,15 @@ folly::Optional<TimePoint> QuicReadCodec::getHandshakeDoneTime() {
   return handshakeDoneTime_;
 }
 
+void QuicReadCodec::maybeDropZeroRttKeys(TimePoint now) {
+  // parsePacket drops 0-RTT packets from then on without the keys
+  if (handshakeDoneTime_ &&
+      now - *handshakeDoneTime_ > kTimeToRetainZeroRttKeys) {
+    zeroRttReadCipher_.reset();
+    zeroRttHeaderCipher_.reset();
+  }
+}
+
 std::string QuicReadCodec::connIdToHex() const {
   static ConnectionId zeroConn = zeroConnId();
   const auto& serverId = serverConnectionId_.value_or(zeroConn);
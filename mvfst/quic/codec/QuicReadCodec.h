@@ -104,6 +104,16 @@ class QuicReadCodec {
       const AckStates& ackStates,
       size_t dstConnIdSize = kDefaultConnectionIdSize);
 
+  /**
+   * Computes the header protection masks of the short header packets that
+   * start the given datagrams with one batchMask() call. parsePacket() then
+   * uses a prepared mask whenever the sample matches and derives the mask
+   * itself otherwise.
+   */
+  void prepareShortHeaderMasks(
+      const std::vector<Buf>& datagrams,
+      size_t dstConnIdSize = kDefaultConnectionIdSize);
+
   /**
    * Tries to parse the packet and returns whether or not
    * it is a version negotiation packet.
@@ -157,6 +167,12 @@ class QuicReadCodec {
 
   folly::Optional<TimePoint> getHandshakeDoneTime();
 
+  /**
+   * Drops the 0-RTT keys once 0-RTT packets are no longer accepted, i.e.
+   * kTimeToRetainZeroRttKeys after the handshake is done.
+   */
+  void maybeDropZeroRttKeys(TimePoint now);
+
  private:
   CodecResult tryParseShortHeaderPacket(
       Buf data,
@@ -169,6 +185,8 @@ class QuicReadCodec {
 
   [[nodiscard]] std::string connIdToHex() const;
 
+  const HeaderProtectionMask* takePreparedMask(folly::ByteRange sample);
+
   QuicNodeType nodeType_;
 
   CodecParameters params_;
@@ -187,6 +205,11 @@ class QuicReadCodec {
   std::unique_ptr<PacketNumberCipher> zeroRttHeaderCipher_;
   std::unique_ptr<PacketNumberCipher> handshakeHeaderCipher_;
 
+  // 1-rtt masks computed by prepareShortHeaderMasks(), consumed in order.
+  std::vector<Sample> preparedSamples_;
+  std::vector<HeaderProtectionMask> preparedMasks_;
+  size_t nextPreparedMask_{0};
+
   folly::Optional<StatelessResetToken> statelessResetToken_;
   folly::Optional<TimePoint> handshakeDoneTime_;
 };
@@ -438,10 +438,22 @@ folly::Optional<WriteAckFrame> writeAckFrameToPacketBuilder(
         getQuicIntegerSize(maybeLastPktNum).value_or(0) +
         getQuicIntegerSize(maybeLastPktTsDelta.count()).value_or(0);
   }
-  if (spaceLeft < (headerSize + minAdditionalAckReceiveTimestampsFieldsSize)) {
+  QuicInteger ecnECT0CountInt(ackState.ecnECT0CountReceived);
+  QuicInteger ecnECT1CountInt(ackState.ecnECT1CountReceived);
+  QuicInteger ecnCECountInt(ackState.ecnCECountReceived);
+  size_t ecnCountsSize = 0;
+  if (frameType == FrameType::ACK_ECN) {
+    ecnCountsSize = ecnECT0CountInt.getSize() + ecnECT1CountInt.getSize() +
+        ecnCECountInt.getSize();
+  }
+  if (spaceLeft <
+      (headerSize + minAdditionalAckReceiveTimestampsFieldsSize +
+       ecnCountsSize)) {
     return folly::none;
   }
-  spaceLeft -= (headerSize + minAdditionalAckReceiveTimestampsFieldsSize);
+  spaceLeft -=
+      (headerSize + minAdditionalAckReceiveTimestampsFieldsSize +
+       ecnCountsSize);
 
   ackFrame.ackBlocks.push_back(ackState.acks.back());
   auto numAdditionalAckBlocks =
@@ -467,6 +479,14 @@ folly::Optional<WriteAckFrame> writeAckFrameToPacketBuilder(
     builder.write(currentBlockLenInt);
     currentSeqNum = it->start;
   }
+  if (frameType == FrameType::ACK_ECN) {
+    builder.write(ecnECT0CountInt);
+    builder.write(ecnECT1CountInt);
+    builder.write(ecnCECountInt);
+    ackFrame.ecnECT0Count = ackState.ecnECT0CountReceived;
+    ackFrame.ecnECT1Count = ackState.ecnECT1CountReceived;
+    ackFrame.ecnCECount = ackState.ecnCECountReceived;
+  }
   ackFrame.ackDelay = ackFrameMetaData.ackDelay;
   return ackFrame;
 }
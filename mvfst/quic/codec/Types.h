@@ -197,6 +197,10 @@ struct ReadAckFrame {
   folly::Optional<std::chrono::microseconds> maybeLatestRecvdPacketTime;
   folly::Optional<PacketNum> maybeLatestRecvdPacketNum;
   RecvdPacketsTimestampsRangeVec recvdPacketsTimestampRanges;
+  // ECN counts, only present in ACK_ECN frames.
+  uint64_t ecnECT0Count{0};
+  uint64_t ecnECT1Count{0};
+  uint64_t ecnCECount{0};
   bool operator==(const ReadAckFrame& /*rhs*/) const {
     // Can't compare ackBlocks, function is just here to appease compiler.
     return false;
@@ -215,6 +219,10 @@ struct WriteAckFrame {
   folly::Optional<std::chrono::microseconds> maybeLatestRecvdPacketTime;
   folly::Optional<PacketNum> maybeLatestRecvdPacketNum;
   RecvdPacketsTimestampsRangeVec recvdPacketsTimestampRanges;
+  // ECN counts, only written in ACK_ECN frames.
+  uint64_t ecnECT0Count{0};
+  uint64_t ecnECT1Count{0};
+  uint64_t ecnCECount{0};
   bool operator==(const WriteAckFrame& /*rhs*/) const {
     // Can't compare ackBlocks, function is just here to appease compiler.
     return false;
@@ -249,6 +257,12 @@ struct WriteAckFrameState {
   // element in the deque (e.g., entries are not added for packets that
   // arrive out of order relative to previously received packets).
   CircularDeque<RecvdPacketInfo> recvdPacketInfos;
+
+  // Number of packets received with each ECN codepoint, reported to the peer
+  // in ACK_ECN frames.
+  uint64_t ecnECT0CountReceived{0};
+  uint64_t ecnECT1CountReceived{0};
+  uint64_t ecnCECountReceived{0};
 };
 
 struct WriteAckFrameMetaData {
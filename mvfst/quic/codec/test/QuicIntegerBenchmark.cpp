@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <common/init/Init.h>
+#include <folly/Benchmark.h>
+#include <folly/io/Cursor.h>
+#include <quic/codec/QuicInteger.h>
+
+using namespace std;
+using namespace folly;
+using namespace quic;
+
+// A buffer of kNumIntegers encoded integers cycling through all four sizes,
+// split into buffers of chunkSize bytes (0 keeps it contiguous).
+static constexpr size_t kNumIntegers = 1000;
+
+static std::unique_ptr<IOBuf> makeIntegers(size_t chunkSize) {
+  auto contiguous = IOBuf::create(kNumIntegers * sizeof(uint64_t));
+  BufAppender appender(contiguous.get(), kNumIntegers * sizeof(uint64_t));
+  auto appendOp = [&](auto val) { appender.writeBE(val); };
+  constexpr uint64_t kValues[] = {37, 15293, 494878333, 151288809941952652};
+  for (size_t i = 0; i < kNumIntegers; i++) {
+    encodeQuicInteger(kValues[i % 4], appendOp);
+  }
+  if (chunkSize == 0) {
+    return contiguous;
+  }
+  std::unique_ptr<IOBuf> chain;
+  ByteRange data = contiguous->coalesce();
+  while (!data.empty()) {
+    auto len = std::min(chunkSize, data.size());
+    auto chunk = IOBuf::copyBuffer(data.data(), len);
+    if (chain) {
+      chain->prependChain(std::move(chunk));
+    } else {
+      chain = std::move(chunk);
+    }
+    data.advance(len);
+  }
+  return chain;
+}
+
+static inline void benchmarkDecode(size_t n, size_t chunkSize) {
+  std::unique_ptr<IOBuf> buf;
+  BENCHMARK_SUSPEND {
+    buf = makeIntegers(chunkSize);
+  }
+  while (n--) {
+    io::Cursor cursor(buf.get());
+    uint64_t sum = 0;
+    for (size_t i = 0; i < kNumIntegers; i++) {
+      sum += decodeQuicInteger(cursor)->first;
+    }
+    doNotOptimizeAway(sum);
+  }
+}
+
+BENCHMARK(decodeContiguous, n) {
+  benchmarkDecode(n, 0);
+}
+
+BENCHMARK(decodeChained_1200, n) {
+  benchmarkDecode(n, 1200);
+}
+
+BENCHMARK(decodeChained_7, n) {
+  benchmarkDecode(n, 7);
+}
+
+BENCHMARK(decodeRange, n) {
+  std::unique_ptr<IOBuf> buf;
+  BENCHMARK_SUSPEND {
+    buf = makeIntegers(0);
+  }
+  while (n--) {
+    ByteRange range = buf->coalesce();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < kNumIntegers; i++) {
+      auto decoded = decodeQuicInteger(range);
+      sum += decoded->first;
+      range.advance(decoded->second);
+    }
+    doNotOptimizeAway(sum);
+  }
+}
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  runBenchmarks();
+  return 0;
+}
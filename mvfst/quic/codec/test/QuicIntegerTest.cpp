@@ -8,6 +8,7 @@
 #include <folly/Expected.h>
 #include <folly/Optional.h>
 #include <folly/String.h>
+#include <folly/io/Cursor.h>
 #include <folly/io/IOBuf.h>
 #include <folly/portability/GTest.h>
 
@@ -71,6 +72,49 @@ TEST_P(QuicIntegerDecodeTest, DecodeAtMost) {
   }
 }
 
+TEST_P(QuicIntegerDecodeTest, DecodeRange) {
+  std::string encodedBytes = folly::unhexlify(GetParam().hexEncoded);
+  // trailing bytes must be left alone, and put the 8-byte load in play
+  std::string padded = encodedBytes + std::string(8, '\xff');
+
+  for (int atMost = 0; atMost <= GetParam().encodedLength; atMost++) {
+    auto decodedValue = decodeQuicInteger(
+        folly::ByteRange(folly::StringPiece(padded)), atMost);
+    auto exactValue = decodeQuicInteger(
+        folly::ByteRange(folly::StringPiece(encodedBytes)), atMost);
+    if (GetParam().error || atMost != GetParam().encodedLength) {
+      EXPECT_FALSE(exactValue.has_value());
+    } else {
+      EXPECT_EQ(decodedValue->first, GetParam().decoded);
+      EXPECT_EQ(decodedValue->second, GetParam().encodedLength);
+      EXPECT_EQ(exactValue->first, GetParam().decoded);
+      EXPECT_EQ(exactValue->second, GetParam().encodedLength);
+    }
+  }
+}
+
+TEST_P(QuicIntegerDecodeTest, DecodeChained) {
+  std::string encodedBytes = folly::unhexlify(GetParam().hexEncoded);
+
+  for (size_t split = 1; split < encodedBytes.size(); split++) {
+    auto chain = IOBuf::copyBuffer(encodedBytes.data(), split);
+    chain->prependChain(IOBuf::copyBuffer(
+        encodedBytes.data() + split, encodedBytes.size() - split));
+    folly::io::Cursor cursor(chain.get());
+    auto originalLength = cursor.totalLength();
+    auto decodedValue = decodeQuicInteger(cursor);
+    if (GetParam().error) {
+      EXPECT_FALSE(decodedValue.has_value());
+      EXPECT_EQ(cursor.totalLength(), originalLength);
+    } else {
+      EXPECT_EQ(decodedValue->first, GetParam().decoded);
+      EXPECT_EQ(decodedValue->second, GetParam().encodedLength);
+      EXPECT_EQ(
+          cursor.totalLength(), originalLength - GetParam().encodedLength);
+    }
+  }
+}
+
 TEST_P(QuicIntegerEncodeTest, Encode) {
   auto queue = folly::IOBuf::create(0);
   BufAppender appender(queue.get(), 10);
@@ -219,6 +219,40 @@ TEST_F(QuicReadCodecTest, StreamWithShortHeader) {
   EXPECT_TRUE(parseSuccess(std::move(packet)));
 }
 
+TEST_F(QuicReadCodecTest, StreamWithShortHeaderPreparedMasks) {
+  auto connId = getTestConnectionId();
+  StreamId streamId = 2;
+  auto codec = makeEncryptedCodec(connId, createNoOpAead());
+  auto headerCipher = std::make_unique<NiceMock<MockPacketNumberCipher>>();
+  // One mask per packet for the whole batch, none while parsing.
+  EXPECT_CALL(*headerCipher, mask(_))
+      .Times(3)
+      .WillRepeatedly(Return(HeaderProtectionMask{}));
+  codec->setOneRttHeaderCipher(std::move(headerCipher));
+
+  std::vector<Buf> datagrams;
+  for (PacketNum packetNum = 100; packetNum < 103; packetNum++) {
+    auto data = folly::IOBuf::copyBuffer(folly::to<std::string>(
+        "packet number ", packetNum, " carries some stream data"));
+    auto streamPacket = createStreamPacket(
+        connId,
+        connId,
+        packetNum,
+        streamId,
+        *data,
+        0 /* cipherOverhead */,
+        0 /* largestAcked */);
+    datagrams.push_back(packetToBuf(streamPacket));
+  }
+  codec->prepareShortHeaderMasks(datagrams);
+
+  AckStates ackStates;
+  for (auto& datagram : datagrams) {
+    auto packetQueue = bufToQueue(std::move(datagram));
+    EXPECT_TRUE(parseSuccess(codec->parsePacket(packetQueue, ackStates)));
+  }
+}
+
 TEST_F(QuicReadCodecTest, StreamWithShortHeaderOnlyHeader) {
   auto connId = getTestConnectionId();
   PacketNum packetNum = 12321;
@@ -819,3 +853,18 @@ TEST_F(QuicReadCodecTest, TestZeroRttPacketsAfterHandshakeDone) {
   codec->onHandshakeDone(Clock::now() - kTimeToRetainZeroRttKeys * 2);
   EXPECT_FALSE(parseSuccess(codec->parsePacket(packetQueue, ackStates)));
 }
+
+TEST_F(QuicReadCodecTest, TestDropZeroRttKeys) {
+  auto connId = getTestConnectionId();
+  auto codec = makeEncryptedCodec(connId, nullptr, createNoOpAead());
+  // kept before the handshake is done and while 0-RTT packets are accepted
+  codec->maybeDropZeroRttKeys(Clock::now());
+  EXPECT_NE(codec->getZeroRttReadCipher(), nullptr);
+  auto handshakeDoneTime = Clock::now();
+  codec->onHandshakeDone(handshakeDoneTime);
+  codec->maybeDropZeroRttKeys(handshakeDoneTime + 1s);
+  EXPECT_NE(codec->getZeroRttReadCipher(), nullptr);
+  codec->maybeDropZeroRttKeys(handshakeDoneTime + kTimeToRetainZeroRttKeys * 2);
+  EXPECT_EQ(codec->getZeroRttReadCipher(), nullptr);
+  EXPECT_EQ(codec->getZeroRttHeaderCipher(), nullptr);
+}
@@ -1146,6 +1146,48 @@ TEST_P(QuicWriteCodecTest, WriteAckFrameWillSaveAckDelay) {
   EXPECT_EQ(ackDelay, ackFrame.ackDelay);
 }
 
+TEST_F(QuicWriteCodecTest, WriteAckEcnFrame) {
+  MockQuicPacketBuilder pktBuilder;
+  setupCommonExpects(pktBuilder);
+  AckBlocks ackBlocks = {{501, 1000}, {101, 400}};
+  TimePoint connTime = Clock::now();
+  WriteAckFrameState ackState =
+      createTestWriteAckState(FrameType::ACK_ECN, connTime, ackBlocks);
+  ackState.ecnECT0CountReceived = 1000;
+  ackState.ecnCECountReceived = 17;
+  WriteAckFrameMetaData ackFrameMetaData = {
+      .ackState = ackState,
+      .ackDelay = 111us,
+      .ackDelayExponent = static_cast<uint8_t>(kDefaultAckDelayExponent),
+      .connTime = connTime,
+  };
+  // The 11 bytes of the simple ack frame, then 2 bytes for ECT(0), 1 byte for
+  // ECT(1) and 1 byte for CE => 15 bytes
+  auto ackFrameWriteResult =
+      *writeAckFrame(ackFrameMetaData, pktBuilder, FrameType::ACK_ECN);
+  EXPECT_EQ(15, ackFrameWriteResult.bytesWritten);
+  EXPECT_EQ(kDefaultUDPSendPacketLen - 15, pktBuilder.remainingSpaceInPkt());
+
+  auto builtOut = std::move(pktBuilder).buildTestPacket();
+  WriteAckFrame& ackFrame = *builtOut.first.frames.back().asWriteAckFrame();
+  EXPECT_EQ(ackFrame.frameType, FrameType::ACK_ECN);
+  EXPECT_EQ(ackFrame.ecnECT0Count, 1000);
+  EXPECT_EQ(ackFrame.ecnECT1Count, 0);
+  EXPECT_EQ(ackFrame.ecnCECount, 17);
+
+  BufQueue queue;
+  queue.append(builtOut.second->clone());
+  QuicFrame decodedFrame = parseQuicFrame(queue);
+  auto& decodedAckFrame = *decodedFrame.asReadAckFrame();
+  EXPECT_EQ(decodedAckFrame.frameType, FrameType::ACK_ECN);
+  EXPECT_EQ(decodedAckFrame.largestAcked, 1000);
+  EXPECT_EQ(decodedAckFrame.ackBlocks.size(), 2);
+  EXPECT_EQ(decodedAckFrame.ecnECT0Count, 1000);
+  EXPECT_EQ(decodedAckFrame.ecnECT1Count, 0);
+  EXPECT_EQ(decodedAckFrame.ecnCECount, 17);
+  EXPECT_TRUE(queue.empty());
+}
+
 TEST_P(QuicWriteCodecTest, VerifyNumAckBlocksSizeAccounted) {
   // Tests that if we restrict the size to be exactly the size required
   // for a byte num blocks size, if the num blocks requires 2 bytes
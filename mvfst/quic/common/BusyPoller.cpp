@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/common/BusyPoller.h>
+
+namespace quic {
+
+thread_local BusyPoller* BusyPoller::current_ = nullptr;
+
+BusyPoller::BusyPoller(folly::EventBase* evb, Options options)
+    : evb_(evb), options_(options), spinTime_(options.minSpinTime) {
+  CHECK_LE(options_.minSpinTime, options_.maxSpinTime);
+}
+
+BusyPoller::~BusyPoller() {
+  stop();
+}
+
+void BusyPoller::start() {
+  DCHECK(evb_->isInEventBaseThread());
+  CHECK(!current_ || current_ == this)
+      << "Only one busy poller can run per thread";
+  current_ = this;
+  running_ = true;
+  lastActivityTime_ = Clock::now();
+  if (!spinning_) {
+    spinning_ = true;
+    evb_->runInLoop(this);
+  }
+}
+
+void BusyPoller::stop() {
+  if (!running_) {
+    return;
+  }
+  // current_ is only visible from the EventBase's thread, and the loop
+  // callback may only be cancelled there
+  CHECK(evb_->isInEventBaseThread())
+      << "A running busy poller must be stopped on its EventBase's thread";
+  DCHECK_EQ(current_, this);
+  current_ = nullptr;
+  running_ = false;
+  spinning_ = false;
+  cancelLoopCallback();
+}
+
+void BusyPoller::runLoopCallback() noexcept {
+  auto now = Clock::now();
+  if (activity_ != lastActivity_) {
+    lastActivity_ = activity_;
+    lastActivityTime_ = now;
+  }
+  if (now - lastActivityTime_ < spinTime_) {
+    // keeps the next iteration from blocking
+    evb_->runInLoop(this);
+    return;
+  }
+  spinning_ = false;
+  sleepTime_ = now;
+}
+
+void BusyPoller::onActivity() noexcept {
+  ++activity_;
+  if (spinning_) {
+    return;
+  }
+  auto now = Clock::now();
+  auto slept =
+      std::chrono::duration_cast<std::chrono::microseconds>(now - sleepTime_);
+  if (slept < spinTime_) {
+    // spinning a little longer would have avoided the wakeup
+    spinTime_ = std::min(spinTime_ * 2, options_.maxSpinTime);
+  } else {
+    spinTime_ = std::max(spinTime_ / 2, options_.minSpinTime);
+  }
+  lastActivity_ = activity_;
+  lastActivityTime_ = now;
+  spinning_ = true;
+  evb_->runInLoop(this);
+}
+
+} // namespace quic
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/io/async/EventBase.h>
+#include <quic/QuicConstants.h>
+
+namespace quic {
+
+/**
+ * Keeps an EventBase from blocking in epoll while there is traffic. The poller
+ * is a loop callback that schedules itself for every iteration, which makes
+ * the EventBase poll its fds without blocking. Once no activity has been noted
+ * for the spin time, it stops rescheduling itself and the EventBase blocks
+ * again until the next event. The spin time adapts to the idle gaps: it grows
+ * when activity resumes shortly after the poller went to sleep, and shrinks
+ * when the EventBase sleeps for longer than that.
+ *
+ * Readers call noteActivity() when they got data; the poller costs a dedicated
+ * core while spinning.
+ */
+class BusyPoller : public folly::EventBase::LoopCallback {
+ public:
+  struct Options {
+    std::chrono::microseconds minSpinTime{50};
+    std::chrono::microseconds maxSpinTime{5000};
+  };
+
+  BusyPoller(folly::EventBase* evb, Options options);
+  ~BusyPoller() override;
+
+  /**
+   * Starts polling. Must be called on the EventBase's thread, a thread can
+   * have only one running poller.
+   */
+  void start();
+
+  /**
+   * Stops polling and unregisters the poller from its thread. Must be called
+   * on the EventBase's thread, which the destructor checks if the poller is
+   * still running.
+   */
+  void stop();
+
+  bool isSpinning() const {
+    return spinning_;
+  }
+
+  std::chrono::microseconds getSpinTime() const {
+    return spinTime_;
+  }
+
+  /**
+   * Notes activity for the poller running on the calling thread, if any.
+   */
+  static void noteActivity() noexcept {
+    if (current_) {
+      current_->onActivity();
+    }
+  }
+
+  void runLoopCallback() noexcept override;
+
+ private:
+  void onActivity() noexcept;
+
+  static thread_local BusyPoller* current_;
+
+  folly::EventBase* evb_;
+  const Options options_;
+  std::chrono::microseconds spinTime_;
+  // between start() and stop(), current_ of the EventBase's thread is this
+  bool running_{false};
+  bool spinning_{false};
+  uint64_t activity_{0};
+  uint64_t lastActivity_{0};
+  TimePoint lastActivityTime_;
+  TimePoint sleepTime_;
+};
+
+} // namespace quic
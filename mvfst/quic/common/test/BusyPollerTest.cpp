@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/common/BusyPoller.h>
+
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace std;
+using namespace folly;
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+TEST(BusyPollerTest, SpinsUntilIdle) {
+  EventBase evb;
+  BusyPoller::Options options;
+  options.minSpinTime = 1ms;
+  options.maxSpinTime = 4ms;
+  BusyPoller poller(&evb, options);
+  poller.start();
+  EXPECT_TRUE(poller.isSpinning());
+  // the loop does not block while the poller is scheduled
+  for (int i = 0; i < 10; i++) {
+    evb.loopOnce();
+    EXPECT_TRUE(poller.isSpinning());
+  }
+  auto start = Clock::now();
+  while (poller.isSpinning()) {
+    evb.loopOnce();
+  }
+  EXPECT_GE(Clock::now() - start, options.minSpinTime);
+  EXPECT_EQ(poller.getSpinTime(), options.minSpinTime);
+}
+
+TEST(BusyPollerTest, ActivityKeepsSpinning) {
+  EventBase evb;
+  BusyPoller::Options options;
+  options.minSpinTime = 2ms;
+  options.maxSpinTime = 8ms;
+  BusyPoller poller(&evb, options);
+  poller.start();
+  auto start = Clock::now();
+  while (Clock::now() - start < 3 * options.minSpinTime) {
+    BusyPoller::noteActivity();
+    evb.loopOnce();
+    EXPECT_TRUE(poller.isSpinning());
+  }
+}
+
+TEST(BusyPollerTest, SpinTimeAdapts) {
+  EventBase evb;
+  BusyPoller::Options options;
+  options.minSpinTime = 1ms;
+  options.maxSpinTime = 4ms;
+  BusyPoller poller(&evb, options);
+  poller.start();
+  while (poller.isSpinning()) {
+    evb.loopOnce();
+  }
+  // activity right after going to sleep doubles the spin time
+  BusyPoller::noteActivity();
+  EXPECT_TRUE(poller.isSpinning());
+  EXPECT_EQ(poller.getSpinTime(), 2ms);
+  while (poller.isSpinning()) {
+    evb.loopOnce();
+  }
+  BusyPoller::noteActivity();
+  EXPECT_EQ(poller.getSpinTime(), 4ms);
+  while (poller.isSpinning()) {
+    evb.loopOnce();
+  }
+  BusyPoller::noteActivity();
+  EXPECT_EQ(poller.getSpinTime(), options.maxSpinTime);
+  while (poller.isSpinning()) {
+    evb.loopOnce();
+  }
+  // a long sleep halves it
+  std::this_thread::sleep_for(10ms);
+  BusyPoller::noteActivity();
+  EXPECT_EQ(poller.getSpinTime(), 2ms);
+}
+
+TEST(BusyPollerTest, StopAndNoActivity) {
+  EventBase evb;
+  BusyPoller poller(&evb, BusyPoller::Options());
+  poller.start();
+  poller.stop();
+  EXPECT_FALSE(poller.isSpinning());
+  // no poller runs on this thread anymore
+  BusyPoller::noteActivity();
+  EXPECT_FALSE(poller.isSpinning());
+  evb.loopOnce(EVLOOP_NONBLOCK);
+  EXPECT_FALSE(poller.isSpinning());
+}
+
+TEST(BusyPollerTest, StopAllowsNewPoller) {
+  EventBase evb;
+  auto poller = std::make_unique<BusyPoller>(&evb, BusyPoller::Options());
+  poller->start();
+  poller.reset();
+  // the destroyed poller no longer holds the thread
+  BusyPoller::noteActivity();
+  BusyPoller newPoller(&evb, BusyPoller::Options());
+  newPoller.start();
+  EXPECT_TRUE(newPoller.isSpinning());
+}
+
+TEST(BusyPollerTest, StoppedPollerDestroyedOnOtherThread) {
+  EventBase evb;
+  auto poller = std::make_unique<BusyPoller>(&evb, BusyPoller::Options());
+  std::thread evbThread([&] { evb.loopForever(); });
+  evb.runInEventBaseThreadAndWait([&] { poller->start(); });
+  evb.runInEventBaseThreadAndWait([&] { poller->stop(); });
+  poller.reset();
+  // the poller was unregistered from the EventBase's thread
+  evb.runInEventBaseThreadAndWait([&] {
+    BusyPoller newPoller(&evb, BusyPoller::Options());
+    newPoller.start();
+    EXPECT_TRUE(newPoller.isSpinning());
+  });
+  evb.terminateLoopSoon();
+  evbThread.join();
+}
+
+} // namespace test
+} // namespace quic
@@ -213,7 +213,7 @@ template <typename Match>
 OutstandingPacketWrapper* findOutstandingPacket(
     QuicConnectionStateBase& conn,
     Match match) {
-  auto helper = [&](std::deque<OutstandingPacketWrapper>& packets)
+  auto helper = [&](OutstandingPacketList& packets)
       -> OutstandingPacketWrapper* {
     for (auto& packet : packets) {
       if (match(packet)) {
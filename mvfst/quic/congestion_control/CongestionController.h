@@ -125,6 +125,16 @@ struct CongestionController {
     return folly::none;
   }
 
+  /**
+   * Return the time until the controller becomes writable again if it is
+   * blocked by something an ack does not change, such as a rate limit. The
+   * transport then schedules a write instead of waiting for the next ack.
+   */
+  FOLLY_NODISCARD virtual folly::Optional<std::chrono::microseconds>
+  getTimeUntilWritable() const {
+    return folly::none;
+  }
+
   /**
    * Notify congestion controller that the connection has become idle or active
    * in the sense that there are active non-control streams.
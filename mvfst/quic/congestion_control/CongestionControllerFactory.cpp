@@ -16,6 +16,7 @@
 #include <quic/congestion_control/NewReno.h>
 #include <quic/congestion_control/QuicCubic.h>
 #include <quic/congestion_control/StaticCwndCongestionController.h>
+#include <quic/congestion_control/TunnelCongestionController.h>
 
 #include <memory>
 
@@ -64,6 +65,9 @@ DefaultCongestionControllerFactory::makeCongestionController(
           "constructed via CongestionControllerFactory.",
           LocalErrorCode::INTERNAL_ERROR);
     }
+    case CongestionControlType::Tunnel:
+      congestionController = std::make_unique<TunnelCongestionController>(conn);
+      break;
     case CongestionControlType::None:
       break;
     case CongestionControlType::MAX:
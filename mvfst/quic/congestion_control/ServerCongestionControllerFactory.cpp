@@ -17,6 +17,7 @@
 #include <quic/congestion_control/NewReno.h>
 #include <quic/congestion_control/QuicCubic.h>
 #include <quic/congestion_control/StaticCwndCongestionController.h>
+#include <quic/congestion_control/TunnelCongestionController.h>
 
 #include <memory>
 
@@ -67,6 +68,9 @@ ServerCongestionControllerFactory::makeCongestionController(
           "constructed via CongestionControllerFactory.",
           LocalErrorCode::INTERNAL_ERROR);
     }
+    case CongestionControlType::Tunnel:
+      congestionController = std::make_unique<TunnelCongestionController>(conn);
+      break;
     case CongestionControlType::None:
       break;
     case CongestionControlType::MAX:
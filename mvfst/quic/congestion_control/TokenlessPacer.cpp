@@ -107,20 +107,21 @@ void TokenlessPacer::onPacketsLoss() {}
 
 std::chrono::microseconds TokenlessPacer::getTimeUntilNextWrite(
     TimePoint now) const {
+  auto wakeupInterval = writeInterval_ * burstsPerWrite();
   // If we don't have a lastWriteTime_, we want to write immediately.
   auto timeSinceLastWrite =
       std::chrono::duration_cast<std::chrono::microseconds>(
-          now - lastWriteTime_.value_or(now - 2 * writeInterval_));
-  if (timeSinceLastWrite >= writeInterval_) {
+          now - lastWriteTime_.value_or(now - 2 * wakeupInterval));
+  if (timeSinceLastWrite >= wakeupInterval) {
     return 0us;
   }
   return std::max(
-      writeInterval_ - timeSinceLastWrite,
+      wakeupInterval - timeSinceLastWrite,
       conn_.transportSettings.pacingTickInterval);
 }
 
 uint64_t TokenlessPacer::updateAndGetWriteBatchSize(TimePoint currentTime) {
-  auto sendBatch = batchSize_;
+  auto sendBatch = batchSize_ * burstsPerWrite();
   if (lastWriteTime_.hasValue() && writeInterval_ > 0us &&
       conn_.congestionController &&
       !conn_.congestionController->isAppLimited()) {
@@ -130,7 +131,8 @@ uint64_t TokenlessPacer::updateAndGetWriteBatchSize(TimePoint currentTime) {
             currentTime - lastWriteTime_.value());
     if (conn_.congestionController &&
         !conn_.congestionController->isAppLimited() &&
-        timeSinceLastWrite > (writeInterval_ * 110 / 100)) {
+        timeSinceLastWrite >
+            (writeInterval_ * burstsPerWrite() * 110 / 100)) {
       // Log if connection is not application-limited and the timer has been
       // delayed by more than 10% of the expected write interval
       QUIC_STATS(conn_.statsCallback, onPacerTimerLagged);
@@ -149,6 +151,19 @@ uint64_t TokenlessPacer::getCachedWriteBatchSize() const {
   return batchSize_;
 }
 
+std::chrono::microseconds TokenlessPacer::getWriteInterval() const {
+  return writeInterval_;
+}
+
+uint64_t TokenlessPacer::burstsPerWrite() const {
+  if (conn_.transportSettings.edtPacing &&
+      conn_.txTimeSupported.value_or(false) &&
+      !conn_.transportSettings.useThreadLocalBatching && writeInterval_ > 0us) {
+    return std::max<uint64_t>(conn_.transportSettings.edtPacingBursts, 1);
+  }
+  return 1;
+}
+
 void TokenlessPacer::setPacingRateCalculator(
     PacingRateCalculator pacingRateCalculator) {
   pacingRateCalculator_ = std::move(pacingRateCalculator);
@@ -43,12 +43,18 @@ class TokenlessPacer : public Pacer {
 
   uint64_t getCachedWriteBatchSize() const override;
 
+  std::chrono::microseconds getWriteInterval() const override;
+
   void onPacketSent() override;
   void onPacketsLoss() override;
 
   void setExperimental(bool experimental) override;
 
  private:
+  // Number of write batches covered by one wakeup. More than one when the
+  // kernel spaces the batches out by their departure times.
+  uint64_t burstsPerWrite() const;
+
   const QuicConnectionStateBase& conn_;
   uint64_t minCwndInMss_;
   uint64_t batchSize_;
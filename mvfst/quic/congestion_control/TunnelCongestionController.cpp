@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/congestion_control/TunnelCongestionController.h>
+
+#include <quic/congestion_control/BbrBandwidthSampler.h>
+#include <quic/congestion_control/CongestionControlFunctions.h>
+
+#include <cmath>
+
+namespace quic {
+
+TunnelCongestionController::TunnelCongestionController(
+    QuicConnectionStateBase& conn)
+    : conn_(conn),
+      config_(conn.transportSettings.tunnelCongestionConfig),
+      bandwidthSampler_(std::make_unique<BbrBandwidthSampler>(conn)),
+      cwndBytes_(
+          conn.udpSendPacketLen * conn.transportSettings.initCwndInMss),
+      endOfRoundTrip_(Clock::now()) {
+  if (config_.shapingRateBytesPerSec > 0) {
+    SimulatedTBF::Config tbfConfig;
+    tbfConfig.rateBytesPerSecond = config_.shapingRateBytesPerSec;
+    tbfConfig.burstSizeBytes = std::max(
+        config_.shapingBurstBytes, uint64_t(conn.udpSendPacketLen));
+    tbfConfig.trackEmptyIntervals = false;
+    shaper_ = std::make_unique<SimulatedTBF>(std::move(tbfConfig));
+  }
+}
+
+void TunnelCongestionController::setBandwidthSampler(
+    std::unique_ptr<BbrCongestionController::BandwidthSampler>
+        sampler) noexcept {
+  bandwidthSampler_ = std::move(sampler);
+}
+
+void TunnelCongestionController::onRemoveBytesFromInflight(
+    uint64_t bytesToRemove) {
+  subtractAndCheckUnderflow(inflightBytes_, bytesToRemove);
+}
+
+void TunnelCongestionController::onPacketSent(
+    const OutstandingPacketWrapper& packet) {
+  addAndCheckOverflow(inflightBytes_, packet.metadata.encodedSize);
+  if (shaper_) {
+    shaper_->consumeWithBorrowNonBlockingAndUpdateState(
+        packet.metadata.encodedSize, packet.metadata.time);
+  }
+}
+
+void TunnelCongestionController::onPacketAckOrLoss(
+    const AckEvent* FOLLY_NULLABLE ackEvent,
+    const LossEvent* FOLLY_NULLABLE lossEvent) {
+  if (lossEvent) {
+    // losses are left to the flows inside the tunnel
+    subtractAndCheckUnderflow(inflightBytes_, lossEvent->lostBytes);
+    if (lossEvent->persistentCongestion) {
+      bandwidthSampler_ = std::make_unique<BbrBandwidthSampler>(conn_);
+    }
+  }
+  if (ackEvent && ackEvent->largestNewlyAckedPacket.has_value()) {
+    onPacketAcked(*ackEvent);
+  }
+  updateCwnd();
+}
+
+void TunnelCongestionController::onPacketAcked(const AckEvent& ack) {
+  subtractAndCheckUnderflow(inflightBytes_, ack.ackedBytes);
+  if (ack.largestNewlyAckedPacketSentTime > endOfRoundTrip_) {
+    roundTripCounter_++;
+    endOfRoundTrip_ = Clock::now();
+  }
+  if (bandwidthSampler_) {
+    bandwidthSampler_->onPacketAcked(ack, roundTripCounter_);
+  }
+}
+
+void TunnelCongestionController::updateCwnd() {
+  auto bandwidth = getBandwidth();
+  if (!bandwidth || conn_.lossState.srtt == 0us) {
+    return;
+  }
+  uint64_t bdp = *bandwidth * conn_.lossState.mrtt;
+  cwndBytes_ = boundedCwnd(
+      bdp * config_.cwndGain,
+      conn_.udpSendPacketLen,
+      conn_.transportSettings.maxCwndInMss,
+      kMinCwndInMssForBbr);
+  if (conn_.pacer) {
+    conn_.pacer->refreshPacingRate(cwndBytes_, conn_.lossState.mrtt);
+  }
+}
+
+uint64_t TunnelCongestionController::getWritableBytes() const noexcept {
+  uint64_t writableBytes =
+      cwndBytes_ > inflightBytes_ ? cwndBytes_ - inflightBytes_ : 0;
+  if (shaper_) {
+    auto tokens = shaper_->getNumAvailableTokensInBytes(Clock::now());
+    writableBytes =
+        std::min(writableBytes, tokens > 0 ? uint64_t(tokens) : uint64_t(0));
+  }
+  return writableBytes;
+}
+
+folly::Optional<std::chrono::microseconds>
+TunnelCongestionController::getTimeUntilWritable() const {
+  // a full window is reopened by the acks of the bytes in flight, while an
+  // empty shaper only refills with time
+  if (!shaper_ || cwndBytes_ <= inflightBytes_) {
+    return folly::none;
+  }
+  auto tokens = shaper_->getNumAvailableTokensInBytes(Clock::now());
+  if (tokens >= conn_.udpSendPacketLen) {
+    return folly::none;
+  }
+  // until there is room for a full packet
+  return std::chrono::microseconds(static_cast<uint64_t>(std::ceil(
+      (conn_.udpSendPacketLen - tokens) * 1000 * 1000 /
+      config_.shapingRateBytesPerSec)));
+}
+
+uint64_t TunnelCongestionController::getCongestionWindow() const noexcept {
+  return cwndBytes_;
+}
+
+folly::Optional<Bandwidth> TunnelCongestionController::getBandwidth() const {
+  if (!bandwidthSampler_) {
+    return folly::none;
+  }
+  auto bandwidth = bandwidthSampler_->getBandwidth();
+  if (!bandwidth) {
+    return folly::none;
+  }
+  return bandwidth;
+}
+
+CongestionControlType TunnelCongestionController::type() const noexcept {
+  return CongestionControlType::Tunnel;
+}
+
+bool TunnelCongestionController::isInBackgroundMode() const {
+  return false;
+}
+
+bool TunnelCongestionController::isAppLimited() const {
+  return bandwidthSampler_ && bandwidthSampler_->isAppLimited();
+}
+
+void TunnelCongestionController::setAppLimited() noexcept {
+  if (bandwidthSampler_ && inflightBytes_ <= cwndBytes_) {
+    bandwidthSampler_->onAppLimited();
+  }
+}
+
+} // namespace quic
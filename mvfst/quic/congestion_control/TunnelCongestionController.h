@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/congestion_control/Bbr.h>
+#include <quic/congestion_control/CongestionController.h>
+#include <quic/congestion_control/SimulatedTBF.h>
+#include <quic/state/StateData.h>
+#include <quic/state/TransportSettings.h>
+
+namespace quic {
+
+/**
+ * Congestion controller for connections carrying flows that run their own
+ * congestion control, such as a MASQUE tunnel.
+ *
+ * Nesting two loss-based or delay-based controllers makes them fight: the
+ * outer one queues what the inner ones send and hides the path's losses and
+ * delay from them. This controller therefore does not react to losses or RTT
+ * increases. It estimates the bottleneck bandwidth the way BBR does and only
+ * caps the bytes in flight at a multiple of the bandwidth-delay product. If a
+ * shaping rate is configured, it stops sending above that rate, so that
+ * datagrams are dropped at the tunnel and the inner flows back off.
+ */
+class TunnelCongestionController : public CongestionController {
+ public:
+  explicit TunnelCongestionController(QuicConnectionStateBase& conn);
+
+  void setBandwidthSampler(
+      std::unique_ptr<BbrCongestionController::BandwidthSampler>
+          sampler) noexcept;
+
+  void onRemoveBytesFromInflight(uint64_t bytesToRemove) override;
+
+  void onPacketSent(const OutstandingPacketWrapper& packet) override;
+
+  void onPacketAckOrLoss(
+      const AckEvent* FOLLY_NULLABLE ackEvent,
+      const LossEvent* FOLLY_NULLABLE lossEvent) override;
+
+  FOLLY_NODISCARD uint64_t getWritableBytes() const noexcept override;
+
+  FOLLY_NODISCARD uint64_t getCongestionWindow() const noexcept override;
+
+  FOLLY_NODISCARD folly::Optional<Bandwidth> getBandwidth() const override;
+
+  FOLLY_NODISCARD folly::Optional<std::chrono::microseconds>
+  getTimeUntilWritable() const override;
+
+  FOLLY_NODISCARD CongestionControlType type() const noexcept override;
+
+  FOLLY_NODISCARD bool isInBackgroundMode() const override;
+
+  FOLLY_NODISCARD bool isAppLimited() const override;
+
+  void setAppLimited() noexcept override;
+
+  void setAppIdle(bool, TimePoint) noexcept override {}
+
+  void setBandwidthUtilizationFactor(float) noexcept override {}
+
+  void getStats(CongestionControllerStats&) const override {}
+
+ private:
+  void onPacketAcked(const AckEvent& ack);
+  void updateCwnd();
+
+  QuicConnectionStateBase& conn_;
+  const TunnelCongestionConfig config_;
+  std::unique_ptr<BbrCongestionController::BandwidthSampler> bandwidthSampler_;
+  // none without a shaping rate
+  std::unique_ptr<SimulatedTBF> shaper_;
+  uint64_t inflightBytes_{0};
+  uint64_t cwndBytes_;
+  uint64_t roundTripCounter_{0};
+  TimePoint endOfRoundTrip_;
+};
+
+} // namespace quic
@@ -41,6 +41,29 @@ TEST_F(TokenlessPacerTest, RateCalculator) {
   EXPECT_NEAR(1234, pacer.getTimeUntilNextWrite().count(), 100);
 }
 
+TEST_F(TokenlessPacerTest, EdtPacing) {
+  conn.transportSettings.edtPacing = true;
+  conn.transportSettings.edtPacingBursts = 4;
+  pacer.setPacingRateCalculator([](const QuicConnectionStateBase&,
+                                   uint64_t,
+                                   uint64_t,
+                                   std::chrono::microseconds) {
+    return PacingRate::Builder().setInterval(1000us).setBurstSize(10).build();
+  });
+  pacer.refreshPacingRate(20, 100us); // These two values do not matter here
+  // Without SO_TXTIME on the socket the pacer keeps to one burst per wakeup.
+  auto currentTime = Clock::now();
+  EXPECT_EQ(10, pacer.updateAndGetWriteBatchSize(currentTime));
+  EXPECT_EQ(1000us, pacer.getTimeUntilNextWrite(currentTime));
+
+  conn.txTimeSupported = true;
+  EXPECT_EQ(1000us, pacer.getWriteInterval());
+  EXPECT_EQ(40, pacer.updateAndGetWriteBatchSize(currentTime));
+  EXPECT_EQ(4000us, pacer.getTimeUntilNextWrite(currentTime));
+  EXPECT_EQ(1000us, pacer.getTimeUntilNextWrite(currentTime + 3000us));
+  EXPECT_EQ(0us, pacer.getTimeUntilNextWrite(currentTime + 4000us));
+}
+
 TEST_F(TokenlessPacerTest, NoCompensateTimerDrift) {
   pacer.setPacingRateCalculator([](const QuicConnectionStateBase&,
                                    uint64_t,
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/congestion_control/TunnelCongestionController.h>
+
+#include <folly/portability/GMock.h>
+#include <folly/portability/GTest.h>
+#include <quic/common/test/TestUtils.h>
+#include <quic/congestion_control/test/Mocks.h>
+
+#include <thread>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+class TunnelCongestionControllerTest : public Test {
+ public:
+  void SetUp() override {
+    conn_.udpSendPacketLen = 1000;
+  }
+
+  MockBandwidthSampler* setBandwidthSampler(TunnelCongestionController& cc) {
+    auto sampler = std::make_unique<NiceMock<MockBandwidthSampler>>();
+    auto rawSampler = sampler.get();
+    cc.setBandwidthSampler(std::move(sampler));
+    return rawSampler;
+  }
+
+ protected:
+  QuicConnectionStateBase conn_{QuicNodeType::Client};
+};
+
+TEST_F(TunnelCongestionControllerTest, InitStates) {
+  TunnelCongestionController cc(conn_);
+  EXPECT_EQ(CongestionControlType::Tunnel, cc.type());
+  EXPECT_EQ(
+      1000 * conn_.transportSettings.initCwndInMss, cc.getCongestionWindow());
+  EXPECT_EQ(cc.getWritableBytes(), cc.getCongestionWindow());
+  EXPECT_FALSE(cc.getBandwidth().has_value());
+}
+
+TEST_F(TunnelCongestionControllerTest, CwndFromBandwidth) {
+  TunnelCongestionController cc(conn_);
+  auto sampler = setBandwidthSampler(cc);
+  conn_.lossState.srtt = 20ms;
+  conn_.lossState.mrtt = 10ms;
+  // 1MB/s over 10ms
+  ON_CALL(*sampler, getBandwidth())
+      .WillByDefault(Return(Bandwidth(1000, 1ms)));
+
+  auto packet = makeTestingWritePacket(0, 3000, 3000);
+  cc.onPacketSent(packet);
+  EXPECT_CALL(*sampler, onPacketAcked(_, 1));
+  auto ack = makeAck(0, 3000, Clock::now(), packet.metadata.time);
+  cc.onPacketAckOrLoss(&ack, nullptr);
+  EXPECT_EQ(
+      10000 * conn_.transportSettings.tunnelCongestionConfig.cwndGain,
+      cc.getCongestionWindow());
+  EXPECT_EQ(cc.getWritableBytes(), cc.getCongestionWindow());
+
+  // bounded below, however low the bandwidth
+  ON_CALL(*sampler, getBandwidth()).WillByDefault(Return(Bandwidth(1, 1ms)));
+  cc.onPacketAckOrLoss(&ack, nullptr);
+  EXPECT_EQ(1000 * kMinCwndInMssForBbr, cc.getCongestionWindow());
+}
+
+TEST_F(TunnelCongestionControllerTest, LossesDoNotShrinkCwnd) {
+  TunnelCongestionController cc(conn_);
+  auto cwnd = cc.getCongestionWindow();
+  cc.onPacketSent(makeTestingWritePacket(0, 1000, 1000));
+  cc.onPacketSent(makeTestingWritePacket(1, 1000, 2000));
+  EXPECT_EQ(cwnd - 2000, cc.getWritableBytes());
+
+  CongestionController::LossEvent loss;
+  loss.lostBytes = 1000;
+  loss.lostPackets = 1;
+  cc.onPacketAckOrLoss(nullptr, &loss);
+  EXPECT_EQ(cwnd, cc.getCongestionWindow());
+  EXPECT_EQ(cwnd - 1000, cc.getWritableBytes());
+
+  loss.persistentCongestion = true;
+  cc.onPacketAckOrLoss(nullptr, &loss);
+  EXPECT_EQ(cwnd, cc.getCongestionWindow());
+  EXPECT_EQ(cwnd, cc.getWritableBytes());
+}
+
+TEST_F(TunnelCongestionControllerTest, ShapingRate) {
+  conn_.transportSettings.tunnelCongestionConfig.shapingRateBytesPerSec =
+      1000 * 1000;
+  conn_.transportSettings.tunnelCongestionConfig.shapingBurstBytes = 5000;
+  TunnelCongestionController cc(conn_);
+  EXPECT_LT(cc.getWritableBytes(), cc.getCongestionWindow());
+  EXPECT_LE(cc.getWritableBytes(), 5000);
+
+  // the burst is used up while the cwnd still leaves room
+  cc.onPacketSent(makeTestingWritePacket(0, 5000, 5000));
+  EXPECT_LT(cc.getWritableBytes(), 1000);
+}
+
+TEST_F(TunnelCongestionControllerTest, DrainedShaperNothingInflight) {
+  conn_.transportSettings.tunnelCongestionConfig.shapingRateBytesPerSec =
+      1000 * 1000;
+  conn_.transportSettings.tunnelCongestionConfig.shapingBurstBytes = 5000;
+  TunnelCongestionController cc(conn_);
+  EXPECT_FALSE(cc.getTimeUntilWritable().has_value());
+
+  auto packet = makeTestingWritePacket(0, 5000, 5000);
+  cc.onPacketSent(packet);
+  auto ack = makeAck(0, 5000, Clock::now(), packet.metadata.time);
+  cc.onPacketAckOrLoss(&ack, nullptr);
+  // no ack will come, so the transport has to be told when to write
+  EXPECT_LT(cc.getWritableBytes(), 1000);
+  auto timeUntilWritable = cc.getTimeUntilWritable();
+  ASSERT_TRUE(timeUntilWritable.has_value());
+  EXPECT_GT(*timeUntilWritable, 0us);
+  // 1000 bytes at 1MB/s
+  EXPECT_LE(*timeUntilWritable, 1ms);
+
+  std::this_thread::sleep_for(*timeUntilWritable);
+  EXPECT_GE(cc.getWritableBytes(), 1000);
+  EXPECT_FALSE(cc.getTimeUntilWritable().has_value());
+}
+
+TEST_F(TunnelCongestionControllerTest, FullWindowWaitsForAcks) {
+  conn_.transportSettings.tunnelCongestionConfig.shapingRateBytesPerSec =
+      1000 * 1000;
+  TunnelCongestionController cc(conn_);
+  cc.onPacketSent(makeTestingWritePacket(0, cc.getCongestionWindow(), 0));
+  EXPECT_EQ(cc.getWritableBytes(), 0);
+  EXPECT_FALSE(cc.getTimeUntilWritable().has_value());
+}
+
+TEST_F(TunnelCongestionControllerTest, RemoveBytesFromInflight) {
+  TunnelCongestionController cc(conn_);
+  cc.onPacketSent(makeTestingWritePacket(0, 1000, 1000));
+  EXPECT_EQ(cc.getCongestionWindow() - 1000, cc.getWritableBytes());
+  cc.onRemoveBytesFromInflight(1000);
+  EXPECT_EQ(cc.getCongestionWindow(), cc.getWritableBytes());
+}
+
+TEST_F(TunnelCongestionControllerTest, AppLimited) {
+  TunnelCongestionController cc(conn_);
+  auto sampler = setBandwidthSampler(cc);
+  EXPECT_CALL(*sampler, onAppLimited());
+  cc.setAppLimited();
+  EXPECT_CALL(*sampler, isAppLimited()).WillOnce(Return(true));
+  EXPECT_TRUE(cc.isAppLimited());
+}
+
+} // namespace test
+} // namespace quic
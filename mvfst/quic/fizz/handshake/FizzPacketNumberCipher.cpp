@@ -42,6 +42,31 @@ static HeaderProtectionMask maskImpl(
   return outMask;
 }
 
+// ECB has no chaining between blocks, so a single update over all samples
+// lets OpenSSL pipeline the AES rounds of several blocks at once.
+static void batchMaskImpl(
+    const folly::ssl::EvpCipherCtxUniquePtr& context,
+    folly::Range<const Sample*> samples,
+    HeaderProtectionMask* masks) {
+  static_assert(
+      sizeof(Sample) == sizeof(HeaderProtectionMask),
+      "a mask is one cipher block of a sample");
+  if (samples.empty()) {
+    return;
+  }
+  int inLen = samples.size() * sizeof(Sample);
+  int outLen = 0;
+  if (EVP_EncryptUpdate(
+          context.get(),
+          masks->data(),
+          &outLen,
+          samples.front().data(),
+          inLen) != 1 ||
+      outLen != inLen) {
+    throw std::runtime_error("Encryption error");
+  }
+}
+
 void Aes128PacketNumberCipher::setKey(folly::ByteRange key) {
   pnKey_ = folly::IOBuf::copyBuffer(key);
   return setKeyImpl(encryptCtx_, EVP_aes_128_ecb(), key);
@@ -70,6 +95,18 @@ HeaderProtectionMask Aes256PacketNumberCipher::mask(
   return maskImpl(encryptCtx_, sample);
 }
 
+void Aes128PacketNumberCipher::batchMask(
+    folly::Range<const Sample*> samples,
+    HeaderProtectionMask* masks) const {
+  batchMaskImpl(encryptCtx_, samples, masks);
+}
+
+void Aes256PacketNumberCipher::batchMask(
+    folly::Range<const Sample*> samples,
+    HeaderProtectionMask* masks) const {
+  batchMaskImpl(encryptCtx_, samples, masks);
+}
+
 constexpr size_t kAES128KeyLength = 16;
 
 size_t Aes128PacketNumberCipher::keyLength() const {
@@ -23,6 +23,10 @@ class Aes128PacketNumberCipher : public PacketNumberCipher {
 
   HeaderProtectionMask mask(folly::ByteRange sample) const override;
 
+  void batchMask(
+      folly::Range<const Sample*> samples,
+      HeaderProtectionMask* masks) const override;
+
   size_t keyLength() const override;
 
  private:
@@ -41,6 +45,10 @@ class Aes256PacketNumberCipher : public PacketNumberCipher {
 
   HeaderProtectionMask mask(folly::ByteRange sample) const override;
 
+  void batchMask(
+      folly::Range<const Sample*> samples,
+      HeaderProtectionMask* masks) const override;
+
   size_t keyLength() const override;
 
  private:
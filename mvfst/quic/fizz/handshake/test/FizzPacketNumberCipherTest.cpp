@@ -89,6 +89,46 @@ TEST_P(LongPacketNumberCipherTest, TestEncryptDecrypt) {
       GetParam().decryptedPacketNumberBytes);
 }
 
+TEST_P(LongPacketNumberCipherTest, TestBatchMask) {
+  FizzCryptoFactory cryptoFactory;
+  auto cipher = cryptoFactory.makePacketNumberCipher(GetParam().cipher);
+  auto key = folly::unhexlify(GetParam().key);
+  cipher->setKey(folly::range(key));
+  std::vector<Sample> samples(9);
+  for (size_t i = 0; i < samples.size(); i++) {
+    samples[i] = hexToBytes<SampleBytes>(GetParam().sample);
+    samples[i][i] ^= 0xff;
+  }
+  std::vector<HeaderProtectionMask> masks(samples.size());
+  cipher->batchMask(folly::range(samples), masks.data());
+  for (size_t i = 0; i < samples.size(); i++) {
+    EXPECT_EQ(masks[i], cipher->mask(folly::range(samples[i])));
+  }
+
+  // A precomputed mask protects the header exactly like the sample does.
+  CipherBytes cipherBytes(
+      GetParam().sample,
+      GetParam().decryptedInitialByte,
+      GetParam().decryptedPacketNumberBytes);
+  auto headerMask = cipher->mask(folly::range(cipherBytes.sample));
+  cipher->encryptLongHeaderWithMask(
+      headerMask,
+      folly::range(cipherBytes.initial),
+      folly::range(cipherBytes.packetNumber));
+  EXPECT_EQ(folly::hexlify(cipherBytes.initial), GetParam().initialByte);
+  EXPECT_EQ(
+      folly::hexlify(cipherBytes.packetNumber), GetParam().packetNumberBytes);
+  cipher->decryptLongHeaderWithMask(
+      headerMask,
+      folly::range(cipherBytes.initial),
+      folly::range(cipherBytes.packetNumber));
+  EXPECT_EQ(
+      folly::hexlify(cipherBytes.initial), GetParam().decryptedInitialByte);
+  EXPECT_EQ(
+      folly::hexlify(cipherBytes.packetNumber),
+      GetParam().decryptedPacketNumberBytes);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     LongPacketNumberCipherTests,
     LongPacketNumberCipherTest,
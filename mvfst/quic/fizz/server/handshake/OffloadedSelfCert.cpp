@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/fizz/server/handshake/OffloadedSelfCert.h>
+
+#include <folly/futures/Future.h>
+
+namespace quic {
+
+OffloadedSelfCert::OffloadedSelfCert(
+    std::shared_ptr<const fizz::SelfCert> cert,
+    std::shared_ptr<folly::Executor> executor)
+    : cert_(std::move(cert)), executor_(std::move(executor)) {
+  CHECK(cert_);
+  CHECK(executor_);
+}
+
+std::string OffloadedSelfCert::getIdentity() const {
+  return cert_->getIdentity();
+}
+
+std::vector<std::string> OffloadedSelfCert::getAltIdentities() const {
+  return cert_->getAltIdentities();
+}
+
+std::vector<fizz::SignatureScheme> OffloadedSelfCert::getSigSchemes() const {
+  return cert_->getSigSchemes();
+}
+
+fizz::CertificateMsg OffloadedSelfCert::getCertMessage(
+    fizz::Buf certificateRequestContext) const {
+  return cert_->getCertMessage(std::move(certificateRequestContext));
+}
+
+fizz::CompressedCertificate OffloadedSelfCert::getCompressedCert(
+    fizz::CertificateCompressionAlgorithm algo) const {
+  return cert_->getCompressedCert(algo);
+}
+
+folly::ssl::X509UniquePtr OffloadedSelfCert::getX509() const {
+  return cert_->getX509();
+}
+
+fizz::Buf OffloadedSelfCert::sign(
+    fizz::SignatureScheme scheme,
+    fizz::CertificateVerifyContext context,
+    folly::ByteRange toBeSigned) const {
+  return cert_->sign(scheme, context, toBeSigned);
+}
+
+folly::SemiFuture<folly::Optional<fizz::Buf>> OffloadedSelfCert::signFuture(
+    fizz::SignatureScheme scheme,
+    fizz::CertificateVerifyContext context,
+    std::unique_ptr<folly::IOBuf> toBeSigned) const {
+  // The certificate is kept alive by the task, the handshake may be gone by
+  // the time it runs.
+  return folly::via(
+             executor_.get(),
+             [cert = cert_,
+              scheme,
+              context,
+              toBeSigned = std::move(toBeSigned)]() mutable
+             -> folly::Optional<fizz::Buf> {
+               return cert->sign(scheme, context, toBeSigned->coalesce());
+             })
+      .semi();
+}
+
+} // namespace quic
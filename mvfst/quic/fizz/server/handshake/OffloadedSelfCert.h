@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <fizz/server/AsyncSelfCert.h>
+#include <folly/Executor.h>
+
+namespace quic {
+
+/**
+ * Certificate whose CertificateVerify signatures are computed on an executor
+ * instead of the thread running the handshake. Fizz then returns the server's
+ * flight as async actions, and ServerHandshake continues the handshake on the
+ * transport's event base once the signature is ready. Everything but signing
+ * is forwarded to the wrapped certificate.
+ */
+class OffloadedSelfCert : public fizz::server::AsyncSelfCert {
+ public:
+  OffloadedSelfCert(
+      std::shared_ptr<const fizz::SelfCert> cert,
+      std::shared_ptr<folly::Executor> executor);
+
+  std::string getIdentity() const override;
+  std::vector<std::string> getAltIdentities() const override;
+  std::vector<fizz::SignatureScheme> getSigSchemes() const override;
+  fizz::CertificateMsg getCertMessage(
+      fizz::Buf certificateRequestContext = nullptr) const override;
+  fizz::CompressedCertificate getCompressedCert(
+      fizz::CertificateCompressionAlgorithm algo) const override;
+  folly::ssl::X509UniquePtr getX509() const override;
+
+  fizz::Buf sign(
+      fizz::SignatureScheme scheme,
+      fizz::CertificateVerifyContext context,
+      folly::ByteRange toBeSigned) const override;
+
+  folly::SemiFuture<folly::Optional<fizz::Buf>> signFuture(
+      fizz::SignatureScheme scheme,
+      fizz::CertificateVerifyContext context,
+      std::unique_ptr<folly::IOBuf> toBeSigned) const override;
+
+ private:
+  std::shared_ptr<const fizz::SelfCert> cert_;
+  std::shared_ptr<folly::Executor> executor_;
+};
+
+} // namespace quic
@@ -173,6 +173,20 @@ void happyEyeballsSetUpSocket(
   // never fragment, always turn off PMTU
   socket.setDFAndTurnOffPMTU();
 
+  if (transportSettings.edtPacing) {
+    // departure times are relative to CLOCK_MONOTONIC, as fq expects
+    folly::AsyncUDPSocket::TXTime txTime;
+    txTime.clockid = CLOCK_MONOTONIC;
+    socket.setTXTime(txTime);
+  }
+
+  if (transportSettings.enableEcnOnEgress) {
+    socket.setTosOrTrafficClass(kEcnECT0);
+  }
+  if (transportSettings.readEcnOnIngress) {
+    socket.setRecvTos(true);
+  }
+
   if (transportSettings.enableSocketErrMsgCallback) {
     socket.setErrMessageCallback(errMsgCallback);
   }
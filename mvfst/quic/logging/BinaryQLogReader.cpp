@@ -0,0 +1,466 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/logging/BinaryQLogReader.h>
+
+#include <cstring>
+
+#include <folly/FileUtil.h>
+#include <folly/container/F14Map.h>
+
+namespace {
+
+using quic::BinaryQLogRecord;
+using FrameKind = quic::BinaryQLogRecord::FrameKind;
+using RecordType = quic::BinaryQLogRecord::Type;
+
+bool isAttachment(RecordType type) {
+  switch (type) {
+    case RecordType::Text:
+    case RecordType::Frame:
+    case RecordType::AckBlocks:
+    case RecordType::Versions:
+    case RecordType::Args:
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::string recordText(const BinaryQLogRecord& record) {
+  return std::string(
+      reinterpret_cast<const char*>(record.args),
+      std::min<size_t>(record.textLen, BinaryQLogRecord::kTextSize));
+}
+
+quic::ConnectionId recordConnectionId(const BinaryQLogRecord& record) {
+  auto text = recordText(record);
+  return quic::ConnectionId(std::vector<uint8_t>(text.begin(), text.end()));
+}
+
+// An event record together with the records attached to it.
+struct PendingEvent {
+  BinaryQLogRecord head;
+  std::vector<BinaryQLogRecord> attachments;
+};
+
+struct Connection {
+  std::unique_ptr<quic::FileQLogger> logger;
+  folly::Optional<PendingEvent> pending;
+};
+
+std::unique_ptr<quic::QLogFrame> makeFrame(
+    const BinaryQLogRecord& record,
+    const std::vector<const BinaryQLogRecord*>& attachments) {
+  const auto* a = record.args;
+  std::string text;
+  std::vector<std::pair<quic::PacketNum, quic::PacketNum>> ackBlocks;
+  for (const auto* attachment : attachments) {
+    if (attachment->type == RecordType::Text) {
+      text += recordText(*attachment);
+    } else if (attachment->type == RecordType::AckBlocks) {
+      for (uint32_t i = 0;
+           i < attachment->extra && 2 * i + 1 < BinaryQLogRecord::kNumArgs;
+           i++) {
+        ackBlocks.emplace_back(
+            attachment->args[2 * i], attachment->args[2 * i + 1]);
+      }
+    }
+  }
+  switch (static_cast<FrameKind>(record.extra)) {
+    case FrameKind::Padding:
+      return std::make_unique<quic::PaddingFrameLog>(a[0]);
+    case FrameKind::RstStream:
+      return std::make_unique<quic::RstStreamFrameLog>(a[0], a[1], a[2]);
+    case FrameKind::ConnectionClose: {
+      folly::Optional<quic::QuicErrorCode> errorCode;
+      switch (static_cast<quic::QuicErrorCode::Type>(a[0])) {
+        case quic::QuicErrorCode::Type::ApplicationErrorCode:
+          errorCode = quic::QuicErrorCode(quic::ApplicationErrorCode(a[1]));
+          break;
+        case quic::QuicErrorCode::Type::LocalErrorCode:
+          errorCode = quic::QuicErrorCode(
+              static_cast<quic::LocalErrorCode>(a[1]));
+          break;
+        case quic::QuicErrorCode::Type::TransportErrorCode:
+          errorCode = quic::QuicErrorCode(
+              static_cast<quic::TransportErrorCode>(a[1]));
+          break;
+      }
+      if (!errorCode) {
+        return nullptr;
+      }
+      return std::make_unique<quic::ConnectionCloseFrameLog>(
+          *errorCode, std::move(text), static_cast<quic::FrameType>(a[2]));
+    }
+    case FrameKind::MaxData:
+      return std::make_unique<quic::MaxDataFrameLog>(a[0]);
+    case FrameKind::MaxStreamData:
+      return std::make_unique<quic::MaxStreamDataFrameLog>(a[0], a[1]);
+    case FrameKind::MaxStreams:
+      return std::make_unique<quic::MaxStreamsFrameLog>(a[0], a[1] != 0);
+    case FrameKind::DataBlocked:
+      return std::make_unique<quic::DataBlockedFrameLog>(a[0]);
+    case FrameKind::StreamDataBlocked:
+      return std::make_unique<quic::StreamDataBlockedFrameLog>(a[0], a[1]);
+    case FrameKind::StreamsBlocked:
+      return std::make_unique<quic::StreamsBlockedFrameLog>(a[0], a[1] != 0);
+    case FrameKind::ReadAck: {
+      quic::ReadAckFrame::Vec blocks;
+      for (const auto& block : ackBlocks) {
+        blocks.emplace_back(block.first, block.second);
+      }
+      return std::make_unique<quic::ReadAckFrameLog>(
+          blocks,
+          std::chrono::microseconds(a[0]),
+          static_cast<quic::FrameType>(a[1]));
+    }
+    case FrameKind::WriteAck: {
+      quic::WriteAckFrame::AckBlockVec blocks;
+      for (const auto& block : ackBlocks) {
+        blocks.emplace_back(block.first, block.second);
+      }
+      return std::make_unique<quic::WriteAckFrameLog>(
+          blocks,
+          std::chrono::microseconds(a[0]),
+          static_cast<quic::FrameType>(a[1]));
+    }
+    case FrameKind::Stream:
+      return std::make_unique<quic::StreamFrameLog>(
+          a[0], a[1], a[2], a[3] != 0);
+    case FrameKind::Crypto:
+      return std::make_unique<quic::CryptoFrameLog>(a[0], a[1]);
+    case FrameKind::ReadNewToken:
+      return std::make_unique<quic::ReadNewTokenFrameLog>();
+    case FrameKind::NewToken:
+      return std::make_unique<quic::NewTokenFrameLog>(std::move(text));
+    case FrameKind::Ping:
+      return std::make_unique<quic::PingFrameLog>();
+    case FrameKind::StopSending:
+      return std::make_unique<quic::StopSendingFrameLog>(a[0], a[1]);
+    case FrameKind::PathChallenge:
+      return std::make_unique<quic::PathChallengeFrameLog>(a[0]);
+    case FrameKind::PathResponse:
+      return std::make_unique<quic::PathResponseFrameLog>(a[0]);
+    case FrameKind::NewConnectionId: {
+      quic::StatelessResetToken token;
+      memcpy(token.data(), &a[1], token.size());
+      return std::make_unique<quic::NewConnectionIdFrameLog>(
+          static_cast<uint16_t>(a[0]), token);
+    }
+    case FrameKind::RetireConnectionId:
+      return std::make_unique<quic::RetireConnectionIdFrameLog>(a[0]);
+    case FrameKind::HandshakeDone:
+      return std::make_unique<quic::HandshakeDoneFrameLog>();
+    case FrameKind::Knob:
+      return std::make_unique<quic::KnobFrameLog>(a[0], a[1], a[2]);
+    case FrameKind::AckFrequency:
+      return std::make_unique<quic::AckFrequencyFrameLog>(
+          a[0], a[1], a[2], a[3]);
+    case FrameKind::ImmediateAck:
+      return std::make_unique<quic::ImmediateAckFrameLog>();
+    case FrameKind::Datagram:
+      return std::make_unique<quic::DatagramFrameLog>(a[0]);
+  }
+  return nullptr;
+}
+
+std::unique_ptr<quic::QLogPacketEvent> makePacketEvent(
+    const PendingEvent& pending) {
+  const auto& head = pending.head;
+  auto event = std::make_unique<quic::QLogPacketEvent>();
+  event->eventType = head.type == RecordType::PacketReceived
+      ? quic::QLogEventType::PacketReceived
+      : quic::QLogEventType::PacketSent;
+  if (head.extra == 0) {
+    event->packetType = quic::kShortHeaderPacketType.str();
+  } else {
+    event->packetType =
+        quic::toQlogString(static_cast<quic::LongHeader::Types>(head.extra - 1))
+            .str();
+  }
+  event->packetNum = head.args[0];
+  event->packetSize = head.args[1];
+  // attachments of a packet belong to the frame before them
+  const BinaryQLogRecord* frame = nullptr;
+  std::vector<const BinaryQLogRecord*> frameAttachments;
+  auto addFrame = [&]() {
+    if (frame) {
+      if (auto frameLog = makeFrame(*frame, frameAttachments)) {
+        event->frames.push_back(std::move(frameLog));
+      }
+    }
+    frameAttachments.clear();
+  };
+  for (const auto& attachment : pending.attachments) {
+    if (attachment.type == RecordType::Frame) {
+      addFrame();
+      frame = &attachment;
+    } else {
+      frameAttachments.push_back(&attachment);
+    }
+  }
+  addFrame();
+  return event;
+}
+
+std::unique_ptr<quic::QLogEvent> makeEvent(
+    const PendingEvent& pending,
+    quic::VantagePoint vantagePoint) {
+  const auto& head = pending.head;
+  std::vector<std::string> strings;
+  std::vector<uint64_t> args(head.args, head.args + BinaryQLogRecord::kNumArgs);
+  for (const auto& attachment : pending.attachments) {
+    if (attachment.type == RecordType::Text) {
+      if (strings.size() <= attachment.extra) {
+        strings.resize(attachment.extra + 1);
+      }
+      strings[attachment.extra] += recordText(attachment);
+    } else if (attachment.type == RecordType::Args) {
+      if (args.size() < attachment.extra + BinaryQLogRecord::kNumArgs) {
+        args.resize(attachment.extra + BinaryQLogRecord::kNumArgs);
+      }
+      std::copy(
+          attachment.args,
+          attachment.args + BinaryQLogRecord::kNumArgs,
+          args.begin() + attachment.extra);
+    }
+  }
+  strings.resize(std::max<size_t>(strings.size(), 3));
+  const auto& a = args;
+  auto& s = strings;
+  std::chrono::microseconds refTime(head.time);
+  switch (head.type) {
+    case RecordType::PacketReceived:
+    case RecordType::PacketSent: {
+      auto event = makePacketEvent(pending);
+      event->refTime = refTime;
+      return event;
+    }
+    case RecordType::VersionNegotiation: {
+      std::vector<quic::QuicVersion> versions;
+      for (const auto& attachment : pending.attachments) {
+        if (attachment.type != RecordType::Versions) {
+          continue;
+        }
+        for (uint32_t i = 0;
+             i < attachment.extra && i < BinaryQLogRecord::kNumArgs;
+             i++) {
+          versions.push_back(static_cast<quic::QuicVersion>(attachment.args[i]));
+        }
+      }
+      auto event = std::make_unique<quic::QLogVersionNegotiationEvent>();
+      event->refTime = refTime;
+      event->eventType = head.extra ? quic::QLogEventType::PacketReceived
+                                    : quic::QLogEventType::PacketSent;
+      event->packetType = quic::kVersionNegotiationPacketType;
+      event->packetSize = a[0];
+      event->versionLog =
+          std::make_unique<quic::VersionNegotiationLog>(versions);
+      return event;
+    }
+    case RecordType::Retry: {
+      auto event = std::make_unique<quic::QLogRetryEvent>();
+      event->refTime = refTime;
+      event->eventType = head.extra ? quic::QLogEventType::PacketReceived
+                                    : quic::QLogEventType::PacketSent;
+      event->packetType =
+          quic::toQlogString(quic::LongHeader::Types::Retry).str();
+      event->packetSize = a[0];
+      event->tokenSize = a[1];
+      return event;
+    }
+    case RecordType::ConnectionClose:
+      return std::make_unique<quic::QLogConnectionCloseEvent>(
+          s[0], s[1], a[0] != 0, a[1] != 0, refTime);
+    case RecordType::TransportSummary:
+      args.resize(std::max<size_t>(args.size(), 18));
+      return std::make_unique<quic::QLogTransportSummaryEvent>(
+          a[0],
+          a[1],
+          a[2],
+          a[3],
+          a[4],
+          a[5],
+          a[6],
+          a[7],
+          a[8],
+          a[9],
+          a[10],
+          a[11],
+          a[12],
+          a[13],
+          a[14],
+          a[15] != 0,
+          static_cast<quic::QuicVersion>(a[16]),
+          a[17],
+          refTime);
+    case RecordType::CongestionMetricUpdate:
+      return std::make_unique<quic::QLogCongestionMetricUpdateEvent>(
+          a[0], a[1], s[0], s[1], s[2], refTime);
+    case RecordType::BandwidthEstUpdate:
+      return std::make_unique<quic::QLogBandwidthEstUpdateEvent>(
+          a[0], std::chrono::microseconds(a[1]), refTime);
+    case RecordType::AppLimitedUpdate:
+      return std::make_unique<quic::QLogAppLimitedUpdateEvent>(
+          head.extra != 0, refTime);
+    case RecordType::PacingMetricUpdate:
+      return std::make_unique<quic::QLogPacingMetricUpdateEvent>(
+          a[0], std::chrono::microseconds(a[1]), refTime);
+    case RecordType::PacingObservation:
+      return std::make_unique<quic::QLogPacingObservationEvent>(
+          s[0], s[1], s[2], refTime);
+    case RecordType::AppIdleUpdate:
+      return std::make_unique<quic::QLogAppIdleUpdateEvent>(
+          s[0], head.extra != 0, refTime);
+    case RecordType::PacketDrop:
+      return std::make_unique<quic::QLogPacketDropEvent>(a[0], s[0], refTime);
+    case RecordType::DatagramReceived:
+      return std::make_unique<quic::QLogDatagramReceivedEvent>(a[0], refTime);
+    case RecordType::LossAlarm:
+      return std::make_unique<quic::QLogLossAlarmEvent>(
+          a[0], a[1], a[2], s[0], refTime);
+    case RecordType::PacketsLost:
+      return std::make_unique<quic::QLogPacketsLostEvent>(
+          a[0], a[1], a[2], refTime);
+    case RecordType::TransportStateUpdate:
+      return std::make_unique<quic::QLogTransportStateUpdateEvent>(
+          s[0], refTime);
+    case RecordType::PacketBuffered:
+      return std::make_unique<quic::QLogPacketBufferedEvent>(
+          static_cast<quic::ProtectionType>(head.extra), a[0], refTime);
+    case RecordType::MetricUpdate:
+      return std::make_unique<quic::QLogMetricUpdateEvent>(
+          std::chrono::microseconds(a[0]),
+          std::chrono::microseconds(a[1]),
+          std::chrono::microseconds(a[2]),
+          std::chrono::microseconds(a[3]),
+          refTime);
+    case RecordType::StreamStateUpdate: {
+      folly::Optional<std::chrono::milliseconds> timeSinceStreamCreation;
+      if (head.extra) {
+        timeSinceStreamCreation = std::chrono::milliseconds(a[1]);
+      }
+      return std::make_unique<quic::QLogStreamStateUpdateEvent>(
+          a[0], s[0], timeSinceStreamCreation, vantagePoint, refTime);
+    }
+    case RecordType::ConnectionMigration:
+      return std::make_unique<quic::QLogConnectionMigrationEvent>(
+          head.extra != 0, vantagePoint, refTime);
+    case RecordType::PathValidation:
+      return std::make_unique<quic::QLogPathValidationEvent>(
+          head.extra != 0, vantagePoint, refTime);
+    case RecordType::PriorityUpdate:
+      return std::make_unique<quic::QLogPriorityUpdateEvent>(
+          a[0], static_cast<uint8_t>(a[1]), head.extra != 0, refTime);
+    default:
+      return nullptr;
+  }
+}
+
+void finishPending(Connection& connection) {
+  if (!connection.pending) {
+    return;
+  }
+  const auto& pending = *connection.pending;
+  if (pending.head.type == RecordType::Connection) {
+    std::string protocolType;
+    for (const auto& attachment : pending.attachments) {
+      if (attachment.type == RecordType::Text) {
+        protocolType += recordText(attachment);
+      }
+    }
+    if (!protocolType.empty()) {
+      connection.logger->protocolType = std::move(protocolType);
+    }
+  } else if (
+      auto event = makeEvent(pending, connection.logger->vantagePoint)) {
+    connection.logger->logs.push_back(std::move(event));
+  }
+  connection.pending.reset();
+}
+
+} // namespace
+
+namespace quic {
+
+BinaryQLogReader::Result BinaryQLogReader::read(folly::ByteRange data) {
+  if (data.size() < sizeof(BinaryQLogRecord) ||
+      data.size() % sizeof(BinaryQLogRecord) != 0) {
+    throw std::runtime_error("not a binary qlog: size");
+  }
+  auto numRecords = data.size() / sizeof(BinaryQLogRecord);
+  auto recordAt = [&](size_t i) {
+    BinaryQLogRecord record;
+    memcpy(&record, data.data() + i * sizeof(record), sizeof(record));
+    return record;
+  };
+  auto header = recordAt(0);
+  if (header.type != RecordType::FileHeader ||
+      header.args[0] != BinaryQLogRecord::kVersion) {
+    throw std::runtime_error("not a binary qlog: header");
+  }
+
+  Result result;
+  std::vector<uint64_t> order;
+  folly::F14FastMap<uint64_t, Connection> connections;
+  auto getConnection = [&](const BinaryQLogRecord& record) -> Connection& {
+    auto& connection = connections[record.connection];
+    if (!connection.logger) {
+      auto vantagePoint = record.type == RecordType::Connection
+          ? static_cast<VantagePoint>(record.extra)
+          : VantagePoint::Server;
+      connection.logger = std::make_unique<FileQLogger>(vantagePoint);
+      order.push_back(record.connection);
+    }
+    return connection;
+  };
+  for (size_t i = 1; i < numRecords; i++) {
+    auto record = recordAt(i);
+    if (record.type == RecordType::Dropped) {
+      result.droppedEvents += record.args[0];
+      continue;
+    }
+    auto& connection = getConnection(record);
+    if (isAttachment(record.type)) {
+      // attachments whose event was dropped are dropped as well
+      if (connection.pending) {
+        connection.pending->attachments.push_back(record);
+      }
+    } else if (record.type == RecordType::Dcid) {
+      connection.logger->dcid = recordConnectionId(record);
+    } else if (record.type == RecordType::Scid) {
+      connection.logger->scid = recordConnectionId(record);
+    } else {
+      finishPending(connection);
+      connection.pending = PendingEvent{record, {}};
+    }
+  }
+  for (auto id : order) {
+    auto& connection = connections[id];
+    finishPending(connection);
+    if (!connection.logger->dcid) {
+      // never got a dcid, name it after the connection number
+      std::vector<uint8_t> bytes(sizeof(id));
+      memcpy(bytes.data(), &id, sizeof(id));
+      connection.logger->dcid = ConnectionId(bytes);
+    }
+    result.connections.push_back(std::move(connection.logger));
+  }
+  return result;
+}
+
+BinaryQLogReader::Result BinaryQLogReader::readFile(
+    const std::string& filePath) {
+  std::string data;
+  if (!folly::readFile(filePath.c_str(), data)) {
+    throw std::runtime_error("can not read " + filePath);
+  }
+  return read(folly::StringPiece(data));
+}
+
+} // namespace quic
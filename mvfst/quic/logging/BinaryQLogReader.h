@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Range.h>
+#include <quic/logging/BinaryQLogger.h>
+#include <quic/logging/FileQLogger.h>
+
+namespace quic {
+
+/**
+ * Converts the output of BinaryQLogWriter back into qlog events: one
+ * FileQLogger per connection, which can then be written out as standard qlog
+ * JSON with FileQLogger::outputLogsToFile.
+ */
+class BinaryQLogReader {
+ public:
+  struct Result {
+    std::vector<std::unique_ptr<FileQLogger>> connections;
+    // events the writer had to drop because a ring was full
+    uint64_t droppedEvents{0};
+  };
+
+  // Throws std::runtime_error if the data is not a binary qlog.
+  static Result read(folly::ByteRange data);
+  static Result readFile(const std::string& filePath);
+};
+
+} // namespace quic
@@ -0,0 +1,799 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/logging/BinaryQLogger.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/lang/Bits.h>
+
+namespace {
+
+uint64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// 0 for short headers, 1 + the long header type otherwise
+uint32_t packetTypeCode(const quic::PacketHeader& header) {
+  if (header.asShort()) {
+    return 0;
+  }
+  return 1 + static_cast<uint32_t>(header.asLong()->getHeaderType());
+}
+
+} // namespace
+
+namespace quic {
+
+BinaryQLogWriter::BinaryQLogWriter(
+    const std::string& path,
+    size_t ringSize,
+    std::chrono::milliseconds flushInterval)
+    : filePath_(
+          folly::to<std::string>(path, "/", getpid(), kBinaryQlogExtension)),
+      ringSize_(folly::nextPowTwo(ringSize)),
+      flushInterval_(flushInterval) {
+  fd_ = ::open(filePath_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ < 0) {
+    LOG(ERROR) << "Error creating binary qlog file " << filePath_;
+  } else {
+    BinaryQLogRecord header{};
+    header.type = BinaryQLogRecord::Type::FileHeader;
+    header.time = nowUs();
+    header.args[0] = BinaryQLogRecord::kVersion;
+    folly::writeFull(fd_, &header, sizeof(header));
+  }
+  thread_ = std::thread([this]() { run(); });
+}
+
+BinaryQLogWriter::~BinaryQLogWriter() {
+  {
+    std::lock_guard<std::mutex> guard(stopMutex_);
+    stop_ = true;
+  }
+  stopCv_.notify_one();
+  thread_.join();
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+BinaryQLogWriter::Ring& BinaryQLogWriter::localRing() {
+  Ring*& ring = *localRing_;
+  if (!ring) {
+    auto newRing = std::make_unique<Ring>(ringSize_);
+    std::lock_guard<std::mutex> guard(ringsMutex_);
+    rings_.push_back(std::move(newRing));
+    ring = rings_.back().get();
+  }
+  return *ring;
+}
+
+void BinaryQLogWriter::write(folly::Range<const BinaryQLogRecord*> event) {
+  auto& ring = localRing();
+  auto head = ring.head.load(std::memory_order_relaxed);
+  auto used = head - ring.tail.load(std::memory_order_acquire);
+  if (event.size() > ring.records.size() - used) {
+    // only this thread writes to it
+    ring.dropped.store(
+        ring.dropped.load(std::memory_order_relaxed) + 1,
+        std::memory_order_relaxed);
+    return;
+  }
+  auto mask = ring.records.size() - 1;
+  for (const auto& record : event) {
+    ring.records[head++ & mask] = record;
+  }
+  ring.head.store(head, std::memory_order_release);
+}
+
+void BinaryQLogWriter::run() {
+  while (true) {
+    bool stop;
+    {
+      std::unique_lock<std::mutex> lock(stopMutex_);
+      stopCv_.wait_for(lock, flushInterval_, [this]() { return stop_; });
+      stop = stop_;
+    }
+    drain();
+    if (stop) {
+      return;
+    }
+  }
+}
+
+void BinaryQLogWriter::drain() {
+  drainBuffer_.clear();
+  {
+    // only contends with threads logging for the first time
+    std::lock_guard<std::mutex> guard(ringsMutex_);
+    for (auto& ring : rings_) {
+      auto head = ring->head.load(std::memory_order_acquire);
+      auto tail = ring->tail.load(std::memory_order_relaxed);
+      auto mask = ring->records.size() - 1;
+      for (; tail != head; tail++) {
+        drainBuffer_.push_back(ring->records[tail & mask]);
+      }
+      ring->tail.store(head, std::memory_order_release);
+      auto dropped = ring->dropped.load(std::memory_order_relaxed);
+      if (dropped != ring->droppedReported) {
+        BinaryQLogRecord record{};
+        record.type = BinaryQLogRecord::Type::Dropped;
+        record.time = nowUs();
+        record.args[0] = dropped - ring->droppedReported;
+        drainBuffer_.push_back(record);
+        ring->droppedReported = dropped;
+      }
+    }
+  }
+  if (fd_ < 0 || drainBuffer_.empty()) {
+    return;
+  }
+  if (folly::writeFull(
+          fd_,
+          drainBuffer_.data(),
+          drainBuffer_.size() * sizeof(BinaryQLogRecord)) < 0) {
+    LOG(ERROR) << "Error writing binary qlog file " << filePath_;
+  }
+}
+
+BinaryQLogger::BinaryQLogger(
+    VantagePoint vantagePointIn,
+    std::shared_ptr<BinaryQLogWriter> writer,
+    std::string protocolTypeIn)
+    : QLogger(vantagePointIn, std::move(protocolTypeIn)),
+      writer_(std::move(writer)),
+      connection_(writer_->newConnection()) {
+  addRecord(
+      BinaryQLogRecord::Type::Connection,
+      static_cast<uint32_t>(vantagePoint));
+  addText(0, protocolType);
+  writeEvent();
+}
+
+void BinaryQLogger::writeEvent() {
+  if (event_.empty()) {
+    return;
+  }
+  writer_->write(folly::range(event_));
+  event_.clear();
+}
+
+BinaryQLogRecord BinaryQLogger::makeRecord(
+    BinaryQLogRecord::Type type,
+    uint32_t extra,
+    std::initializer_list<uint64_t> args) const {
+  DCHECK_LE(args.size(), BinaryQLogRecord::kNumArgs);
+  BinaryQLogRecord record{};
+  record.connection = connection_;
+  record.time = nowUs();
+  record.type = type;
+  record.extra = extra;
+  std::copy(args.begin(), args.end(), record.args);
+  return record;
+}
+
+void BinaryQLogger::addRecord(
+    BinaryQLogRecord::Type type,
+    uint32_t extra,
+    std::initializer_list<uint64_t> args) {
+  event_.push_back(makeRecord(type, extra, args));
+}
+
+void BinaryQLogger::addFrame(
+    BinaryQLogRecord::FrameKind kind,
+    std::initializer_list<uint64_t> args) {
+  addRecord(BinaryQLogRecord::Type::Frame, static_cast<uint32_t>(kind), args);
+}
+
+void BinaryQLogger::addText(uint32_t index, folly::StringPiece text) {
+  while (!text.empty()) {
+    auto record = makeRecord(BinaryQLogRecord::Type::Text, index);
+    record.textLen = std::min(text.size(), BinaryQLogRecord::kTextSize);
+    memcpy(record.args, text.data(), record.textLen);
+    event_.push_back(record);
+    text.advance(record.textLen);
+  }
+}
+
+void BinaryQLogger::addText(
+    BinaryQLogRecord::Type type,
+    folly::StringPiece text) {
+  auto record = makeRecord(type);
+  record.textLen = std::min(text.size(), BinaryQLogRecord::kTextSize);
+  memcpy(record.args, text.data(), record.textLen);
+  event_.push_back(record);
+}
+
+void BinaryQLogger::addConnectionCloseFrame(const ConnectionCloseFrame& frame) {
+  uint64_t errorCode = 0;
+  switch (frame.errorCode.type()) {
+    case QuicErrorCode::Type::ApplicationErrorCode:
+      errorCode = *frame.errorCode.asApplicationErrorCode();
+      break;
+    case QuicErrorCode::Type::LocalErrorCode:
+      errorCode = static_cast<uint64_t>(*frame.errorCode.asLocalErrorCode());
+      break;
+    case QuicErrorCode::Type::TransportErrorCode:
+      errorCode =
+          static_cast<uint64_t>(*frame.errorCode.asTransportErrorCode());
+      break;
+  }
+  addFrame(
+      BinaryQLogRecord::FrameKind::ConnectionClose,
+      {static_cast<uint64_t>(frame.errorCode.type()),
+       errorCode,
+       static_cast<uint64_t>(frame.closingFrameType)});
+  addText(0, frame.reasonPhrase);
+}
+
+template <typename AckBlocks>
+void BinaryQLogger::addAckFrame(
+    BinaryQLogRecord::FrameKind kind,
+    const AckBlocks& ackBlocks,
+    std::chrono::microseconds ackDelay,
+    FrameType frameType) {
+  addFrame(
+      kind,
+      {static_cast<uint64_t>(ackDelay.count()),
+       static_cast<uint64_t>(frameType),
+       ackBlocks.size()});
+  auto record = makeRecord(BinaryQLogRecord::Type::AckBlocks);
+  for (const auto& ackBlock : ackBlocks) {
+    if constexpr (std::is_same_v<
+                      std::decay_t<decltype(ackBlock)>,
+                      AckBlock>) {
+      record.args[2 * record.extra] = ackBlock.startPacket;
+      record.args[2 * record.extra + 1] = ackBlock.endPacket;
+    } else {
+      record.args[2 * record.extra] = ackBlock.start;
+      record.args[2 * record.extra + 1] = ackBlock.end;
+    }
+    if (++record.extra == BinaryQLogRecord::kNumArgs / 2) {
+      event_.push_back(record);
+      record.extra = 0;
+    }
+  }
+  if (record.extra) {
+    event_.push_back(record);
+  }
+}
+
+void BinaryQLogger::addSimpleFrame(const QuicSimpleFrame& simpleFrame) {
+  using FrameKind = BinaryQLogRecord::FrameKind;
+  switch (simpleFrame.type()) {
+    case QuicSimpleFrame::Type::StopSendingFrame: {
+      const auto& frame = *simpleFrame.asStopSendingFrame();
+      addFrame(FrameKind::StopSending, {frame.streamId, frame.errorCode});
+      break;
+    }
+    case QuicSimpleFrame::Type::PathChallengeFrame:
+      addFrame(
+          FrameKind::PathChallenge,
+          {simpleFrame.asPathChallengeFrame()->pathData});
+      break;
+    case QuicSimpleFrame::Type::PathResponseFrame:
+      addFrame(
+          FrameKind::PathResponse,
+          {simpleFrame.asPathResponseFrame()->pathData});
+      break;
+    case QuicSimpleFrame::Type::NewConnectionIdFrame: {
+      const auto& frame = *simpleFrame.asNewConnectionIdFrame();
+      uint64_t token[2];
+      static_assert(sizeof(token) == sizeof(frame.token));
+      memcpy(token, frame.token.data(), sizeof(token));
+      addFrame(
+          FrameKind::NewConnectionId,
+          {frame.sequenceNumber, token[0], token[1]});
+      break;
+    }
+    case QuicSimpleFrame::Type::MaxStreamsFrame: {
+      const auto& frame = *simpleFrame.asMaxStreamsFrame();
+      addFrame(
+          FrameKind::MaxStreams, {frame.maxStreams, frame.isForBidirectional});
+      break;
+    }
+    case QuicSimpleFrame::Type::RetireConnectionIdFrame:
+      addFrame(
+          FrameKind::RetireConnectionId,
+          {simpleFrame.asRetireConnectionIdFrame()->sequenceNumber});
+      break;
+    case QuicSimpleFrame::Type::HandshakeDoneFrame:
+      addFrame(FrameKind::HandshakeDone);
+      break;
+    case QuicSimpleFrame::Type::KnobFrame: {
+      const auto& frame = *simpleFrame.asKnobFrame();
+      addFrame(
+          FrameKind::Knob, {frame.knobSpace, frame.id, frame.blob->length()});
+      break;
+    }
+    case QuicSimpleFrame::Type::AckFrequencyFrame: {
+      const auto& frame = *simpleFrame.asAckFrequencyFrame();
+      addFrame(
+          FrameKind::AckFrequency,
+          {frame.sequenceNumber,
+           frame.packetTolerance,
+           frame.updateMaxAckDelay,
+           frame.reorderThreshold});
+      break;
+    }
+    case QuicSimpleFrame::Type::NewTokenFrame:
+      addFrame(FrameKind::NewToken);
+      addText(0, simpleFrame.asNewTokenFrame()->token);
+      break;
+  }
+}
+
+void BinaryQLogger::addPacket(
+    const RegularQuicPacket& regularPacket,
+    uint64_t packetSize) {
+  using FrameKind = BinaryQLogRecord::FrameKind;
+  auto packetType = packetTypeCode(regularPacket.header);
+  PacketNum packetNum = 0;
+  if (packetType != 1 + static_cast<uint32_t>(LongHeader::Types::Retry)) {
+    // A Retry packet does not include a packet number.
+    packetNum = regularPacket.header.getPacketSequenceNum();
+  }
+  addRecord(
+      BinaryQLogRecord::Type::PacketReceived,
+      packetType,
+      {packetNum, packetSize});
+
+  uint64_t numPaddingFrames = 0;
+  for (const auto& quicFrame : regularPacket.frames) {
+    switch (quicFrame.type()) {
+      case QuicFrame::Type::PaddingFrame:
+        numPaddingFrames += quicFrame.asPaddingFrame()->numFrames;
+        break;
+      case QuicFrame::Type::RstStreamFrame: {
+        const auto& frame = *quicFrame.asRstStreamFrame();
+        addFrame(
+            FrameKind::RstStream,
+            {frame.streamId, frame.errorCode, frame.offset});
+        break;
+      }
+      case QuicFrame::Type::ConnectionCloseFrame:
+        addConnectionCloseFrame(*quicFrame.asConnectionCloseFrame());
+        break;
+      case QuicFrame::Type::MaxDataFrame:
+        addFrame(
+            FrameKind::MaxData, {quicFrame.asMaxDataFrame()->maximumData});
+        break;
+      case QuicFrame::Type::MaxStreamDataFrame: {
+        const auto& frame = *quicFrame.asMaxStreamDataFrame();
+        addFrame(FrameKind::MaxStreamData, {frame.streamId, frame.maximumData});
+        break;
+      }
+      case QuicFrame::Type::DataBlockedFrame:
+        addFrame(
+            FrameKind::DataBlocked, {quicFrame.asDataBlockedFrame()->dataLimit});
+        break;
+      case QuicFrame::Type::StreamDataBlockedFrame: {
+        const auto& frame = *quicFrame.asStreamDataBlockedFrame();
+        addFrame(
+            FrameKind::StreamDataBlocked, {frame.streamId, frame.dataLimit});
+        break;
+      }
+      case QuicFrame::Type::StreamsBlockedFrame: {
+        const auto& frame = *quicFrame.asStreamsBlockedFrame();
+        addFrame(
+            FrameKind::StreamsBlocked,
+            {frame.streamLimit, frame.isForBidirectional});
+        break;
+      }
+      case QuicFrame::Type::ReadAckFrame: {
+        const auto& frame = *quicFrame.asReadAckFrame();
+        addAckFrame(
+            FrameKind::ReadAck, frame.ackBlocks, frame.ackDelay, frame.frameType);
+        break;
+      }
+      case QuicFrame::Type::ReadStreamFrame: {
+        const auto& frame = *quicFrame.asReadStreamFrame();
+        addFrame(
+            FrameKind::Stream,
+            {frame.streamId, frame.offset, frame.data->length(), frame.fin});
+        break;
+      }
+      case QuicFrame::Type::ReadCryptoFrame: {
+        const auto& frame = *quicFrame.asReadCryptoFrame();
+        addFrame(FrameKind::Crypto, {frame.offset, frame.data->length()});
+        break;
+      }
+      case QuicFrame::Type::ReadNewTokenFrame:
+        addFrame(FrameKind::ReadNewToken);
+        break;
+      case QuicFrame::Type::PingFrame:
+        addFrame(FrameKind::Ping);
+        break;
+      case QuicFrame::Type::QuicSimpleFrame:
+        addSimpleFrame(*quicFrame.asQuicSimpleFrame());
+        break;
+      case QuicFrame::Type::NoopFrame:
+        break;
+      case QuicFrame::Type::DatagramFrame:
+        addFrame(FrameKind::Datagram, {quicFrame.asDatagramFrame()->length});
+        break;
+      case QuicFrame::Type::ImmediateAckFrame:
+        addFrame(FrameKind::ImmediateAck);
+        break;
+    }
+  }
+  if (numPaddingFrames > 0) {
+    addFrame(FrameKind::Padding, {numPaddingFrames});
+  }
+  writeEvent();
+}
+
+void BinaryQLogger::addPacket(
+    const RegularQuicWritePacket& writePacket,
+    uint64_t packetSize) {
+  using FrameKind = BinaryQLogRecord::FrameKind;
+  addRecord(
+      BinaryQLogRecord::Type::PacketSent,
+      packetTypeCode(writePacket.header),
+      {writePacket.header.getPacketSequenceNum(), packetSize});
+
+  uint64_t numPaddingFrames = 0;
+  for (const auto& quicFrame : writePacket.frames) {
+    switch (quicFrame.type()) {
+      case QuicWriteFrame::Type::PaddingFrame:
+        numPaddingFrames += quicFrame.asPaddingFrame()->numFrames;
+        break;
+      case QuicWriteFrame::Type::RstStreamFrame: {
+        const auto& frame = *quicFrame.asRstStreamFrame();
+        addFrame(
+            FrameKind::RstStream,
+            {frame.streamId, frame.errorCode, frame.offset});
+        break;
+      }
+      case QuicWriteFrame::Type::ConnectionCloseFrame:
+        addConnectionCloseFrame(*quicFrame.asConnectionCloseFrame());
+        break;
+      case QuicWriteFrame::Type::MaxDataFrame:
+        addFrame(
+            FrameKind::MaxData, {quicFrame.asMaxDataFrame()->maximumData});
+        break;
+      case QuicWriteFrame::Type::MaxStreamDataFrame: {
+        const auto& frame = *quicFrame.asMaxStreamDataFrame();
+        addFrame(FrameKind::MaxStreamData, {frame.streamId, frame.maximumData});
+        break;
+      }
+      case QuicWriteFrame::Type::StreamsBlockedFrame: {
+        const auto& frame = *quicFrame.asStreamsBlockedFrame();
+        addFrame(
+            FrameKind::StreamsBlocked,
+            {frame.streamLimit, frame.isForBidirectional});
+        break;
+      }
+      case QuicWriteFrame::Type::DataBlockedFrame:
+        addFrame(
+            FrameKind::DataBlocked, {quicFrame.asDataBlockedFrame()->dataLimit});
+        break;
+      case QuicWriteFrame::Type::StreamDataBlockedFrame: {
+        const auto& frame = *quicFrame.asStreamDataBlockedFrame();
+        addFrame(
+            FrameKind::StreamDataBlocked, {frame.streamId, frame.dataLimit});
+        break;
+      }
+      case QuicWriteFrame::Type::WriteAckFrame: {
+        const auto& frame = *quicFrame.asWriteAckFrame();
+        addAckFrame(
+            FrameKind::WriteAck,
+            frame.ackBlocks,
+            frame.ackDelay,
+            frame.frameType);
+        break;
+      }
+      case QuicWriteFrame::Type::WriteStreamFrame: {
+        const auto& frame = *quicFrame.asWriteStreamFrame();
+        addFrame(
+            FrameKind::Stream,
+            {frame.streamId, frame.offset, frame.len, frame.fin});
+        break;
+      }
+      case QuicWriteFrame::Type::WriteCryptoFrame: {
+        const auto& frame = *quicFrame.asWriteCryptoFrame();
+        addFrame(FrameKind::Crypto, {frame.offset, frame.len});
+        break;
+      }
+      case QuicWriteFrame::Type::QuicSimpleFrame:
+        addSimpleFrame(*quicFrame.asQuicSimpleFrame());
+        break;
+      case QuicWriteFrame::Type::NoopFrame:
+        break;
+      case QuicWriteFrame::Type::DatagramFrame:
+        addFrame(FrameKind::Datagram, {quicFrame.asDatagramFrame()->length});
+        break;
+      case QuicWriteFrame::Type::ImmediateAckFrame:
+        addFrame(FrameKind::ImmediateAck);
+        break;
+      case QuicWriteFrame::Type::PingFrame:
+        addFrame(FrameKind::Ping);
+        break;
+    }
+  }
+  if (numPaddingFrames > 0) {
+    addFrame(FrameKind::Padding, {numPaddingFrames});
+  }
+  writeEvent();
+}
+
+void BinaryQLogger::addPacket(
+    const VersionNegotiationPacket& versionPacket,
+    uint64_t packetSize,
+    bool isPacketRecvd) {
+  addRecord(
+      BinaryQLogRecord::Type::VersionNegotiation,
+      isPacketRecvd,
+      {packetSize});
+  auto record = makeRecord(BinaryQLogRecord::Type::Versions);
+  for (auto version : versionPacket.versions) {
+    record.args[record.extra] = static_cast<uint64_t>(version);
+    if (++record.extra == BinaryQLogRecord::kNumArgs) {
+      event_.push_back(record);
+      record.extra = 0;
+    }
+  }
+  if (record.extra) {
+    event_.push_back(record);
+  }
+  writeEvent();
+}
+
+void BinaryQLogger::addPacket(
+    const RetryPacket& retryPacket,
+    uint64_t packetSize,
+    bool isPacketRecvd) {
+  addRecord(
+      BinaryQLogRecord::Type::Retry,
+      isPacketRecvd,
+      {packetSize, retryPacket.header.getToken().size()});
+  writeEvent();
+}
+
+void BinaryQLogger::addConnectionClose(
+    std::string error,
+    std::string reason,
+    bool drainConnection,
+    bool sendCloseImmediately) {
+  addRecord(
+      BinaryQLogRecord::Type::ConnectionClose,
+      0,
+      {drainConnection, sendCloseImmediately});
+  addText(0, error);
+  addText(1, reason);
+  writeEvent();
+}
+
+void BinaryQLogger::addTransportSummary(const TransportSummaryArgs& args) {
+  addRecord(
+      BinaryQLogRecord::Type::TransportSummary,
+      0,
+      {args.totalBytesSent,
+       args.totalBytesRecvd,
+       args.sumCurWriteOffset,
+       args.sumMaxObservedOffset,
+       args.sumCurStreamBufferLen});
+  addRecord(
+      BinaryQLogRecord::Type::Args,
+      5,
+      {args.totalBytesRetransmitted,
+       args.totalStreamBytesCloned,
+       args.totalBytesCloned,
+       args.totalCryptoDataWritten,
+       args.totalCryptoDataRecvd});
+  addRecord(
+      BinaryQLogRecord::Type::Args,
+      10,
+      {args.currentWritableBytes,
+       args.currentConnFlowControl,
+       args.totalPacketsSpuriouslyMarkedLost,
+       args.finalPacketLossReorderingThreshold,
+       args.finalPacketLossTimeReorderingThreshDividend});
+  addRecord(
+      BinaryQLogRecord::Type::Args,
+      15,
+      {args.usedZeroRtt,
+       static_cast<uint64_t>(args.quicVersion),
+       args.dsrPacketCount});
+  writeEvent();
+}
+
+void BinaryQLogger::addCongestionMetricUpdate(
+    uint64_t bytesInFlight,
+    uint64_t currentCwnd,
+    std::string congestionEvent,
+    std::string state,
+    std::string recoveryState) {
+  addRecord(
+      BinaryQLogRecord::Type::CongestionMetricUpdate,
+      0,
+      {bytesInFlight, currentCwnd});
+  addText(0, congestionEvent);
+  addText(1, state);
+  addText(2, recoveryState);
+  writeEvent();
+}
+
+void BinaryQLogger::addBandwidthEstUpdate(
+    uint64_t bytes,
+    std::chrono::microseconds interval) {
+  addRecord(
+      BinaryQLogRecord::Type::BandwidthEstUpdate,
+      0,
+      {bytes, static_cast<uint64_t>(interval.count())});
+  writeEvent();
+}
+
+void BinaryQLogger::addAppLimitedUpdate() {
+  addRecord(BinaryQLogRecord::Type::AppLimitedUpdate, true);
+  writeEvent();
+}
+
+void BinaryQLogger::addAppUnlimitedUpdate() {
+  addRecord(BinaryQLogRecord::Type::AppLimitedUpdate, false);
+  writeEvent();
+}
+
+void BinaryQLogger::addPacingMetricUpdate(
+    uint64_t pacingBurstSizeIn,
+    std::chrono::microseconds pacingIntervalIn) {
+  addRecord(
+      BinaryQLogRecord::Type::PacingMetricUpdate,
+      0,
+      {pacingBurstSizeIn, static_cast<uint64_t>(pacingIntervalIn.count())});
+  writeEvent();
+}
+
+void BinaryQLogger::addPacingObservation(
+    std::string actual,
+    std::string expected,
+    std::string conclusion) {
+  addRecord(BinaryQLogRecord::Type::PacingObservation);
+  addText(0, actual);
+  addText(1, expected);
+  addText(2, conclusion);
+  writeEvent();
+}
+
+void BinaryQLogger::addAppIdleUpdate(std::string idleEvent, bool idle) {
+  addRecord(BinaryQLogRecord::Type::AppIdleUpdate, idle);
+  addText(0, idleEvent);
+  writeEvent();
+}
+
+void BinaryQLogger::addPacketDrop(size_t packetSize, std::string dropReasonIn) {
+  addRecord(BinaryQLogRecord::Type::PacketDrop, 0, {packetSize});
+  addText(0, dropReasonIn);
+  writeEvent();
+}
+
+void BinaryQLogger::addDatagramReceived(uint64_t dataLen) {
+  addRecord(BinaryQLogRecord::Type::DatagramReceived, 0, {dataLen});
+  writeEvent();
+}
+
+void BinaryQLogger::addLossAlarm(
+    PacketNum largestSent,
+    uint64_t alarmCount,
+    uint64_t outstandingPackets,
+    std::string type) {
+  addRecord(
+      BinaryQLogRecord::Type::LossAlarm,
+      0,
+      {largestSent, alarmCount, outstandingPackets});
+  addText(0, type);
+  writeEvent();
+}
+
+void BinaryQLogger::addPacketsLost(
+    PacketNum largestLostPacketNum,
+    uint64_t lostBytes,
+    uint64_t lostPackets) {
+  addRecord(
+      BinaryQLogRecord::Type::PacketsLost,
+      0,
+      {largestLostPacketNum, lostBytes, lostPackets});
+  writeEvent();
+}
+
+void BinaryQLogger::addTransportStateUpdate(std::string update) {
+  addRecord(BinaryQLogRecord::Type::TransportStateUpdate);
+  addText(0, update);
+  writeEvent();
+}
+
+void BinaryQLogger::addPacketBuffered(
+    ProtectionType protectionType,
+    uint64_t packetSize) {
+  addRecord(
+      BinaryQLogRecord::Type::PacketBuffered,
+      static_cast<uint32_t>(protectionType),
+      {packetSize});
+  writeEvent();
+}
+
+void BinaryQLogger::addMetricUpdate(
+    std::chrono::microseconds latestRtt,
+    std::chrono::microseconds mrtt,
+    std::chrono::microseconds srtt,
+    std::chrono::microseconds ackDelay) {
+  addRecord(
+      BinaryQLogRecord::Type::MetricUpdate,
+      0,
+      {static_cast<uint64_t>(latestRtt.count()),
+       static_cast<uint64_t>(mrtt.count()),
+       static_cast<uint64_t>(srtt.count()),
+       static_cast<uint64_t>(ackDelay.count())});
+  writeEvent();
+}
+
+void BinaryQLogger::addStreamStateUpdate(
+    StreamId id,
+    std::string update,
+    folly::Optional<std::chrono::milliseconds> timeSinceStreamCreation) {
+  addRecord(
+      BinaryQLogRecord::Type::StreamStateUpdate,
+      timeSinceStreamCreation.hasValue(),
+      {id,
+       timeSinceStreamCreation
+           ? static_cast<uint64_t>(timeSinceStreamCreation->count())
+           : 0});
+  addText(0, update);
+  writeEvent();
+}
+
+void BinaryQLogger::addConnectionMigrationUpdate(bool intentionalMigration) {
+  addRecord(BinaryQLogRecord::Type::ConnectionMigration, intentionalMigration);
+  writeEvent();
+}
+
+void BinaryQLogger::addPathValidationEvent(bool success) {
+  addRecord(BinaryQLogRecord::Type::PathValidation, success);
+  writeEvent();
+}
+
+void BinaryQLogger::addPriorityUpdate(
+    quic::StreamId streamId,
+    uint8_t urgency,
+    bool incremental) {
+  addRecord(
+      BinaryQLogRecord::Type::PriorityUpdate,
+      incremental,
+      {streamId, urgency});
+  writeEvent();
+}
+
+void BinaryQLogger::setDcid(folly::Optional<ConnectionId> connID) {
+  if (connID.hasValue()) {
+    dcid = connID.value();
+    addText(
+        BinaryQLogRecord::Type::Dcid,
+        folly::StringPiece(
+            reinterpret_cast<const char*>(dcid->data()), dcid->size()));
+    writeEvent();
+  }
+}
+
+void BinaryQLogger::setScid(folly::Optional<ConnectionId> connID) {
+  if (connID.hasValue()) {
+    scid = connID.value();
+    addText(
+        BinaryQLogRecord::Type::Scid,
+        folly::StringPiece(
+            reinterpret_cast<const char*>(scid->data()), scid->size()));
+    writeEvent();
+  }
+}
+
+} // namespace quic
@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <folly/Range.h>
+#include <folly/ThreadLocal.h>
+#include <quic/logging/QLogger.h>
+
+namespace quic {
+
+/**
+ * Fixed-size record of the binary qlog format. An event is one record,
+ * optionally followed by records that belong to it (frames of a packet,
+ * strings), which are attached to the last event of the same connection.
+ */
+struct BinaryQLogRecord {
+  enum class Type : uint16_t {
+    // args: version
+    FileHeader,
+    // extra: vantage point, followed by the protocol type as Text
+    Connection,
+    // text: connection id
+    Dcid,
+    Scid,
+    // extra: index of the string in the last event, text: a chunk of it
+    Text,
+    // extra: FrameKind
+    Frame,
+    // args: pairs of (start, end), extra: number of pairs
+    AckBlocks,
+    // args: up to 5 versions, extra: number of versions
+    Versions,
+    // more args of the last event, extra: index of the first one
+    Args,
+    // args: number of events dropped because the ring was full
+    Dropped,
+    // one type per QLogger event
+    PacketReceived,
+    PacketSent,
+    VersionNegotiation,
+    Retry,
+    ConnectionClose,
+    TransportSummary,
+    CongestionMetricUpdate,
+    BandwidthEstUpdate,
+    AppLimitedUpdate,
+    PacingMetricUpdate,
+    PacingObservation,
+    AppIdleUpdate,
+    PacketDrop,
+    DatagramReceived,
+    LossAlarm,
+    PacketsLost,
+    TransportStateUpdate,
+    PacketBuffered,
+    MetricUpdate,
+    StreamStateUpdate,
+    ConnectionMigration,
+    PathValidation,
+    PriorityUpdate,
+  };
+
+  enum class FrameKind : uint32_t {
+    Padding,
+    RstStream,
+    ConnectionClose,
+    MaxData,
+    MaxStreamData,
+    MaxStreams,
+    DataBlocked,
+    StreamDataBlocked,
+    StreamsBlocked,
+    ReadAck,
+    WriteAck,
+    Stream,
+    Crypto,
+    ReadNewToken,
+    NewToken,
+    Ping,
+    StopSending,
+    PathChallenge,
+    PathResponse,
+    NewConnectionId,
+    RetireConnectionId,
+    HandshakeDone,
+    Knob,
+    AckFrequency,
+    ImmediateAck,
+    Datagram,
+  };
+
+  static constexpr uint64_t kVersion = 1;
+  static constexpr size_t kNumArgs = 5;
+  static constexpr size_t kTextSize = kNumArgs * sizeof(uint64_t);
+
+  uint64_t connection;
+  // microseconds since the epoch
+  uint64_t time;
+  Type type;
+  uint16_t textLen;
+  uint32_t extra;
+  uint64_t args[kNumArgs];
+};
+
+static_assert(sizeof(BinaryQLogRecord) == 64, "records are one cache line");
+
+/**
+ * Drains the records of all BinaryQLoggers sharing it into one file. Every
+ * thread logs into its own ring, so logging is a copy into thread local
+ * memory and a release store; a background thread periodically appends the
+ * rings to the file. An event goes into the ring whole, with the records
+ * attached to it, or is dropped and counted when the ring has no room for all
+ * of them.
+ */
+class BinaryQLogWriter {
+ public:
+  inline const static std::string kBinaryQlogExtension = ".bqlog";
+
+  explicit BinaryQLogWriter(
+      const std::string& path,
+      size_t ringSize = 8192,
+      std::chrono::milliseconds flushInterval = std::chrono::milliseconds(50));
+  ~BinaryQLogWriter();
+
+  // An event record followed by its attachments.
+  void write(folly::Range<const BinaryQLogRecord*> event);
+
+  uint64_t newConnection() {
+    return nextConnection_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // file the records are written to, <path>/<pid>.bqlog
+  const std::string& getFilePath() const {
+    return filePath_;
+  }
+
+ private:
+  struct Ring {
+    explicit Ring(size_t size) : records(size) {}
+    std::vector<BinaryQLogRecord> records;
+    // written by the producer thread
+    std::atomic<uint64_t> head{0};
+    // written by the writer thread
+    std::atomic<uint64_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+    // only used by the writer thread
+    uint64_t droppedReported{0};
+  };
+
+  Ring& localRing();
+  void run();
+  void drain();
+
+  std::string filePath_;
+  int fd_{-1};
+  size_t ringSize_;
+  std::chrono::milliseconds flushInterval_;
+  std::atomic<uint64_t> nextConnection_{1};
+
+  struct RingTag {};
+  folly::ThreadLocal<Ring*, RingTag> localRing_;
+  // rings outlive their threads so that nothing logged is lost
+  std::mutex ringsMutex_;
+  std::vector<std::unique_ptr<Ring>> rings_;
+  std::vector<BinaryQLogRecord> drainBuffer_;
+
+  std::mutex stopMutex_;
+  std::condition_variable stopCv_;
+  bool stop_{false};
+  std::thread thread_;
+};
+
+/**
+ * QLogger that encodes events into BinaryQLogRecords instead of building
+ * QLogEvents. The output is converted to standard qlog JSON offline by
+ * BinaryQLogReader. Strings are split over as many records as they need; ack
+ * receive timestamps are not recorded.
+ */
+class BinaryQLogger : public QLogger {
+ public:
+  BinaryQLogger(
+      VantagePoint vantagePointIn,
+      std::shared_ptr<BinaryQLogWriter> writer,
+      std::string protocolTypeIn = kHTTP3ProtocolType);
+  ~BinaryQLogger() override = default;
+
+  void addPacket(const RegularQuicPacket& regularPacket, uint64_t packetSize)
+      override;
+  void addPacket(
+      const VersionNegotiationPacket& versionPacket,
+      uint64_t packetSize,
+      bool isPacketRecvd) override;
+  void addPacket(const RegularQuicWritePacket& writePacket, uint64_t packetSize)
+      override;
+  void addPacket(
+      const RetryPacket& retryPacket,
+      uint64_t packetSize,
+      bool isPacketRecvd) override;
+  void addConnectionClose(
+      std::string error,
+      std::string reason,
+      bool drainConnection,
+      bool sendCloseImmediately) override;
+  void addTransportSummary(const TransportSummaryArgs& args) override;
+  void addCongestionMetricUpdate(
+      uint64_t bytesInFlight,
+      uint64_t currentCwnd,
+      std::string congestionEvent,
+      std::string state = "",
+      std::string recoveryState = "") override;
+  void addBandwidthEstUpdate(uint64_t bytes, std::chrono::microseconds interval)
+      override;
+  void addAppLimitedUpdate() override;
+  void addAppUnlimitedUpdate() override;
+  void addPacingMetricUpdate(
+      uint64_t pacingBurstSizeIn,
+      std::chrono::microseconds pacingIntervalIn) override;
+  void addPacingObservation(
+      std::string actual,
+      std::string expected,
+      std::string conclusion) override;
+  void addAppIdleUpdate(std::string idleEvent, bool idle) override;
+  void addPacketDrop(size_t packetSize, std::string dropReasonIn) override;
+  void addDatagramReceived(uint64_t dataLen) override;
+  void addLossAlarm(
+      PacketNum largestSent,
+      uint64_t alarmCount,
+      uint64_t outstandingPackets,
+      std::string type) override;
+  void addPacketsLost(
+      PacketNum largestLostPacketNum,
+      uint64_t lostBytes,
+      uint64_t lostPackets) override;
+  void addTransportStateUpdate(std::string update) override;
+  void addPacketBuffered(ProtectionType protectionType, uint64_t packetSize)
+      override;
+  void addMetricUpdate(
+      std::chrono::microseconds latestRtt,
+      std::chrono::microseconds mrtt,
+      std::chrono::microseconds srtt,
+      std::chrono::microseconds ackDelay) override;
+  void addStreamStateUpdate(
+      StreamId id,
+      std::string update,
+      folly::Optional<std::chrono::milliseconds> timeSinceStreamCreation)
+      override;
+  void addConnectionMigrationUpdate(bool intentionalMigration) override;
+  void addPathValidationEvent(bool success) override;
+  void addPriorityUpdate(
+      quic::StreamId streamId,
+      uint8_t urgency,
+      bool incremental) override;
+
+  void setDcid(folly::Optional<ConnectionId> connID) override;
+  void setScid(folly::Optional<ConnectionId> connID) override;
+
+ private:
+  // Hands the records of the event built so far to the writer.
+  void writeEvent();
+  BinaryQLogRecord makeRecord(
+      BinaryQLogRecord::Type type,
+      uint32_t extra = 0,
+      std::initializer_list<uint64_t> args = {}) const;
+  void addRecord(
+      BinaryQLogRecord::Type type,
+      uint32_t extra = 0,
+      std::initializer_list<uint64_t> args = {});
+  void addFrame(
+      BinaryQLogRecord::FrameKind kind,
+      std::initializer_list<uint64_t> args = {});
+  void addText(uint32_t index, folly::StringPiece text);
+  void addText(BinaryQLogRecord::Type type, folly::StringPiece text);
+  void addSimpleFrame(const QuicSimpleFrame& simpleFrame);
+  void addConnectionCloseFrame(const ConnectionCloseFrame& frame);
+  template <typename AckBlocks>
+  void addAckFrame(
+      BinaryQLogRecord::FrameKind kind,
+      const AckBlocks& ackBlocks,
+      std::chrono::microseconds ackDelay,
+      FrameType frameType);
+
+  std::shared_ptr<BinaryQLogWriter> writer_;
+  uint64_t connection_;
+  // records of the event being logged
+  std::vector<BinaryQLogRecord> event_;
+};
+
+} // namespace quic
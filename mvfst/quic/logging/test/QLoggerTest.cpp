@@ -14,6 +14,7 @@
 #include <gtest/gtest.h>
 #include <quic/common/test/TestUtils.h>
 #include <quic/congestion_control/Bbr.h>
+#include <quic/logging/BinaryQLogReader.h>
 #include <quic/logging/FileQLogger.h>
 #include <chrono>
 
@@ -1898,4 +1899,111 @@ TEST_F(QLoggerTest, ReadAckReceiveTimestampsFrame) {
   EXPECT_EQ(expected, parsed);
 }
 
+TEST_F(QLoggerTest, BinaryQLogRoundTrip) {
+  auto dir = folly::fs::temp_directory_path().string();
+  std::string filePath;
+  {
+    auto writer = std::make_shared<BinaryQLogWriter>(dir);
+    filePath = writer->getFilePath();
+    BinaryQLogger q(VantagePoint::Client, writer);
+    q.setDcid(getTestConnectionId(1));
+    q.addPacket(createRegularQuicWritePacket(streamId, offset, len, fin), 10);
+    q.addCongestionMetricUpdate(
+        20, 30, kPersistentCongestion, std::string(100, 's'));
+    q.addStreamStateUpdate(streamId, kAbort, folly::none);
+    // the writer drains everything left when it is destroyed
+  }
+
+  auto result = BinaryQLogReader::readFile(filePath);
+  EXPECT_EQ(result.droppedEvents, 0);
+  ASSERT_EQ(result.connections.size(), 1);
+  const auto& q = *result.connections[0];
+  EXPECT_EQ(q.vantagePoint, VantagePoint::Client);
+  EXPECT_EQ(q.protocolType, kHTTP3ProtocolType);
+  EXPECT_EQ(q.dcid, getTestConnectionId(1));
+  ASSERT_EQ(q.logs.size(), 3);
+
+  auto packet = dynamic_cast<QLogPacketEvent*>(q.logs[0].get());
+  ASSERT_NE(packet, nullptr);
+  EXPECT_EQ(packet->eventType, QLogEventType::PacketSent);
+  EXPECT_EQ(packet->packetSize, 10);
+  EXPECT_EQ(packet->packetNum, packetNumSent);
+  ASSERT_EQ(packet->frames.size(), 1);
+  auto frame = static_cast<StreamFrameLog*>(packet->frames[0].get());
+  EXPECT_EQ(frame->streamId, streamId);
+  EXPECT_EQ(frame->offset, offset);
+  EXPECT_EQ(frame->len, len);
+  EXPECT_EQ(frame->fin, fin);
+
+  auto congestion =
+      dynamic_cast<QLogCongestionMetricUpdateEvent*>(q.logs[1].get());
+  ASSERT_NE(congestion, nullptr);
+  EXPECT_EQ(congestion->bytesInFlight, 20);
+  EXPECT_EQ(congestion->currentCwnd, 30);
+  EXPECT_EQ(congestion->congestionEvent, kPersistentCongestion);
+  // split over several records
+  EXPECT_EQ(congestion->state, std::string(100, 's'));
+  EXPECT_EQ(congestion->recoveryState, "");
+
+  auto stream = dynamic_cast<QLogStreamStateUpdateEvent*>(q.logs[2].get());
+  ASSERT_NE(stream, nullptr);
+  EXPECT_EQ(stream->id, streamId);
+  EXPECT_EQ(stream->update, kAbort);
+  EXPECT_FALSE(stream->timeSinceStreamCreation.hasValue());
+}
+
+TEST_F(QLoggerTest, BinaryQLogDatagramFrames) {
+  auto dir = folly::fs::temp_directory_path().string();
+  std::string filePath;
+  {
+    auto writer = std::make_shared<BinaryQLogWriter>(dir);
+    filePath = writer->getFilePath();
+    BinaryQLogger q(VantagePoint::Client, writer);
+    auto packet = createRegularQuicWritePacket(streamId, offset, len, fin);
+    packet.frames.clear();
+    packet.frames.emplace_back(
+        DatagramFrame(100, folly::IOBuf::copyBuffer(std::string(100, 'd'))));
+    q.addPacket(packet, 150);
+  }
+
+  auto result = BinaryQLogReader::readFile(filePath);
+  ASSERT_EQ(result.connections.size(), 1);
+  const auto& q = *result.connections[0];
+  ASSERT_EQ(q.logs.size(), 1);
+  auto sent = dynamic_cast<QLogPacketEvent*>(q.logs[0].get());
+  ASSERT_NE(sent, nullptr);
+  EXPECT_EQ(sent->eventType, QLogEventType::PacketSent);
+  ASSERT_EQ(sent->frames.size(), 1);
+  auto datagram = dynamic_cast<DatagramFrameLog*>(sent->frames[0].get());
+  ASSERT_NE(datagram, nullptr);
+  EXPECT_EQ(datagram->len, 100);
+}
+
+TEST_F(QLoggerTest, BinaryQLogDropsWholeEvents) {
+  auto dir = folly::fs::temp_directory_path().string();
+  std::string filePath;
+  {
+    // nothing is drained before the writer is destroyed
+    auto writer = std::make_shared<BinaryQLogWriter>(
+        dir, 4, std::chrono::milliseconds(3600 * 1000));
+    filePath = writer->getFilePath();
+    // the connection record and its protocol type
+    BinaryQLogger q(VantagePoint::Client, writer);
+    // five records, more than the ring has room for
+    q.addCongestionMetricUpdate(
+        20, 30, kPersistentCongestion, std::string(100, 's'));
+    // two records, which fill the ring
+    q.addStreamStateUpdate(streamId, kAbort, folly::none);
+  }
+
+  auto result = BinaryQLogReader::readFile(filePath);
+  EXPECT_EQ(result.droppedEvents, 1);
+  ASSERT_EQ(result.connections.size(), 1);
+  const auto& q = *result.connections[0];
+  ASSERT_EQ(q.logs.size(), 1);
+  auto stream = dynamic_cast<QLogStreamStateUpdateEvent*>(q.logs[0].get());
+  ASSERT_NE(stream, nullptr);
+  EXPECT_EQ(stream->update, kAbort);
+}
+
 } // namespace quic::test
@@ -7,6 +7,7 @@
 
 #include <folly/small_vector.h>
 #include <quic/loss/QuicLossFunctions.h>
+#include <quic/state/PmtuDiscovery.h>
 #include <quic/state/QuicStreamFunctions.h>
 
 namespace quic {
@@ -383,7 +384,17 @@ bool processOutstandingsForLoss(
       conn.lossState.totalPacketsMarkedLostByReorderingThreshold++;
       iter->metadata.lossReorderDistance = reorderDistance;
     }
-    lossEvent.addLostPacket(pkt);
+    if (isPmtuProbe(conn, pkt)) {
+      // A probe larger than the path MTU is expected to get lost, so it is
+      // not a congestion signal.
+      onPmtuProbeLost(conn, lossTime);
+      if (conn.congestionController) {
+        conn.congestionController->onRemoveBytesFromInflight(
+            pkt.metadata.encodedSize);
+      }
+    } else {
+      lossEvent.addLostPacket(pkt);
+    }
     if (observerLossEvent) {
       observerLossEvent->addLostPacket(
           pkt.metadata,
@@ -13,7 +13,7 @@ namespace quic {
 
 SocketObserverInterface::WriteEvent::Builder&&
 SocketObserverInterface::WriteEvent::Builder::setOutstandingPackets(
-    const std::deque<OutstandingPacketWrapper>& outstandingPacketsIn) {
+    const OutstandingPacketList& outstandingPacketsIn) {
   maybeOutstandingPacketsRef = outstandingPacketsIn;
   return std::move(*this);
 }
@@ -69,7 +69,7 @@ SocketObserverInterface::WriteEvent::WriteEvent(
 
 SocketObserverInterface::AppLimitedEvent::Builder&&
 SocketObserverInterface::AppLimitedEvent::Builder::setOutstandingPackets(
-    const std::deque<OutstandingPacketWrapper>& outstandingPacketsIn) {
+    const OutstandingPacketList& outstandingPacketsIn) {
   maybeOutstandingPacketsRef = outstandingPacketsIn;
   return std::move(*this);
 }
@@ -126,31 +126,31 @@ void SocketObserverInterface::PacketsWrittenEvent::
     return; // nothing to do
   }
 
-  // The packets in the OutstandingPackets deque are sorted by their sequence
+  // The packets in the OutstandingPacketList are sorted by their sequence
   // nunber in their packet number space. As a result, the N packets at the end
-  // of the deque may not be the N most recently sent OutstandingPacketss.
+  // of the list may not be the N most recently sent OutstandingPacketss.
   // Furthermore, adjacent OutstandingPackets may have the same sequence
   // number because they belong to different packet number spaces. Because
-  // packets in the deque are sorted only by sequence number, the ith packet
-  // in the deque may have actually been sent after the i+1th packet.
+  // packets in the list are sorted only by sequence number, the ith packet
+  // in the list may have actually been sent after the i+1th packet.
   //
-  // However, the deque will typically only contain AppData packets, and thus
-  // we can expect that the last N elements in the deque will typically be the
+  // However, the list will typically only contain AppData packets, and thus
+  // we can expect that the last N elements in the list will typically be the
   // N most recently sent OutstandingPackets. We use this to avoid needing to
   // scan the queue when the following is true:
   //
   //    (1) If the writeCount of the OutstandingPacketWrapper N packets from the
   //    end of
-  //        the deque has a writeCount equal to that reported by this event, and
+  //        the list has a writeCount equal to that reported by this event, and
   //    (2) If when scanning from the OutstandingPacketWrapper N packets from
   //    the end
-  //        of the deque to the end of the deque, the numAckElicitingPacketsSent
+  //        of the list to the end of the list, the numAckElicitingPacketsSent
   //        recorded for each OutstandingPacketWrapper is one larger than that
   //        of the previous OutstandingPacketWrapper, and writeCount recorded is
   //        equal to the writeCount reported by this event.
   //
   // If the above is true, then the N OutstandingPackets from the end of the
-  // deque were all sent during this write operation, and they are already
+  // list were all sent during this write operation, and they are already
   // ordered such that packet i was sent before packet i+1.
   {
     const auto startIt = outstandingPackets.end() -
@@ -190,7 +190,7 @@ void SocketObserverInterface::PacketsWrittenEvent::
 
   // It looks like a full walk is needed.
   //
-  // From the front of the deque, find OutstandingPackets with the writeCount
+  // From the front of the list, find OutstandingPackets with the writeCount
   // reported by this event and insert references to them into a vector.
   std::vector<std::reference_wrapper<const OutstandingPacketWrapper>>
       newOutstandingPackets;
@@ -224,7 +224,7 @@ void SocketObserverInterface::PacketsWrittenEvent::
 
 SocketObserverInterface::PacketsWrittenEvent::Builder&&
 SocketObserverInterface::PacketsWrittenEvent::Builder::setOutstandingPackets(
-    const std::deque<OutstandingPacketWrapper>& outstandingPacketsIn) {
+    const OutstandingPacketList& outstandingPacketsIn) {
   maybeOutstandingPacketsRef = outstandingPacketsIn;
   return std::move(*this);
 }
@@ -10,7 +10,7 @@
 #include <quic/QuicException.h>
 #include <quic/common/SmallCollections.h>
 #include <quic/state/AckEvent.h>
-#include <quic/state/OutstandingPacket.h>
+#include <quic/state/OutstandingPacketList.h>
 #include <quic/state/QuicStreamUtilities.h>
 
 #include <utility>
@@ -35,6 +35,7 @@ class SocketObserverInterface {
     rttSamples = 4,
     lossEvents = 5,
     spuriousLossEvents = 6,
+    pmtuEvents = 7,
     knobFrameEvents = 8,
     streamEvents = 9,
     acksProcessedEvents = 10,
@@ -86,13 +87,12 @@ class SocketObserverInterface {
   };
 
   struct WriteEvent {
-    [[nodiscard]] const std::deque<OutstandingPacketWrapper>&
-    getOutstandingPackets() const {
+    [[nodiscard]] const OutstandingPacketList& getOutstandingPackets() const {
       return outstandingPackets;
     }
 
     // Reference to the current list of outstanding packets.
-    const std::deque<OutstandingPacketWrapper>& outstandingPackets;
+    const OutstandingPacketList& outstandingPackets;
 
     // Monotonically increasing number assigned to each write operation.
     const uint64_t writeCount;
@@ -111,8 +111,7 @@ class SocketObserverInterface {
     const folly::Optional<uint64_t> maybeWritableBytes;
 
     struct BuilderFields {
-      folly::Optional<
-          std::reference_wrapper<const std::deque<OutstandingPacketWrapper>>>
+      folly::Optional<std::reference_wrapper<const OutstandingPacketList>>
           maybeOutstandingPacketsRef;
       folly::Optional<uint64_t> maybeWriteCount;
       folly::Optional<TimePoint> maybeLastPacketSentTime;
@@ -123,7 +122,7 @@ class SocketObserverInterface {
 
     struct Builder : public BuilderFields {
       Builder&& setOutstandingPackets(
-          const std::deque<OutstandingPacketWrapper>& outstandingPacketsIn);
+          const OutstandingPacketList& outstandingPacketsIn);
       Builder&& setWriteCount(const uint64_t writeCountIn);
       Builder&& setLastPacketSentTime(const TimePoint& lastPacketSentTimeIn);
       Builder&& setLastPacketSentTime(
@@ -153,7 +152,7 @@ class SocketObserverInterface {
   struct AppLimitedEvent : public WriteEvent {
     struct Builder : public WriteEvent::BuilderFields {
       Builder&& setOutstandingPackets(
-          const std::deque<OutstandingPacketWrapper>& outstandingPacketsIn);
+          const OutstandingPacketList& outstandingPacketsIn);
       Builder&& setWriteCount(const uint64_t writeCountIn);
       Builder&& setLastPacketSentTime(const TimePoint& lastPacketSentTimeIn);
       Builder&& setLastPacketSentTime(
@@ -197,7 +196,7 @@ class SocketObserverInterface {
 
     struct Builder : public BuilderFields {
       Builder&& setOutstandingPackets(
-          const std::deque<OutstandingPacketWrapper>& outstandingPacketsIn);
+          const OutstandingPacketList& outstandingPacketsIn);
       Builder&& setWriteCount(const uint64_t writeCountIn);
       Builder&& setLastPacketSentTime(const TimePoint& lastPacketSentTimeIn);
       Builder&& setLastPacketSentTime(
@@ -397,6 +396,21 @@ class SocketObserverInterface {
     const quic::KnobFrame knobFrame;
   };
 
+  struct PmtuUpdateEvent {
+    PmtuUpdateEvent(
+        TimePoint timeIn,
+        uint64_t previousPacketLenIn,
+        uint64_t packetLenIn)
+        : time(timeIn),
+          previousPacketLen(previousPacketLenIn),
+          packetLen(packetLenIn) {}
+
+    const TimePoint time;
+    // udpSendPacketLen before and after the update
+    const uint64_t previousPacketLen;
+    const uint64_t packetLen;
+  };
+
   struct StreamEvent {
     StreamEvent(
         const StreamId id,
@@ -562,6 +576,17 @@ class SocketObserverInterface {
       QuicSocket*, /* socket */
       const KnobFrameEvent& /* event */) {}
 
+  /**
+   * pmtuUpdated() is invoked when path MTU discovery changes the size of the
+   * packets the socket sends, and with it the datagram size limit.
+   *
+   * @param socket   Socket when the callback is processed.
+   * @param event    const reference to the PmtuUpdateEvent.
+   */
+  virtual void pmtuUpdated(
+      QuicSocket*, /* socket */
+      const PmtuUpdateEvent& /* event */) {}
+
   /**
    * streamOpened() is invoked when a new stream is opened.
    *
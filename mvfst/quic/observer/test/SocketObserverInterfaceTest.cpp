@@ -76,7 +76,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // no new packets, no old packets
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
 
     // build event with writeCount = 10
     const auto event = SocketObserverInterface::PacketsWrittenEvent::Builder()
@@ -106,7 +106,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // no new packets, has old packets
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -145,7 +145,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // no new ack eliciting packets, no old packets
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
 
     // build event with writeCount = 10
     const auto event = SocketObserverInterface::PacketsWrittenEvent::Builder()
@@ -175,7 +175,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // no new ack eliciting packets, has old packets
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -214,7 +214,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // first packet sent for initial, handshake, app data, single write, ordered
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::Initial;
@@ -293,7 +293,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // first packet sent for initial, handshake, app data, single write, reversed
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -373,7 +373,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // specifically, ordered by packet number, but random on pnspace
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::Handshake;
@@ -452,7 +452,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // first packet for initial, handshake, app data, separate writes, ordered
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::Initial;
@@ -517,7 +517,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // first packet for initial, handshake, app data, separate writes, reversed
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -582,7 +582,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // retransmit initial
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::Initial;
@@ -657,7 +657,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // retransmit all three
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::Initial;
@@ -766,7 +766,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // just app data, single new packet
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -811,7 +811,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // just app data, single new packet, non-ack eliciting written
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -856,7 +856,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // just app data, multiple new packets
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -919,7 +919,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // just app data, multiple new packets, non-ack eliciting written
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -982,7 +982,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // just app data, multiple old packets, multiple new packets
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
@@ -1065,7 +1065,7 @@ TEST_F(SocketObserverInterfaceTest, InvokeForEachNewOutstandingPacketOrdered) {
   // just app data, multiple old packets, single new packet
   {
     // create OutstandingPacketWrapper deque
-    std::deque<OutstandingPacketWrapper> outstandingPackets;
+    OutstandingPacketList outstandingPackets;
     outstandingPackets.emplace_back([]() {
       OutstandingPacketRelevantFields fields;
       fields.maybePnSpace = PacketNumberSpace::AppData;
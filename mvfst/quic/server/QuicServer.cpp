@@ -92,6 +92,25 @@ void QuicServer::setUnfinishedHandshakeLimit(std::function<int()> limitFn) {
   unfinishedHandshakeLimitFn_ = std::move(limitFn);
 }
 
+void QuicServer::setWorkerUnfinishedHandshakeLimit(uint32_t limit) {
+  workerUnfinishedHandshakeLimit_ = limit;
+}
+
+void QuicServer::setWorkerCpus(std::vector<int> cpus) {
+  CHECK(workers_.empty()) << "Worker CPUs must be set before start";
+  workerCpus_ = std::move(cpus);
+}
+
+void QuicServer::setBusyPollWorkers(
+    size_t numWorkers,
+    std::chrono::microseconds socketBusyPoll,
+    BusyPoller::Options options) {
+  CHECK(workers_.empty()) << "Busy poll workers must be set before start";
+  busyPollWorkers_ = numWorkers;
+  socketBusyPoll_ = socketBusyPoll;
+  busyPollOptions_ = options;
+}
+
 void QuicServer::setSupportedVersion(const std::vector<QuicVersion>& versions) {
   supportedVersions_ = versions;
 }
@@ -201,10 +220,27 @@ void QuicServer::initializeWorkers(
           rateLimit_->count, rateLimit_->window));
     }
     worker->setUnfinishedHandshakeLimit(unfinishedHandshakeLimitFn_);
+    worker->setWorkerUnfinishedHandshakeLimit(workerUnfinishedHandshakeLimit_);
     worker->setWorkerId(i);
     worker->setTransportSettingsOverrideFn(transportSettingsOverrideFn_);
     workers_.push_back(std::move(worker));
     evbToWorkers_.emplace(workerEvb, workers_.back().get());
+    if (!workerCpus_.empty()) {
+      // before the socket is bound, which applies SO_INCOMING_CPU
+      workerEvb->runImmediatelyOrRunInEventBaseThreadAndWait(
+          [workerPtr = workers_.back().get(),
+           cpu = workerCpus_[i % workerCpus_.size()]] {
+            workerPtr->setCpuAffinity(cpu);
+          });
+    }
+    if (i < busyPollWorkers_) {
+      workerEvb->runImmediatelyOrRunInEventBaseThreadAndWait(
+          [workerPtr = workers_.back().get(),
+           socketBusyPoll = socketBusyPoll_,
+           options = busyPollOptions_] {
+            workerPtr->enableBusyPoll(socketBusyPoll, options);
+          });
+    }
   }
 }
 
@@ -107,6 +107,31 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
 
   void setUnfinishedHandshakeLimit(std::function<int()> limitFn);
 
+  /**
+   * Limits the handshakes in progress on each worker, see
+   * QuicServerWorker::setWorkerUnfinishedHandshakeLimit.
+   */
+  void setWorkerUnfinishedHandshakeLimit(uint32_t limit);
+
+  /**
+   * Pins worker i to cpus[i % cpus.size()], see
+   * QuicServerWorker::setCpuAffinity. To keep packets on one NUMA node, pass
+   * the CPUs that service the NIC's receive queues. Must be called before the
+   * server is started.
+   */
+  void setWorkerCpus(std::vector<int> cpus);
+
+  /**
+   * Runs the first numWorkers workers in busy poll mode, see
+   * QuicServerWorker::enableBusyPoll. Best combined with setWorkerCpus, each
+   * of these workers keeps its core busy while there is traffic. Must be
+   * called before the server is started.
+   */
+  void setBusyPollWorkers(
+      size_t numWorkers,
+      std::chrono::microseconds socketBusyPoll,
+      BusyPoller::Options options = BusyPoller::Options());
+
   /**
    * Set list of supported QUICVersion for this server. These versions will be
    * used during the 'Version-Negotiation' phase with the client.
@@ -457,6 +482,12 @@ class QuicServer : public QuicServerWorker::WorkerCallback,
   folly::Optional<RateLimit> rateLimit_;
 
   std::function<int()> unfinishedHandshakeLimitFn_{[]() { return 1048576; }};
+  uint32_t workerUnfinishedHandshakeLimit_{
+      std::numeric_limits<uint32_t>::max()};
+  std::vector<int> workerCpus_;
+  size_t busyPollWorkers_{0};
+  std::chrono::microseconds socketBusyPoll_{0};
+  BusyPoller::Options busyPollOptions_;
 
   // Options to AsyncUDPSocket::bind, only controls IPV6_ONLY currently.
   folly::AsyncUDPSocket::BindOptions bindOptions_;
@@ -513,7 +513,8 @@ void QuicServerTransport::processPendingData(bool async) {
             pendingPacket.peer,
             NetworkData(
                 std::move(pendingPacket.networkData.data),
-                pendingPacket.networkData.receiveTimePoint));
+                pendingPacket.networkData.receiveTimePoint,
+                pendingPacket.networkData.tosValue));
         if (serverPtr->closeState_ == CloseState::CLOSED) {
           // The pending data could potentially contain a connection close, or
           // the app could have triggered a connection close with an error. It
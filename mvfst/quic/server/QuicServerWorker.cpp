@@ -6,9 +6,11 @@
  */
 
 #include <fmt/format.h>
+#include <folly/String.h>
 #include <folly/chrono/Conv.h>
 #include <folly/io/Cursor.h>
 #include <folly/io/SocketOptionMap.h>
+#include <folly/net/NetOps.h>
 #include <folly/system/ThreadId.h>
 #include <quic/QuicConstants.h>
 #include <quic/common/SocketUtil.h>
@@ -104,6 +106,18 @@ void QuicServerWorker::bind(
         folly::SocketOptionKey::ApplyPos::POST_BIND);
   }
   socket_->setDFAndTurnOffPMTU();
+  if (transportSettings_.edtPacing) {
+    // departure times are relative to CLOCK_MONOTONIC, as fq expects
+    folly::AsyncUDPSocket::TXTime txTime;
+    txTime.clockid = CLOCK_MONOTONIC;
+    socket_->setTXTime(txTime);
+  }
+  if (transportSettings_.enableEcnOnEgress) {
+    socket_->setTosOrTrafficClass(kEcnECT0);
+  }
+  if (transportSettings_.readEcnOnIngress) {
+    socket_->setRecvTos(true);
+  }
   if (transportSettings_.numGROBuffers_ > kDefaultNumGROBuffers) {
     socket_->setGRO(true);
     if (socket_->getGRO() > 0) {
@@ -112,6 +126,7 @@ void QuicServerWorker::bind(
     }
   }
   socket_->setTimestamping(SOF_TIMESTAMPING_SOFTWARE);
+  applyWorkerSocketOptions();
 
   if (mvfst_hook_on_socket_create) {
     mvfst_hook_on_socket_create(socket_->getNetworkSocket().toFd());
@@ -132,6 +147,77 @@ void QuicServerWorker::applyAllSocketOptions() {
         getAddress().getFamily(),
         folly::SocketOptionKey::ApplyPos::POST_BIND);
   }
+  applyWorkerSocketOptions();
+}
+
+void QuicServerWorker::setCpuAffinity(int cpu) {
+  DCHECK(evb_->isInEventBaseThread());
+  DCHECK(sourceAddressMap_.empty() && connectionIdMap_.empty());
+  cpu_ = cpu;
+#ifdef __linux__
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(cpu, &cpuSet);
+  int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+  if (ret != 0) {
+    LOG(ERROR) << "Failed to pin worker=" << fmt::ptr(this) << " to cpu=" << cpu
+               << ", error=" << folly::errnoStr(ret);
+  }
+#else
+  LOG(WARNING) << "CPU affinity is not supported on this platform";
+#endif
+  if (bufAccessor_) {
+    createBufAccessor();
+  }
+  if (socket_) {
+    applyWorkerSocketOptions();
+  }
+}
+
+void QuicServerWorker::enableBusyPoll(
+    std::chrono::microseconds socketBusyPoll,
+    BusyPoller::Options options) {
+  DCHECK(evb_->isInEventBaseThread());
+  socketBusyPoll_ = socketBusyPoll;
+  busyPoller_ = std::make_unique<BusyPoller>(evb_, options);
+  busyPoller_->start();
+  if (socket_) {
+    applyWorkerSocketOptions();
+  }
+}
+
+void QuicServerWorker::applyWorkerSocketOptions() {
+  if (socket_->getNetworkSocket() == folly::NetworkSocket()) {
+    return;
+  }
+#ifdef SO_INCOMING_CPU
+  if (cpu_) {
+    int cpu = *cpu_;
+    if (folly::netops::setsockopt(
+            socket_->getNetworkSocket(),
+            SOL_SOCKET,
+            SO_INCOMING_CPU,
+            &cpu,
+            sizeof(cpu)) != 0) {
+      LOG(WARNING) << "Failed to set SO_INCOMING_CPU=" << cpu
+                   << ", error=" << folly::errnoStr(errno);
+    }
+  }
+#endif
+#ifdef SO_BUSY_POLL
+  if (socketBusyPoll_.count() > 0) {
+    int busyPollUs = socketBusyPoll_.count();
+    if (folly::netops::setsockopt(
+            socket_->getNetworkSocket(),
+            SOL_SOCKET,
+            SO_BUSY_POLL,
+            &busyPollUs,
+            sizeof(busyPollUs)) != 0) {
+      LOG(WARNING) << "Failed to set SO_BUSY_POLL=" << busyPollUs
+                   << ", error=" << folly::errnoStr(errno);
+    }
+  }
+#endif
 }
 
 void QuicServerWorker::setTransportSettingsOverrideFn(
@@ -172,6 +258,10 @@ void QuicServerWorker::setUnfinishedHandshakeLimit(
   unfinishedHandshakeLimitFn_ = std::move(limitFn);
 }
 
+void QuicServerWorker::setWorkerUnfinishedHandshakeLimit(uint32_t limit) {
+  workerUnfinishedHandshakeLimit_ = limit;
+}
+
 void QuicServerWorker::start() {
   CHECK(socket_);
   if (!pacingTimer_) {
@@ -297,6 +387,7 @@ void QuicServerWorker::onDataAvailable(
     size_t len,
     bool truncated,
     OnDataAvailableParams params) noexcept {
+  BusyPoller::noteActivity();
   auto packetReceiveTime = Clock::now();
   auto originalPacketReceiveTime = packetReceiveTime;
   if (params.ts) {
@@ -336,7 +427,12 @@ void QuicServerWorker::onDataAvailable(
     data->append(len);
     QUIC_STATS(statsCallback_, onPacketReceived);
     QUIC_STATS(statsCallback_, onRead, len);
-    handleNetworkData(client, std::move(data), packetReceiveTime);
+    handleNetworkData(
+        client,
+        std::move(data),
+        packetReceiveTime,
+        false /* isForwardedData */,
+        params.tos);
   } else {
     // if we receive a truncated packet
     // we still need to consider the prev valid ones
@@ -352,13 +448,15 @@ void QuicServerWorker::onDataAvailable(
 
     size_t remaining = len;
     size_t offset = 0;
+    std::vector<Buf> segments;
+    segments.reserve((len + params.gro - 1) / params.gro);
     while (remaining) {
       if (static_cast<int>(remaining) <= params.gro) {
         // do not clone the last packet
         // start at offset, use all the remaining data
         data->trimStart(offset);
         DCHECK_EQ(data->length(), remaining);
-        handleNetworkData(client, std::move(data), packetReceiveTime);
+        segments.emplace_back(std::move(data));
         break;
       }
       auto tmp = data->cloneOne();
@@ -370,16 +468,83 @@ void QuicServerWorker::onDataAvailable(
       DCHECK_EQ(tmp->length(), params.gro);
       offset += params.gro;
       remaining -= params.gro;
-      handleNetworkData(client, std::move(tmp), packetReceiveTime);
+      segments.emplace_back(std::move(tmp));
+    }
+    handleGroSegments(
+        client, std::move(segments), packetReceiveTime, params.tos);
+  }
+}
+
+void QuicServerWorker::handleGroSegments(
+    const folly::SocketAddress& client,
+    std::vector<Buf> segments,
+    const TimePoint& packetReceiveTime,
+    uint8_t tosValue) noexcept {
+  // GRO only coalesces datagrams of one flow, so the segments almost always
+  // belong to the same connection. Delivering them together lets the
+  // transport derive their header protection masks in one batch.
+  folly::Optional<ConnectionId> dstConnId;
+  bool batchable = segments.size() > 1 && !shutdown_ && callback_ &&
+      !isBlockListedSrcPort_(client.getPort());
+  try {
+    for (const auto& segment : segments) {
+      if (!batchable) {
+        break;
+      }
+      folly::io::Cursor cursor(segment.get());
+      if (!cursor.canAdvance(sizeof(uint8_t))) {
+        batchable = false;
+        break;
+      }
+      uint8_t initialByte = cursor.readBE<uint8_t>();
+      if (getHeaderForm(initialByte) != HeaderForm::Short) {
+        batchable = false;
+        break;
+      }
+      auto maybeParsedShortHeader =
+          parseShortHeaderInvariants(initialByte, cursor);
+      if (!maybeParsedShortHeader ||
+          (dstConnId &&
+           maybeParsedShortHeader->destinationConnId != *dstConnId)) {
+        batchable = false;
+        break;
+      }
+      dstConnId = std::move(maybeParsedShortHeader->destinationConnId);
+    }
+  } catch (const std::exception&) {
+    batchable = false;
+  }
+
+  if (!batchable) {
+    for (auto& segment : segments) {
+      handleNetworkData(
+          client,
+          std::move(segment),
+          packetReceiveTime,
+          false /* isForwardedData */,
+          tosValue);
     }
+    return;
   }
+  RoutingData routingData(
+      HeaderForm::Short,
+      false, /* isInitial */
+      false, /* is0Rtt */
+      std::move(*dstConnId),
+      folly::none);
+  forwardNetworkData(
+      client,
+      std::move(routingData),
+      NetworkData(std::move(segments), packetReceiveTime, tosValue),
+      folly::none /* quicVersion */);
 }
 
 void QuicServerWorker::handleNetworkData(
     const folly::SocketAddress& client,
     Buf data,
     const TimePoint& packetReceiveTime,
-    bool isForwardedData) noexcept {
+    bool isForwardedData,
+    uint8_t tosValue) noexcept {
   // if packet drop reason is set, invoke stats cb accordingly
   auto packetDropReason = PacketDropReason::NONE;
   auto maybeReportPacketDrop = folly::makeGuard([&]() {
@@ -425,7 +590,7 @@ void QuicServerWorker::handleNetworkData(
         return forwardNetworkData(
             client,
             std::move(routingData),
-            NetworkData(std::move(data), packetReceiveTime),
+            NetworkData(std::move(data), packetReceiveTime, tosValue),
             folly::none, /* quicVersion */
             isForwardedData);
       }
@@ -465,7 +630,7 @@ void QuicServerWorker::handleNetworkData(
       return forwardNetworkData(
           client,
           std::move(routingData),
-          NetworkData(std::move(data), packetReceiveTime),
+          NetworkData(std::move(data), packetReceiveTime, tosValue),
           invariant.version,
           isForwardedData);
     }
@@ -574,6 +739,16 @@ bool QuicServerWorker::tryHandlingAsHealthCheck(
   return false;
 }
 
+void QuicServerWorker::forwardPacketsToAnotherServer(
+    const folly::SocketAddress& client,
+    NetworkData&& networkData) {
+  for (auto& packet : networkData.packets) {
+    takeoverPktHandler_.forwardPacketToAnotherServer(
+        client, std::move(packet), networkData.receiveTimePoint);
+    QUIC_STATS(statsCallback_, onPacketForwarded);
+  }
+}
+
 void QuicServerWorker::forwardNetworkData(
     const folly::SocketAddress& client,
     RoutingData&& routingData,
@@ -589,10 +764,7 @@ void QuicServerWorker::forwardNetworkData(
           "Forwarding packet with unknown connId version from client={} to another process, routingInfo={}",
           client.describe(),
           logRoutingInfo(routingData.destinationConnId));
-      auto recvTime = networkData.receiveTimePoint;
-      takeoverPktHandler_.forwardPacketToAnotherServer(
-          client, std::move(networkData).moveAllData(), recvTime);
-      QUIC_STATS(statsCallback_, onPacketForwarded);
+      forwardPacketsToAnotherServer(client, std::move(networkData));
       return;
     } else {
       VLOG(3) << fmt::format(
@@ -631,6 +803,7 @@ QuicServerTransport::Ptr QuicServerWorker::makeTransport(
       transportFactory_->make(evb, std::move(sock), client, quicVersion, ctx_);
   if (trans) {
     globalUnfinishedHandshakes++;
+    unfinishedHandshakes_++;
     if (transportSettings_.dataPathType == DataPathType::ContinuousMemory &&
         bufAccessor_) {
       trans->setBufAccessor(bufAccessor_.get());
@@ -787,10 +960,7 @@ void QuicServerWorker::dispatchPacketData(
         "Forwarding packet from client={} to another process, routingInfo={}",
         client.describe(),
         logRoutingInfo(dstConnId));
-    auto recvTime = networkData.receiveTimePoint;
-    takeoverPktHandler_.forwardPacketToAnotherServer(
-        client, std::move(networkData).moveAllData(), recvTime);
-    QUIC_STATS(statsCallback_, onPacketForwarded);
+    forwardPacketsToAnotherServer(client, std::move(networkData));
   });
 
   // helper fn to handle fwd-ing data to the transport
@@ -917,6 +1087,15 @@ void QuicServerWorker::dispatchPacketData(
     return;
   }
 
+  // Every handshake costs crypto work on this worker's event loop, which
+  // delays the packets of its established connections.
+  if (unfinishedHandshakes_ >= workerUnfinishedHandshakeLimit_) {
+    VLOG(3) << "Dropping initial packet from client=" << client
+            << ", unfinished handshakes=" << unfinishedHandshakes_;
+    packetDropReason = PacketDropReason::HANDSHAKE_LIMITED;
+    return;
+  }
+
   auto transport = makeTransport(
       quicVersion.value(), client, maybeSrcConnId, dstConnId, isValidNewToken);
   if (!transport) {
@@ -940,7 +1119,10 @@ void QuicServerWorker::sendResetPacket(
     // Only send resets in response to short header packets.
     return;
   }
-  auto packetSize = networkData.totalData;
+  // A GRO batch carries several packets, size the reset by the first one.
+  auto packetSize = networkData.packets.empty()
+      ? networkData.totalData
+      : networkData.packets.front()->computeChainDataLength();
   auto resetSize = std::min<uint16_t>(packetSize, kDefaultMaxUDPPayload);
   // Per the spec, less than 43 we should respond with packet size - 1.
   if (packetSize < 43) {
@@ -1205,15 +1387,19 @@ void QuicServerWorker::setTransportSettings(
     transportSettings_.dataPathType = DataPathType::ChainedMemory;
   }
   if (transportSettings_.dataPathType == DataPathType::ContinuousMemory) {
-    // TODO: maxBatchSize is only a good start value when each transport does
-    // its own socket writing. If we experiment with multiple transports GSO
-    // together, we will need a better value.
-    bufAccessor_ = std::make_unique<SimpleBufAccessor>(
-        kDefaultMaxUDPPayload * transportSettings_.maxBatchSize);
-    VLOG(10) << "GSO write buf accessor created for ContinuousMemory data path";
+    createBufAccessor();
   }
 }
 
+void QuicServerWorker::createBufAccessor() {
+  // TODO: maxBatchSize is only a good start value when each transport does
+  // its own socket writing. If we experiment with multiple transports GSO
+  // together, we will need a better value.
+  bufAccessor_ = std::make_unique<SimpleBufAccessor>(
+      kDefaultMaxUDPPayload * transportSettings_.maxBatchSize);
+  VLOG(10) << "GSO write buf accessor created for ContinuousMemory data path";
+}
+
 void QuicServerWorker::rejectNewConnections(
     std::function<bool()> rejectNewConnections) {
   rejectNewConnections_ = std::move(rejectNewConnections);
@@ -1370,10 +1556,14 @@ void QuicServerWorker::onConnectionUnbound(
 
 void QuicServerWorker::onHandshakeFinished() noexcept {
   CHECK_GE(--globalUnfinishedHandshakes, 0);
+  CHECK_GT(unfinishedHandshakes_, 0);
+  unfinishedHandshakes_--;
 }
 
 void QuicServerWorker::onHandshakeUnfinished() noexcept {
   CHECK_GE(--globalUnfinishedHandshakes, 0);
+  CHECK_GT(unfinishedHandshakes_, 0);
+  unfinishedHandshakes_--;
 }
 
 void QuicServerWorker::shutdownAllConnections(LocalErrorCode error) {
@@ -1391,6 +1581,9 @@ void QuicServerWorker::shutdownAllConnections(LocalErrorCode error) {
     takeoverCB_->pause();
   }
   callback_ = nullptr;
+  // stopped here, on the worker's thread, since the worker itself may be
+  // destroyed on another one
+  busyPoller_.reset();
 
   // Shut down all transports without bound connection ids.
   for (auto& it : sourceAddressMap_) {
@@ -20,6 +20,7 @@
 #include <quic/codec/ConnectionIdAlgo.h>
 #include <quic/codec/QuicConnectionId.h>
 #include <quic/common/BufAccessor.h>
+#include <quic/common/BusyPoller.h>
 #include <quic/common/Timers.h>
 #include <quic/congestion_control/CongestionControllerFactory.h>
 #include <quic/server/QuicServerPacketRouter.h>
@@ -232,6 +233,29 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
    */
   void applyAllSocketOptions();
 
+  /**
+   * Pins the worker's thread to the given CPU and sets SO_INCOMING_CPU on its
+   * listening socket, so that the kernel prefers this worker's socket for
+   * packets received on that CPU. Buffers owned by the worker are recreated
+   * from the pinned thread, which places them on the CPU's NUMA node under
+   * the default first touch policy. Must be called on the worker's thread
+   * before any connection is accepted.
+   */
+  void setCpuAffinity(int cpu);
+
+  folly::Optional<int> getCpuAffinity() const {
+    return cpu_;
+  }
+
+  /**
+   * Keeps the worker's EventBase polling its socket instead of blocking in
+   * epoll while there is traffic, see BusyPoller, and sets SO_BUSY_POLL on
+   * the socket. Must be called on the worker's thread.
+   */
+  void enableBusyPoll(
+      std::chrono::microseconds socketBusyPoll,
+      BusyPoller::Options options = BusyPoller::Options());
+
   /**
    * Initialize and bind given listening socket to the given takeover address
    * so that this server can accept and process misrouted packets forwarded
@@ -366,6 +390,17 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
 
   void setUnfinishedHandshakeLimit(std::function<int()> limitFn);
 
+  /**
+   * Limits the handshakes in progress on this worker. Initials of new
+   * connections beyond the limit are dropped, and the clients retransmit them
+   * once their handshake timer fires.
+   */
+  void setWorkerUnfinishedHandshakeLimit(uint32_t limit);
+
+  uint32_t getUnfinishedHandshakes() const {
+    return unfinishedHandshakes_;
+  }
+
   // Read callback
   void getReadBuffer(void** buf, size_t* len) noexcept override;
 
@@ -454,7 +489,19 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
       const folly::SocketAddress& client,
       Buf data,
       const TimePoint& receiveTime,
-      bool isForwardedData = false) noexcept;
+      bool isForwardedData = false,
+      uint8_t tosValue = 0) noexcept;
+
+  /**
+   * Handles the segments of one GRO read. Segments that are all short header
+   * packets for the same connection are handed to it as a single
+   * NetworkData, otherwise each segment goes through handleNetworkData().
+   */
+  void handleGroSegments(
+      const folly::SocketAddress& client,
+      std::vector<Buf> segments,
+      const TimePoint& receiveTime,
+      uint8_t tosValue = 0) noexcept;
 
   /**
    * Try handling the data as a health check.
@@ -535,6 +582,9 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
       folly::EventBase* evb,
       int fd) const;
 
+  void createBufAccessor();
+  void applyWorkerSocketOptions();
+
   /**
    * Tries to get the encrypted retry token from a client initial packet
    */
@@ -586,6 +636,11 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
     return (socket_ && (socket_->getTimestamping() > 0));
   }
 
+  // Forwards every packet of networkData as its own datagram.
+  void forwardPacketsToAnotherServer(
+      const folly::SocketAddress& client,
+      NetworkData&& networkData);
+
   /**
    * Forward data to the right worker or to the takeover socket
    */
@@ -671,11 +726,21 @@ class QuicServerWorker : public folly::AsyncUDPSocket::ReadCallback,
   // Output buffer to be used for continuous memory GSO write
   std::unique_ptr<BufAccessor> bufAccessor_;
 
+  // CPU the worker's thread is pinned to
+  folly::Optional<int> cpu_;
+  std::chrono::microseconds socketBusyPoll_{0};
+  std::unique_ptr<BusyPoller> busyPoller_;
+
   // Rate limits the creation of new connections for this worker.
   std::unique_ptr<RateLimiter> newConnRateLimiter_;
 
   folly::Optional<std::function<int()>> unfinishedHandshakeLimitFn_;
 
+  // Handshakes in progress on this worker, and the limit on them.
+  uint32_t unfinishedHandshakes_{0};
+  uint32_t workerUnfinishedHandshakeLimit_{
+      std::numeric_limits<uint32_t>::max()};
+
   // EventRecvmsgCallback data
   std::unique_ptr<MsgHdr> msgHdr_;
 
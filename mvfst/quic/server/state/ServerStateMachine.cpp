@@ -17,6 +17,7 @@
 #include <quic/handshake/TransportParameters.h>
 #include <quic/logging/QLoggerConstants.h>
 #include <quic/state/DatagramHandlers.h>
+#include <quic/state/PmtuDiscovery.h>
 #include <quic/state/QuicPacingFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
 #include <quic/state/QuicTransportStatsCallback.h>
@@ -346,6 +347,7 @@ void processClientInitialParams(
       }
     }
   }
+  startPmtuDiscovery(conn);
 
   conn.peerActiveConnectionIdLimit =
       activeConnectionIdLimit.value_or(kDefaultActiveConnectionIdLimit);
@@ -703,7 +705,9 @@ static void handleCipherUnavailable(
     ServerEvents::ReadData pendingReadData;
     pendingReadData.peer = readData.peer;
     pendingReadData.networkData = NetworkDataSingle(
-        std::move(originalData->packet), readData.networkData.receiveTimePoint);
+        std::move(originalData->packet),
+        readData.networkData.receiveTimePoint,
+        readData.networkData.tosValue);
     pendingData->emplace_back(std::move(pendingReadData));
     VLOG(10) << "Adding pending data to "
              << toString(originalData->protectionType)
@@ -1007,6 +1011,8 @@ void onServerReadDataFromOpen(
     auto& ackState = getAckState(conn, packetNumberSpace);
     uint64_t distanceFromExpectedPacketNum = updateLargestReceivedPacketNum(
         conn, ackState, packetNum, readData.networkData.receiveTimePoint);
+    updateEcnCountsOnRecvPacket(
+        conn, ackState, readData.networkData.tosValue);
     if (distanceFromExpectedPacketNum > 0) {
       QUIC_STATS(conn.statsCallback, onOutOfOrderPacketReceived);
     }
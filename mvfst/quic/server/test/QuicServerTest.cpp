@@ -605,6 +605,56 @@ TEST_F(QuicServerWorkerTest, UnfinishedHandshakeLimit) {
   eventbase_.loopIgnoreKeepAlive();
 }
 
+TEST_F(QuicServerWorkerTest, WorkerUnfinishedHandshakeLimit) {
+  worker_->setWorkerUnfinishedHandshakeLimit(1);
+  auto connId1 = getTestConnectionId(hostId_);
+  createQuicConnection(kClientAddr, connId1);
+  EXPECT_EQ(worker_->getUnfinishedHandshakes(), 1);
+  Mock::VerifyAndClearExpectations(factory_.get());
+
+  // The initial of a second connection is dropped while the first handshake
+  // is in progress.
+  auto caddr2 = folly::SocketAddress("2.3.4.5", 1234);
+  ConnectionId connId2({2, 4, 5, 6, 7, 8, 9, 10});
+  RoutingData routingData(HeaderForm::Long, true, false, connId2, connId2);
+  auto data = createData(kMinInitialPacketSize + 10);
+  EXPECT_CALL(*factory_, _make(_, _, _, _)).Times(0);
+  EXPECT_CALL(
+      *quicStats_,
+      onPacketDropped(PacketDropReason(PacketDropReason::HANDSHAKE_LIMITED)));
+  worker_->dispatchPacketData(
+      caddr2,
+      std::move(routingData),
+      NetworkData(data->clone(), Clock::now()),
+      QuicVersion::MVFST);
+  const auto& addrMap = worker_->getSrcToTransportMap();
+  EXPECT_EQ(addrMap.count(std::make_pair(caddr2, connId2)), 0);
+  eventbase_.loopIgnoreKeepAlive();
+  Mock::VerifyAndClearExpectations(factory_.get());
+
+  // Its retransmission is accepted once the first handshake finished.
+  worker_->onHandshakeFinished();
+  EXPECT_EQ(worker_->getUnfinishedHandshakes(), 0);
+  NiceMock<MockConnectionSetupCallback> connSetupCb2;
+  NiceMock<MockConnectionCallback> connCb2;
+  auto mockSock2 =
+      std::make_unique<NiceMock<folly::test::MockAsyncUDPSocket>>(&eventbase_);
+  EXPECT_CALL(*mockSock2, address()).WillRepeatedly(ReturnRef(caddr2));
+  MockQuicTransport::Ptr testTransport2 = std::make_shared<MockQuicTransport>(
+      worker_->getEventBase(),
+      std::move(mockSock2),
+      &connSetupCb2,
+      &connCb2,
+      nullptr);
+  EXPECT_CALL(*testTransport2, getEventBase())
+      .WillRepeatedly(Return(&eventbase_));
+  EXPECT_CALL(*testTransport2, getOriginalPeerAddress())
+      .WillRepeatedly(ReturnRef(caddr2));
+  createQuicConnection(caddr2, connId2, testTransport2);
+  EXPECT_EQ(worker_->getUnfinishedHandshakes(), 1);
+  Mock::VerifyAndClearExpectations(factory_.get());
+}
+
 TEST_F(QuicServerWorkerTest, QuicServerWorkerUnbindBeforeCidAvailable) {
   NiceMock<MockConnectionSetupCallback> connSetupCb;
   NiceMock<MockConnectionCallback> connCb;
@@ -8,6 +8,8 @@
 #include <folly/MapUtil.h>
 #include <quic/loss/QuicLossFunctions.h>
 #include <quic/state/AckHandlers.h>
+#include <quic/state/PmtuDiscovery.h>
+#include <quic/state/QuicAckFrequencyFunctions.h>
 #include <quic/state/QuicStateFunctions.h>
 #include <quic/state/QuicStreamFunctions.h>
 #include <iterator>
@@ -35,15 +37,17 @@ struct OutstandingPacketWithHandlerContext {
  * Process ack frame and acked outstanding packets.
  *
  * This function process incoming ack blocks which is sorted in the descending
- * order of packet number. For each ack block, we try to find a continuous range
- * of outstanding packets in the connection's outstanding packets list that is
- * acked by the current ack block. The search is in the reverse order of the
- * outstandings.packets given that the list is sorted in the ascending order of
- * packet number. For each outstanding packet that is acked by current ack
- * frame, ack and loss visitors are invoked on the sent frames. The outstanding
- * packets may contain packets from all three packet number spaces. But ack is
- * always restrained to a single space. So we also need to skip packets that are
- * not in the current packet number space.
+ * order of packet number. For each ack block, we look up the largest
+ * outstanding packet covered by the block by its packet number and walk the
+ * outstandings.packets backwards from there, given that the list is sorted in
+ * the ascending order of packet number. Acked packets are erased one by one,
+ * which leaves tombstones rather than moving the remaining packets, so the
+ * cost is proportional to the number of ack blocks and acked packets rather
+ * than to the number of outstanding packets. For each outstanding packet that
+ * is acked by current ack frame, ack and loss visitors are invoked on the sent
+ * frames. The outstanding packets may contain packets from all three packet
+ * number spaces. But ack is always restrained to a single space. So we also
+ * need to skip packets that are not in the current packet number space.
  *
  */
 
@@ -69,8 +73,6 @@ AckEvent processAckFrame(
   // temporary storage to enable packets to be processed in sent order
   SmallVec<OutstandingPacketWithHandlerContext, 50> packetsWithHandlerContext;
 
-  auto currentPacketIt = getLastOutstandingPacketIncludingLost(conn, pnSpace);
-
   // Store first outstanding packet number to ignore old receive timestamps.
   const auto& firstOutstandingPacket =
       getFirstOutstandingPacket(conn, PacketNumberSpace::AppData);
@@ -93,19 +95,17 @@ AckEvent processAckFrame(
       spuriousLossEvent.emplace(ackReceiveTime);
     }
   }
+  // Packets at and after searchEnd have been handled by previous ack blocks.
+  auto searchEnd = conn.outstandings.packets.end();
   auto ackBlockIt = frame.ackBlocks.cbegin();
   while (ackBlockIt != frame.ackBlocks.cend() &&
-         currentPacketIt != conn.outstandings.packets.rend()) {
-    // In reverse order, find the first outstanding packet that has a packet
-    // number LE the endPacket of the current ack range.
-    auto rPacketIt = std::lower_bound(
-        currentPacketIt,
-        conn.outstandings.packets.rend(),
-        ackBlockIt->endPacket,
-        [&](const auto& packetWithTime, const auto& val) {
-          return packetWithTime.packet.header.getPacketSequenceNum() > val;
-        });
-    if (rPacketIt == conn.outstandings.packets.rend()) {
+         searchEnd != conn.outstandings.packets.begin()) {
+    // Find the first outstanding packet that has a packet number GT the
+    // endPacket of the current ack range, and walk backwards from there.
+    auto packetIt = std::min(
+        conn.outstandings.packets.upperBound(ackBlockIt->endPacket),
+        searchEnd);
+    if (packetIt == conn.outstandings.packets.begin()) {
       // This means that all the packets are greater than the end packet.
       // Since we iterate the ACK blocks in reverse order of end packets, our
       // work here is done.
@@ -118,26 +118,15 @@ AckEvent processAckFrame(
       break;
     }
 
-    auto eraseEnd = rPacketIt;
-    while (rPacketIt != conn.outstandings.packets.rend()) {
+    while (packetIt != conn.outstandings.packets.begin()) {
+      auto rPacketIt = std::prev(packetIt);
       auto currentPacketNum = rPacketIt->packet.header.getPacketSequenceNum();
       auto currentPacketNumberSpace =
           rPacketIt->packet.header.getPacketNumberSpace();
       if (pnSpace != currentPacketNumberSpace) {
         // When the next packet is not in the same packet number space, we need
-        // to skip it in current ack processing. If the iterator has moved, that
-        // means we have found packets in the current space that are acked by
-        // this ack block. So the code erases the current iterator range and
-        // move the iterator to be the next search point.
-        if (rPacketIt != eraseEnd) {
-          auto nextElem = conn.outstandings.packets.erase(
-              rPacketIt.base(), eraseEnd.base());
-          rPacketIt = std::reverse_iterator<decltype(nextElem)>(nextElem) + 1;
-          eraseEnd = rPacketIt;
-        } else {
-          rPacketIt++;
-          eraseEnd = rPacketIt;
-        }
+        // to skip it in current ack processing.
+        packetIt = rPacketIt;
         continue;
       }
       if (currentPacketNum < ackBlockIt->startPacket) {
@@ -147,6 +136,9 @@ AckEvent processAckFrame(
                << " space=" << currentPacketNumberSpace << " handshake="
                << (int)((rPacketIt->metadata.isHandshake) ? 1 : 0) << " "
                << conn;
+      if (isPmtuProbe(conn, *rPacketIt)) {
+        onPmtuProbeAcked(conn, ackReceiveTime);
+      }
       // If we hit a packet which has been lost we need to count the spurious
       // loss and ignore all other processing.
       if (rPacketIt->declaredLost) {
@@ -185,8 +177,6 @@ AckEvent processAckFrame(
           }
         }
         QUIC_STATS(conn.statsCallback, onPacketSpuriousLoss);
-        // Decrement the counter, trust that we will erase this as part of
-        // the bulk erase.
         CHECK_GT(conn.outstandings.declaredLostCount, 0);
         conn.outstandings.declaredLostCount--;
         if (spuriousLossEvent) {
@@ -195,7 +185,7 @@ AckEvent processAckFrame(
               rPacketIt->packet.header.getPacketSequenceNum(),
               rPacketIt->packet.header.getPacketNumberSpace());
         }
-        rPacketIt++;
+        packetIt = conn.outstandings.packets.erase(rPacketIt);
         continue;
       }
       bool needsProcess = !rPacketIt->associatedEvent ||
@@ -305,19 +295,11 @@ AckEvent processAckFrame(
         tmpIt->processAllFrames = needsProcess;
       }
 
-      rPacketIt++;
-    }
-    // Done searching for acked outstanding packets in current ack block. Erase
-    // the current iterator range which is the last batch of continuous
-    // outstanding packets that are in this ack block. Move the iterator to be
-    // the next search point.
-    if (rPacketIt != eraseEnd) {
-      auto nextElem =
-          conn.outstandings.packets.erase(rPacketIt.base(), eraseEnd.base());
-      currentPacketIt = std::reverse_iterator<decltype(nextElem)>(nextElem);
-    } else {
-      currentPacketIt = rPacketIt;
+      packetIt = conn.outstandings.packets.erase(rPacketIt);
     }
+    // Done searching for acked outstanding packets in current ack block. The
+    // next block only covers smaller packet numbers.
+    searchEnd = packetIt;
     ackBlockIt++;
   }
 
@@ -486,6 +468,22 @@ AckEvent processAckFrame(
       << originalPacketCount[PacketNumberSpace::AppData] << "}";
   CHECK_GE(updatedOustandingPacketsCount, conn.outstandings.numClonedPackets());
   auto lossEvent = handleAckForLoss(conn, lossVisitor, ack, pnSpace);
+  auto& ackState = getAckState(conn, pnSpace);
+  if (frame.frameType == FrameType::ACK_ECN &&
+      frame.ecnCECount > ackState.ecnCECountEchoed) {
+    ackState.ecnCECountEchoed = frame.ecnCECount;
+    // A CE mark is a congestion signal just like a loss, without anything to
+    // retransmit (RFC 9002 section 7.1). The largest newly acked packet
+    // stands in for the lost one so that the controller enters recovery at
+    // most once per round trip.
+    if (!lossEvent && ack.largestNewlyAckedPacket &&
+        conn.transportSettings.enableEcnOnEgress) {
+      lossEvent.emplace(ackReceiveTime);
+      lossEvent->largestLostPacketNum = *ack.largestNewlyAckedPacket;
+      lossEvent->largestLostSentTime = ack.largestNewlyAckedPacketSentTime;
+      lossEvent->smallestLostSentTime = ack.largestNewlyAckedPacketSentTime;
+    }
+  }
   if (conn.congestionController &&
       (ack.largestNewlyAckedPacket.has_value() || lossEvent)) {
     if (lossEvent) {
@@ -511,6 +509,13 @@ AckEvent processAckFrame(
     }
     ack.ccState = conn.congestionController->getState();
   }
+  if (pnSpace == PacketNumberSpace::AppData &&
+      conn.transportSettings.ackFrequencyPolicy &&
+      !conn.transportSettings.bbrConfig.ackFrequencyConfig &&
+      canSendAckControlFrames(conn) &&
+      (ack.largestNewlyAckedPacket.has_value() || lossEvent)) {
+    updatePeerAckFrequency(conn, ackReceiveTime, lossEvent.has_value());
+  }
   clearOldOutstandingPackets(conn, ackReceiveTime, pnSpace);
 
   // notify observers
@@ -539,7 +544,6 @@ void clearOldOutstandingPackets(
     // Reap any old packets declared lost that are unlikely to be ACK'd.
     auto threshold = calculatePTO(conn);
     auto opItr = conn.outstandings.packets.begin();
-    auto eraseBegin = opItr;
     while (opItr != conn.outstandings.packets.end()) {
       // This case can happen when we have buffered an undecryptable ACK and
       // are able to decrypt it later.
@@ -547,26 +551,18 @@ void clearOldOutstandingPackets(
         break;
       }
       if (opItr->packet.header.getPacketNumberSpace() != pnSpace) {
-        if (eraseBegin != opItr) {
-          // We want to keep [eraseBegin, opItr) within a single PN space.
-          opItr = conn.outstandings.packets.erase(eraseBegin, opItr);
-        }
         opItr++;
-        eraseBegin = opItr;
         continue;
       }
       auto timeSinceSent = time - opItr->metadata.time;
       if (opItr->declaredLost && timeSinceSent > threshold) {
-        opItr++;
         CHECK_GT(conn.outstandings.declaredLostCount, 0);
         conn.outstandings.declaredLostCount--;
+        opItr = conn.outstandings.packets.erase(opItr);
       } else {
         break;
       }
     }
-    if (eraseBegin != opItr) {
-      conn.outstandings.packets.erase(eraseBegin, opItr);
-    }
   }
 }
 
@@ -45,6 +45,8 @@ struct AckState : WriteAckFrameState {
   folly::Optional<TimePoint> latestRecvdPacketTime;
   // Packet number of the latest packet
   folly::Optional<PacketNum> latestReceivedPacketNum;
+  // Largest CE count the peer reported in ACK_ECN frames for our packets.
+  uint64_t ecnCECountEchoed{0};
 };
 
 struct AckStates {
@@ -9,6 +9,29 @@
 
 namespace quic {
 
+namespace {
+
+template <typename Buffer>
+void bufferDatagram(
+    QuicConnectionStateBase& conn,
+    Buffer& buffer,
+    DatagramFrame& frame,
+    TimePoint recvTimePoint) {
+  if (buffer.size() >= conn.datagramState.maxReadBufferSize) {
+    QUIC_STATS(conn.statsCallback, onDatagramDroppedOnRead);
+    if (!conn.transportSettings.datagramConfig.recvDropOldDataFirst) {
+      frame.data.move();
+      return;
+    } else {
+      buffer.erase(buffer.begin());
+    }
+  }
+  QUIC_STATS(conn.statsCallback, onDatagramRead, frame.data.chainLength());
+  buffer.emplace_back(recvTimePoint, std::move(frame.data));
+}
+
+} // namespace
+
 void handleDatagram(
     QuicConnectionStateBase& conn,
     DatagramFrame& frame,
@@ -21,19 +44,12 @@ void handleDatagram(
     QUIC_STATS(conn.statsCallback, onDatagramDroppedOnRead);
     return;
   }
-  if (conn.datagramState.readBuffer.size() >=
-      conn.datagramState.maxReadBufferSize) {
-    QUIC_STATS(conn.statsCallback, onDatagramDroppedOnRead);
-    if (!conn.transportSettings.datagramConfig.recvDropOldDataFirst) {
-      frame.data.move();
-      return;
-    } else {
-      conn.datagramState.readBuffer.pop_front();
-    }
+  if (conn.datagramState.deliverBursts) {
+    bufferDatagram(
+        conn, conn.datagramState.burstBuffer, frame, recvTimePoint);
+  } else {
+    bufferDatagram(conn, conn.datagramState.readBuffer, frame, recvTimePoint);
   }
-  QUIC_STATS(conn.statsCallback, onDatagramRead, frame.data.chainLength());
-  conn.datagramState.readBuffer.emplace_back(
-      recvTimePoint, std::move(frame.data));
 }
 
 } // namespace quic
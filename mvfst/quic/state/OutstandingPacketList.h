@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Optional.h>
+#include <glog/logging.h>
+#include <quic/state/OutstandingPacket.h>
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace quic {
+
+/**
+ * The outstanding packets of a connection, sorted by packet number.
+ *
+ * Packets are kept in a ring buffer of slots. Erasing a packet destroys it
+ * right away but leaves a tombstone in its slot, so an erase never moves other
+ * packets and iterators to other packets remain valid. Tombstones at either end
+ * are reclaimed immediately, interior ones are squeezed out on insertion once
+ * they outnumber the live packets.
+ *
+ * Tombstones keep the packet number of the packet they replaced, which keeps
+ * the slots sorted. Looking up a packet number is therefore a binary search
+ * over the slots, with an O(1) fast path when the packet numbers are dense
+ * (the common case for AppData).
+ *
+ * The interface mirrors the subset of std::deque the transport uses.
+ * Iterators are bidirectional and skip tombstones; operator+ and operator-
+ * step one packet at a time.
+ */
+class OutstandingPacketList {
+ private:
+  struct Slot {
+    PacketNum packetNum{0};
+    // folly::none marks a tombstone.
+    folly::Optional<OutstandingPacketWrapper> packet;
+  };
+
+ public:
+  template <bool IsConst>
+  class IteratorImpl {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = OutstandingPacketWrapper;
+    using difference_type = std::ptrdiff_t;
+    using pointer =
+        std::conditional_t<IsConst, const value_type*, value_type*>;
+    using reference =
+        std::conditional_t<IsConst, const value_type&, value_type&>;
+
+    IteratorImpl() = default;
+
+    template <
+        bool OtherConst,
+        typename = std::enable_if_t<IsConst && !OtherConst>>
+    /* implicit */ IteratorImpl(const IteratorImpl<OtherConst>& other)
+        : list_(other.list_), pos_(other.pos_) {}
+
+    reference operator*() const {
+      return *list_->slotAt(pos_).packet;
+    }
+
+    pointer operator->() const {
+      return &**this;
+    }
+
+    IteratorImpl& operator++() {
+      pos_ = list_->nextLive(pos_ + 1);
+      return *this;
+    }
+
+    IteratorImpl operator++(int) {
+      auto it = *this;
+      ++*this;
+      return it;
+    }
+
+    IteratorImpl& operator--() {
+      pos_ = list_->prevLive(pos_ - 1);
+      return *this;
+    }
+
+    IteratorImpl operator--(int) {
+      auto it = *this;
+      --*this;
+      return it;
+    }
+
+    IteratorImpl& operator+=(difference_type n) {
+      for (; n > 0; n--) {
+        ++*this;
+      }
+      for (; n < 0; n++) {
+        --*this;
+      }
+      return *this;
+    }
+
+    IteratorImpl& operator-=(difference_type n) {
+      return *this += -n;
+    }
+
+    IteratorImpl operator+(difference_type n) const {
+      auto it = *this;
+      return it += n;
+    }
+
+    IteratorImpl operator-(difference_type n) const {
+      auto it = *this;
+      return it -= n;
+    }
+
+    template <bool OtherConst>
+    bool operator==(const IteratorImpl<OtherConst>& rhs) const {
+      return pos_ == rhs.pos_;
+    }
+
+    template <bool OtherConst>
+    bool operator!=(const IteratorImpl<OtherConst>& rhs) const {
+      return pos_ != rhs.pos_;
+    }
+
+    // Iterators into the same list are ordered by position.
+    template <bool OtherConst>
+    bool operator<(const IteratorImpl<OtherConst>& rhs) const {
+      return pos_ < rhs.pos_;
+    }
+
+   private:
+    friend class OutstandingPacketList;
+    template <bool>
+    friend class IteratorImpl;
+
+    using ListPtr = std::conditional_t<
+        IsConst,
+        const OutstandingPacketList*,
+        OutstandingPacketList*>;
+
+    IteratorImpl(ListPtr list, uint64_t pos) : list_(list), pos_(pos) {}
+
+    ListPtr list_{nullptr};
+    // Absolute slot position, stable across erases.
+    uint64_t pos_{0};
+  };
+
+  using value_type = OutstandingPacketWrapper;
+  using size_type = size_t;
+  using reference = OutstandingPacketWrapper&;
+  using const_reference = const OutstandingPacketWrapper&;
+  using iterator = IteratorImpl<false>;
+  using const_iterator = IteratorImpl<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  OutstandingPacketList() = default;
+  // The source is left empty; its slots move with the packets.
+  OutstandingPacketList(OutstandingPacketList&& other) noexcept
+      : slots_(std::move(other.slots_)),
+        begin_(std::exchange(other.begin_, 0)),
+        end_(std::exchange(other.end_, 0)),
+        size_(std::exchange(other.size_, 0)) {
+    other.slots_.clear();
+  }
+
+  OutstandingPacketList& operator=(OutstandingPacketList&& other) noexcept {
+    if (this != &other) {
+      slots_ = std::move(other.slots_);
+      other.slots_.clear();
+      begin_ = std::exchange(other.begin_, 0);
+      end_ = std::exchange(other.end_, 0);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  iterator begin() {
+    return iterator(this, begin_);
+  }
+
+  const_iterator begin() const {
+    return const_iterator(this, begin_);
+  }
+
+  const_iterator cbegin() const {
+    return begin();
+  }
+
+  iterator end() {
+    return iterator(this, end_);
+  }
+
+  const_iterator end() const {
+    return const_iterator(this, end_);
+  }
+
+  const_iterator cend() const {
+    return end();
+  }
+
+  reverse_iterator rbegin() {
+    return reverse_iterator(end());
+  }
+
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+
+  reverse_iterator rend() {
+    return reverse_iterator(begin());
+  }
+
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  reference front() {
+    DCHECK(!empty());
+    return *slotAt(begin_).packet;
+  }
+
+  const_reference front() const {
+    DCHECK(!empty());
+    return *slotAt(begin_).packet;
+  }
+
+  reference back() {
+    DCHECK(!empty());
+    return *slotAt(end_ - 1).packet;
+  }
+
+  const_reference back() const {
+    DCHECK(!empty());
+    return *slotAt(end_ - 1).packet;
+  }
+
+  // O(1) without interior tombstones, linear otherwise.
+  reference operator[](size_t index) {
+    if (numTombstones() == 0) {
+      return *slotAt(begin_ + index).packet;
+    }
+    return *(begin() + index);
+  }
+
+  const_reference operator[](size_t index) const {
+    if (numTombstones() == 0) {
+      return *slotAt(begin_ + index).packet;
+    }
+    return *(begin() + index);
+  }
+
+  reference at(size_t index) {
+    if (index >= size_) {
+      throw std::out_of_range("OutstandingPacketList::at");
+    }
+    return (*this)[index];
+  }
+
+  const_reference at(size_t index) const {
+    if (index >= size_) {
+      throw std::out_of_range("OutstandingPacketList::at");
+    }
+    return (*this)[index];
+  }
+
+  void push_back(OutstandingPacketWrapper&& packet) {
+    emplace(end(), std::move(packet));
+  }
+
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    return *emplace(end(), std::forward<Args>(args)...);
+  }
+
+  /**
+   * Inserts a packet in front of pos. The caller is responsible for keeping
+   * the list sorted. Invalidates all iterators.
+   */
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    OutstandingPacketWrapper packet(std::forward<Args>(args)...);
+    auto packetNum = packet.packet.header.getPacketSequenceNum();
+    uint64_t insertPos = pos.pos_;
+    // Tombstones in front of pos may carry larger packet numbers than the new
+    // packet, step over them to keep the slots sorted.
+    while (insertPos > begin_ && !slotAt(insertPos - 1).packet &&
+           slotAt(insertPos - 1).packetNum > packetNum) {
+      insertPos--;
+    }
+    if (insertPos > begin_ && !slotAt(insertPos - 1).packet) {
+      // Reuse the tombstone, nothing has to move.
+      insertPos--;
+    } else {
+      if (numTombstones() > size_ &&
+          numTombstones() >= kMinTombstonesToCompact) {
+        insertPos = compact(insertPos);
+      }
+      if (end_ - begin_ == slots_.size()) {
+        grow();
+      }
+      for (uint64_t i = end_; i > insertPos; i--) {
+        moveSlot(slotAt(i), slotAt(i - 1));
+      }
+      end_++;
+    }
+    auto& slot = slotAt(insertPos);
+    slot.packetNum = packetNum;
+    slot.packet.emplace(std::move(packet));
+    size_++;
+    return iterator(this, insertPos);
+  }
+
+  /**
+   * Destroys the packet at pos and returns an iterator to the following one.
+   * Other iterators remain valid.
+   */
+  iterator erase(const_iterator pos) {
+    auto& slot = slotAt(pos.pos_);
+    DCHECK(slot.packet);
+    slot.packet.reset();
+    size_--;
+    trim();
+    return iterator(this, nextLive(pos.pos_ + 1));
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    for (uint64_t pos = first.pos_; pos < last.pos_; pos++) {
+      auto& slot = slotAt(pos);
+      if (slot.packet) {
+        slot.packet.reset();
+        size_--;
+      }
+    }
+    trim();
+    return iterator(this, nextLive(last.pos_));
+  }
+
+  void pop_front() {
+    erase(begin());
+  }
+
+  void pop_back() {
+    erase(std::prev(end()));
+  }
+
+  void clear() {
+    for (uint64_t pos = begin_; pos < end_; pos++) {
+      slotAt(pos).packet.reset();
+    }
+    begin_ = end_ = 0;
+    size_ = 0;
+  }
+
+  void shrink_to_fit() {
+    compact(end_);
+    size_t capacity = kMinCapacity;
+    while (capacity < size_) {
+      capacity *= 2;
+    }
+    if (capacity < slots_.size()) {
+      rebuild(capacity);
+    }
+  }
+
+  /**
+   * First packet, in any packet number space, whose packet number is greater
+   * than packetNum.
+   */
+  iterator upperBound(PacketNum packetNum) {
+    return iterator(this, upperBoundPos(packetNum));
+  }
+
+  const_iterator upperBound(PacketNum packetNum) const {
+    return const_iterator(this, upperBoundPos(packetNum));
+  }
+
+ private:
+  static constexpr size_t kMinCapacity = 64;
+  static constexpr size_t kMinTombstonesToCompact = 64;
+
+  Slot& slotAt(uint64_t pos) {
+    return slots_[pos & (slots_.size() - 1)];
+  }
+
+  const Slot& slotAt(uint64_t pos) const {
+    return slots_[pos & (slots_.size() - 1)];
+  }
+
+  size_t numTombstones() const {
+    return end_ - begin_ - size_;
+  }
+
+  // The slots at begin_ and end_ - 1 are always live, so these never run past
+  // either end.
+  uint64_t nextLive(uint64_t pos) const {
+    pos = std::max(std::min(pos, end_), begin_);
+    while (pos < end_ && !slotAt(pos).packet) {
+      pos++;
+    }
+    return pos;
+  }
+
+  uint64_t prevLive(uint64_t pos) const {
+    while (pos > begin_ && !slotAt(pos).packet) {
+      pos--;
+    }
+    return pos;
+  }
+
+  uint64_t upperBoundPos(PacketNum packetNum) const {
+    if (begin_ == end_ || packetNum < slotAt(begin_).packetNum) {
+      return begin_;
+    }
+    auto guess = begin_ + (packetNum - slotAt(begin_).packetNum);
+    if (guess < end_ && slotAt(guess).packetNum == packetNum &&
+        (guess + 1 == end_ || slotAt(guess + 1).packetNum > packetNum)) {
+      return nextLive(guess + 1);
+    }
+    uint64_t low = begin_;
+    uint64_t high = end_;
+    while (low < high) {
+      auto mid = low + (high - low) / 2;
+      if (slotAt(mid).packetNum <= packetNum) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return nextLive(low);
+  }
+
+  static void moveSlot(Slot& dst, Slot& src) {
+    dst.packetNum = src.packetNum;
+    if (src.packet) {
+      dst.packet.emplace(std::move(*src.packet));
+      src.packet.reset();
+    } else {
+      dst.packet.reset();
+    }
+  }
+
+  // Reclaims tombstones at either end.
+  void trim() {
+    while (begin_ < end_ && !slotAt(begin_).packet) {
+      begin_++;
+    }
+    while (end_ > begin_ && !slotAt(end_ - 1).packet) {
+      end_--;
+    }
+  }
+
+  // Squeezes out all tombstones and returns the new position of pos.
+  uint64_t compact(uint64_t pos) {
+    uint64_t newPos = 0;
+    uint64_t write = begin_;
+    for (uint64_t read = begin_; read < end_; read++) {
+      if (read == pos) {
+        newPos = write;
+      }
+      if (!slotAt(read).packet) {
+        continue;
+      }
+      if (read != write) {
+        moveSlot(slotAt(write), slotAt(read));
+      }
+      write++;
+    }
+    if (pos >= end_) {
+      newPos = write;
+    }
+    end_ = write;
+    return newPos;
+  }
+
+  void grow() {
+    rebuild(std::max(kMinCapacity, slots_.size() * 2));
+  }
+
+  void rebuild(size_t capacity) {
+    std::vector<Slot> slots(capacity);
+    for (uint64_t pos = begin_; pos < end_; pos++) {
+      moveSlot(slots[pos & (capacity - 1)], slotAt(pos));
+    }
+    slots_ = std::move(slots);
+  }
+
+  // Capacity is zero or a power of two.
+  std::vector<Slot> slots_;
+  uint64_t begin_{0};
+  uint64_t end_{0};
+  // Number of live packets.
+  size_t size_{0};
+};
+
+} // namespace quic
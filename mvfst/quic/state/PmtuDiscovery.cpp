@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <quic/state/PmtuDiscovery.h>
+
+namespace quic {
+
+namespace {
+
+// The search stops once the range of sizes left is smaller than this.
+constexpr uint64_t kPmtuSearchGranularity = 16;
+
+uint64_t getPmtuUpperSize(const QuicConnectionStateBase& conn) {
+  return std::min(
+      conn.transportSettings.maxPmtuProbeSize, conn.peerMaxUdpPayloadSize);
+}
+
+void maybeFinishPmtuSearch(QuicConnectionStateBase& conn, TimePoint now) {
+  auto& pmtu = *conn.pmtuDiscovery;
+  if (pmtu.upperSize < pmtu.baseSize + kPmtuSearchGranularity) {
+    VLOG(4) << "PMTU search done, packetLen=" << conn.udpSendPacketLen << " "
+            << conn;
+    pmtu.raiseTime = now + conn.transportSettings.pmtuRaiseInterval;
+  }
+}
+
+void setPmtu(QuicConnectionStateBase& conn, uint64_t packetLen, TimePoint now) {
+  auto previousPacketLen = conn.udpSendPacketLen;
+  conn.udpSendPacketLen = packetLen;
+  VLOG(4) << "PMTU changed from " << previousPacketLen << " to "
+          << conn.udpSendPacketLen << " " << conn;
+
+  const auto socketObserverContainer = conn.getSocketObserverContainer();
+  if (socketObserverContainer &&
+      socketObserverContainer->hasObserversForEvent<
+          SocketObserverInterface::Events::pmtuEvents>()) {
+    SocketObserverInterface::PmtuUpdateEvent event(
+        now, previousPacketLen, conn.udpSendPacketLen);
+    socketObserverContainer
+        ->invokeInterfaceMethod<SocketObserverInterface::Events::pmtuEvents>(
+            [&event](auto observer, auto observed) {
+              observer->pmtuUpdated(observed, event);
+            });
+  }
+}
+
+} // namespace
+
+void startPmtuDiscovery(QuicConnectionStateBase& conn) {
+  // canIgnorePathMTU already sends the largest packets the peer accepts
+  if (!conn.transportSettings.enablePmtuDiscovery ||
+      conn.transportSettings.canIgnorePathMTU || conn.pmtuDiscovery) {
+    return;
+  }
+  auto upperSize = getPmtuUpperSize(conn);
+  if (upperSize <= conn.udpSendPacketLen) {
+    return;
+  }
+  conn.pmtuDiscovery.emplace();
+  conn.pmtuDiscovery->minSize = conn.udpSendPacketLen;
+  conn.pmtuDiscovery->baseSize = conn.udpSendPacketLen;
+  conn.pmtuDiscovery->upperSize = upperSize;
+  VLOG(10) << "PMTU search from " << conn.udpSendPacketLen << " to "
+           << upperSize << " " << conn;
+}
+
+folly::Optional<uint64_t> getNextPmtuProbeSize(
+    QuicConnectionStateBase& conn,
+    TimePoint now) {
+  if (!conn.pmtuDiscovery || conn.pmtuDiscovery->probePacketNum) {
+    return folly::none;
+  }
+  auto& pmtu = *conn.pmtuDiscovery;
+  if (pmtu.raiseTime) {
+    if (now < *pmtu.raiseTime) {
+      return folly::none;
+    }
+    // the path may carry larger packets by now
+    pmtu.raiseTime.reset();
+    pmtu.baseSize = conn.udpSendPacketLen;
+    pmtu.upperSize = getPmtuUpperSize(conn);
+    pmtu.probeCount = 0;
+    if (pmtu.upperSize < pmtu.baseSize + kPmtuSearchGranularity) {
+      pmtu.raiseTime = now + conn.transportSettings.pmtuRaiseInterval;
+      return folly::none;
+    }
+  }
+  if (pmtu.probeCount > 0) {
+    // retry the size whose probe was lost
+    return pmtu.probeSize;
+  }
+  return pmtu.baseSize + (pmtu.upperSize - pmtu.baseSize + 1) / 2;
+}
+
+void onPmtuProbeSent(
+    QuicConnectionStateBase& conn,
+    PacketNum packetNum,
+    uint64_t probeSize) {
+  CHECK(conn.pmtuDiscovery);
+  conn.pmtuDiscovery->probePacketNum = packetNum;
+  conn.pmtuDiscovery->probeSize = probeSize;
+}
+
+bool isPmtuProbe(
+    const QuicConnectionStateBase& conn,
+    const OutstandingPacketWrapper& packet) {
+  return conn.pmtuDiscovery && conn.pmtuDiscovery->probePacketNum &&
+      packet.packet.header.getPacketNumberSpace() ==
+      PacketNumberSpace::AppData &&
+      packet.packet.header.getPacketSequenceNum() ==
+      *conn.pmtuDiscovery->probePacketNum;
+}
+
+void onPmtuProbeAcked(QuicConnectionStateBase& conn, TimePoint ackTime) {
+  auto& pmtu = *conn.pmtuDiscovery;
+  pmtu.probePacketNum.reset();
+  pmtu.probeCount = 0;
+  pmtu.baseSize = std::max(pmtu.baseSize, pmtu.probeSize);
+  maybeFinishPmtuSearch(conn, ackTime);
+  if (pmtu.baseSize <= conn.udpSendPacketLen) {
+    return;
+  }
+  setPmtu(conn, pmtu.baseSize, ackTime);
+}
+
+void onPmtuProbeLost(QuicConnectionStateBase& conn, TimePoint lossTime) {
+  auto& pmtu = *conn.pmtuDiscovery;
+  pmtu.probePacketNum.reset();
+  if (++pmtu.probeCount < conn.transportSettings.maxPmtuProbes) {
+    return;
+  }
+  VLOG(10) << "PMTU probe of " << pmtu.probeSize << " too large " << conn;
+  pmtu.probeCount = 0;
+  pmtu.upperSize = std::min(pmtu.upperSize, pmtu.probeSize - 1);
+  maybeFinishPmtuSearch(conn, lossTime);
+}
+
+void onPmtuMsgSizeError(
+    QuicConnectionStateBase& conn,
+    uint64_t packetLen,
+    TimePoint now) {
+  if (!conn.pmtuDiscovery) {
+    return;
+  }
+  auto& pmtu = *conn.pmtuDiscovery;
+  // Outside of a probe write udpSendPacketLen is baseSize, probes are larger.
+  // A probe that did not fit is left to the loss detection.
+  if (packetLen > pmtu.baseSize || packetLen <= pmtu.minSize) {
+    return;
+  }
+  VLOG(4) << "PMTU black hole at " << packetLen << " " << conn;
+  pmtu.baseSize = pmtu.minSize;
+  pmtu.upperSize = packetLen - 1;
+  pmtu.probeCount = 0;
+  pmtu.raiseTime.reset();
+  maybeFinishPmtuSearch(conn, now);
+  setPmtu(conn, pmtu.minSize, now);
+}
+
+} // namespace quic
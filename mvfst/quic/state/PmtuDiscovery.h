@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <quic/state/StateData.h>
+
+namespace quic {
+
+/**
+ * Start path MTU discovery (RFC 8899) if it is enabled. Called once the peer's
+ * transport parameters, and with them its max_udp_payload_size, are known.
+ */
+void startPmtuDiscovery(QuicConnectionStateBase& conn);
+
+/**
+ * Size of the next probe to send, or none if no probe should be sent now:
+ * discovery is not running, a probe is in flight, or the search is finished
+ * and the raise timer has not fired yet.
+ */
+folly::Optional<uint64_t> getNextPmtuProbeSize(
+    QuicConnectionStateBase& conn,
+    TimePoint now);
+
+void onPmtuProbeSent(
+    QuicConnectionStateBase& conn,
+    PacketNum packetNum,
+    uint64_t probeSize);
+
+bool isPmtuProbe(
+    const QuicConnectionStateBase& conn,
+    const OutstandingPacketWrapper& packet);
+
+/**
+ * The probe got through: raise udpSendPacketLen to its size and tell the
+ * observers.
+ */
+void onPmtuProbeAcked(QuicConnectionStateBase& conn, TimePoint ackTime);
+
+/**
+ * The probe was lost. After maxPmtuProbes lost probes of a size, the size is
+ * considered too large for the path. Lost probes are not a congestion signal.
+ */
+void onPmtuProbeLost(QuicConnectionStateBase& conn, TimePoint lossTime);
+
+/**
+ * A packet of packetLen bytes failed to send with EMSGSIZE. If it was not a
+ * probe, the path no longer carries the current size: fall back to the size
+ * the search started from and search again below packetLen.
+ */
+void onPmtuMsgSizeError(
+    QuicConnectionStateBase& conn,
+    uint64_t packetLen,
+    TimePoint now);
+
+} // namespace quic
@@ -8,6 +8,8 @@
 #include <quic/common/TimeUtil.h>
 #include <quic/state/QuicAckFrequencyFunctions.h>
 
+#include <algorithm>
+
 namespace quic {
 
 bool canSendAckControlFrames(const QuicConnectionStateBase& conn) {
@@ -35,6 +37,75 @@ std::chrono::microseconds clampMaxAckDelay(
   return timeMax(maxAckDelay, conn.peerMinAckDelay.value());
 }
 
+void updatePeerAckFrequency(
+    QuicConnectionStateBase& conn,
+    TimePoint ackTime,
+    bool lossDetected) {
+  CHECK(conn.transportSettings.ackFrequencyPolicy.has_value());
+  const auto& config = *conn.transportSettings.ackFrequencyPolicy;
+  auto& state = conn.ackFrequencyPolicyState;
+  if (conn.lossState.srtt == 0us) {
+    return;
+  }
+  if (lossDetected) {
+    state.lastLossTime = ackTime;
+  } else if (
+      state.lastUpdateTime &&
+      ackTime - *state.lastUpdateTime < conn.lossState.srtt) {
+    return;
+  }
+  auto lastUpdateTime = state.lastUpdateTime;
+  auto bytesAckedSinceUpdate =
+      conn.lossState.totalBytesAcked - state.totalBytesAckedAtUpdate;
+  state.lastUpdateTime = ackTime;
+  state.totalBytesAckedAtUpdate = conn.lossState.totalBytesAcked;
+  bool inRecovery = state.lastLossTime &&
+      ackTime - *state.lastLossTime < conn.lossState.srtt;
+  auto acksPerRtt = std::max<uint32_t>(config.acksPerRtt, 1);
+  uint64_t ackElicitingThreshold = config.recoveryAckElicitingThreshold;
+  uint64_t reorderThreshold = kReorderingThreshold;
+  if (!inRecovery) {
+    uint64_t windowBytes = conn.lossState.inflightBytes;
+    if (conn.congestionController) {
+      windowBytes = conn.congestionController->getCongestionWindow();
+    } else if (lastUpdateTime) {
+      // Without a congestion controller, e.g. on hops that leave congestion
+      // control to the flows they carry, the bytes acknowledged per RTT
+      // stand in for the window
+      auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+          ackTime - *lastUpdateTime);
+      if (elapsed > 0us) {
+        windowBytes = bytesAckedSinceUpdate * conn.lossState.srtt.count() /
+            elapsed.count();
+      }
+    }
+    auto cwndPackets = windowBytes / conn.udpSendPacketLen;
+    ackElicitingThreshold = std::clamp<uint64_t>(
+        cwndPackets / acksPerRtt,
+        config.recoveryAckElicitingThreshold,
+        std::max(
+            config.maxAckElicitingThreshold,
+            config.recoveryAckElicitingThreshold));
+    // the peer does not need to ACK reorderings we would not call a loss
+    reorderThreshold = conn.lossState.reorderingThreshold;
+  }
+  // Not above the peer's max_ack_delay, which our PTO accounts for
+  auto maxAckDelay = clampMaxAckDelay(
+      conn,
+      std::min<std::chrono::microseconds>(
+          conn.lossState.srtt / acksPerRtt, conn.lossState.maxAckDelay));
+  if (ackElicitingThreshold == state.ackElicitingThreshold &&
+      maxAckDelay == state.maxAckDelay &&
+      reorderThreshold == state.reorderThreshold) {
+    return;
+  }
+  requestPeerAckFrequencyChange(
+      conn, ackElicitingThreshold, maxAckDelay, reorderThreshold);
+  state.ackElicitingThreshold = ackElicitingThreshold;
+  state.maxAckDelay = maxAckDelay;
+  state.reorderThreshold = reorderThreshold;
+}
+
 /**
  * Send an IMMEDIATE_ACK frame to request the peer to send an ACK immediately
  */
@@ -30,6 +30,21 @@ std::chrono::microseconds clampMaxAckDelay(
     const QuicConnectionStateBase& conn,
     std::chrono::microseconds maxAckDelay);
 
+/**
+ * Applies TransportSettings::ackFrequencyPolicy, called for every ACK of the
+ * AppData space. The ack-eliciting threshold is sized from the congestion
+ * window, or without a congestion controller from the bytes acknowledged per
+ * RTT since the last update (the bytes in flight for the first one), the max
+ * ACK delay from the smoothed RTT, and the reordering
+ * threshold follows our own loss reordering threshold. At most one
+ * ACK_FREQUENCY frame is sent per RTT, except that a loss switches to the
+ * recovery threshold right away.
+ */
+void updatePeerAckFrequency(
+    QuicConnectionStateBase& conn,
+    TimePoint ackTime,
+    bool lossDetected);
+
 /**
  * Send an IMMEDIATE_ACK frame to request the peer to send an ACK immediately
  */
@@ -11,22 +11,21 @@
 #include <quic/common/TimeUtil.h>
 
 namespace {
-std::deque<quic::OutstandingPacketWrapper>::reverse_iterator
-getPreviousOutstandingPacket(
+quic::OutstandingPacketList::reverse_iterator getPreviousOutstandingPacket(
     quic::QuicConnectionStateBase& conn,
     quic::PacketNumberSpace packetNumberSpace,
-    std::deque<quic::OutstandingPacketWrapper>::reverse_iterator from) {
+    quic::OutstandingPacketList::reverse_iterator from) {
   return std::find_if(
       from, conn.outstandings.packets.rend(), [=](const auto& op) {
         return !op.declaredLost &&
             packetNumberSpace == op.packet.header.getPacketNumberSpace();
       });
 }
-std::deque<quic::OutstandingPacketWrapper>::reverse_iterator
+quic::OutstandingPacketList::reverse_iterator
 getPreviousOutstandingPacketIncludingLost(
     quic::QuicConnectionStateBase& conn,
     quic::PacketNumberSpace packetNumberSpace,
-    std::deque<quic::OutstandingPacketWrapper>::reverse_iterator from) {
+    quic::OutstandingPacketList::reverse_iterator from) {
   return std::find_if(
       from, conn.outstandings.packets.rend(), [=](const auto& op) {
         return packetNumberSpace == op.packet.header.getPacketNumberSpace();
@@ -267,32 +266,31 @@ void increaseNextPacketNum(
   }
 }
 
-std::deque<OutstandingPacketWrapper>::iterator getFirstOutstandingPacket(
+OutstandingPacketList::iterator getFirstOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace) {
   return getNextOutstandingPacket(
       conn, packetNumberSpace, conn.outstandings.packets.begin());
 }
 
-std::deque<OutstandingPacketWrapper>::reverse_iterator getLastOutstandingPacket(
+OutstandingPacketList::reverse_iterator getLastOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace) {
   return getPreviousOutstandingPacket(
       conn, packetNumberSpace, conn.outstandings.packets.rbegin());
 }
 
-std::deque<OutstandingPacketWrapper>::reverse_iterator
-getLastOutstandingPacketIncludingLost(
+OutstandingPacketList::reverse_iterator getLastOutstandingPacketIncludingLost(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace) {
   return getPreviousOutstandingPacketIncludingLost(
       conn, packetNumberSpace, conn.outstandings.packets.rbegin());
 }
 
-std::deque<OutstandingPacketWrapper>::iterator getNextOutstandingPacket(
+OutstandingPacketList::iterator getNextOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace,
-    std::deque<OutstandingPacketWrapper>::iterator from) {
+    OutstandingPacketList::iterator from) {
   return std::find_if(
       from, conn.outstandings.packets.end(), [=](const auto& op) {
         return !op.declaredLost &&
@@ -437,6 +435,28 @@ uint64_t updateLargestReceivedPacketNum(
   }
 }
 
+void updateEcnCountsOnRecvPacket(
+    const QuicConnectionStateBase& conn,
+    AckState& ackState,
+    uint8_t tosValue) {
+  if (!conn.transportSettings.readEcnOnIngress) {
+    return;
+  }
+  switch (tosValue & kEcnMask) {
+    case kEcnECT0:
+      ackState.ecnECT0CountReceived++;
+      break;
+    case kEcnECT1:
+      ackState.ecnECT1CountReceived++;
+      break;
+    case kEcnCE:
+      ackState.ecnCECountReceived++;
+      break;
+    default:
+      break;
+  }
+}
+
 bool checkCustomRetransmissionProfilesEnabled(
     const QuicConnectionStateBase& conn) {
   return conn.transportSettings.advertisedMaxStreamGroups > 0;
@@ -461,4 +481,26 @@ bool streamRetransmissionDisabled(
   return noRetransmissions;
 }
 
+void hibernateConnection(QuicConnectionStateBase& conn) {
+  conn.outstandings.packets.shrink_to_fit();
+  detail::releaseIfEmpty(conn.outstandings.packetEvents);
+  detail::releaseIfEmpty(conn.pendingEvents.resets);
+  detail::releaseIfEmpty(conn.pendingEvents.frames);
+  detail::releaseIfEmpty(conn.pendingEvents.knobs);
+  detail::releaseIfEmpty(conn.lastProcessedAckEvents);
+  detail::releaseIfEmpty(conn.datagramState.burstBuffer);
+  if (conn.cryptoState) {
+    auto& cryptoState = *conn.cryptoState;
+    detail::releaseIfEmpty(cryptoState.initialStream.retransmissionBuffer);
+    detail::releaseIfEmpty(cryptoState.handshakeStream.retransmissionBuffer);
+    detail::releaseIfEmpty(cryptoState.oneRttStream.retransmissionBuffer);
+  }
+  if (conn.streamManager) {
+    conn.streamManager->compact();
+  }
+  if (conn.readCodec) {
+    conn.readCodec->maybeDropZeroRttKeys(Clock::now());
+  }
+}
+
 } // namespace quic
@@ -69,19 +69,27 @@ uint64_t updateLargestReceivedPacketNum(
     PacketNum packetNum,
     TimePoint receivedTime);
 
-std::deque<OutstandingPacketWrapper>::iterator getNextOutstandingPacket(
+/**
+ * Counts the ECN codepoint of a received packet for the next ACK_ECN frame,
+ * if reading ECN is enabled.
+ */
+void updateEcnCountsOnRecvPacket(
+    const QuicConnectionStateBase& conn,
+    AckState& ackState,
+    uint8_t tosValue);
+
+OutstandingPacketList::iterator getNextOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace,
-    std::deque<OutstandingPacketWrapper>::iterator from);
-std::deque<OutstandingPacketWrapper>::iterator getFirstOutstandingPacket(
+    OutstandingPacketList::iterator from);
+OutstandingPacketList::iterator getFirstOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace);
 
-std::deque<OutstandingPacketWrapper>::reverse_iterator getLastOutstandingPacket(
+OutstandingPacketList::reverse_iterator getLastOutstandingPacket(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace);
-std::deque<OutstandingPacketWrapper>::reverse_iterator
-getLastOutstandingPacketIncludingLost(
+OutstandingPacketList::reverse_iterator getLastOutstandingPacketIncludingLost(
     QuicConnectionStateBase& conn,
     PacketNumberSpace packetNumberSpace);
 
@@ -122,4 +130,12 @@ bool streamRetransmissionDisabled(
     QuicConnectionStateBase& conn,
     const QuicStreamState& stream);
 
+/**
+ * Frees the memory an idle connection keeps around from its last burst of
+ * activity: drained containers keep their capacity, and the outstanding
+ * packet list keeps its largest size. The containers grow again with the next
+ * packet. Also drops the 0-RTT keys once they can no longer be used.
+ */
+void hibernateConnection(QuicConnectionStateBase& conn);
+
 } // namespace quic
@@ -780,4 +780,27 @@ void QuicStreamManager::addToStreamPriorityMap(
   notifyStreamPriorityChanges();
 }
 
+void QuicStreamManager::compact() {
+  for (auto& stream : streams_) {
+    detail::releaseIfEmpty(stream.second.retransmissionBuffer);
+    detail::releaseIfEmpty(stream.second.retransmissionBufMetas);
+  }
+  detail::releaseIfEmpty(newPeerStreams_);
+  detail::releaseIfEmpty(newGroupedPeerStreams_);
+  detail::releaseIfEmpty(newPeerStreamGroups_);
+  detail::releaseIfEmpty(blockedStreams_);
+  detail::releaseIfEmpty(stopSendingStreams_);
+  detail::releaseIfEmpty(windowUpdates_);
+  detail::releaseIfEmpty(flowControlUpdated_);
+  detail::releaseIfEmpty(lossStreams_);
+  detail::releaseIfEmpty(lossDSRStreams_);
+  detail::releaseIfEmpty(readableStreams_);
+  detail::releaseIfEmpty(peekableStreams_);
+  detail::releaseIfEmpty(writableStreams_);
+  detail::releaseIfEmpty(writableDSRStreams_);
+  detail::releaseIfEmpty(txStreams_);
+  detail::releaseIfEmpty(deliverableStreams_);
+  detail::releaseIfEmpty(closedStreams_);
+}
+
 } // namespace quic
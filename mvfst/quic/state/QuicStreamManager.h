@@ -23,6 +23,14 @@ constexpr uint8_t kStreamIncrement = 0x04;
 constexpr uint8_t kStreamGroupIncrement = 0x04;
 constexpr uint64_t kMaxStreamGroupId = 128 * kStreamGroupIncrement;
 
+// Frees the memory of an empty container, which clear() keeps
+template <typename Container>
+void releaseIfEmpty(Container& container) {
+  if (container.empty()) {
+    Container().swap(container);
+  }
+}
+
 } // namespace detail
 
 class QuicStreamManager {
@@ -345,6 +353,13 @@ class QuicStreamManager {
     streams_.clear();
   }
 
+  /*
+   * Frees the memory of the empty containers of the manager and its streams,
+   * which they keep after being drained. Used when the connection hibernates,
+   * the containers grow again on the next packet.
+   */
+  void compact();
+
   /*
    * Return a const reference to the underlying container holding the stream
    * state. Only really useful for iterating.
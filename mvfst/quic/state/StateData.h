@@ -22,7 +22,7 @@
 #include <quic/state/AckEvent.h>
 #include <quic/state/AckStates.h>
 #include <quic/state/LossState.h>
-#include <quic/state/OutstandingPacket.h>
+#include <quic/state/OutstandingPacketList.h>
 #include <quic/state/PacketEvent.h>
 #include <quic/state/PendingPathRateLimiter.h>
 #include <quic/state/QuicConnectionStats.h>
@@ -48,23 +48,43 @@ struct NetworkData {
   TimePoint receiveTimePoint;
   std::vector<Buf> packets;
   size_t totalData{0};
+  // IP TOS / traffic class byte of each entry in packets. Trailing packets
+  // without an entry arrived with 0.
+  std::vector<uint8_t> tosValues;
 
   NetworkData() = default;
-  NetworkData(Buf&& buf, const TimePoint& receiveTime)
+  NetworkData(Buf&& buf, const TimePoint& receiveTime, uint8_t tosValue = 0)
       : receiveTimePoint(receiveTime) {
     if (buf) {
       totalData = buf->computeChainDataLength();
       packets.emplace_back(std::move(buf));
     }
+    setTosValues(0, tosValue);
   }
 
-  NetworkData(std::vector<Buf>&& packetBufs, const TimePoint& receiveTime)
+  NetworkData(
+      std::vector<Buf>&& packetBufs,
+      const TimePoint& receiveTime,
+      uint8_t tosValue = 0)
       : receiveTimePoint(receiveTime),
         packets(std::move(packetBufs)),
         totalData(0) {
     for (const auto& buf : packets) {
       totalData += buf->computeChainDataLength();
     }
+    setTosValues(0, tosValue);
+  }
+
+  // Records tosValue for the packets appended from index first onwards.
+  void setTosValues(size_t first, uint8_t tosValue) {
+    if (tosValue) {
+      tosValues.resize(first, 0);
+      tosValues.resize(packets.size(), tosValue);
+    }
+  }
+
+  uint8_t getTosValue(size_t index) const {
+    return index < tosValues.size() ? tosValues[index] : 0;
   }
 
   std::unique_ptr<folly::IOBuf> moveAllData() && {
@@ -84,13 +104,15 @@ struct NetworkDataSingle {
   Buf data;
   TimePoint receiveTimePoint;
   size_t totalData{0};
+  uint8_t tosValue{0};
 
   NetworkDataSingle() = default;
 
   NetworkDataSingle(
       std::unique_ptr<folly::IOBuf> buf,
-      const TimePoint& receiveTime)
-      : data(std::move(buf)), receiveTimePoint(receiveTime) {
+      const TimePoint& receiveTime,
+      uint8_t tos = 0)
+      : data(std::move(buf)), receiveTimePoint(receiveTime), tosValue(tos) {
     if (data) {
       totalData += data->computeChainDataLength();
     }
@@ -99,7 +121,7 @@ struct NetworkDataSingle {
 
 struct OutstandingsInfo {
   // Sent packets which have not been acked. These are sorted by PacketNum.
-  std::deque<OutstandingPacketWrapper> packets;
+  OutstandingPacketList packets;
 
   // All PacketEvents of this connection. If a OutstandingPacketWrapper doesn't
   // have an associatedEvent or if it's not in this set, there is no need to
@@ -262,6 +284,11 @@ struct Pacer {
    */
   virtual uint64_t getCachedWriteBatchSize() const = 0;
 
+  /**
+   * Getter API of the interval between two write batches.
+   */
+  [[nodiscard]] virtual std::chrono::microseconds getWriteInterval() const = 0;
+
   virtual void onPacketSent() = 0;
   virtual void onPacketsLoss() = 0;
 
@@ -588,6 +615,24 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
   // use when receiving the forciblySetUdpPayloadSize transport knob param
   uint64_t peerMaxUdpPayloadSize{kDefaultUDPSendPacketLen};
 
+  // State of path MTU discovery, set when it is enabled and started.
+  struct PmtuDiscoveryState {
+    // udpSendPacketLen when the search started, the size to fall back to
+    uint64_t minSize;
+    // largest size acknowledged so far, the current udpSendPacketLen
+    uint64_t baseSize;
+    // largest size that may still work
+    uint64_t upperSize;
+    // size being probed and the packet number of its last probe
+    uint64_t probeSize{0};
+    folly::Optional<PacketNum> probePacketNum;
+    uint8_t probeCount{0};
+    // when the search is finished, the time to search again
+    folly::Optional<TimePoint> raiseTime;
+  };
+
+  folly::Optional<PmtuDiscoveryState> pmtuDiscovery;
+
   struct PacketSchedulingState {
     StreamId nextScheduledControlStream{0};
   };
@@ -697,8 +742,15 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
     uint32_t maxWriteBufferSize{kDefaultMaxDatagramsBuffered};
     // Buffers Incoming Datagrams
     std::deque<ReadDatagram> readBuffer;
+    // Incoming Datagrams of the current read burst, used instead of readBuffer
+    // when the DatagramCallback takes bursts. Keeps its capacity across bursts.
+    std::vector<ReadDatagram> burstBuffer;
+    bool deliverBursts{false};
     // Buffers Outgoing Datagrams
     std::deque<BufQueue> writeBuffer;
+    // Datagrams sent ahead of the head of writeBuffer since it became the
+    // head, bounded by DatagramConfig::packingWindow - 1
+    uint32_t headSkips{0};
   };
 
   DatagramState datagramState;
@@ -709,9 +761,25 @@ struct QuicConnectionStateBase : public folly::DelayedDestruction {
   // Sequence number to use for the next ACK_FREQUENCY frame
   uint64_t nextAckFrequencyFrameSequenceNumber{0};
 
+  // Values last requested by the ACK frequency policy
+  struct AckFrequencyPolicyState {
+    folly::Optional<TimePoint> lastUpdateTime;
+    folly::Optional<TimePoint> lastLossTime;
+    uint64_t ackElicitingThreshold{0};
+    std::chrono::microseconds maxAckDelay{0us};
+    uint64_t reorderThreshold{0};
+    // lossState.totalBytesAcked at lastUpdateTime
+    uint64_t totalBytesAckedAtUpdate{0};
+  };
+
+  AckFrequencyPolicyState ackFrequencyPolicyState;
+
   // GSO supported on conn.
   folly::Optional<bool> gsoSupported;
 
+  // SO_TXTIME enabled on the conn's socket.
+  folly::Optional<bool> txTimeSupported;
+
   folly::Optional<AckReceiveTimestampsConfig>
       maybePeerAckReceiveTimestampsConfig;
 
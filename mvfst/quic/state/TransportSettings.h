@@ -55,6 +55,34 @@ struct BbrConfig {
   folly::Optional<AckFrequencyConfig> ackFrequencyConfig;
 };
 
+// Controls how the ACK frequency of the peer follows the connection, see
+// updatePeerAckFrequency. The peer ACKs once per ack-eliciting threshold of
+// packets, which is sized to acksPerRtt ACKs per congestion window.
+struct AckFrequencyPolicyConfig {
+  // ACKs the peer should send per congestion window, at least
+  uint32_t acksPerRtt{4};
+  // Upper bound of the ack-eliciting threshold
+  uint64_t maxAckElicitingThreshold{64};
+  // Threshold used from a loss until one RTT later, so that losses are
+  // detected and repaired quickly. Also the lower bound of the threshold.
+  uint64_t recoveryAckElicitingThreshold{2};
+};
+
+// Config of TunnelCongestionController, the congestion controller for hops
+// carrying flows that run their own congestion control
+struct TunnelCongestionConfig {
+  // Bytes in flight allowed in multiples of the estimated bandwidth-delay
+  // product. Large, so that the flows inside the tunnel are limited by their
+  // own congestion control and not by the tunnel.
+  double cwndGain{4.0};
+  // Rate above which the tunnel stops sending, 0 for none. Datagrams that do
+  // not fit into the datagram write buffer are then dropped, which the flows
+  // inside the tunnel see as losses.
+  uint64_t shapingRateBytesPerSec{0};
+  // Bytes that may be sent at once above the shaping rate
+  uint64_t shapingBurstBytes{64 * 1024};
+};
+
 struct DatagramConfig {
   bool enabled{false};
   bool framePerPacket{true};
@@ -62,6 +90,14 @@ struct DatagramConfig {
   bool sendDropOldDataFirst{false};
   uint32_t readBufSize{kDefaultMaxDatagramsBuffered};
   uint32_t writeBufSize{kDefaultMaxDatagramsBuffered};
+  // Number of datagrams, counted from the head of the write buffer, the
+  // scheduler may choose from when filling a packet. It picks the largest one
+  // that still fits, so a datagram can be overtaken by at most
+  // packingWindow - 1 later ones. 1 keeps strict FIFO order.
+  uint32_t packingWindow{1};
+  // With framePerPacket, datagrams up to this size may still be coalesced
+  // into a packet that already carries one. 0 disables coalescing.
+  uint32_t coalesceMaxSize{0};
 };
 
 struct AckReceiveTimestampsConfig {
@@ -107,6 +143,16 @@ struct TransportSettings {
   // Can we ignore the path mtu when sending a packet. This is useful for
   // testing.
   bool canIgnorePathMTU{false};
+  // Datagram packetization layer path MTU discovery (RFC 8899). Once the
+  // handshake is done, PING+PADDING probes search for the largest packet the
+  // path carries between udpSendPacketLen and the smaller of maxPmtuProbeSize
+  // and the peer's max_udp_payload_size, and udpSendPacketLen is raised to it.
+  bool enablePmtuDiscovery{false};
+  uint64_t maxPmtuProbeSize{kDefaultMaxUDPPayload};
+  // Number of lost probes of one size after which the size is given up.
+  uint8_t maxPmtuProbes{3};
+  // Time after a finished search before searching for a larger size again.
+  std::chrono::seconds pmtuRaiseInterval{600};
   // Whether or not to use a connected UDP socket on the client. This should
   // only be used in environments where you know your IP address does not
   // change. See AsyncUDPSocket::connect for the caveats.
@@ -131,6 +177,18 @@ struct TransportSettings {
   // than kDefaultPacingTickInterval.
   std::chrono::microseconds pacingTimerResolution{
       kDefaultPacingTimerResolution};
+  // Earliest departure time pacing: each pacer wakeup writes edtPacingBursts
+  // bursts at once, and every batch carries an SCM_TXTIME departure time for
+  // the fq qdisc to release it at. Needs SO_TXTIME support on the socket and
+  // is ignored with thread local batching.
+  bool edtPacing{false};
+  uint32_t edtPacingBursts{kDefaultEdtPacingBursts};
+  // Mark outgoing packets ECT(0) so that routers can signal congestion with CE
+  // instead of dropping them.
+  bool enableEcnOnEgress{false};
+  // Read the ECN codepoint of incoming packets and report the counts to the
+  // peer in ACK_ECN frames.
+  bool readEcnOnIngress{false};
   ZeroRttSourceTokenMatchingPolicy zeroRttSourceTokenMatchingPolicy{
       ZeroRttSourceTokenMatchingPolicy::REJECT_IF_NO_EXACT_MATCH};
   // Scale pacing rate for CC, non-empty indicates override via transport knobs
@@ -160,6 +218,10 @@ struct TransportSettings {
   // maximum number of packets we can batch. This does not apply to
   // BATCHING_MODE_NONE
   uint32_t maxBatchSize{kDefaultQuicMaxBatchSize};
+  // Apply header protection to the packets of a batch right before it is
+  // flushed, with the masks of the whole batch computed at once. Ignored with
+  // thread local batching since its batches outlive a write loop.
+  bool batchHeaderProtection{false};
   // Initial congestion window in MSS
   uint64_t initCwndInMss{kInitCwndInMss};
   // Minimum congestion window in MSS
@@ -180,6 +242,10 @@ struct TransportSettings {
   // Setting a value here also indicates to the peer that it can send
   // ACK_FREQUENCY and IMMEDIATE_ACK frames
   folly::Optional<std::chrono::microseconds> minAckDelay;
+  // Adjust the ACK frequency of the peer from the RTT, the congestion window
+  // and the reordering threshold. Needs a peer that announced min_ack_delay,
+  // and is not used when bbrConfig.ackFrequencyConfig is set.
+  folly::Optional<AckFrequencyPolicyConfig> ackFrequencyPolicy;
   // Limits the amount of data that should be buffered in a QuicSocket.
   // If the amount of data in the buffer equals or exceeds this amount, then
   // the callback registered through notifyPendingWriteOnConnection() will
@@ -208,6 +274,7 @@ struct TransportSettings {
   bool shouldUseRecvmmsgForBatchRecv{false};
   // Config struct for BBR
   BbrConfig bbrConfig;
+  TunnelCongestionConfig tunnelCongestionConfig;
   // A packet is considered loss when a packet that's sent later by at least
   // timeReorderingThreshold * RTT is acked by peer.
   DurationRep timeReorderingThreshDividend{
@@ -248,6 +315,11 @@ struct TransportSettings {
   // before an idle timeout. To work effectively this means the idle timer
   // has to be set to something >> the RTT of the connection.
   bool enableKeepalive{false};
+  // Time without new packets, like the idle timeout, after which the
+  // connection frees its empty containers and expired 0-RTT keys, see
+  // hibernateConnection(). 0 disables hibernation. Has to be shorter than the
+  // keepalive timeout to take effect with keepalives.
+  std::chrono::milliseconds hibernateTimeout{0ms};
   std::string flowPriming = "";
   // Whether or not to enable WritableBytes limit (server only)
   bool enableWritableBytesLimit{false};
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <common/init/Init.h>
+#include <folly/Benchmark.h>
+#include <quic/common/test/TestUtils.h>
+#include <quic/fizz/server/handshake/FizzServerQuicHandshakeContext.h>
+#include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/AckHandlers.h>
+
+using namespace std;
+using namespace folly;
+using namespace quic;
+using namespace quic::test;
+
+// Processes an ACK of numAckBlocks ranges of packetsPerBlock packets each,
+// separated by one-packet holes, with the largest range ending at
+// largestAcked. numOutstanding AppData packets are in flight.
+static inline void benchmarkAckProcessing(
+    size_t n,
+    size_t numOutstanding,
+    PacketNum largestAcked,
+    size_t numAckBlocks,
+    size_t packetsPerBlock) {
+  while (n--) {
+    std::unique_ptr<QuicServerConnectionState> conn;
+    ReadAckFrame ackFrame;
+    BENCHMARK_SUSPEND {
+      conn = std::make_unique<QuicServerConnectionState>(
+          FizzServerQuicHandshakeContext::Builder().build());
+      // Keep loss detection out of the measurement.
+      conn->lossState.srtt = 10s;
+      conn->lossState.reorderingThreshold = numOutstanding;
+      auto sentTime = Clock::now();
+      for (PacketNum packetNum = 0; packetNum < numOutstanding; packetNum++) {
+        conn->outstandings.packetCount[PacketNumberSpace::AppData]++;
+        conn->outstandings.packets.emplace_back(
+            createNewPacket(packetNum, PacketNumberSpace::AppData),
+            sentTime,
+            100,
+            0,
+            false,
+            (packetNum + 1) * 100,
+            0,
+            0,
+            0,
+            LossState(),
+            0,
+            OutstandingPacketMetadata::DetailsPerStream());
+      }
+      ackFrame.largestAcked = largestAcked;
+      PacketNum end = largestAcked;
+      for (size_t i = 0; i < numAckBlocks && end + 1 >= packetsPerBlock; i++) {
+        ackFrame.ackBlocks.emplace_back(end + 1 - packetsPerBlock, end);
+        if (end < packetsPerBlock + 1) {
+          break;
+        }
+        end -= packetsPerBlock + 1;
+      }
+    }
+    processAckFrame(
+        *conn,
+        PacketNumberSpace::AppData,
+        ackFrame,
+        [](const auto&, const auto&, const auto&) {},
+        [](auto&, auto&, bool) {},
+        Clock::now());
+    BENCHMARK_SUSPEND {
+      conn.reset();
+    }
+  }
+}
+
+BENCHMARK(ackTail_1Range_10kOutstanding, n) {
+  benchmarkAckProcessing(n, 10000, 9999, 1, 10);
+}
+
+BENCHMARK(ackTail_32Ranges_10kOutstanding, n) {
+  benchmarkAckProcessing(n, 10000, 9999, 32, 10);
+}
+
+BENCHMARK(ackMiddle_32Ranges_10kOutstanding, n) {
+  benchmarkAckProcessing(n, 10000, 5000, 32, 10);
+}
+
+BENCHMARK(ackMiddle_32Ranges_100kOutstanding, n) {
+  benchmarkAckProcessing(n, 100000, 50000, 32, 10);
+}
+
+BENCHMARK(ackMiddle_256Ranges_100kOutstanding, n) {
+  benchmarkAckProcessing(n, 100000, 50000, 256, 10);
+}
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  runBenchmarks();
+  return 0;
+}
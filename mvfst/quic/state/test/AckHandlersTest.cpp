@@ -1424,6 +1424,80 @@ TEST_P(AckHandlersTest, LossByAckedRecovered) {
       Clock::now());
 }
 
+TEST_P(AckHandlersTest, EcnCongestionExperienced) {
+  QuicServerConnectionState conn(
+      FizzServerQuicHandshakeContext::Builder().build());
+  conn.transportSettings.enableEcnOnEgress = true;
+  auto mockController = std::make_unique<MockCongestionController>();
+  auto rawController = mockController.get();
+  conn.congestionController = std::move(mockController);
+
+  auto sentTime = Clock::now();
+  for (PacketNum packetNum = 0; packetNum < 3; packetNum++) {
+    auto regularPacket = createNewPacket(packetNum, GetParam().pnSpace);
+    conn.outstandings
+        .packetCount[regularPacket.header.getPacketNumberSpace()]++;
+    conn.outstandings.packets.emplace_back(
+        std::move(regularPacket),
+        sentTime + std::chrono::milliseconds(packetNum),
+        100,
+        0,
+        false,
+        (packetNum + 1) * 100,
+        0,
+        0,
+        0,
+        LossState(),
+        0,
+        OutstandingPacketMetadata::DetailsPerStream());
+  }
+
+  // A new CE mark is reported as a loss of nothing, anchored at the largest
+  // newly acked packet.
+  ReadAckFrame ackFrame;
+  ackFrame.frameType = FrameType::ACK_ECN;
+  ackFrame.largestAcked = 1;
+  ackFrame.ackBlocks.emplace_back(0, 1);
+  ackFrame.ecnECT0Count = 1;
+  ackFrame.ecnCECount = 1;
+  EXPECT_CALL(*rawController, onPacketAckOrLoss(_, _))
+      .WillOnce(Invoke([&](auto ack, auto loss) {
+        ASSERT_NE(ack, nullptr);
+        ASSERT_NE(loss, nullptr);
+        EXPECT_EQ(ul(1), loss->largestLostPacketNum);
+        EXPECT_EQ(sentTime + 1ms, loss->largestLostSentTime);
+        EXPECT_EQ(0, loss->lostBytes);
+        EXPECT_EQ(0, loss->lostPackets);
+        EXPECT_FALSE(loss->persistentCongestion);
+      }));
+  processAckFrame(
+      conn,
+      GetParam().pnSpace,
+      ackFrame,
+      [](const auto&, const auto&, const auto&) {},
+      [](auto&, auto&, bool) {},
+      Clock::now());
+  EXPECT_EQ(getAckState(conn, GetParam().pnSpace).ecnCECountEchoed, 1);
+
+  // The same CE count again is not a new congestion signal.
+  ackFrame.largestAcked = 2;
+  ackFrame.ackBlocks.clear();
+  ackFrame.ackBlocks.emplace_back(0, 2);
+  ackFrame.ecnECT0Count = 2;
+  EXPECT_CALL(*rawController, onPacketAckOrLoss(_, _))
+      .WillOnce(Invoke([&](auto ack, auto loss) {
+        ASSERT_NE(ack, nullptr);
+        EXPECT_EQ(loss, nullptr);
+      }));
+  processAckFrame(
+      conn,
+      GetParam().pnSpace,
+      ackFrame,
+      [](const auto&, const auto&, const auto&) {},
+      [](auto&, auto&, bool) {},
+      Clock::now());
+}
+
 TEST_P(AckHandlersTest, AckPacketNumDoesNotExist) {
   QuicServerConnectionState conn(
       FizzServerQuicHandshakeContext::Builder().build());
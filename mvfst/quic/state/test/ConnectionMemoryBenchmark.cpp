@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <common/init/Init.h>
+#include <folly/Benchmark.h>
+#include <folly/io/async/test/MockAsyncUDPSocket.h>
+#include <malloc.h>
+#include <quic/api/QuicTransportFunctions.h>
+#include <quic/common/test/TestUtils.h>
+#include <quic/fizz/server/handshake/FizzServerQuicHandshakeContext.h>
+#include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/AckHandlers.h>
+#include <quic/state/QuicStateFunctions.h>
+#include <quic/state/QuicStreamFunctions.h>
+#include <quic/state/stream/StreamSendHandlers.h>
+
+using namespace std;
+using namespace folly;
+using namespace quic;
+using namespace quic::test;
+using namespace testing;
+
+static constexpr size_t kNumConnections = 1000;
+// packets written before each ACK
+static constexpr size_t kPacketsPerRoundTrip = 100;
+
+static size_t heapInUse() {
+  return mallinfo2().uordblks;
+}
+
+static std::unique_ptr<QuicServerConnectionState> createConn(
+    size_t numStreams) {
+  auto conn = std::make_unique<QuicServerConnectionState>(
+      FizzServerQuicHandshakeContext::Builder().build());
+  conn->serverConnectionId = getTestConnectionId();
+  conn->clientConnectionId = getTestConnectionId();
+  conn->version = QuicVersion::MVFST;
+  conn->flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiLocal =
+      kDefaultStreamWindowSize * 1000;
+  conn->flowControlState.peerAdvertisedInitialMaxStreamOffsetBidiRemote =
+      kDefaultStreamWindowSize * 1000;
+  conn->flowControlState.peerAdvertisedMaxOffset =
+      kDefaultConnectionWindowSize * 1000;
+  conn->streamManager->setMaxLocalBidirectionalStreams(numStreams);
+  return conn;
+}
+
+// Acks every outstanding packet the way the server handles an ACK frame
+static void ackOutstandingPackets(QuicServerConnectionState& conn) {
+  if (conn.outstandings.packets.empty()) {
+    return;
+  }
+  ReadAckFrame ackFrame;
+  ackFrame.largestAcked = conn.outstandings.packets.back()
+                              .packet.header.getPacketSequenceNum();
+  ackFrame.ackBlocks.emplace_back(
+      conn.outstandings.packets.front().packet.header.getPacketSequenceNum(),
+      ackFrame.largestAcked);
+  conn.lastProcessedAckEvents.emplace_back(processAckFrame(
+      conn,
+      PacketNumberSpace::AppData,
+      ackFrame,
+      [&](const OutstandingPacketWrapper&,
+          const QuicWriteFrame& packetFrame,
+          const ReadAckFrame&) {
+        if (auto frame = packetFrame.asWriteStreamFrame()) {
+          if (auto stream = conn.streamManager->getStream(frame->streamId)) {
+            sendAckSMHandler(*stream, *frame);
+          }
+        }
+      },
+      [](auto&, auto&, bool) {},
+      Clock::now()));
+  // the delivery callbacks of the transport
+  while (conn.streamManager->popDeliverable()) {
+  }
+}
+
+// Leaves the connection idle after a burst of numPackets packets on
+// numStreams streams, written and acknowledged one round trip at a time
+static void simulateBurst(
+    QuicServerConnectionState& conn,
+    folly::AsyncUDPSocket& sock,
+    size_t numPackets,
+    size_t numStreams) {
+  auto aead = createNoOpAead();
+  auto headerCipher = createNoOpHeaderCipher();
+  std::vector<QuicStreamState*> streams;
+  for (size_t i = 0; i < numStreams; i++) {
+    streams.push_back(
+        conn.streamManager->createNextBidirectionalStream().value());
+  }
+  auto data = buildRandomInputData(
+      kPacketsPerRoundTrip * conn.udpSendPacketLen / numStreams);
+  size_t packetsWritten = 0;
+  while (packetsWritten < numPackets) {
+    for (auto* stream : streams) {
+      writeDataToQuicStream(*stream, data->clone(), false);
+    }
+    auto result = writeQuicDataToSocket(
+        sock,
+        conn,
+        *conn.serverConnectionId,
+        *conn.clientConnectionId,
+        *aead,
+        *headerCipher,
+        *conn.version,
+        numPackets - packetsWritten);
+    CHECK_GT(result.packetsWritten, 0);
+    packetsWritten += result.packetsWritten;
+    // the tx callbacks of the transport
+    while (conn.streamManager->popTx()) {
+    }
+    ackOutstandingPackets(conn);
+  }
+}
+
+// Heap bytes per idle connection, with and without hibernation
+static void benchmarkIdleConnectionMemory(
+    UserCounters& counters,
+    size_t numPackets,
+    size_t numStreams,
+    bool hibernate) {
+  EventBase evb;
+  NiceMock<folly::test::MockAsyncUDPSocket> sock(&evb);
+  ON_CALL(sock, write(_, _))
+      .WillByDefault(Invoke([](const SocketAddress&,
+                               const std::unique_ptr<folly::IOBuf>& buf) {
+        return buf->computeChainDataLength();
+      }));
+  std::vector<std::unique_ptr<QuicServerConnectionState>> conns;
+  conns.reserve(kNumConnections);
+  auto heapBefore = heapInUse();
+  for (size_t i = 0; i < kNumConnections; i++) {
+    auto conn = createConn(numStreams);
+    simulateBurst(*conn, sock, numPackets, numStreams);
+    if (hibernate) {
+      hibernateConnection(*conn);
+    }
+    conns.push_back(std::move(conn));
+  }
+  counters["bytes_per_conn"] = (heapInUse() - heapBefore) / kNumConnections;
+}
+
+BENCHMARK_COUNTERS(idle_100Packets_1Stream, counters) {
+  benchmarkIdleConnectionMemory(counters, 100, 1, false);
+}
+
+BENCHMARK_COUNTERS(idle_100Packets_1Stream_hibernated, counters) {
+  benchmarkIdleConnectionMemory(counters, 100, 1, true);
+}
+
+BENCHMARK_COUNTERS(idle_1kPackets_10Streams, counters) {
+  benchmarkIdleConnectionMemory(counters, 1000, 10, false);
+}
+
+BENCHMARK_COUNTERS(idle_1kPackets_10Streams_hibernated, counters) {
+  benchmarkIdleConnectionMemory(counters, 1000, 10, true);
+}
+
+int main(int argc, char** argv) {
+  facebook::initFacebook(&argc, &argv);
+  runBenchmarks();
+  return 0;
+}
@@ -35,6 +35,11 @@ class MockCongestionController : public CongestionController {
   MOCK_METHOD(uint64_t, getWritableBytes, (), (const));
   MOCK_METHOD(uint64_t, getCongestionWindow, (), (const));
   MOCK_METHOD(folly::Optional<Bandwidth>, getBandwidth, (), (const));
+  MOCK_METHOD(
+      folly::Optional<std::chrono::microseconds>,
+      getTimeUntilWritable,
+      (),
+      (const));
   MOCK_METHOD(void, onSpuriousLoss, ());
   MOCK_METHOD(CongestionControlType, type, (), (const));
   MOCK_METHOD(void, setAppIdle, (bool, TimePoint));
@@ -80,6 +85,7 @@ class MockPacer : public Pacer {
       (const));
   MOCK_METHOD(uint64_t, updateAndGetWriteBatchSize, (TimePoint));
   MOCK_METHOD(uint64_t, getCachedWriteBatchSize, (), (const));
+  MOCK_METHOD(std::chrono::microseconds, getWriteInterval, (), (const));
   MOCK_METHOD(void, setAppLimited, (bool));
   MOCK_METHOD(void, onPacketSent, ());
   MOCK_METHOD(void, onPacketsLoss, ());
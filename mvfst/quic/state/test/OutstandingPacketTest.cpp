@@ -14,6 +14,7 @@
 #include <quic/common/test/TestUtils.h>
 #include <quic/logging/test/Mocks.h>
 #include <quic/state/OutstandingPacket.h>
+#include <quic/state/OutstandingPacketList.h>
 #include <quic/state/stream/StreamSendHandlers.h>
 #include <quic/state/test/Mocks.h>
 
@@ -377,4 +378,117 @@ TEST(OutstandingPacketTest, DequeMoveAssignPacketDestructionCallback) {
   EXPECT_EQ(numDestroyCallbacks, maxPackets);
 }
 
+TEST(OutstandingPacketListTest, EraseLeavesOtherIteratorsValid) {
+  OutstandingPacketList packets;
+  for (PacketNum packetNum = 0; packetNum < 10; packetNum++) {
+    packets.emplace_back(makeTestingWritePacket(packetNum, 100, 100));
+  }
+  auto third = packets.begin() + 3;
+  auto seventh = packets.begin() + 7;
+  auto next = packets.erase(packets.begin() + 5);
+  EXPECT_EQ(6, next->packet.header.getPacketSequenceNum());
+  EXPECT_EQ(3, third->packet.header.getPacketSequenceNum());
+  EXPECT_EQ(7, seventh->packet.header.getPacketSequenceNum());
+  packets.erase(third);
+  EXPECT_EQ(8, packets.size());
+  EXPECT_EQ(6, packets[4].packet.header.getPacketSequenceNum());
+
+  std::vector<PacketNum> packetNums;
+  for (const auto& packet : packets) {
+    packetNums.push_back(packet.packet.header.getPacketSequenceNum());
+  }
+  EXPECT_EQ(std::vector<PacketNum>({0, 1, 2, 4, 6, 7, 8, 9}), packetNums);
+  packetNums.clear();
+  for (auto it = packets.rbegin(); it != packets.rend(); it++) {
+    packetNums.push_back(it->packet.header.getPacketSequenceNum());
+  }
+  EXPECT_EQ(std::vector<PacketNum>({9, 8, 7, 6, 4, 2, 1, 0}), packetNums);
+
+  // Erasing at either end reclaims the tombstones next to it.
+  packets.erase(packets.begin() + 4, packets.end());
+  EXPECT_EQ(4, packets.size());
+  EXPECT_EQ(4, packets.back().packet.header.getPacketSequenceNum());
+  packets.pop_front();
+  EXPECT_EQ(1, packets.front().packet.header.getPacketSequenceNum());
+}
+
+TEST(OutstandingPacketListTest, UpperBound) {
+  OutstandingPacketList packets;
+  EXPECT_EQ(packets.end(), packets.upperBound(0));
+  for (PacketNum packetNum = 10; packetNum < 1000; packetNum += 2) {
+    packets.emplace_back(makeTestingWritePacket(packetNum, 100, 100));
+  }
+  EXPECT_EQ(packets.begin(), packets.upperBound(5));
+  EXPECT_EQ(packets.end(), packets.upperBound(998));
+  EXPECT_EQ(14, packets.upperBound(12)->packet.header.getPacketSequenceNum());
+  EXPECT_EQ(14, packets.upperBound(13)->packet.header.getPacketSequenceNum());
+
+  // Tombstones keep the lookup working and are skipped over.
+  packets.erase(packets.upperBound(13), packets.upperBound(20));
+  EXPECT_EQ(22, packets.upperBound(13)->packet.header.getPacketSequenceNum());
+
+  // Dense packet numbers take the direct index path.
+  OutstandingPacketList dense;
+  for (PacketNum packetNum = 100; packetNum < 200; packetNum++) {
+    dense.emplace_back(makeTestingWritePacket(packetNum, 100, 100));
+  }
+  EXPECT_EQ(151, dense.upperBound(150)->packet.header.getPacketSequenceNum());
+}
+
+TEST(OutstandingPacketListTest, InsertKeepsOrderAcrossTombstones) {
+  OutstandingPacketList packets;
+  for (PacketNum packetNum = 0; packetNum < 1000; packetNum += 10) {
+    packets.emplace_back(makeTestingWritePacket(packetNum, 100, 100));
+  }
+  // Leave a run of tombstones in the middle, more than there are live
+  // packets, so the next insertion compacts.
+  packets.erase(packets.begin() + 10, packets.begin() + 90);
+  EXPECT_EQ(20, packets.size());
+  auto pos = std::find_if(packets.begin(), packets.end(), [](const auto& p) {
+    return p.packet.header.getPacketSequenceNum() > 95;
+  });
+  EXPECT_EQ(900, pos->packet.header.getPacketSequenceNum());
+  auto inserted = packets.emplace(pos, makeTestingWritePacket(95, 100, 100));
+  EXPECT_EQ(95, inserted->packet.header.getPacketSequenceNum());
+  EXPECT_EQ(21, packets.size());
+  EXPECT_TRUE(std::is_sorted(
+      packets.begin(), packets.end(), [](const auto& a, const auto& b) {
+        return a.packet.header.getPacketSequenceNum() <
+            b.packet.header.getPacketSequenceNum();
+      }));
+  EXPECT_EQ(900, packets.upperBound(95)->packet.header.getPacketSequenceNum());
+  EXPECT_EQ(95, packets.upperBound(90)->packet.header.getPacketSequenceNum());
+}
+
+TEST(OutstandingPacketListTest, MoveLeavesSourceEmpty) {
+  OutstandingPacketList packets;
+  for (PacketNum packetNum = 0; packetNum < 10; packetNum++) {
+    packets.emplace_back(makeTestingWritePacket(packetNum, 100, 100));
+  }
+  packets.erase(packets.begin() + 4);
+
+  OutstandingPacketList moved(std::move(packets));
+  EXPECT_EQ(9, moved.size());
+  EXPECT_EQ(5, moved[4].packet.header.getPacketSequenceNum());
+  EXPECT_TRUE(packets.empty());
+  EXPECT_EQ(0, packets.size());
+  EXPECT_EQ(packets.begin(), packets.end());
+  EXPECT_EQ(packets.end(), packets.upperBound(5));
+
+  // The moved-from list is usable again.
+  packets.emplace_back(makeTestingWritePacket(20, 100, 100));
+  EXPECT_EQ(1, packets.size());
+  EXPECT_EQ(20, packets.front().packet.header.getPacketSequenceNum());
+
+  OutstandingPacketList assigned;
+  assigned.emplace_back(makeTestingWritePacket(30, 100, 100));
+  assigned = std::move(moved);
+  EXPECT_EQ(9, assigned.size());
+  EXPECT_EQ(9, assigned.back().packet.header.getPacketSequenceNum());
+  EXPECT_TRUE(moved.empty());
+  EXPECT_EQ(moved.begin(), moved.end());
+  moved.emplace_back(makeTestingWritePacket(40, 100, 100));
+  EXPECT_EQ(40, moved.back().packet.header.getPacketSequenceNum());
+}
+
 } // namespace quic::test
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <quic/fizz/server/handshake/FizzServerQuicHandshakeContext.h>
+#include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/PmtuDiscovery.h>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+class PmtuDiscoveryTest : public Test {
+ public:
+  void SetUp() override {
+    conn_ = std::make_unique<QuicServerConnectionState>(
+        FizzServerQuicHandshakeContext::Builder().build());
+    conn_->transportSettings.enablePmtuDiscovery = true;
+    conn_->transportSettings.maxPmtuProbeSize = 1472;
+    conn_->udpSendPacketLen = 1252;
+    conn_->peerMaxUdpPayloadSize = 1472;
+  }
+
+  // sends a probe of the next size and returns the size
+  uint64_t sendProbe() {
+    auto size = getNextPmtuProbeSize(*conn_, now_);
+    CHECK(size);
+    onPmtuProbeSent(*conn_, nextPacketNum_++, *size);
+    return *size;
+  }
+
+ protected:
+  std::unique_ptr<QuicServerConnectionState> conn_;
+  TimePoint now_{Clock::now()};
+  PacketNum nextPacketNum_{10};
+};
+
+TEST_F(PmtuDiscoveryTest, Disabled) {
+  conn_->transportSettings.enablePmtuDiscovery = false;
+  startPmtuDiscovery(*conn_);
+  EXPECT_FALSE(conn_->pmtuDiscovery);
+  EXPECT_FALSE(getNextPmtuProbeSize(*conn_, now_));
+}
+
+TEST_F(PmtuDiscoveryTest, PeerLimitsSearch) {
+  conn_->peerMaxUdpPayloadSize = conn_->udpSendPacketLen;
+  startPmtuDiscovery(*conn_);
+  EXPECT_FALSE(conn_->pmtuDiscovery);
+}
+
+TEST_F(PmtuDiscoveryTest, Search) {
+  startPmtuDiscovery(*conn_);
+  ASSERT_TRUE(conn_->pmtuDiscovery);
+
+  EXPECT_EQ(sendProbe(), 1362);
+  // one probe at a time
+  EXPECT_FALSE(getNextPmtuProbeSize(*conn_, now_));
+  onPmtuProbeAcked(*conn_, now_);
+  EXPECT_EQ(conn_->udpSendPacketLen, 1362);
+
+  // the same size is retried until maxPmtuProbes probes got lost
+  for (int i = 0; i < conn_->transportSettings.maxPmtuProbes; i++) {
+    EXPECT_EQ(sendProbe(), 1417);
+    onPmtuProbeLost(*conn_, now_);
+  }
+  EXPECT_EQ(conn_->udpSendPacketLen, 1362);
+  EXPECT_EQ(conn_->pmtuDiscovery->upperSize, 1416);
+
+  EXPECT_EQ(sendProbe(), 1389);
+  onPmtuProbeAcked(*conn_, now_);
+  EXPECT_EQ(sendProbe(), 1403);
+  onPmtuProbeAcked(*conn_, now_);
+  EXPECT_EQ(conn_->udpSendPacketLen, 1403);
+
+  // done until the raise timer fires, then search up to the limit again
+  EXPECT_FALSE(getNextPmtuProbeSize(*conn_, now_));
+  now_ += conn_->transportSettings.pmtuRaiseInterval;
+  EXPECT_EQ(getNextPmtuProbeSize(*conn_, now_), 1438);
+}
+
+TEST_F(PmtuDiscoveryTest, MsgSizeError) {
+  startPmtuDiscovery(*conn_);
+  ASSERT_TRUE(conn_->pmtuDiscovery);
+  EXPECT_EQ(sendProbe(), 1362);
+  onPmtuProbeAcked(*conn_, now_);
+  EXPECT_EQ(conn_->udpSendPacketLen, 1362);
+
+  // a probe that does not fit is left to the loss detection
+  EXPECT_EQ(sendProbe(), 1417);
+  onPmtuMsgSizeError(*conn_, 1417, now_);
+  EXPECT_EQ(conn_->udpSendPacketLen, 1362);
+  onPmtuProbeLost(*conn_, now_);
+
+  // the path shrank under the current size: fall back and search below it
+  onPmtuMsgSizeError(*conn_, 1362, now_);
+  EXPECT_EQ(conn_->udpSendPacketLen, 1252);
+  EXPECT_EQ(conn_->pmtuDiscovery->baseSize, 1252);
+  EXPECT_EQ(conn_->pmtuDiscovery->upperSize, 1361);
+  EXPECT_EQ(getNextPmtuProbeSize(*conn_, now_), 1307);
+
+  // nothing smaller to fall back to
+  onPmtuMsgSizeError(*conn_, 1252, now_);
+  EXPECT_EQ(conn_->udpSendPacketLen, 1252);
+}
+
+} // namespace test
+} // namespace quic
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <quic/fizz/server/handshake/FizzServerQuicHandshakeContext.h>
+#include <quic/server/state/ServerStateMachine.h>
+#include <quic/state/QuicAckFrequencyFunctions.h>
+#include <quic/state/test/Mocks.h>
+
+using namespace testing;
+
+namespace quic {
+namespace test {
+
+class AckFrequencyPolicyTest : public Test {
+ public:
+  void SetUp() override {
+    conn_ = std::make_unique<QuicServerConnectionState>(
+        FizzServerQuicHandshakeContext::Builder().build());
+    conn_->transportSettings.ackFrequencyPolicy = AckFrequencyPolicyConfig();
+    conn_->peerMinAckDelay = 1ms;
+    conn_->udpSendPacketLen = 1000;
+    conn_->lossState.srtt = 40ms;
+    conn_->lossState.maxAckDelay = 25ms;
+    auto cc = std::make_unique<NiceMock<MockCongestionController>>();
+    cc_ = cc.get();
+    conn_->congestionController = std::move(cc);
+    setCwndPackets(100);
+  }
+
+  void setCwndPackets(uint64_t packets) {
+    ON_CALL(*cc_, getCongestionWindow())
+        .WillByDefault(Return(packets * conn_->udpSendPacketLen));
+  }
+
+  const AckFrequencyFrame* lastFrame() const {
+    const AckFrequencyFrame* frame = nullptr;
+    for (const auto& pending : conn_->pendingEvents.frames) {
+      if (pending.asAckFrequencyFrame()) {
+        frame = pending.asAckFrequencyFrame();
+      }
+    }
+    return frame;
+  }
+
+ protected:
+  std::unique_ptr<QuicServerConnectionState> conn_;
+  MockCongestionController* cc_;
+  TimePoint now_{Clock::now()};
+};
+
+TEST_F(AckFrequencyPolicyTest, SizedFromCwndAndRtt) {
+  updatePeerAckFrequency(*conn_, now_, false);
+  auto frame = lastFrame();
+  ASSERT_NE(frame, nullptr);
+  // 100 packets, 4 ACKs per RTT
+  EXPECT_EQ(frame->packetTolerance, 25);
+  EXPECT_EQ(frame->updateMaxAckDelay, 10000);
+  EXPECT_EQ(frame->reorderThreshold, conn_->lossState.reorderingThreshold);
+}
+
+TEST_F(AckFrequencyPolicyTest, Bounds) {
+  conn_->lossState.srtt = 200ms;
+  setCwndPackets(10000);
+  updatePeerAckFrequency(*conn_, now_, false);
+  auto frame = lastFrame();
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(frame->packetTolerance, 64);
+  // capped by the peer's max_ack_delay
+  EXPECT_EQ(frame->updateMaxAckDelay, 25000);
+
+  conn_->pendingEvents.frames.clear();
+  conn_->lossState.srtt = 2ms;
+  setCwndPackets(4);
+  updatePeerAckFrequency(*conn_, now_ + 1s, false);
+  frame = lastFrame();
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(frame->packetTolerance, 2);
+  // not below the peer's min_ack_delay
+  EXPECT_EQ(frame->updateMaxAckDelay, 1000);
+}
+
+TEST_F(AckFrequencyPolicyTest, OncePerRtt) {
+  updatePeerAckFrequency(*conn_, now_, false);
+  EXPECT_EQ(conn_->pendingEvents.frames.size(), 1);
+  setCwndPackets(200);
+  updatePeerAckFrequency(*conn_, now_ + 10ms, false);
+  EXPECT_EQ(conn_->pendingEvents.frames.size(), 1);
+  updatePeerAckFrequency(*conn_, now_ + 40ms, false);
+  EXPECT_EQ(conn_->pendingEvents.frames.size(), 2);
+  EXPECT_EQ(lastFrame()->packetTolerance, 50);
+  // nothing changed
+  updatePeerAckFrequency(*conn_, now_ + 80ms, false);
+  EXPECT_EQ(conn_->pendingEvents.frames.size(), 2);
+}
+
+TEST_F(AckFrequencyPolicyTest, LossRecovery) {
+  updatePeerAckFrequency(*conn_, now_, false);
+  EXPECT_EQ(lastFrame()->packetTolerance, 25);
+  // a loss lowers the threshold right away
+  updatePeerAckFrequency(*conn_, now_ + 1ms, true);
+  EXPECT_EQ(conn_->pendingEvents.frames.size(), 2);
+  EXPECT_EQ(lastFrame()->packetTolerance, 2);
+  EXPECT_EQ(lastFrame()->reorderThreshold, kReorderingThreshold);
+  // and it is raised again one RTT later
+  updatePeerAckFrequency(*conn_, now_ + 45ms, false);
+  EXPECT_EQ(conn_->pendingEvents.frames.size(), 3);
+  EXPECT_EQ(lastFrame()->packetTolerance, 25);
+}
+
+TEST_F(AckFrequencyPolicyTest, NoCongestionController) {
+  conn_->congestionController.reset();
+  // the first update goes by the bytes in flight
+  conn_->lossState.inflightBytes = 40 * conn_->udpSendPacketLen;
+  conn_->lossState.totalBytesAcked = 1000 * conn_->udpSendPacketLen;
+  updatePeerAckFrequency(*conn_, now_, false);
+  auto frame = lastFrame();
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(frame->packetTolerance, 10);
+  // later ones by the bytes acknowledged per RTT, 160 packets in 2 RTTs
+  conn_->lossState.totalBytesAcked += 160 * conn_->udpSendPacketLen;
+  updatePeerAckFrequency(*conn_, now_ + 80ms, false);
+  ASSERT_EQ(conn_->pendingEvents.frames.size(), 2);
+  EXPECT_EQ(lastFrame()->packetTolerance, 20);
+  // a loss still switches to the recovery threshold
+  updatePeerAckFrequency(*conn_, now_ + 81ms, true);
+  ASSERT_EQ(conn_->pendingEvents.frames.size(), 3);
+  EXPECT_EQ(lastFrame()->packetTolerance, 2);
+}
+
+TEST_F(AckFrequencyPolicyTest, SequenceNumbers) {
+  updatePeerAckFrequency(*conn_, now_, false);
+  updatePeerAckFrequency(*conn_, now_ + 1ms, true);
+  ASSERT_EQ(conn_->pendingEvents.frames.size(), 2);
+  EXPECT_EQ(
+      conn_->pendingEvents.frames[0].asAckFrequencyFrame()->sequenceNumber, 0);
+  EXPECT_EQ(
+      conn_->pendingEvents.frames[1].asAckFrequencyFrame()->sequenceNumber, 1);
+}
+
+} // namespace test
+} // namespace quic
@@ -132,6 +132,26 @@ TEST_P(UpdateLargestReceivedPacketNumTest, ReceiveOldWithGap) {
       currentLargestReceived);
 }
 
+TEST_P(UpdateLargestReceivedPacketNumTest, EcnCounts) {
+  QuicServerConnectionState conn(
+      FizzServerQuicHandshakeContext::Builder().build());
+  auto& ackState = getAckState(conn, GetParam());
+  // Nothing is counted unless reading ECN is enabled.
+  updateEcnCountsOnRecvPacket(conn, ackState, kEcnCE);
+  EXPECT_EQ(ackState.ecnCECountReceived, 0);
+
+  conn.transportSettings.readEcnOnIngress = true;
+  // Only the two low bits of the TOS byte are the ECN codepoint.
+  updateEcnCountsOnRecvPacket(conn, ackState, 0xb8 | kEcnECT0);
+  updateEcnCountsOnRecvPacket(conn, ackState, kEcnECT0);
+  updateEcnCountsOnRecvPacket(conn, ackState, kEcnECT1);
+  updateEcnCountsOnRecvPacket(conn, ackState, kEcnCE);
+  updateEcnCountsOnRecvPacket(conn, ackState, kEcnNotECT);
+  EXPECT_EQ(ackState.ecnECT0CountReceived, 2);
+  EXPECT_EQ(ackState.ecnECT1CountReceived, 1);
+  EXPECT_EQ(ackState.ecnCECountReceived, 1);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     UpdateLargestReceivedPacketNumTests,
     UpdateLargestReceivedPacketNumTest,
@@ -1226,6 +1246,28 @@ TEST_F(QuicStateFunctionsTest, EarliestLossTimer) {
   EXPECT_EQ(currentTime - 1s, earliestLossTimer(conn).first.value());
 }
 
+TEST_F(QuicStateFunctionsTest, HibernateConnection) {
+  QuicServerConnectionState conn(
+      FizzServerQuicHandshakeContext::Builder().build());
+  conn.pendingEvents.frames.resize(100, HandshakeDoneFrame());
+  conn.pendingEvents.frames.clear();
+  conn.lastProcessedAckEvents.reserve(10);
+  conn.cryptoState->oneRttStream.retransmissionBuffer.reserve(10);
+  auto ackDelayExponent = conn.transportSettings.ackDelayExponent;
+
+  hibernateConnection(conn);
+  EXPECT_EQ(conn.pendingEvents.frames.capacity(), 0);
+  EXPECT_EQ(conn.lastProcessedAckEvents.capacity(), 0);
+  EXPECT_EQ(
+      conn.cryptoState->oneRttStream.retransmissionBuffer.bucket_count(), 0);
+  EXPECT_EQ(conn.transportSettings.ackDelayExponent, ackDelayExponent);
+
+  // non-empty containers are left alone
+  conn.pendingEvents.frames.emplace_back(HandshakeDoneFrame());
+  hibernateConnection(conn);
+  EXPECT_EQ(conn.pendingEvents.frames.size(), 1);
+}
+
 TEST_P(QuicStateFunctionsTest, CloseTranportStateChange) {
   QuicConnectionStateBase conn(QuicNodeType::Server);
   getAckState(conn, GetParam()).nextPacketNum = kMaxPacketNumber - 2;
@@ -745,6 +745,28 @@ TEST_P(QuicStreamManagerTest, StreamPriorityExcludesControl) {
   manager.removeClosedStream(stream->id);
 }
 
+TEST_P(QuicStreamManagerTest, Compact) {
+  auto& manager = *conn.streamManager;
+  auto stream = manager.createNextBidirectionalStream().value();
+  for (StreamId id = 0; id < 1000; id += 4) {
+    manager.addDeliverable(id);
+  }
+  for (StreamId id = 0; id < 1000; id += 4) {
+    manager.removeDeliverable(id);
+  }
+  stream->retransmissionBuffer.reserve(100);
+  EXPECT_GT(manager.deliverableStreams().bucket_count(), 0);
+
+  manager.compact();
+  EXPECT_EQ(manager.deliverableStreams().bucket_count(), 0);
+  EXPECT_EQ(stream->retransmissionBuffer.bucket_count(), 0);
+  // nothing else changed
+  EXPECT_EQ(manager.getStream(stream->id), stream);
+  EXPECT_FALSE(manager.hasDeliverable());
+  manager.addDeliverable(stream->id);
+  EXPECT_TRUE(manager.hasDeliverable());
+}
+
 INSTANTIATE_TEST_SUITE_P(
     QuicStreamManagerTest,
     QuicStreamManagerTest,
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <glog/logging.h>
+
+#include <folly/init/Init.h>
+#include <folly/portability/GFlags.h>
+
+#include <quic/logging/BinaryQLogReader.h>
+
+DEFINE_string(input, "", "Binary qlog file written by BinaryQLogWriter");
+DEFINE_string(output_dir, ".", "Directory to write one qlog per connection to");
+DEFINE_bool(pretty, false, "Write pretty printed JSON");
+
+int main(int argc, char* argv[]) {
+#if FOLLY_HAVE_LIBGFLAGS
+  // Enable glog logging to stderr by default.
+  gflags::SetCommandLineOptionWithMode(
+      "logtostderr", "1", gflags::SET_FLAGS_DEFAULT);
+#endif
+  gflags::ParseCommandLineFlags(&argc, &argv, false);
+  folly::Init init(&argc, &argv);
+
+  if (FLAGS_input.empty()) {
+    LOG(ERROR) << "--input is required";
+    return 1;
+  }
+  quic::BinaryQLogReader::Result result;
+  try {
+    result = quic::BinaryQLogReader::readFile(FLAGS_input);
+  } catch (const std::exception& ex) {
+    LOG(ERROR) << "Failed to read " << FLAGS_input << ": " << ex.what();
+    return 1;
+  }
+  if (result.droppedEvents) {
+    LOG(WARNING) << result.droppedEvents
+                 << " events were dropped while logging, the qlogs are "
+                    "incomplete";
+  }
+  for (const auto& connection : result.connections) {
+    connection->outputLogsToFile(FLAGS_output_dir, FLAGS_pretty);
+  }
+  LOG(INFO) << "Wrote " << result.connections.size() << " qlogs to "
+            << FLAGS_output_dir;
+  return 0;
+}
@@ -9,6 +9,7 @@
 
 #include <fizz/crypto/Utils.h>
 #include <folly/init/Init.h>
+#include <folly/io/Cursor.h>
 #include <folly/io/async/HHWheelTimer.h>
 #include <folly/portability/GFlags.h>
 #include <folly/stats/Histogram.h>
@@ -19,6 +20,7 @@
 #include <quic/common/test/TestUtils.h>
 #include <quic/congestion_control/ServerCongestionControllerFactory.h>
 #include <quic/fizz/client/handshake/FizzClientQuicHandshakeContext.h>
+#include <quic/samples/echo/LogQuicStats.h>
 #include <quic/server/AcceptObserver.h>
 #include <quic/server/QuicServer.h>
 #include <quic/server/QuicServerTransport.h>
@@ -99,6 +101,33 @@ DEFINE_uint32(
     max_ack_receive_timestamps_to_send,
     quic::kMaxReceivedPktsTimestampsStored,
     "Controls how many packet receive timestamps the peer should send");
+DEFINE_bool(
+    datagram,
+    false,
+    "Send datagrams instead of stream data. Latencies are only meaningful "
+    "with client and server on the same host");
+DEFINE_uint32(
+    datagram_size,
+    1200,
+    "Datagram payload size, capped at the peer's datagram size limit");
+DEFINE_uint64(
+    datagram_rate,
+    0,
+    "Datagrams sent per second. 0 (the default) offers a burst every event "
+    "loop, i.e. as many datagrams as the transport accepts");
+DEFINE_uint32(datagram_burst, 1, "Number of datagrams written back to back");
+DEFINE_bool(
+    datagram_frame_per_packet,
+    true,
+    "Send one datagram per packet instead of packing several into one");
+DEFINE_uint32(
+    datagram_send_buffer,
+    quic::kDefaultMaxDatagramsBuffered,
+    "Number of datagrams the server buffers before rejecting writes");
+DEFINE_uint32(
+    datagram_recv_buffer,
+    quic::kDefaultMaxDatagramsBuffered,
+    "Number of datagrams the client buffers before dropping them");
 
 namespace quic {
 namespace tperf {
@@ -172,6 +201,157 @@ class TPerfAcceptObserver : public AcceptObserver {
   std::unique_ptr<TPerfObserver> tperfObserver_;
 };
 
+/**
+ * Counts the datagrams the client had to drop because its read buffer was
+ * full.
+ */
+class TPerfQuicStats : public samples::LogQuicStats {
+ public:
+  TPerfQuicStats() : LogQuicStats("tperf_client") {}
+
+  void onDatagramDroppedOnRead() override {
+    datagramsDroppedOnRead_++;
+    LogQuicStats::onDatagramDroppedOnRead();
+  }
+
+  uint64_t getDatagramsDroppedOnRead() const {
+    return datagramsDroppedOnRead_;
+  }
+
+ private:
+  uint64_t datagramsDroppedOnRead_{0};
+};
+
+/**
+ * Every tperf datagram starts with the sequence number among the datagrams
+ * the transport accepted, the steady clock time it was written at, and the
+ * number of writes the transport rejected so far. The rest is padding.
+ */
+struct DatagramHeader {
+  static constexpr size_t kSize = 3 * sizeof(uint64_t);
+
+  uint64_t seq;
+  uint64_t sendTimeUs;
+  uint64_t sendBufferDrops;
+};
+
+uint64_t steadyTimeUs(TimePoint time) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             time.time_since_epoch())
+      .count();
+}
+
+/**
+ * Writes bursts of fixed size datagrams. With a rate the bursts are spread
+ * evenly over time, and bursts that became due while the timer was late are
+ * sent on the next tick rather than skipped. Without one a burst is offered
+ * every event loop.
+ */
+class DatagramSender : public folly::HHWheelTimer::Callback,
+                       public folly::EventBase::LoopCallback {
+ public:
+  DatagramSender(
+      folly::EventBase* evb,
+      std::shared_ptr<quic::QuicSocket> sock,
+      uint32_t size,
+      uint64_t rate,
+      uint32_t burst)
+      : evb_(evb),
+        sock_(std::move(sock)),
+        size_(size),
+        rate_(rate),
+        burst_(std::max<uint32_t>(burst, 1)) {}
+
+  ~DatagramSender() override {
+    stop();
+  }
+
+  void start() {
+    auto sizeLimit = sock_->getDatagramSizeLimit();
+    if (sizeLimit < DatagramHeader::kSize) {
+      LOG(ERROR) << "Peer does not accept datagrams of at least "
+                 << DatagramHeader::kSize << " bytes";
+      return;
+    }
+    if (size_ < DatagramHeader::kSize || size_ > sizeLimit) {
+      size_ = std::clamp<uint32_t>(size_, DatagramHeader::kSize, sizeLimit);
+      LOG(WARNING) << "Datagram size adjusted to " << size_;
+    }
+    LOG(INFO) << "Starting datagram sends to client: size=" << size_
+              << " rate=" << rate_ << "/s burst=" << burst_;
+    startTime_ = Clock::now();
+    if (rate_ == 0) {
+      evb_->runInLoop(this);
+    } else {
+      interval_ = std::max<std::chrono::milliseconds>(
+          1ms, std::chrono::milliseconds(burst_ * 1000 / rate_));
+      timeoutExpired();
+    }
+  }
+
+  void stop() {
+    cancelTimeout();
+    cancelLoopCallback();
+    sock_.reset();
+  }
+
+  void timeoutExpired() noexcept override {
+    auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                         Clock::now() - startTime_)
+                         .count();
+    uint64_t burstsDue = elapsedUs * rate_ / 1000000 / burst_ + 1;
+    while (sock_ && burstsSent_ < burstsDue) {
+      sendBurst();
+    }
+    if (sock_) {
+      evb_->timer().scheduleTimeout(this, interval_);
+    }
+  }
+
+  void callbackCanceled() noexcept override {}
+
+  void runLoopCallback() noexcept override {
+    sendBurst();
+    if (sock_) {
+      evb_->runInLoop(this);
+    }
+  }
+
+ private:
+  void sendBurst() {
+    for (uint32_t i = 0; i < burst_; i++) {
+      auto buf = folly::IOBuf::create(size_);
+      buf->append(size_);
+      memset(
+          buf->writableData() + DatagramHeader::kSize,
+          'd',
+          size_ - DatagramHeader::kSize);
+      folly::io::RWPrivateCursor cursor(buf.get());
+      cursor.writeBE<uint64_t>(seq_);
+      cursor.writeBE<uint64_t>(steadyTimeUs(Clock::now()));
+      cursor.writeBE<uint64_t>(sendBufferDrops_);
+      auto res = sock_->writeDatagram(std::move(buf));
+      if (res.hasError()) {
+        sendBufferDrops_++;
+      } else {
+        seq_++;
+      }
+    }
+    burstsSent_++;
+  }
+
+  folly::EventBase* evb_;
+  std::shared_ptr<quic::QuicSocket> sock_;
+  uint32_t size_;
+  uint64_t rate_;
+  uint32_t burst_;
+  std::chrono::milliseconds interval_{1ms};
+  TimePoint startTime_;
+  uint64_t burstsSent_{0};
+  uint64_t seq_{0};
+  uint64_t sendBufferDrops_{0};
+};
+
 } // namespace
 
 class ServerStreamHandler : public quic::QuicSocket::ConnectionSetupCallback,
@@ -217,6 +397,7 @@ class ServerStreamHandler : public quic::QuicSocket::ConnectionSetupCallback,
 
   void onConnectionEnd() noexcept override {
     LOG(INFO) << "Socket closed";
+    datagramSender_.reset();
     sock_.reset();
   }
 
@@ -227,12 +408,23 @@ class ServerStreamHandler : public quic::QuicSocket::ConnectionSetupCallback,
   void onConnectionError(QuicError error) noexcept override {
     LOG(ERROR) << "Conn errorCoded=" << toString(error.code)
                << ", errorMsg=" << error.message;
+    datagramSender_.reset();
   }
 
   void onTransportReady() noexcept override {
     if (FLAGS_max_pacing_rate != std::numeric_limits<uint64_t>::max()) {
       sock_->setMaxPacingRate(FLAGS_max_pacing_rate);
     }
+    if (FLAGS_datagram) {
+      datagramSender_ = std::make_unique<DatagramSender>(
+          evb_,
+          sock_,
+          FLAGS_datagram_size,
+          FLAGS_datagram_rate,
+          FLAGS_datagram_burst);
+      datagramSender_->start();
+      return;
+    }
     LOG(INFO) << "Starting sends to client.";
     for (uint32_t i = 0; i < numStreams_; i++) {
       createNewStream();
@@ -359,6 +551,7 @@ class ServerStreamHandler : public quic::QuicSocket::ConnectionSetupCallback,
   std::set<quic::StreamId> streamsHavingDSRSender_;
   folly::AsyncUDPSocket& udpSock_;
   bool dsrEnabled_;
+  std::unique_ptr<DatagramSender> datagramSender_;
 };
 
 class TPerfServerTransportFactory : public quic::QuicServerTransportFactory {
@@ -477,6 +670,11 @@ class TPerfServer {
                FLAGS_max_ack_receive_timestamps_to_send,
            .receiveTimestampsExponent = kDefaultReceiveTimestampsExponent});
     }
+    if (FLAGS_datagram) {
+      settings.datagramConfig.enabled = true;
+      settings.datagramConfig.framePerPacket = FLAGS_datagram_frame_per_packet;
+      settings.datagramConfig.writeBufSize = FLAGS_datagram_send_buffer;
+    }
 
     server_->setCongestionControllerFactory(
         std::make_shared<ServerCongestionControllerFactory>());
@@ -508,6 +706,7 @@ class TPerfClient : public quic::QuicSocket::ConnectionSetupCallback,
                     public quic::QuicSocket::ConnectionCallback,
                     public quic::QuicSocket::ReadCallback,
                     public quic::QuicSocket::WriteCallback,
+                    public quic::QuicSocket::DatagramCallback,
                     public folly::HHWheelTimer::Callback {
  public:
   TPerfClient(
@@ -535,6 +734,10 @@ class TPerfClient : public quic::QuicSocket::ConnectionSetupCallback,
   void timeoutExpired() noexcept override {
     quicClient_->closeNow(folly::none);
     constexpr double bytesPerMegabit = 131072;
+    if (FLAGS_datagram) {
+      reportDatagrams();
+      return;
+    }
     LOG(INFO) << "Received " << receivedBytes_ << " bytes in "
               << duration_.count() << " seconds.";
     LOG(INFO) << "Overall throughput: "
@@ -565,8 +768,74 @@ class TPerfClient : public quic::QuicSocket::ConnectionSetupCallback,
     }
   }
 
+  void reportDatagrams() {
+    constexpr double bytesPerMegabit = 131072;
+    uint64_t received = datagramLatenciesUs_.size();
+    LOG(INFO) << "Received " << received << " datagrams, "
+              << receivedDatagramBytes_ << " bytes in " << duration_.count()
+              << " seconds.";
+    LOG(INFO) << "Delivered rate: "
+              << (receivedDatagramBytes_ / bytesPerMegabit) / duration_.count()
+              << "Mb/s, " << received / duration_.count() << " datagrams/s";
+    if (received == 0) {
+      return;
+    }
+    // Datagrams sent after the last one received are not accounted for.
+    uint64_t sent = maxDatagramSeq_ + 1;
+    uint64_t recvBufferDrops = stats_->getDatagramsDroppedOnRead();
+    uint64_t networkLoss = sent - std::min(sent, received + recvBufferDrops);
+    uint64_t offered = sent + sendBufferDrops_;
+    auto dropRate = [offered](uint64_t drops) {
+      return fmt::format("{} ({:.3f}%)", drops, 100.0 * drops / offered);
+    };
+    LOG(INFO) << "Offered " << offered << " datagrams, dropped "
+              << dropRate(sendBufferDrops_ + recvBufferDrops + networkLoss);
+    LOG(INFO) << "  send buffer: " << dropRate(sendBufferDrops_);
+    LOG(INFO) << "  receive buffer: " << dropRate(recvBufferDrops);
+    LOG(INFO) << "  network: " << dropRate(networkLoss);
+    std::sort(datagramLatenciesUs_.begin(), datagramLatenciesUs_.end());
+    auto percentile = [this, received](double p) {
+      return datagramLatenciesUs_[std::min<uint64_t>(
+          received - 1, static_cast<uint64_t>(p * received))];
+    };
+    LOG(INFO) << fmt::format(
+        "One-way latency (us): p50={} p90={} p99={} p99.9={} max={}",
+        percentile(0.5),
+        percentile(0.9),
+        percentile(0.99),
+        percentile(0.999),
+        datagramLatenciesUs_.back());
+  }
+
   virtual void callbackCanceled() noexcept override {}
 
+  void onDatagramsAvailable() noexcept override {
+    auto datagrams = quicClient_->readDatagrams();
+    if (datagrams.hasError()) {
+      LOG(ERROR) << "TPerfClient failed to read datagrams, error="
+                 << toString(datagrams.error());
+      return;
+    }
+    for (auto& datagram : *datagrams) {
+      auto& bufQueue = datagram.bufQueue();
+      if (bufQueue.chainLength() < DatagramHeader::kSize) {
+        LOG(ERROR) << "TPerfClient got a datagram without header";
+        continue;
+      }
+      folly::io::Cursor cursor(bufQueue.front());
+      DatagramHeader header;
+      header.seq = cursor.readBE<uint64_t>();
+      header.sendTimeUs = cursor.readBE<uint64_t>();
+      header.sendBufferDrops = cursor.readBE<uint64_t>();
+      auto receiveTimeUs = steadyTimeUs(datagram.receiveTimePoint());
+      datagramLatenciesUs_.push_back(
+          receiveTimeUs - std::min(receiveTimeUs, header.sendTimeUs));
+      receivedDatagramBytes_ += bufQueue.chainLength();
+      maxDatagramSeq_ = std::max(maxDatagramSeq_, header.seq);
+      sendBufferDrops_ = std::max(sendBufferDrops_, header.sendBufferDrops);
+    }
+  }
+
   void readAvailable(quic::StreamId streamId) noexcept override {
     auto readData = quicClient_->read(streamId, 0);
     if (readData.hasError()) {
@@ -609,6 +878,10 @@ class TPerfClient : public quic::QuicSocket::ConnectionSetupCallback,
 
   void onTransportReady() noexcept override {
     LOG(INFO) << "TPerfClient: onTransportReady";
+    if (FLAGS_datagram && !timerScheduled_) {
+      timerScheduled_ = true;
+      eventBase_.timer().scheduleTimeout(this, duration_);
+    }
   }
 
   void onStopSending(
@@ -695,6 +968,13 @@ class TPerfClient : public quic::QuicSocket::ConnectionSetupCallback,
                FLAGS_max_ack_receive_timestamps_to_send,
            .receiveTimestampsExponent = kDefaultReceiveTimestampsExponent});
     }
+    if (FLAGS_datagram) {
+      settings.datagramConfig.enabled = true;
+      settings.datagramConfig.readBufSize = FLAGS_datagram_recv_buffer;
+      auto res = quicClient_->setDatagramCallback(this);
+      CHECK(res.hasValue()) << res.error();
+      quicClient_->setTransportStatsCallback(stats_);
+    }
     quicClient_->setTransportSettings(settings);
 
     LOG(INFO) << "TPerfClient connecting to " << addr.describe();
@@ -713,6 +993,11 @@ class TPerfClient : public quic::QuicSocket::ConnectionSetupCallback,
   uint64_t receivedBytes_{0};
   uint64_t receivedStreams_{0};
   std::map<quic::StreamId, uint64_t> bytesPerStream_;
+  std::shared_ptr<TPerfQuicStats> stats_{std::make_shared<TPerfQuicStats>()};
+  std::vector<uint64_t> datagramLatenciesUs_;
+  uint64_t receivedDatagramBytes_{0};
+  uint64_t maxDatagramSeq_{0};
+  uint64_t sendBufferDrops_{0};
   folly::Histogram<uint64_t> bytesPerStreamHistogram_{
       1024,
       0,
@@ -1,11 +1,98 @@
 #include "ConnectClient.h"
 
+#include <folly/ScopeGuard.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <proxygen/lib/transport/PersistentQuicPskCache.h>
+#include <proxygen/lib/transport/PersistentQuicTokenCache.h>
+
 using namespace std;
 using namespace folly;
 using namespace proxygen;
 
 namespace MasqueService {
 
+namespace {
+wangle::PersistentCacheConfig resumptionCacheConfig() {
+  return wangle::PersistentCacheConfig::Builder()
+      .setCapacity(1000)
+      .setSyncInterval(std::chrono::seconds(1))
+      .build();
+}
+} // namespace
+
+shared_ptr<quic::QuicPskCache> createPskCache(const string& file) {
+  return make_shared<PersistentQuicPskCache>(file, resumptionCacheConfig());
+}
+
+shared_ptr<quic::QuicTokenCache> createTokenCache(const string& file) {
+  return make_shared<PersistentQuicTokenCache>(file, resumptionCacheConfig());
+}
+
+void applyResumptionSettings(vector<OptionPair>& hops,
+                             shared_ptr<quic::QuicPskCache> pskCache,
+                             shared_ptr<quic::QuicTokenCache> tokenCache,
+                             bool earlyData) {
+  for (auto& hop : hops) {
+    hop.options.pskCache_ = pskCache;
+    hop.options.tokenCache_ = tokenCache;
+    hop.options.earlyData_ = earlyData;
+  }
+}
+
+void applyPmtuDiscoverySettings(vector<OptionPair>& hops) {
+  for (auto& hop : hops) {
+    hop.options.pmtuDiscovery_ = true;
+  }
+}
+
+void applyAckFrequencySettings(vector<OptionPair>& hops) {
+  for (auto& hop : hops) {
+    hop.options.transportSettings.minAckDelay = quic::kDefaultMinAckDelay;
+    hop.options.transportSettings.ackFrequencyPolicy =
+        quic::AckFrequencyPolicyConfig();
+  }
+}
+
+void applyTunnelShapingRate(vector<OptionPair>& hops, uint64_t shapingRate) {
+  for (auto& hop : hops) {
+    hop.options.transportSettings.tunnelCongestionConfig
+        .shapingRateBytesPerSec = shapingRate;
+  }
+}
+
+void applyDatagramPackingSettings(vector<OptionPair>& hops,
+                                  uint32_t packingWindow,
+                                  uint32_t coalesceMaxSize) {
+  for (auto& hop : hops) {
+    hop.options.transportSettings.datagramConfig.packingWindow = packingWindow;
+    hop.options.transportSettings.datagramConfig.coalesceMaxSize =
+        coalesceMaxSize;
+  }
+}
+
+void setTunDeviceMTU(const string& name, size_t mtu) {
+  int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    PLOG(ERROR) << "Unable to set the mtu of " << name;
+    return;
+  }
+  SCOPE_EXIT {
+    ::close(fd);
+  };
+  struct ifreq ifr {};
+  strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
+  ifr.ifr_mtu = static_cast<int>(mtu);
+  if (ioctl(fd, SIOCSIFMTU, &ifr) < 0) {
+    PLOG(ERROR) << "Unable to set the mtu of " << name << " to " << mtu;
+    return;
+  }
+  LOG(INFO) << "Set the mtu of " << name << " to " << mtu;
+}
+
 void TunReadCallback::getReadBuffer(void** buf, size_t* len) noexcept {
   *buf = readBuffer.data();
   *len = readBuffer.size();
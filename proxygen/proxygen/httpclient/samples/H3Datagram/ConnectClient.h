@@ -14,7 +14,34 @@ struct OptionPair {
   std::size_t maxRecvPacketSize = 0;
 };
 
+// Persistent caches for session resumption
+std::shared_ptr<quic::QuicPskCache> createPskCache(const std::string &);
+std::shared_ptr<quic::QuicTokenCache> createTokenCache(const std::string &);
+void applyResumptionSettings(std::vector<OptionPair> &,
+                             std::shared_ptr<quic::QuicPskCache>,
+                             std::shared_ptr<quic::QuicTokenCache>,
+                             bool earlyData);
+// Path MTU discovery on every hop instead of the fixed UDPSendPacketLens,
+// which become the upper bounds of the search
+void applyPmtuDiscoverySettings(std::vector<OptionPair> &);
+// ACK_FREQUENCY on every hop: accept the server's requests and adapt the
+// server's ACK frequency to RTT and congestion window
+void applyAckFrequencySettings(std::vector<OptionPair> &);
+// Shaping rate of the hops using the tunnel congestion controller, in bytes
+// per second
+void applyTunnelShapingRate(std::vector<OptionPair> &, std::uint64_t);
+// Datagram packing of every hop, see quic::DatagramConfig
+void applyDatagramPackingSettings(std::vector<OptionPair> &,
+                                  std::uint32_t packingWindow,
+                                  std::uint32_t coalesceMaxSize);
+
+// Changes the MTU of a tun device, e.g. when the datagram size limit of the
+// tunnel grows
+void setTunDeviceMTU(const std::string &name, std::size_t mtu);
+
 extern std::size_t FIRST_TUN_NUMBER;
+// 0: read all tun devices on the client EventBase
+extern std::size_t TUN_IO_THREADS;
 
 class TunReadCallback
     : public proxygen::TunDevice::ReadCallback
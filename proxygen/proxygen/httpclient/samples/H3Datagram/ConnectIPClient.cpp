@@ -3,6 +3,7 @@
 #include "proxygen/httpserver/samples/masque/Capsule.h"
 #include <folly/executors/GlobalExecutor.h>
 #include <iostream>
+#include <proxygen/lib/transport/Ecn.h>
 #include <proxygen/lib/utils/Logging.h>
 #include <thread>
 
@@ -21,10 +22,16 @@ using namespace MasqueService::Constants;
 namespace MasqueService {
 
 std::size_t FIRST_TUN_NUMBER = 0;
+std::size_t TUN_IO_THREADS = 0;
 
 void ConnectIPClient::ConnectIPTunCallback::onPacket(uint8_t* buffer,
                                                      size_t len) noexcept {
   auto packet = IOBuf::copyBuffer(buffer, len);
+  if (socket->getEventBase()->isInEventBaseThread()) {
+    // the tun device is multiplexed onto the socket's EventBase
+    socket->LayeredMasqueSocket::write(address, packet);
+    return;
+  }
   socket->getEventBase()->runInEventBaseThread(
       [this, packet = std::move(packet)]() mutable {
         socket->LayeredMasqueSocket::write(address, packet);
@@ -35,19 +42,27 @@ void ConnectIPClient::ConnectIPTunCallback::onDataAvailable(
     const SocketAddress&,
     size_t len,
     bool,
-    AsyncUDPSocket::ReadCallback::OnDataAvailableParams) noexcept {
+    AsyncUDPSocket::ReadCallback::OnDataAvailableParams params) noexcept {
   if (!tunDevice) {
     LOG(WARNING) << __func__ << ": Tun device not ready";
     return;
   }
+  // the socket reports the ECN of the outer connection as the tos
+  if (!ecn::decapsulate(readBuffer.data(), len, params.tos)) {
+    return;
+  }
   tunDevice->write(readBuffer.data(), len);
 }
 
 ConnectIPClient::ConnectIPClient(EventBase* eventBase,
                                  vector<OptionPair> hops,
                                  optional<CIDRNetworkV4> manualTunNetwork,
-                                 optional<string> qlogPath)
-    : eventBase(eventBase), hops(hops), tunMTU(-1) {
+                                 optional<string> qlogPath,
+                                 bool binaryQlog)
+    : eventBase(eventBase),
+      hops(hops),
+      tunMTU(-1),
+      tunReactor(eventBase, TUN_IO_THREADS) {
   if (manualTunNetwork) {
     manualGenerator.emplace(*manualTunNetwork);
   }
@@ -65,7 +80,14 @@ ConnectIPClient::ConnectIPClient(EventBase* eventBase,
                                                move(baseSocket),
                                                outerMostSocket);
   }
-  tunMTU = hops.back().UDPSendPacketLen - H3_OVERHEAD - CONNECT_IP_OVERHEAD + 28;
+  // the tun devices get whole IP packets, whatever is left of a datagram
+  // after the HTTP/3 and CONNECT-IP framing
+  if (hops.back().UDPSendPacketLen <= H3_OVERHEAD + CONNECT_IP_OVERHEAD) {
+    throw std::runtime_error(
+        "UDPSendPacketLen " + to_string(hops.back().UDPSendPacketLen) +
+        " leaves no room for the CONNECT-IP payload");
+  }
+  tunMTU = hops.back().UDPSendPacketLen - H3_OVERHEAD - CONNECT_IP_OVERHEAD;
   auto* releasedBaseSocket =
       dynamic_cast<LayeredConnectIPSocket*>(baseSocket.release());
   if (!releasedBaseSocket) {
@@ -75,6 +97,10 @@ ConnectIPClient::ConnectIPClient(EventBase* eventBase,
   // socket is not connected yet, set qlogpath
   if (qlogPath) {
     socket->setQLogPath(*qlogPath);
+    if (binaryQlog) {
+      socket->setBinaryQLogWriter(
+          make_shared<quic::BinaryQLogWriter>(*qlogPath));
+    }
   }
 }
 
@@ -85,28 +111,62 @@ void ConnectIPClient::createTunDevice(HTTPCodec::StreamID streamID,
         tunDevices.at(streamID).second);
   // create the tun device
   unique_ptr<TunDevice> tunDevice;
-  size_t tunNr = FIRST_TUN_NUMBER + streamID;
   if (manualGenerator) {
     auto ip = manualGenerator->generateSubNet();
-    tunDevice = make_unique<TunDevice>("tun_client_" + to_string(tunNr),
+    tunDevice = make_unique<TunDevice>(tunDeviceName(streamID),
                                        make_pair(ip.first, 31),
-                                       tunMTU,
+                                       currentTunMTU(),
                                        address.ipAddress.first.asV4());
   } else {
     tunDevice =
-        make_unique<TunDevice>("tun_client_" + to_string(tunNr),
+        make_unique<TunDevice>(tunDeviceName(streamID),
                                make_pair(address.ipAddress.first.asV4(), 31),
-                               tunMTU);
+                               currentTunMTU());
   }
   auto* tunPtr = tunDevice.get();
   tunDevice->setReadCallback(tunDevices.at(streamID).second.get());
   tunDevices.at(streamID).first = std::move(tunDevice);
-  // run the tun device in a separate thread
-  tunPtr->run();
   tunDevices.at(streamID).second->setTunDevice(tunPtr);
+  // register the tun fd with the reactor instead of running a read thread
+  tunHandlers[streamID] = tunReactor.attach(
+      tunPtr->getFd(), tunDevices.at(streamID).second.get(), tunMTU);
+}
+
+string ConnectIPClient::tunDeviceName(HTTPCodec::StreamID streamID) const {
+  return "tun_client_" + to_string(FIRST_TUN_NUMBER + streamID);
+}
+
+size_t ConnectIPClient::currentTunMTU() const {
+  if (!hops.back().options.pmtuDiscovery_) {
+    return tunMTU;
+  }
+  auto datagramSizeLimit = socket->getDatagramSizeLimit();
+  if (!datagramSizeLimit) {
+    return tunMTU;
+  }
+  if (*datagramSizeLimit <= CONNECT_IP_OVERHEAD) {
+    LOG(ERROR) << "Datagram size limit " << *datagramSizeLimit
+               << " leaves no room for the CONNECT-IP payload";
+    return tunMTU;
+  }
+  // tunMTU is the largest size, the read buffers are sized for it
+  return std::min(tunMTU, *datagramSizeLimit - CONNECT_IP_OVERHEAD);
+}
+
+void ConnectIPClient::onDatagramSizeLimitChanged() {
+  auto mtu = currentTunMTU();
+  for (auto& [streamID, tunPair] : tunDevices) {
+    if (tunPair.first) {
+      setTunDeviceMTU(tunDeviceName(streamID), mtu);
+    }
+  }
 }
 
 void ConnectIPClient::start() {
+  if (hops.back().options.pmtuDiscovery_) {
+    socket->setDatagramSizeLimitCallback(
+        [this](size_t) { onDatagramSizeLimitChanged(); });
+  }
   socket->setReceivedAddressCallback(
       [this](HTTPCodec::StreamID streamID, const Address::Address& address) {
         LOG(INFO) << "Received address: " << address.ipAddress.first.str();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ConnectClient.h"
+#include "TunReactor.h"
 #include "socket/LayeredConnectIPSocket.h"
 #include <folly/IPAddress.h>
 #include <folly/SocketAddress.h>
@@ -38,17 +39,32 @@ class ConnectIPClient {
   using TunPair = std::pair<std::unique_ptr<proxygen::TunDevice>,
                             std::unique_ptr<ConnectIPTunCallback>>;
   std::unordered_map<proxygen::HTTPCodec::StreamID, TunPair> tunDevices;
+  // declared after tunDevices: the tun callbacks are also read callbacks of
+  // the socket, which must be destroyed before them
   std::unique_ptr<LayeredConnectIPSocket> socket;
+  // Members are destroyed bottom up. Releasing a handler only posts its
+  // deletion to the handler's EventBase, and it may still read in the
+  // meantime; the reactor's destructor then joins the IO threads, which
+  // runs the posted deletions. So every handler is unregistered before the
+  // socket and the tun devices and callbacks it uses go away.
+  TunReactor tunReactor;
+  std::unordered_map<proxygen::HTTPCodec::StreamID, TunEventHandlerPtr>
+      tunHandlers;
 
  public:
   ConnectIPClient(
       folly::EventBase *,
       std::vector<OptionPair>,
       std::optional<folly::CIDRNetworkV4> manualTunNetwork = std::nullopt,
-      std::optional<std::string> = std::nullopt);
+      std::optional<std::string> = std::nullopt,
+      bool binaryQlog = false);
 
  private:
   void createTunDevice(proxygen::HTTPCodec::StreamID, const Address::Address &);
+  std::string tunDeviceName(proxygen::HTTPCodec::StreamID) const;
+  // MTU of the tun devices for the datagram size limit of the socket
+  std::size_t currentTunMTU() const;
+  void onDatagramSizeLimitChanged();
 
  public:
   void start();
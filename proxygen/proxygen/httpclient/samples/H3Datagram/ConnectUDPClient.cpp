@@ -33,6 +33,11 @@ void ConnectUDPClient::ConnectUDPTunCallback::onPacket(uint8_t* buffer,
   uint8_t* payloadBuf = buffer + payloadInfo.startIndex;
   size_t payloadLen = payloadInfo.len;
   auto rawPayload = IOBuf::copyBuffer(payloadBuf, payloadLen);
+  if (socket->getEventBase()->isInEventBaseThread()) {
+    // the tun device is multiplexed onto the socket's EventBase
+    socket->LayeredMasqueSocket::write(address, rawPayload);
+    return;
+  }
   socket->getEventBase()->runInEventBaseThread(
       [this, rawPayload = std::move(rawPayload)]() mutable {
         socket->LayeredMasqueSocket::write(address, rawPayload);
@@ -59,12 +64,14 @@ void ConnectUDPClient::ConnectUDPTunCallback::onDataAvailable(
 ConnectUDPClient::ConnectUDPClient(EventBase* eventBase,
                                    vector<OptionPair> hops,
                                    UDPClientTUNOptions tunOptions,
-                                   optional<string> qlogPath)
+                                   optional<string> qlogPath,
+                                   bool binaryQlog)
     : eventBase(eventBase),
       hops(hops),
       subNetGenerator(tunOptions.tunDeviceNetwork),
       tunOptions(tunOptions),
-      tunMTU(-1) {
+      tunMTU(-1),
+      tunReactor(eventBase, TUN_IO_THREADS) {
   CHECK(!hops.empty());
   // build the chain bottom up
   auto baseSocket = make_unique<AsyncUDPSocket>(eventBase);
@@ -90,14 +97,19 @@ ConnectUDPClient::ConnectUDPClient(EventBase* eventBase,
   // socket is not connected yet, set qlogpath
   if (qlogPath) {
     socket->setQLogPath(*qlogPath);
+    if (binaryQlog) {
+      socket->setBinaryQLogWriter(
+          make_shared<quic::BinaryQLogWriter>(*qlogPath));
+    }
   }
 }
 
 void ConnectUDPClient::createTunDevice(HTTPCodec::StreamID streamID) {
   // EASY_FUNCTION();
   auto address = subNetGenerator.generateSubNet().first;
-  auto tunDevice = make_unique<TunDevice>(
-      "tun_client_" + to_string(streamID), make_pair(address, 31), tunMTU);
+  auto tunDevice = make_unique<TunDevice>("tun_client_" + to_string(streamID),
+                                         make_pair(address, 31),
+                                         currentTunMTU());
   auto* tunPtr = tunDevice.get();
   auto tunReadCallback =
       make_unique<ConnectUDPTunCallback>(tunPtr,
@@ -109,13 +121,37 @@ void ConnectUDPClient::createTunDevice(HTTPCodec::StreamID streamID) {
   tunDevice->setReadCallback(tunReadCallback.get());
   tunDevices.emplace(
       streamID, make_pair(std::move(tunDevice), std::move(tunReadCallback)));
-  // run the tun device in a separate thread
-  tunPtr->run();
   tunDevices.at(streamID).second->setTunDevice(tunPtr);
+  // register the tun fd with the reactor instead of running a read thread
+  tunHandlers[streamID] = tunReactor.attach(
+      tunPtr->getFd(), tunDevices.at(streamID).second.get(), tunMTU);
+}
+
+size_t ConnectUDPClient::currentTunMTU() const {
+  if (!hops.back().options.pmtuDiscovery_) {
+    return tunMTU;
+  }
+  auto datagramSizeLimit = socket->getDatagramSizeLimit();
+  if (!datagramSizeLimit) {
+    return tunMTU;
+  }
+  // tunMTU is the largest size, the read buffers are sized for it
+  return std::min(tunMTU, *datagramSizeLimit + 28);
+}
+
+void ConnectUDPClient::onDatagramSizeLimitChanged() {
+  auto mtu = currentTunMTU();
+  for (auto& [streamID, _] : tunDevices) {
+    setTunDeviceMTU("tun_client_" + to_string(streamID), mtu);
+  }
 }
 
 void ConnectUDPClient::start() {
   // EASY_FUNCTION();
+  if (hops.back().options.pmtuDiscovery_) {
+    socket->setDatagramSizeLimitCallback(
+        [this](size_t) { onDatagramSizeLimitChanged(); });
+  }
   socket->setNewTransactionCallback([this](HTTPCodec::StreamID streamID) {
     LOG(INFO) << "New transaction: " << streamID;
     createTunDevice(streamID);
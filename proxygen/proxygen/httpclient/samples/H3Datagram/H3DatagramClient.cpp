@@ -21,6 +21,7 @@
 #include <folly/portability/GFlags.h>
 #include <folly/ssl/Init.h>
 #include <proxygen/lib/transport/H3DatagramAsyncSocket.h>
+#include <quic/common/BusyPoller.h>
 
 #include <easy/profiler.h>
 
@@ -72,6 +73,7 @@ vector<OptionPair> generateOptions(
       options.httpRequest_->getHeaders().add("capsule-protocol", "?1");
     }
     options.targetAddress_ = SocketAddress(hosts[i], ports[i]);
+    options.hostname_ = hosts[i];
     options.certVerifier_ =
         make_unique<proxygen::AlwaysAcceptCertificateVerifier>();
     options.defaultCCType = ccAlgorithms[i];
@@ -147,6 +149,52 @@ void startClient(const po::variables_map& variablesMap, EventBase& eventBase) {
                                  move(maxRecvPacketSizes),
                                  move(ccAlgorithms),
                                  move(framePerPackets));
+  // spread the transactions of the last hop over multiple connections
+  options.back().options.connections_ =
+      variablesMap["numConnections"].as<size_t>();
+  {
+    shared_ptr<quic::QuicPskCache> pskCache;
+    shared_ptr<quic::QuicTokenCache> tokenCache;
+    if (variablesMap.count("psk-file")) {
+      pskCache = createPskCache(variablesMap["psk-file"].as<string>());
+    }
+    if (variablesMap.count("token-file")) {
+      tokenCache = createTokenCache(variablesMap["token-file"].as<string>());
+    }
+    applyResumptionSettings(options,
+                            std::move(pskCache),
+                            std::move(tokenCache),
+                            variablesMap["early-data"].as<bool>());
+  }
+  if (variablesMap["ecn"].as<bool>()) {
+    for (auto& hop : options) {
+      hop.options.transportSettings.enableEcnOnEgress = true;
+      hop.options.transportSettings.readEcnOnIngress = true;
+    }
+  }
+  if (variablesMap["pmtud"].as<bool>()) {
+    applyPmtuDiscoverySettings(options);
+  }
+  if (variablesMap["ack-frequency"].as<bool>()) {
+    applyAckFrequencySettings(options);
+  }
+  applyTunnelShapingRate(options,
+                         variablesMap["tunnel-shaping-rate"].as<uint64_t>());
+  applyDatagramPackingSettings(
+      options,
+      variablesMap["datagram-packing-window"].as<uint32_t>(),
+      variablesMap["datagram-coalesce-max-size"].as<uint32_t>());
+  // spins on the sockets and the TUN devices read on the client EventBase
+  unique_ptr<quic::BusyPoller> busyPoller;
+  if (auto busyPollUs = variablesMap["busy-poll-us"].as<int>();
+      busyPollUs > 0) {
+    for (auto& hop : options) {
+      hop.options.busyPollUs_ = busyPollUs;
+    }
+    busyPoller = make_unique<quic::BusyPoller>(&eventBase,
+                                               quic::BusyPoller::Options());
+    busyPoller->start();
+  }
   optional<CIDRNetworkV4> tunNetwork;
   if (variablesMap.count("tuntap-ip")) {
     auto generalNetwork =
@@ -163,8 +211,10 @@ void startClient(const po::variables_map& variablesMap, EventBase& eventBase) {
       exit(0);
     });
   }
+  auto binaryQlog = variablesMap["binaryQlog"].as<bool>();
   if (lastIsConnectIP) {
-    ConnectIPClient client(&eventBase, move(options), tunNetwork, qlogPath);
+    ConnectIPClient client(
+        &eventBase, move(options), tunNetwork, qlogPath, binaryQlog);
     client.start();
     eventBase.loopForever();
   } else {
@@ -178,7 +228,7 @@ void startClient(const po::variables_map& variablesMap, EventBase& eventBase) {
         .sourcePort = sourcePort,
         .destinationPort = folly::to<uint16_t>(splitRes.back())};
     ConnectUDPClient client(
-        &eventBase, move(options), move(tunOptions), qlogPath);
+        &eventBase, move(options), move(tunOptions), qlogPath, binaryQlog);
     client.start();
     eventBase.loopForever();
   }
@@ -192,6 +242,9 @@ int main(int argc, char* argv[]) {
   po::options_description optionsDescription("Allowed options");
   optionsDescription.add_options()("help", "output help message")(
       "qlog", po::value<string>(), "set qlog path")(
+      "binaryQlog",
+      po::value<bool>()->default_value(false),
+      "write binary qlogs (convert with bqlog2qlog)")(
       "modes",
       po::value<vector<string>>()->multitoken(),
       "'{connect-ip' | 'connect-udp}'")(
@@ -208,6 +261,43 @@ int main(int argc, char* argv[]) {
       "numTransactions",
       po::value<size_t>(),
       "number of concurrent http transactions")(
+      "psk-file",
+      po::value<string>(),
+      "persistent psk cache (session resumption)")(
+      "token-file",
+      po::value<string>(),
+      "persistent NEW_TOKEN cache (skips address validation)")(
+      "early-data",
+      po::value<bool>()->default_value(false),
+      "send the CONNECT requests as 0-RTT data (needs --psk-file)")(
+      "ecn",
+      po::value<bool>()->default_value(false),
+      "mark packets ECT(0) and copy CE marks into the tunnelled packets")(
+      "pmtud",
+      po::value<bool>()->default_value(false),
+      "discover the path MTU of every hop, UDPSendPacketLens become the "
+      "largest sizes probed")(
+      "ack-frequency",
+      po::value<bool>()->default_value(false),
+      "adapt the ACK frequency of every hop to RTT and congestion window")(
+      "tunnel-shaping-rate",
+      po::value<uint64_t>()->default_value(0),
+      "drop datagrams above this many bytes per second on the hops using the "
+      "tunnel cc (0: never)")(
+      "datagram-packing-window",
+      po::value<uint32_t>()->default_value(1),
+      "number of queued datagrams a packet is filled from (1: FIFO)")(
+      "datagram-coalesce-max-size",
+      po::value<uint32_t>()->default_value(0),
+      "coalesce datagrams up to this size into one packet (0: never)")(
+      "busy-poll-us",
+      po::value<int>()->default_value(0),
+      "spin on the sockets and TUN devices while there is traffic, with this "
+      "SO_BUSY_POLL (0: block in epoll)")(
+      "numConnections",
+      po::value<size_t>()->default_value(1),
+      "number of QUIC connections to the last hop (transactions are striped "
+      "across them)")(
       "UDPSendPacketLens",
       po::value<vector<size_t>>()->multitoken(),
       "set UDPSendPacketLens for each hop")(
@@ -222,7 +312,7 @@ int main(int argc, char* argv[]) {
       po::value<vector<string>>()->multitoken(),
       "set congestion control algorithms ('None' | 'Cubic' | 'NewReno' | "
       "'Copa' "
-      "| 'Copa2' | 'BBR' | 'StaticCwnd')")(
+      "| 'Copa2' | 'BBR' | 'StaticCwnd' | 'Tunnel')")(
       "framePerPackets",
       po::value<vector<bool>>()->multitoken(),
       "force QUIC to use one frame for each packet")(
@@ -233,7 +323,8 @@ int main(int argc, char* argv[]) {
                                       "set connect-ip port")(
       "datagramReadBuf", po::value<size_t>()->default_value(16384), "set datagram read buffer size")(
       "datagramWriteBuf", po::value<size_t>()->default_value(16384), "set datagram write buffer size")(
-	  "tun-starting-nr", po::value<size_t>()->default_value(0), "set first tun nr (tun_client_<nr>)");
+	  "tun-starting-nr", po::value<size_t>()->default_value(0), "set first tun nr (tun_client_<nr>)")(
+      "tun-io-threads", po::value<size_t>()->default_value(0), "read tun devices on N IO threads (0: client event base)");
   po::variables_map variablesMap;
   po::store(po::parse_command_line(argc, argv, optionsDescription),
             variablesMap);
@@ -288,6 +379,7 @@ int main(int argc, char* argv[]) {
   MasqueService::datagramReadBufSize = variablesMap["datagramReadBuf"].as<size_t>();
   MasqueService::datagramWriteBufSize = variablesMap["datagramWriteBuf"].as<size_t>();
   MasqueService::FIRST_TUN_NUMBER = variablesMap["tun-starting-nr"].as<size_t>();
+  MasqueService::TUN_IO_THREADS = variablesMap["tun-io-threads"].as<size_t>();
   // glog
 #if FOLLY_HAVE_LIBGFLAGS
   // Enable glog logging to stderr by default.
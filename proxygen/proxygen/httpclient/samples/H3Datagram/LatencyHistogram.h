@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <folly/dynamic.h>
+#include <folly/lang/Bits.h>
+#include <limits>
+#include <vector>
+
+namespace MasqueService {
+
+// HDR-style log-linear histogram: every power of two is split into
+// kSubBuckets linear buckets, so the relative error stays below
+// 1 / kSubBuckets (~1.6%) over the whole range.
+class LatencyHistogram {
+
+ private:
+  static constexpr std::size_t kSubBucketBits = 6;
+  static constexpr std::size_t kSubBuckets = 1 << kSubBucketBits;
+  // values below 2 * kSubBuckets are recorded exactly
+  static constexpr std::size_t kLinearBuckets = 2 * kSubBuckets;
+  static constexpr std::size_t kNumBuckets =
+      kLinearBuckets + (64 - kSubBucketBits - 1) * kSubBuckets;
+
+  std::vector<std::uint64_t> buckets;
+  std::uint64_t totalCount{0};
+  std::uint64_t minValue{std::numeric_limits<std::uint64_t>::max()};
+  std::uint64_t maxValue{0};
+  long double sum{0};
+
+ public:
+  LatencyHistogram() : buckets(kNumBuckets, 0) {
+  }
+
+ private:
+  static std::size_t bucketIndex(std::uint64_t value) {
+    if (value < kLinearBuckets) {
+      return value;
+    }
+    std::size_t shift = folly::findLastSet(value) - 1 - kSubBucketBits;
+    return kLinearBuckets + (shift - 1) * kSubBuckets +
+           ((value >> shift) - kSubBuckets);
+  }
+
+  // highest value that maps to the bucket
+  static std::uint64_t bucketUpperBound(std::size_t index) {
+    if (index < kLinearBuckets) {
+      return index;
+    }
+    std::size_t shift = (index - kLinearBuckets) / kSubBuckets + 1;
+    std::uint64_t subBucket = (index - kLinearBuckets) % kSubBuckets;
+    return ((kSubBuckets + subBucket + 1) << shift) - 1;
+  }
+
+ public:
+  void record(std::uint64_t value) {
+    buckets[bucketIndex(value)]++;
+    totalCount++;
+    minValue = std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+    sum += value;
+  }
+
+  void record(std::chrono::microseconds value) {
+    record(static_cast<std::uint64_t>(std::max<int64_t>(value.count(), 0)));
+  }
+
+  void merge(const LatencyHistogram& other) {
+    for (std::size_t i = 0; i < kNumBuckets; i++) {
+      buckets[i] += other.buckets[i];
+    }
+    totalCount += other.totalCount;
+    minValue = std::min(minValue, other.minValue);
+    maxValue = std::max(maxValue, other.maxValue);
+    sum += other.sum;
+  }
+
+  std::uint64_t count() const {
+    return totalCount;
+  }
+
+  std::uint64_t min() const {
+    return totalCount ? minValue : 0;
+  }
+
+  std::uint64_t max() const {
+    return maxValue;
+  }
+
+  double mean() const {
+    return totalCount ? static_cast<double>(sum / totalCount) : 0.0;
+  }
+
+  // percentile in [0, 100]
+  std::uint64_t percentile(double percentile) const {
+    if (totalCount == 0) {
+      return 0;
+    }
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    auto rank = static_cast<std::uint64_t>(
+        std::max(1.0, percentile / 100.0 * totalCount + 0.5));
+    rank = std::min(rank, totalCount);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kNumBuckets; i++) {
+      seen += buckets[i];
+      if (seen >= rank) {
+        return std::min(bucketUpperBound(i), maxValue);
+      }
+    }
+    return maxValue;
+  }
+
+  folly::dynamic toDynamic() const {
+    return folly::dynamic::object("count", count())("min", min())(
+        "mean", mean())("p50", percentile(50))("p90", percentile(90))(
+        "p99", percentile(99))("p999", percentile(99.9))("max", max());
+  }
+};
+
+} // namespace MasqueService
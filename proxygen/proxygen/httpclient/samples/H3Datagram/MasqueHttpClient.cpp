@@ -4,7 +4,9 @@
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/program_options.hpp>
 #include <fizz/client/FizzClientContext.h>
+#include <folly/FileUtil.h>
 #include <folly/init/Init.h>
+#include <folly/json.h>
 #include <folly/ssl/Init.h>
 #include <fstream>
 #include <iostream>
@@ -47,6 +49,10 @@ void MasqueHttpClient::TransactionHandler::onHeadersComplete(
   if (options.httpRequest.getMethodString() == "POST") {
     postBody();
     httpTransaction->sendEOM();
+    if (benchmarkClient) {
+      headersCompleteTime = std::chrono::steady_clock::now();
+      return;
+    }
     std::cout << httpTransaction->getID() << ": Sent post body in "
               << duration_cast<milliseconds>(steady_clock::now() -
                                              MasqueHttpClient::startTime)
@@ -62,6 +68,14 @@ void MasqueHttpClient::TransactionHandler::onHeadersComplete(
 
 void MasqueHttpClient::TransactionHandler::onBody(
     unique_ptr<folly::IOBuf> data) noexcept {
+  if (benchmarkClient) {
+    if (!ttfb) {
+      ttfb = duration_cast<microseconds>(steady_clock::now() -
+                                         requestStartTime);
+    }
+    bodyReceivedBytes += data->computeChainDataLength();
+    return;
+  }
   if (bodyReceivedBytes == 0) {
     std::cout << "TTFB="
               << duration_cast<milliseconds>(steady_clock::now() -
@@ -74,6 +88,16 @@ void MasqueHttpClient::TransactionHandler::onBody(
 
 void MasqueHttpClient::TransactionHandler::onEOM() noexcept {
   // LOG(INFO) << __func__;
+  if (benchmarkClient) {
+    finished = true;
+    benchmarkClient->onRequestDone(
+        this,
+        ttfb,
+        duration_cast<microseconds>(steady_clock::now() - requestStartTime),
+        bodyReceivedBytes,
+        false);
+    return;
+  }
   if (options.httpRequest.getMethodString() == "GET") {
     std::cout << bodyReceivedBytes << "bytes received in "
               << duration_cast<milliseconds>(steady_clock::now() -
@@ -89,6 +113,30 @@ void MasqueHttpClient::TransactionHandler::onEOM() noexcept {
   }
 }
 
+void MasqueHttpClient::TransactionHandler::onError(
+    const HTTPException& ex) noexcept {
+  LOG(ERROR) << ex.what();
+  if (benchmarkClient && !finished) {
+    finished = true;
+    benchmarkClient->onRequestDone(
+        this,
+        ttfb,
+        duration_cast<microseconds>(steady_clock::now() - requestStartTime),
+        bodyReceivedBytes,
+        true);
+  }
+}
+
+folly::dynamic BenchmarkResult::toDynamic() const {
+  auto durationMs = duration_cast<milliseconds>(endTime - startTime).count();
+  double seconds = std::max<double>(durationMs, 1) / 1000.0;
+  return folly::dynamic::object("started", started)("completed", completed)(
+      "failed", failed)("duration_ms", durationMs)("bytes", bytesReceived)(
+      "goodput_mbps", bytesReceived * 8 / seconds / 1e6)(
+      "requests_per_second", completed / seconds)("ttfb_us", ttfb.toDynamic())(
+      "completion_us", completion.toDynamic());
+}
+
 std::chrono::steady_clock::time_point MasqueHttpClient::startTime;
 
 MasqueHttpClient::MasqueHttpClient(EventBase* eventBase,
@@ -102,13 +150,17 @@ MasqueHttpClient::MasqueHttpClient(EventBase* eventBase,
 }
 
 void MasqueHttpClient::connectSuccess() {
-  {
+  if (!options.pmtuDiscovery) {
     // weird fix but works
     auto* client = static_cast<quic::QuicClientTransport*>(
         upstreamSession->getQuicSocket());
     client->getStateNonConst()->udpSendPacketLen = options.UDPSendPacketLen;
   }
   LOG(INFO) << "Connected to " << options.targetAddress.describe();
+  if (options.benchmark.enabled) {
+    startBenchmark();
+    return;
+  }
   for (size_t i = 0; i < options.numTransactions; i++) {
     auto handler = make_unique<TransactionHandler>(
         upstreamSession, options, &completedTransactions);
@@ -129,12 +181,125 @@ void MasqueHttpClient::connectSuccess() {
   upstreamSession->closeWhenIdle();
 }
 
+void MasqueHttpClient::startBenchmark() {
+  const auto& benchmark = options.benchmark;
+  LOG(INFO) << "Benchmark: " << benchmark.totalRequests << " requests, "
+            << (benchmark.rate > 0
+                    ? to_string(benchmark.rate) + " req/s (open loop)"
+                    : to_string(benchmark.concurrency) +
+                          " in flight (closed loop)");
+  benchmarkResult.startTime = steady_clock::now();
+  if (benchmark.totalRequests == 0) {
+    finishBenchmark();
+    return;
+  }
+  if (benchmark.rate > 0) {
+    openLoopTimer = AsyncTimeout::make(*eventBase, [this]() noexcept {
+      scheduleNextRequest();
+    });
+    scheduleNextRequest();
+    return;
+  }
+  for (size_t i = 0; i < benchmark.concurrency; i++) {
+    if (!startRequest()) {
+      break;
+    }
+  }
+}
+
+bool MasqueHttpClient::startRequest() {
+  if (benchmarkResult.started >= options.benchmark.totalRequests) {
+    return false;
+  }
+  benchmarkResult.started++;
+  auto handler = make_unique<TransactionHandler>(
+      upstreamSession, options, &completedTransactions, this);
+  auto* httpTransaction = upstreamSession->newTransaction(handler.get());
+  if (!httpTransaction || !httpTransaction->canSendHeaders()) {
+    LOG(ERROR) << "Cannot start benchmark request";
+    onRequestDone(handler.get(), std::nullopt, 0us, 0, true);
+    return false;
+  }
+  handler->setTransaction(httpTransaction);
+  handler->setRequestStartTime(steady_clock::now());
+  httpTransaction->sendHeaders(options.httpRequest);
+  handler->sendEOM();
+  transactionHandlers.push_back(std::move(handler));
+  return true;
+}
+
+void MasqueHttpClient::scheduleNextRequest() {
+  // catch up on every request that is due by now, the timer only has
+  // millisecond granularity
+  auto elapsed = duration_cast<microseconds>(steady_clock::now() -
+                                             benchmarkResult.startTime);
+  auto due = static_cast<size_t>(elapsed.count() * options.benchmark.rate /
+                                 1e6) +
+             1;
+  while (benchmarkResult.started < due && startRequest()) {
+  }
+  if (benchmarkResult.started >= options.benchmark.totalRequests) {
+    return;
+  }
+  auto next = microseconds(static_cast<int64_t>(
+      benchmarkResult.started * 1e6 / options.benchmark.rate));
+  auto wait = duration_cast<milliseconds>(next - elapsed);
+  openLoopTimer->scheduleTimeout(std::max(wait, 1ms));
+}
+
+void MasqueHttpClient::onRequestDone(TransactionHandler*,
+                                     std::optional<microseconds> ttfb,
+                                     microseconds completion,
+                                     size_t bytes,
+                                     bool failed) {
+  if (failed) {
+    benchmarkResult.failed++;
+  } else {
+    benchmarkResult.completed++;
+    benchmarkResult.completion.record(completion);
+    if (ttfb) {
+      benchmarkResult.ttfb.record(*ttfb);
+    }
+  }
+  benchmarkResult.bytesReceived += bytes;
+  if (benchmarkResult.completed + benchmarkResult.failed >=
+      options.benchmark.totalRequests) {
+    finishBenchmark();
+    return;
+  }
+  if (options.benchmark.rate <= 0) {
+    // closed loop: replace the finished request
+    eventBase->runInLoop([this]() { startRequest(); });
+  }
+}
+
+void MasqueHttpClient::finishBenchmark() {
+  benchmarkResult.endTime = steady_clock::now();
+  if (openLoopTimer) {
+    openLoopTimer->cancelTimeout();
+  }
+  auto json = folly::toPrettyJson(benchmarkResult.toDynamic());
+  std::cout << json << std::endl;
+  if (options.benchmark.jsonOutput &&
+      !folly::writeFile(json, options.benchmark.jsonOutput->c_str())) {
+    LOG(ERROR) << "Could not write " << *options.benchmark.jsonOutput;
+  }
+  upstreamSession->closeWhenIdle();
+  if (!options.qlogPath) {
+    exit(0);
+  }
+}
+
 void MasqueHttpClient::call() {
-  MasqueService::ScopeExecutor _([]() {
-    // restore default
-    MasqueService::setQUICPacketLenV4(1472);
+  MasqueService::ScopeExecutor _([pmtuDiscovery = options.pmtuDiscovery]() {
+    if (!pmtuDiscovery) {
+      // restore default
+      MasqueService::setQUICPacketLenV4(1472);
+    }
   });
-  MasqueService::setQUICPacketLenV4(options.UDPSendPacketLen);
+  if (!options.pmtuDiscovery) {
+    MasqueService::setQUICPacketLenV4(options.UDPSendPacketLen);
+  }
   // 1) fizz client context
   auto ctx = make_shared<fizz::client::FizzClientContext>();
   {
@@ -142,26 +307,49 @@ void MasqueHttpClient::call() {
     ctx->setSupportedAlpns(supportedAlpns);
     ctx->setDefaultShares(
         {fizz::NamedGroup::x25519, fizz::NamedGroup::secp256r1});
-    ctx->setSendEarlyData(false);
+    ctx->setSendEarlyData(options.earlyData);
   }
   auto fizzClientContext =
       quic::FizzClientQuicHandshakeContext::Builder()
           .setFizzClientContext(ctx)
           .setCertificateVerifier(
               make_shared<AlwaysAcceptCertificateVerifier>())
+          .setPskCache(options.pskCache)
           .build();
   // 2) quic client transport
   CHECK(socket);
   auto client = make_shared<quic::QuicClientTransport>(
       eventBase, std::move(socket), fizzClientContext);
+  client->setHostname(options.hostname.empty()
+                          ? options.targetAddress.getAddressStr()
+                          : options.hostname);
+  if (options.tokenCache) {
+    // tokens are only valid for the server at that address
+    auto tokenKey = options.targetAddress.describe();
+    if (auto token = options.tokenCache->getToken(tokenKey)) {
+      client->setNewToken(std::move(*token));
+    }
+    client->setNewTokenCallback(
+        [tokenCache = options.tokenCache, tokenKey](string token) {
+          tokenCache->putToken(tokenKey, std::move(token));
+        });
+  }
   client->addNewPeerAddress(options.targetAddress);
   quic::TransportSettings transportSettings;
+  transportSettings.attemptEarlyData =
+      options.earlyData && options.pskCache;
   transportSettings.maxRecvPacketSize = options.maxRecvPacketSize;
-  transportSettings.canIgnorePathMTU = true;
+  if (options.pmtuDiscovery) {
+    transportSettings.enablePmtuDiscovery = true;
+    transportSettings.maxPmtuProbeSize = options.UDPSendPacketLen;
+  } else {
+    transportSettings.canIgnorePathMTU = true;
+  }
   transportSettings.idleTimeout = milliseconds(99999999);
   transportSettings.pacingEnabled =
       (options.cc != quic::CongestionControlType::None);
   transportSettings.defaultCongestionController = options.cc;
+  transportSettings.edtPacing = options.edtPacing;
   client->setCongestionControllerFactory(
       std::make_shared<quic::DefaultCongestionControllerFactory>());
   if (transportSettings.pacingEnabled) {
@@ -172,7 +360,10 @@ void MasqueHttpClient::call() {
   client->setSupportedVersions({quic::QuicVersion::QUIC_V1,
                                 quic::QuicVersion::QUIC_V2,
                                 quic::QuicVersion::MVFST});
-  if (options.qlogPath) {
+  if (options.binaryQLogWriter) {
+    client->setQLogger(std::make_shared<quic::BinaryQLogger>(
+        quic::VantagePoint::Client, options.binaryQLogWriter));
+  } else if (options.qlogPath) {
     client->setQLogger(std::make_shared<MasqueService::QLogger>(
         eventBase, *options.qlogPath, quic::VantagePoint::Client));
   }
@@ -233,6 +424,7 @@ vector<MasqueService::OptionPair> generateOptions(
       options.httpRequest_->getHeaders().add("capsule-protocol", "?1");
     }
     options.targetAddress_ = SocketAddress(hosts[i], ports[i]);
+    options.hostname_ = hosts[i];
     options.certVerifier_ =
         make_unique<proxygen::AlwaysAcceptCertificateVerifier>();
     options.transactions_ = 1;
@@ -273,6 +465,9 @@ int main(int argc, char** argv) {
       "UDPSendPacketLen for the HTTP Client")(
       "maxRecvPacketSize", po::value<size_t>(), "set maxRecvPacketSize")(
       "qlog", po::value<string>(), "set qlog path")(
+      "binaryQlog",
+      po::value<bool>()->default_value(false),
+      "write binary qlogs (convert with bqlog2qlog)")(
       "cc", po::value<string>(), "cc algo for http client")(
       "modes",
       po::value<vector<string>>()->multitoken(),
@@ -303,7 +498,21 @@ int main(int argc, char** argv) {
       po::value<vector<bool>>()->multitoken(),
       "force QUIC to use one frame for each packet")(
       "datagramReadBuf", po::value<size_t>()->default_value(16384), "set datagram read buffer size")(
-      "datagramWriteBuf", po::value<size_t>()->default_value(16384), "set datagram write buffer size");
+      "datagramWriteBuf", po::value<size_t>()->default_value(16384), "set datagram write buffer size")(
+      "psk-file", po::value<string>(), "persistent psk cache (session resumption)")(
+      "token-file", po::value<string>(), "persistent NEW_TOKEN cache")(
+      "early-data", po::value<bool>()->default_value(false), "use 0-RTT (needs --psk-file)")(
+      "edt-pacing", po::value<bool>()->default_value(false), "pace with SO_TXTIME departure times (needs fq qdisc)")(
+      "pmtud", po::value<bool>()->default_value(false), "discover the path MTU of every hop, the UDPSendPacketLens are the largest sizes probed")(
+      "ack-frequency", po::value<bool>()->default_value(false), "adapt the ACK frequency of every hop to RTT and congestion window")(
+      "tunnel-shaping-rate", po::value<uint64_t>()->default_value(0), "drop datagrams above this many bytes per second on the hops using the tunnel cc (0: never)")(
+      "datagram-packing-window", po::value<uint32_t>()->default_value(1), "number of queued datagrams a packet is filled from (1: FIFO)")(
+      "datagram-coalesce-max-size", po::value<uint32_t>()->default_value(0), "coalesce datagrams up to this size into one packet (0: never)")(
+      "bench", po::value<bool>()->default_value(false), "benchmark mode (latency histograms)")(
+      "concurrency", po::value<size_t>()->default_value(1), "benchmark: requests in flight (closed loop)")(
+      "requests", po::value<size_t>()->default_value(100), "benchmark: total number of requests")(
+      "rate", po::value<double>()->default_value(0), "benchmark: requests per second (open loop), 0 = closed loop")(
+      "json-out", po::value<string>(), "benchmark: write the JSON summary to this file");
   po::variables_map vm;
   po::store(po::parse_command_line(argc, argv, desc), vm);
   po::notify(vm);
@@ -377,6 +586,31 @@ int main(int argc, char** argv) {
                            ccAlgorithms,
                            vm["framePerPackets"].as<vector<bool>>());
   }
+  shared_ptr<quic::QuicPskCache> pskCache;
+  shared_ptr<quic::QuicTokenCache> tokenCache;
+  if (vm.count("psk-file")) {
+    pskCache = MasqueService::createPskCache(vm["psk-file"].as<string>());
+  }
+  if (vm.count("token-file")) {
+    tokenCache = MasqueService::createTokenCache(vm["token-file"].as<string>());
+  }
+  MasqueService::applyResumptionSettings(
+      hops, pskCache, tokenCache, vm["early-data"].as<bool>());
+  for (auto& hop : hops) {
+    hop.options.transportSettings.edtPacing = vm["edt-pacing"].as<bool>();
+  }
+  if (vm["pmtud"].as<bool>()) {
+    MasqueService::applyPmtuDiscoverySettings(hops);
+  }
+  if (vm["ack-frequency"].as<bool>()) {
+    MasqueService::applyAckFrequencySettings(hops);
+  }
+  MasqueService::applyTunnelShapingRate(
+      hops, vm["tunnel-shaping-rate"].as<uint64_t>());
+  MasqueService::applyDatagramPackingSettings(
+      hops,
+      vm["datagram-packing-window"].as<uint32_t>(),
+      vm["datagram-coalesce-max-size"].as<uint32_t>());
   // ---------------------------------------------------------------------------
   EventBase eventBase;
   auto baseSocket = make_unique<AsyncUDPSocket>(&eventBase);
@@ -392,6 +626,7 @@ int main(int argc, char** argv) {
   {
     options.targetAddress =
         SocketAddress(vm["ip"].as<string>(), vm["port"].as<uint16_t>());
+    options.hostname = vm["ip"].as<string>();
     options.httpRequest.getHeaders().add(HTTP_HEADER_HOST, "example.org");
     options.httpRequest.setMethod(vm["method"].as<string>());
     options.httpRequest.setHTTPVersion(3, 0);
@@ -419,6 +654,23 @@ int main(int argc, char** argv) {
     }
     if (vm.count("qlog") && !vm["qlog"].as<string>().empty()) {
       options.qlogPath = vm["qlog"].as<string>();
+      if (vm["binaryQlog"].as<bool>()) {
+        options.binaryQLogWriter =
+            make_shared<quic::BinaryQLogWriter>(*options.qlogPath);
+      }
+    }
+    // the end-to-end connection shares the caches of the hops
+    options.pskCache = pskCache;
+    options.tokenCache = tokenCache;
+    options.earlyData = vm["early-data"].as<bool>();
+    options.edtPacing = vm["edt-pacing"].as<bool>();
+    options.pmtuDiscovery = vm["pmtud"].as<bool>();
+    options.benchmark.enabled = vm["bench"].as<bool>();
+    options.benchmark.concurrency = vm["concurrency"].as<size_t>();
+    options.benchmark.totalRequests = vm["requests"].as<size_t>();
+    options.benchmark.rate = vm["rate"].as<double>();
+    if (vm.count("json-out")) {
+      options.benchmark.jsonOutput = vm["json-out"].as<string>();
     }
   }
   MasqueService::datagramReadBufSize = vm["datagramReadBuf"].as<size_t>();
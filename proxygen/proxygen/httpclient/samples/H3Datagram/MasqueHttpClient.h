@@ -1,13 +1,45 @@
 #pragma once
 
+#include "LatencyHistogram.h"
 #include <chrono>
+#include <folly/io/async/AsyncTimeout.h>
 #include <proxygen/lib/http/session/HQUpstreamSession.h>
 #include <proxygen/lib/http/session/HTTPTransaction.h>
 #include <quic/api/QuicSocket.h>
 #include <quic/client/QuicClientTransport.h>
+#include <quic/fizz/client/handshake/QuicPskCache.h>
+#include <quic/fizz/client/handshake/QuicTokenCache.h>
+#include <quic/logging/BinaryQLogger.h>
 
 namespace MasqueService {
 
+class MasqueHttpClient;
+
+// Load generation: keeps `concurrency` requests in flight (closed loop) or
+// starts `rate` requests per second (open loop) until `totalRequests` have
+// been issued
+struct BenchmarkOptions {
+  bool enabled{false};
+  std::size_t concurrency{1};
+  std::size_t totalRequests{1};
+  // requests per second, 0 means closed loop
+  double rate{0};
+  std::optional<std::string> jsonOutput;
+};
+
+struct BenchmarkResult {
+  std::size_t started{0};
+  std::size_t completed{0};
+  std::size_t failed{0};
+  std::uint64_t bytesReceived{0};
+  LatencyHistogram ttfb;
+  LatencyHistogram completion;
+  std::chrono::steady_clock::time_point startTime;
+  std::chrono::steady_clock::time_point endTime;
+
+  folly::dynamic toDynamic() const;
+};
+
 class MasqueHttpClient
     : public proxygen::HQSession::ConnectCallback
     , public proxygen::HTTPSessionBase::InfoCallback {
@@ -15,13 +47,25 @@ class MasqueHttpClient
  public:
   struct Options {
     folly::SocketAddress targetAddress;
+    // SNI and psk cache key, the target address if empty
+    std::string hostname;
     proxygen::HTTPMessage httpRequest;
     std::size_t numTransactions;
     std::size_t UDPSendPacketLen;
     std::size_t maxRecvPacketSize;
     std::shared_ptr<std::ifstream> inputFile;
     std::optional<std::string> qlogPath;
+    // binary qlogs of all connections, instead of JSON qlogs
+    std::shared_ptr<quic::BinaryQLogWriter> binaryQLogWriter;
     quic::CongestionControlType cc;
+    BenchmarkOptions benchmark;
+    std::shared_ptr<quic::QuicPskCache> pskCache;
+    std::shared_ptr<quic::QuicTokenCache> tokenCache;
+    bool earlyData{false};
+    // kernel (SO_TXTIME) pacing instead of pacing timer wakeups
+    bool edtPacing{false};
+    // discover the path MTU, UDPSendPacketLen is the largest size probed
+    bool pmtuDiscovery{false};
   };
 
   class TransactionHandler : public proxygen::HTTPTransactionHandler {
@@ -33,15 +77,22 @@ class MasqueHttpClient
     std::atomic_size_t* completedTransactions;
     std::size_t bodyReceivedBytes;
     std::chrono::steady_clock::time_point headersCompleteTime;
+    // set in benchmark mode
+    MasqueHttpClient* benchmarkClient{nullptr};
+    std::chrono::steady_clock::time_point requestStartTime;
+    std::optional<std::chrono::microseconds> ttfb;
+    bool finished{false};
 
    public:
     explicit TransactionHandler(proxygen::HQUpstreamSession* upstreamSession,
                                 Options options,
-                                std::atomic_size_t* completedTransactions)
+                                std::atomic_size_t* completedTransactions,
+                                MasqueHttpClient* benchmarkClient = nullptr)
         : upstreamSession(upstreamSession),
           options(std::move(options)),
           completedTransactions(completedTransactions),
-          bodyReceivedBytes(0) {
+          bodyReceivedBytes(0),
+          benchmarkClient(benchmarkClient) {
     }
     ~TransactionHandler() override = default;
 
@@ -54,6 +105,12 @@ class MasqueHttpClient
       httpTransaction->sendEOM();
       // startTime = std::chrono::steady_clock::now(); // start measuring time
     }
+    void setRequestStartTime(std::chrono::steady_clock::time_point time) {
+      requestStartTime = time;
+    }
+    bool isFinished() const {
+      return finished;
+    }
     void setTransaction(
         proxygen::HTTPTransaction* httpTransaction) noexcept override {
       this->httpTransaction = httpTransaction;
@@ -72,9 +129,7 @@ class MasqueHttpClient
     void onUpgrade(proxygen::UpgradeProtocol protocol) noexcept override {
       LOG(INFO) << __func__ << ": " << static_cast<int>(protocol);
     }
-    void onError(const proxygen::HTTPException& ex) noexcept override {
-      LOG(ERROR) << ex.what();
-    }
+    void onError(const proxygen::HTTPException& ex) noexcept override;
     void onEgressPaused() noexcept override {
       LOG(INFO) << __func__;
     }
@@ -90,6 +145,8 @@ class MasqueHttpClient
   std::atomic_size_t completedTransactions;
   proxygen::HQUpstreamSession* upstreamSession;
   std::vector<std::unique_ptr<TransactionHandler>> transactionHandlers;
+  BenchmarkResult benchmarkResult;
+  std::unique_ptr<folly::AsyncTimeout> openLoopTimer;
 
  public:
   static std::chrono::steady_clock::time_point startTime;
@@ -101,6 +158,11 @@ class MasqueHttpClient
 
  private:
   void connectSuccess() override;
+  // benchmark mode
+  void startBenchmark();
+  bool startRequest();
+  void scheduleNextRequest();
+  void finishBenchmark();
 
  public:
   void onReplaySafe() override {
@@ -112,6 +174,14 @@ class MasqueHttpClient
 
  public:
   void call();
+  void onRequestDone(TransactionHandler*,
+                     std::optional<std::chrono::microseconds> ttfb,
+                     std::chrono::microseconds completion,
+                     std::size_t bytes,
+                     bool failed);
+  const BenchmarkResult& getBenchmarkResult() const {
+    return benchmarkResult;
+  }
 };
 
 } // namespace MasqueService
@@ -0,0 +1,101 @@
+#include "TunReactor.h"
+
+#include <fcntl.h>
+#include <folly/portability/Unistd.h>
+#include <quic/common/BusyPoller.h>
+
+using namespace std;
+using namespace folly;
+using namespace proxygen;
+
+namespace MasqueService {
+
+namespace {
+// bounds the time a single busy TUN device can hold the event loop
+constexpr size_t kMaxReadsPerEvent = 64;
+} // namespace
+
+TunEventHandler::TunEventHandler(EventBase* eventBase,
+                                 int fd,
+                                 TunDevice::ReadCallback* readCallback,
+                                 size_t mtu)
+    : EventHandler(eventBase, NetworkSocket::fromFd(fd)),
+      eventBase(eventBase),
+      fd(fd),
+      readCallback(readCallback),
+      readBuffer(mtu + 64) {
+  CHECK(readCallback);
+  int flags = fcntl(fd, F_GETFL, 0);
+  CHECK(flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0)
+      << "couldn't set tun fd " << fd << " to non-blocking";
+}
+
+TunEventHandler::~TunEventHandler() {
+  stop();
+}
+
+void TunEventHandler::start() {
+  // the handler is destroyed on the same EventBase, after this callback
+  eventBase->runImmediatelyOrRunInEventBaseThread(
+      [this]() { registerHandler(EventHandler::READ | EventHandler::PERSIST); });
+}
+
+void TunEventHandler::stop() {
+  DCHECK(eventBase->isInEventBaseThread());
+  if (isHandlerRegistered()) {
+    unregisterHandler();
+  }
+}
+
+void TunEventHandler::handlerReady(uint16_t) noexcept {
+  for (size_t i = 0; i < kMaxReadsPerEvent; i++) {
+    auto len = ::read(fd, readBuffer.data(), readBuffer.size());
+    if (len < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        LOG(ERROR) << "tun read failed: " << std::strerror(errno);
+      }
+      return;
+    }
+    if (len == 0) {
+      return;
+    }
+    quic::BusyPoller::noteActivity();
+    readCallback->onPacket(readBuffer.data(), len);
+  }
+}
+
+void TunEventHandlerDeleter::operator()(TunEventHandler* handler) const {
+  auto* eventBase = handler->getEventBase();
+  if (eventBase->isInEventBaseThread()) {
+    delete handler;
+    return;
+  }
+  eventBase->runInEventBaseThread([handler]() { delete handler; });
+}
+
+TunReactor::TunReactor(EventBase* eventBase, size_t numIOThreads)
+    : eventBase(eventBase) {
+  CHECK(eventBase);
+  if (numIOThreads > 0) {
+    ioExecutor = make_shared<IOThreadPoolExecutor>(numIOThreads);
+  }
+}
+
+TunReactor::~TunReactor() {
+  if (ioExecutor) {
+    ioExecutor->join();
+  }
+}
+
+TunEventHandlerPtr TunReactor::attach(
+    int fd, TunDevice::ReadCallback* readCallback, size_t mtu) {
+  // the IO pool hands out its EventBases round robin
+  auto* handlerEventBase =
+      ioExecutor ? ioExecutor->getEventBase() : eventBase;
+  TunEventHandlerPtr handler(
+      new TunEventHandler(handlerEventBase, fd, readCallback, mtu));
+  handler->start();
+  return handler;
+}
+
+} // namespace MasqueService
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <folly/executors/IOThreadPoolExecutor.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/EventHandler.h>
+#include <memory>
+#include <proxygen/httpserver/samples/masque/tuntap/TunDevice.h>
+#include <vector>
+
+namespace MasqueService {
+
+// Reads packets from a TUN fd on an EventBase instead of a dedicated thread.
+// Must be stopped and destroyed on its EventBase thread, see
+// TunEventHandlerDeleter.
+class TunEventHandler : public folly::EventHandler {
+
+ private:
+  folly::EventBase *eventBase;
+  const int fd;
+  proxygen::TunDevice::ReadCallback *readCallback;
+  std::vector<std::uint8_t> readBuffer;
+
+ public:
+  TunEventHandler(folly::EventBase *,
+                  int,
+                  proxygen::TunDevice::ReadCallback *,
+                  std::size_t);
+  ~TunEventHandler() override;
+
+ public:
+  folly::EventBase *getEventBase() const {
+    return eventBase;
+  }
+  // Registers the fd on the EventBase, asynchronously if called from
+  // another thread
+  void start();
+  // Only on the EventBase thread
+  void stop();
+  // folly::EventHandler
+  void handlerReady(std::uint16_t) noexcept override;
+};
+
+// Destroys a handler on its EventBase thread without waiting for it, so
+// that a handler can be released from any thread without a deadlock
+struct TunEventHandlerDeleter {
+  void operator()(TunEventHandler *) const;
+};
+
+using TunEventHandlerPtr =
+    std::unique_ptr<TunEventHandler, TunEventHandlerDeleter>;
+
+// Multiplexes all TUN devices of a client onto the client EventBase or, if
+// requested, onto a small pool of IO threads. Handlers released from another
+// thread are destroyed by the IO threads before the reactor's destructor
+// returns.
+class TunReactor {
+
+ private:
+  folly::EventBase *eventBase;
+  std::shared_ptr<folly::IOThreadPoolExecutor> ioExecutor;
+
+ public:
+  explicit TunReactor(folly::EventBase *, std::size_t numIOThreads = 0);
+  ~TunReactor();
+
+ public:
+  // The fd comes from TunDevice::getFd(), which the external tuntap library
+  // must provide (the library is not part of this tree)
+  TunEventHandlerPtr attach(int,
+                            proxygen::TunDevice::ReadCallback *,
+                            std::size_t);
+};
+
+} // namespace MasqueService
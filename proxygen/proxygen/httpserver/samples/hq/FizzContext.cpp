@@ -12,10 +12,15 @@
 #include <fizz/protocol/ZstdCertificateDecompressor.h>
 #include <fizz/server/AeadTicketCipher.h>
 #include <fizz/server/CertManager.h>
+#include <fcntl.h>
 #include <fizz/server/TicketCodec.h>
+#include <folly/File.h>
 #include <folly/FileUtil.h>
 #include <folly/Random.h>
+#include <quic/fizz/server/handshake/OffloadedSelfCert.h>
+#include <stdexcept>
 #include <string>
+#include <sys/stat.h>
 
 namespace {
 const std::string kDefaultCertData = R"(
@@ -140,6 +145,52 @@ VnFqMCnjdeFhc/LA6rx3ALn2jfDj9jQR0QGRouFA7NbYZFx7Uj3HOw0/
 )";
 }; // namespace
 
+namespace {
+using TicketSeed = std::array<uint8_t, 32>;
+
+// The seed is behind every session ticket and 0-RTT key, so only its owner
+// may access the file. Returns false if there is no valid seed to load.
+bool readTicketSeed(const std::string& path, TicketSeed& seed) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  folly::File file(fd, true);
+  struct stat st {};
+  if (::fstat(file.fd(), &st) != 0) {
+    return false;
+  }
+  if (st.st_mode & (S_IRWXG | S_IRWXO)) {
+    throw std::runtime_error(
+        "Ticket seed file " + path +
+        " is accessible by group or others, restrict it to mode 0600");
+  }
+  std::string data;
+  if (!folly::readFile(file.fd(), data) || data.size() != seed.size()) {
+    return false;
+  }
+  std::copy(data.begin(), data.end(), seed.begin());
+  return true;
+}
+
+void writeTicketSeed(const std::string& path, const TicketSeed& seed) {
+  int fd = ::open(path.c_str(),
+                  O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    PLOG(ERROR) << "Cannot create ticket seed file " << path;
+    return;
+  }
+  folly::File file(fd, true);
+  // O_CREAT keeps the mode of an existing file
+  if (::fchmod(file.fd(), S_IRUSR | S_IWUSR) != 0 ||
+      folly::writeFull(file.fd(), seed.data(), seed.size()) !=
+          static_cast<ssize_t>(seed.size())) {
+    PLOG(ERROR) << "Cannot write ticket seed file " << path;
+  }
+}
+} // namespace
+
 namespace quic::samples {
 FizzServerContextPtr createFizzServerContext(const HQServerParams& params) {
 
@@ -151,21 +202,35 @@ FizzServerContextPtr createFizzServerContext(const HQServerParams& params) {
   if (!params.keyFilePath.empty()) {
     folly::readFile(params.keyFilePath.c_str(), keyData);
   }
+  auto maybeOffload = [&params](std::shared_ptr<fizz::SelfCert> cert)
+      -> std::shared_ptr<fizz::SelfCert> {
+    if (!params.handshakeExecutor) {
+      return cert;
+    }
+    return std::make_shared<quic::OffloadedSelfCert>(std::move(cert),
+                                                     params.handshakeExecutor);
+  };
   auto cert = fizz::CertUtils::makeSelfCert(certData, keyData);
   auto certManager = std::make_shared<fizz::server::CertManager>();
-  certManager->addCert(std::move(cert), true);
+  certManager->addCert(maybeOffload(std::move(cert)), true);
 
   auto cert2 =
       fizz::CertUtils::makeSelfCert(kPrime256v1CertData, kPrime256v1KeyData);
-  certManager->addCert(std::move(cert2), false);
+  certManager->addCert(maybeOffload(std::move(cert2)), false);
 
   auto serverCtx = std::make_shared<fizz::server::FizzServerContext>();
   serverCtx->setCertManager(certManager);
   auto ticketCipher = std::make_shared<fizz::server::Aead128GCMTicketCipher<
       fizz::server::TicketCodec<fizz::server::CertificateStorage::X509>>>(
       serverCtx->getFactoryPtr(), std::move(certManager));
-  std::array<uint8_t, 32> ticketSeed;
-  folly::Random::secureRandom(ticketSeed.data(), ticketSeed.size());
+  TicketSeed ticketSeed;
+  if (params.ticketSeedFilePath.empty() ||
+      !readTicketSeed(params.ticketSeedFilePath, ticketSeed)) {
+    folly::Random::secureRandom(ticketSeed.data(), ticketSeed.size());
+    if (!params.ticketSeedFilePath.empty()) {
+      writeTicketSeed(params.ticketSeedFilePath, ticketSeed);
+    }
+  }
   ticketCipher->setTicketSecrets({{folly::range(ticketSeed)}});
   serverCtx->setTicketCipher(ticketCipher);
   serverCtx->setClientAuthMode(params.clientAuth);
@@ -182,7 +247,8 @@ FizzServerContextPtr createFizzServerContext(const HQServerParams& params) {
   std::shared_ptr<fizz::server::ReplayCache> replayCache =
       std::make_shared<fizz::server::AllowAllReplayReplayCache>();
 
-  serverCtx->setEarlyDataSettings(true, tolerance, std::move(replayCache));
+  serverCtx->setEarlyDataSettings(
+      params.earlyData, tolerance, std::move(replayCache));
 
   return serverCtx;
 }
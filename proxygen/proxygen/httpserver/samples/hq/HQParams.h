@@ -14,6 +14,7 @@
 #include <vector>
 
 #include <fizz/server/FizzServerContext.h>
+#include <folly/Executor.h>
 #include <folly/Optional.h>
 #include <folly/SocketAddress.h>
 #include <proxygen/lib/http/HTTPHeaders.h>
@@ -75,6 +76,8 @@ struct HQBaseParams {
   std::string keyFilePath;
   std::string pskFilePath;
   std::shared_ptr<quic::QuicPskCache> pskCache;
+  // Keeps session tickets valid across server restarts (random if empty)
+  std::string ticketSeedFilePath;
   fizz::server::ClientAuthMode clientAuth{fizz::server::ClientAuthMode::None};
 
   // Transport knobs
@@ -85,6 +88,10 @@ struct HQServerParams : public HQBaseParams {
   size_t serverThreads{0};
   std::string ccpConfig;
   folly::Optional<int64_t> rateLimitPerThread;
+  // signs the handshakes off the worker threads if set
+  std::shared_ptr<folly::Executor> handshakeExecutor;
+  // accept 0-RTT data from resumed clients (replays are not detected)
+  bool earlyData{true};
 };
 
 struct HQInvalidParam {
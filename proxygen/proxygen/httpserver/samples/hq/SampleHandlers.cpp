@@ -10,6 +10,7 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <folly/String.h>
 #include <string>
 
 namespace {
@@ -19,6 +20,10 @@ std::atomic<bool> shouldPassHealthChecks{true};
 DEFINE_string(static_root,
               "/var/www",
               "Path to serve static files from. Disabled if empty.");
+DEFINE_uint64(static_cache_mb,
+              256,
+              "Size of the in-memory cache of static files. Larger "
+              "files, or all of them if 0, are read per request.");
 
 namespace quic::samples {
 
@@ -60,6 +65,16 @@ HTTPTransactionHandler* Dispatcher::getRequestHandler(HTTPMessage* msg) {
   }
 
   if (!FLAGS_static_root.empty()) {
+    if (FLAGS_static_cache_mb > 0 && !path.contains("..")) {
+      static StaticFileCache cache(FLAGS_static_cache_mb * 1024 * 1024);
+      auto filePath = folly::to<std::string>(FLAGS_static_root, "/", path);
+      auto lookup = cache.lookup(filePath);
+      // the others, e.g. files larger than the cache, are read per request
+      if (lookup.cacheable) {
+        return new CachedStaticFileHandler(
+            params_, cache, std::move(filePath), std::move(lookup.file));
+      }
+    }
     return new StaticFileHandler(params_, FLAGS_static_root);
   }
   if (boost::algorithm::starts_with(path, "/delay")) {
@@ -287,4 +302,151 @@ void ServerPushHandler::onEOM() noexcept {
 void ServerPushHandler::onError(const proxygen::HTTPException& error) noexcept {
   VLOG(10) << "ServerPushHandler::onError error=" << error.what();
 }
+
+namespace {
+// weak comparison (RFC 9110, 8.8.3.2), as If-None-Match requires
+bool etagMatches(folly::StringPiece candidates, folly::StringPiece etag) {
+  etag.removePrefix("W/");
+  std::vector<folly::StringPiece> tags;
+  folly::split(',', candidates, tags);
+  for (auto tag : tags) {
+    tag = folly::trimWhitespace(tag);
+    tag.removePrefix("W/");
+    if (tag == "*" || tag == etag) {
+      return true;
+    }
+  }
+  return false;
+}
+} // namespace
+
+void CachedStaticFileHandler::onHeadersComplete(
+    std::unique_ptr<proxygen::HTTPMessage> msg) noexcept {
+  VLOG(10) << "CachedStaticFileHandler::onHeadersComplete";
+  VLOG(4) << "Request path: " << msg->getPathAsStringPiece();
+  request_ = std::move(msg);
+  if (file_) {
+    sendResponse();
+    return;
+  }
+  // use a CPU executor since loading reads the whole file
+  loading_ = true;
+  auto evb = folly::EventBaseManager::get()->getEventBase();
+  folly::getUnsafeMutableGlobalCPUExecutor()->add([this, evb] {
+    auto file = cache_.load(path_);
+    auto error = errno;
+    evb->runInEventBaseThread([this, file = std::move(file), error]() mutable {
+      onLoaded(std::move(file), error);
+    });
+  });
+}
+
+void CachedStaticFileHandler::onLoaded(std::shared_ptr<const CachedFile> file,
+                                       int error) {
+  loading_ = false;
+  if (detached_) {
+    delete this;
+    return;
+  }
+  if (!file) {
+    auto errorMsg = folly::to<std::string>(
+        "Invalid URL: cannot open requested file. "
+        "path: ",
+        request_->getPathAsStringPiece());
+    LOG(ERROR) << errorMsg << ", " << folly::errnoStr(error);
+    sendError(400, "Bad Request", errorMsg);
+    return;
+  }
+  file_ = std::move(file);
+  sendResponse();
+}
+
+void CachedStaticFileHandler::sendResponse() {
+  const auto& headers = request_->getHeaders();
+  const auto& etag = file_->etag();
+  auto ifNoneMatch = headers.getSingleOrEmpty(HTTP_HEADER_IF_NONE_MATCH);
+  if (!ifNoneMatch.empty() && etagMatches(ifNoneMatch, etag)) {
+    proxygen::HTTPMessage resp = createHttpResponse(304, "Not Modified");
+    maybeAddAltSvcHeader(resp);
+    resp.getHeaders().set(HTTP_HEADER_ETAG, etag);
+    txn_->sendHeaders(resp);
+    txn_->sendEOM();
+    file_.reset();
+    return;
+  }
+
+  auto size = file_->size();
+  offset_ = 0;
+  end_ = size;
+  auto range = headers.getSingleOrEmpty(HTTP_HEADER_RANGE);
+  auto ifRange = headers.getSingleOrEmpty("If-Range");
+  // a stale If-Range asks for the whole file
+  if (!range.empty() && (ifRange.empty() || ifRange == etag)) {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    switch (parseRangeHeader(range, size, offset, length)) {
+      case RangeStatus::Unsatisfiable: {
+        proxygen::HTTPMessage resp =
+            createHttpResponse(416, "Range Not Satisfiable");
+        maybeAddAltSvcHeader(resp);
+        resp.getHeaders().set(HTTP_HEADER_CONTENT_RANGE,
+                              folly::to<std::string>("bytes */", size));
+        resp.getHeaders().set(HTTP_HEADER_CONTENT_LENGTH, "0");
+        txn_->sendHeaders(resp);
+        txn_->sendEOM();
+        file_.reset();
+        return;
+      }
+      case RangeStatus::Satisfiable:
+        offset_ = offset;
+        end_ = offset + length;
+        break;
+      case RangeStatus::Ignore:
+        break;
+    }
+  }
+  bool partial = offset_ != 0 || end_ != size;
+  proxygen::HTTPMessage resp = partial
+                                   ? createHttpResponse(206, "Partial Content")
+                                   : createHttpResponse(200, "Ok");
+  maybeAddAltSvcHeader(resp);
+  resp.getHeaders().set(HTTP_HEADER_ETAG, etag);
+  resp.getHeaders().set(HTTP_HEADER_ACCEPT_RANGES, "bytes");
+  resp.getHeaders().set(HTTP_HEADER_CONTENT_LENGTH,
+                        folly::to<std::string>(end_ - offset_));
+  if (partial) {
+    resp.getHeaders().set(
+        HTTP_HEADER_CONTENT_RANGE,
+        folly::to<std::string>("bytes ", offset_, "-", end_ - 1, "/", size));
+  }
+  txn_->sendHeaders(resp);
+  if (request_->getMethod() == proxygen::HTTPMethod::HEAD) {
+    offset_ = end_;
+  }
+  sendChunks();
+}
+
+void CachedStaticFileHandler::sendChunks() {
+  while (file_ && !paused_ && offset_ < end_) {
+    auto length = std::min(kChunkSize, end_ - offset_);
+    auto body = file_->slice(offset_, length);
+    offset_ += length;
+    txn_->sendBody(std::move(body));
+  }
+  if (file_ && offset_ == end_) {
+    file_.reset();
+    txn_->sendEOM();
+  }
+}
+
+void CachedStaticFileHandler::sendError(uint16_t status,
+                                        std::string_view message,
+                                        const std::string& body) {
+  proxygen::HTTPMessage resp = createHttpResponse(status, message);
+  resp.setWantsKeepalive(true);
+  maybeAddAltSvcHeader(resp);
+  txn_->sendHeaders(resp);
+  txn_->sendBody(folly::IOBuf::copyBuffer(body));
+  txn_->sendEOM();
+}
 } // namespace quic::samples
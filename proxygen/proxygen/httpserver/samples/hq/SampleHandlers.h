@@ -32,6 +32,7 @@
 #include <folly/io/async/AsyncTimeout.h>
 #include <folly/io/async/EventBaseManager.h>
 #include <proxygen/httpserver/samples/hq/HQServer.h>
+#include <proxygen/httpserver/samples/hq/StaticFileCache.h>
 #include <proxygen/lib/http/session/HTTPTransaction.h>
 
 namespace quic::samples {
@@ -888,4 +889,79 @@ class StaticFileHandler : public BaseSampleHandler {
   std::string staticRoot_;
 };
 
+/**
+ * Serves files from a StaticFileCache: the body is sent as slices of the
+ * cached contents, on the EventBase and without copies. A file missing from
+ * the cache is read on the CPU executor first. Supports single byte ranges
+ * and conditional requests with ETags.
+ */
+class CachedStaticFileHandler : public BaseSampleHandler {
+ public:
+  // file is the result of StaticFileCache::lookup() for path, nullptr on a
+  // miss
+  CachedStaticFileHandler(const HandlerParams& params,
+                          StaticFileCache& cache,
+                          std::string path,
+                          std::shared_ptr<const CachedFile> file)
+      : BaseSampleHandler(params),
+        cache_(cache),
+        path_(std::move(path)),
+        file_(std::move(file)) {
+  }
+
+  void detachTransaction() noexcept override {
+    if (loading_) {
+      // deleted once the load is back on the EventBase
+      detached_ = true;
+      return;
+    }
+    delete this;
+  }
+
+  void onHeadersComplete(
+      std::unique_ptr<proxygen::HTTPMessage> msg) noexcept override;
+
+  void onBody(std::unique_ptr<folly::IOBuf> /*chain*/) noexcept override {
+  }
+
+  void onEOM() noexcept override {
+  }
+
+  void onError(const proxygen::HTTPException& /*error*/) noexcept override {
+    VLOG(10) << "CachedStaticFileHandler::onError";
+    file_.reset();
+    txn_->sendAbort();
+  }
+
+  void onEgressPaused() noexcept override {
+    paused_ = true;
+  }
+
+  void onEgressResumed() noexcept override {
+    paused_ = false;
+    sendChunks();
+  }
+
+ private:
+  // bytes per sendBody, so that egress pauses take effect
+  static constexpr uint64_t kChunkSize = 64 * 1024;
+
+  void onLoaded(std::shared_ptr<const CachedFile> file, int error);
+  void sendResponse();
+  void sendChunks();
+  void sendError(uint16_t status,
+                 std::string_view message,
+                 const std::string& body);
+
+  StaticFileCache& cache_;
+  std::string path_;
+  std::unique_ptr<proxygen::HTTPMessage> request_;
+  std::shared_ptr<const CachedFile> file_;
+  uint64_t offset_{0};
+  uint64_t end_{0};
+  bool paused_{false};
+  bool loading_{false};
+  bool detached_{false};
+};
+
 } // namespace quic::samples
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <proxygen/httpserver/samples/hq/StaticFileCache.h>
+
+#include <fcntl.h>
+#include <fmt/format.h>
+#include <folly/Conv.h>
+#include <folly/File.h>
+#include <folly/FileUtil.h>
+#include <folly/String.h>
+#include <glog/logging.h>
+#include <sys/stat.h>
+
+namespace quic::samples {
+
+namespace {
+std::string makeEtag(const struct stat& st) {
+  return fmt::format("\"{:x}-{:x}-{:x}.{:x}\"",
+                     st.st_ino,
+                     st.st_size,
+                     st.st_mtim.tv_sec,
+                     st.st_mtim.tv_nsec);
+}
+} // namespace
+
+RangeStatus parseRangeHeader(folly::StringPiece header,
+                             uint64_t size,
+                             uint64_t& offset,
+                             uint64_t& length) {
+  header = folly::trimWhitespace(header);
+  if (!header.removePrefix("bytes=") || header.find(',') != header.npos) {
+    return RangeStatus::Ignore;
+  }
+  auto dash = header.find('-');
+  if (dash == header.npos) {
+    return RangeStatus::Ignore;
+  }
+  auto first = folly::trimWhitespace(header.subpiece(0, dash));
+  auto last = folly::trimWhitespace(header.subpiece(dash + 1));
+  if (first.empty()) {
+    // suffix range: the last n bytes
+    auto suffix = folly::tryTo<uint64_t>(last);
+    if (!suffix) {
+      return RangeStatus::Ignore;
+    }
+    if (*suffix == 0 || size == 0) {
+      return RangeStatus::Unsatisfiable;
+    }
+    length = std::min(*suffix, size);
+    offset = size - length;
+    return RangeStatus::Satisfiable;
+  }
+  auto firstPos = folly::tryTo<uint64_t>(first);
+  if (!firstPos) {
+    return RangeStatus::Ignore;
+  }
+  uint64_t lastPos = size > 0 ? size - 1 : 0;
+  if (!last.empty()) {
+    auto parsedLast = folly::tryTo<uint64_t>(last);
+    if (!parsedLast || *parsedLast < *firstPos) {
+      return RangeStatus::Ignore;
+    }
+    lastPos = std::min(*parsedLast, lastPos);
+  }
+  if (*firstPos >= size) {
+    return RangeStatus::Unsatisfiable;
+  }
+  offset = *firstPos;
+  length = lastPos - *firstPos + 1;
+  return RangeStatus::Satisfiable;
+}
+
+CachedFile::CachedFile(std::unique_ptr<folly::IOBuf> contents,
+                       std::string etag)
+    : contents_(std::move(contents)), etag_(std::move(etag)) {
+  CHECK(!contents_->isChained());
+}
+
+std::unique_ptr<folly::IOBuf> CachedFile::slice(uint64_t offset,
+                                                uint64_t length) const {
+  CHECK_LE(offset + length, size());
+  auto buf = contents_->cloneOne();
+  buf->trimStart(offset);
+  buf->trimEnd(buf->length() - length);
+  return buf;
+}
+
+StaticFileCache::Lookup StaticFileCache::lookup(const std::string& path) {
+  Lookup result;
+  struct stat st {};
+  std::string etag;
+  if (::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) &&
+      static_cast<uint64_t>(st.st_size) <= capacityBytes_) {
+    result.cacheable = true;
+    etag = makeEtag(st);
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = entries_.find(path);
+  if (it == entries_.end()) {
+    return result;
+  }
+  if (it->second.file->etag() == etag) {
+    lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+    result.file = it->second.file;
+    return result;
+  }
+  VLOG(4) << "Dropping changed file " << path;
+  eraseLocked(it);
+  return result;
+}
+
+std::shared_ptr<const CachedFile> StaticFileCache::load(
+    const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  folly::File file(fd, true);
+  struct stat st {};
+  if (::fstat(file.fd(), &st) != 0) {
+    return nullptr;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    errno = EISDIR;
+    return nullptr;
+  }
+  // read outside of the lock
+  auto contents = folly::IOBuf::create(st.st_size);
+  auto bytesRead =
+      folly::readFull(file.fd(), contents->writableData(), st.st_size);
+  if (bytesRead < 0) {
+    return nullptr;
+  }
+  contents->append(bytesRead);
+  auto etag = makeEtag(st);
+  struct stat after {};
+  if (::fstat(file.fd(), &after) != 0) {
+    return nullptr;
+  }
+  if (static_cast<uint64_t>(bytesRead) != static_cast<uint64_t>(st.st_size) ||
+      makeEtag(after) != etag) {
+    // written to while we read, the bytes may not match the ETag
+    VLOG(4) << "File changed while reading " << path;
+    errno = EAGAIN;
+    return nullptr;
+  }
+  std::shared_ptr<const CachedFile> cached =
+      std::make_shared<CachedFile>(std::move(contents), std::move(etag));
+  if (cached->size() <= capacityBytes_) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    insertLocked(path, cached);
+  }
+  return cached;
+}
+
+uint64_t StaticFileCache::sizeBytes() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return sizeBytes_;
+}
+
+void StaticFileCache::insertLocked(const std::string& path,
+                                   std::shared_ptr<const CachedFile> file) {
+  auto it = entries_.find(path);
+  if (it != entries_.end()) {
+    // read concurrently by another request
+    eraseLocked(it);
+  }
+  while (!lru_.empty() && sizeBytes_ + file->size() > capacityBytes_) {
+    eraseLocked(entries_.find(lru_.back()));
+  }
+  sizeBytes_ += file->size();
+  lru_.push_front(path);
+  entries_.emplace(path, Entry{std::move(file), lru_.begin()});
+}
+
+void StaticFileCache::eraseLocked(
+    std::unordered_map<std::string, Entry>::iterator it) {
+  // responses in flight keep the contents alive
+  sizeBytes_ -= it->second.file->size();
+  lru_.erase(it->second.lruPos);
+  entries_.erase(it);
+}
+
+} // namespace quic::samples
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <folly/Range.h>
+#include <folly/io/IOBuf.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace quic::samples {
+
+enum class RangeStatus { Ignore, Unsatisfiable, Satisfiable };
+
+/**
+ * Parses a Range header for a resource of size bytes. Only single byte ranges
+ * are supported, others are ignored, which means serving the whole resource.
+ * Sets offset and length if the range is satisfiable.
+ */
+RangeStatus parseRangeHeader(folly::StringPiece header,
+                             uint64_t size,
+                             uint64_t& offset,
+                             uint64_t& length);
+
+/**
+ * The contents of a file read into memory, shared by the cache and the
+ * responses in flight. A snapshot: later changes to the file, including
+ * truncation, do not affect it.
+ */
+class CachedFile {
+ public:
+  CachedFile(std::unique_ptr<folly::IOBuf> contents, std::string etag);
+
+  uint64_t size() const {
+    return contents_->length();
+  }
+
+  // Strong validator derived from inode, size and modification time
+  const std::string& etag() const {
+    return etag_;
+  }
+
+  // [offset, offset + length) of the file, sharing the contents without a
+  // copy. The buffer keeps the contents alive.
+  std::unique_ptr<folly::IOBuf> slice(uint64_t offset, uint64_t length) const;
+
+ private:
+  std::unique_ptr<folly::IOBuf> contents_;
+  std::string etag_;
+};
+
+/**
+ * LRU of files read into memory, bounded by their total size. Files are read
+ * whole by load(), so later requests do not touch the disk. lookup()
+ * revalidates entries with a stat(2) of the path, which is cheap enough for
+ * the EventBase, and drops them when the file changed. Files are copied
+ * rather than mapped, so that a file truncated or rewritten in place neither
+ * faults the server nor changes the bytes served under an old ETag.
+ * Thread safe.
+ */
+class StaticFileCache {
+ public:
+  explicit StaticFileCache(uint64_t capacityBytes)
+      : capacityBytes_(capacityBytes) {
+  }
+
+  struct Lookup {
+    // the current contents of the file, nullptr on a miss
+    std::shared_ptr<const CachedFile> file;
+    // false if the path is not a regular file that fits in the cache
+    bool cacheable{false};
+  };
+
+  Lookup lookup(const std::string& path);
+
+  // Reads and caches path: meant for a CPU executor. Returns nullptr (with
+  // errno set) if the file cannot be read, is not a regular file or changed
+  // while it was read. A file that grew beyond the capacity since lookup() is
+  // read but not cached.
+  std::shared_ptr<const CachedFile> load(const std::string& path);
+
+  uint64_t sizeBytes() const;
+
+ private:
+  using LruList = std::list<std::string>;
+
+  struct Entry {
+    std::shared_ptr<const CachedFile> file;
+    LruList::iterator lruPos;
+  };
+
+  void insertLocked(const std::string& path,
+                    std::shared_ptr<const CachedFile> file);
+  void eraseLocked(std::unordered_map<std::string, Entry>::iterator it);
+
+  const uint64_t capacityBytes_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  // most recently used first
+  LruList lru_;
+  uint64_t sizeBytes_{0};
+};
+
+} // namespace quic::samples
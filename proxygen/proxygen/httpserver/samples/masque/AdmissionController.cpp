@@ -0,0 +1,172 @@
+#include "AdmissionController.h"
+
+#include "MasqueStats.h"
+#include <limits>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace MasqueService {
+
+namespace {
+
+int64_t steadyNowUs() {
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+uint64_t droppedDatagrams(const MasqueStats::Snapshot &snapshot) {
+  return snapshot[MasqueStats::DATAGRAMS_DROPPED_ON_READ] +
+         snapshot[MasqueStats::DATAGRAMS_DROPPED_ON_WRITE] +
+         snapshot[MasqueStats::DOWNSTREAM_DATAGRAM_WRITE_ERRORS];
+}
+
+} // namespace
+
+AdmissionController::AdmissionController(Options options)
+    : options(move(options)) {
+}
+
+AdmissionController::~AdmissionController() {
+  stop();
+}
+
+void AdmissionController::stop() {
+  {
+    lock_guard<mutex> lock(stopMutex);
+    stopping = true;
+  }
+  stopCv.notify_all();
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+void AdmissionController::install(quic::QuicServer &server) {
+  // only consulted for Initials without a valid retry token, a limit of 0
+  // answers all of them with a Retry
+  server.setUnfinishedHandshakeLimit([this]() {
+    return currentLevel() >= ELEVATED ? 0 : numeric_limits<int>::max();
+  });
+  server.rejectNewConnections(
+      [this]() { return currentLevel() == SATURATED; });
+}
+
+void AdmissionController::start(
+    const vector<folly::EventBase *> &workerEventBases) {
+  CHECK(!started.load());
+  auto now = steady_clock::now();
+  for (auto *eventBase : workerEventBases) {
+    auto worker = make_shared<Worker>(eventBase);
+    worker->calmSince = now;
+    workers.push_back(move(worker));
+  }
+  lastDrops = droppedDatagrams(MasqueStats::aggregate());
+  started.store(true, memory_order_release);
+  thread = std::thread([this]() { run(); });
+}
+
+void AdmissionController::run() {
+  unique_lock<mutex> lock(stopMutex);
+  while (!stopCv.wait_for(lock, options.interval, [this]() { return stopping; })) {
+    update();
+  }
+}
+
+void AdmissionController::update() {
+  auto snapshot = MasqueStats::aggregate();
+  auto drops = droppedDatagrams(snapshot);
+  auto intervalDrops = drops > lastDrops ? drops - lastDrops : 0;
+  lastDrops = drops;
+  auto queued = snapshot[MasqueStats::TUN_PACKETS_QUEUED];
+  auto dequeued = snapshot[MasqueStats::TUN_PACKETS_DEQUEUED];
+  auto tunQueueDepth = queued > dequeued ? queued - dequeued : 0;
+
+  auto now = steady_clock::now();
+  auto nowUs = duration_cast<microseconds>(now.time_since_epoch()).count();
+  for (size_t i = 0; i < workers.size(); i++) {
+    auto &worker = workers[i];
+    microseconds lag(worker->lagUs.load(memory_order_relaxed));
+    auto probePostedUs = worker->probePostedUs.load(memory_order_acquire);
+    if (probePostedUs != 0) {
+      // the worker has not even run the previous probe yet
+      lag = max(lag, microseconds(nowUs - probePostedUs));
+    } else {
+      worker->probePostedUs.store(nowUs, memory_order_release);
+      worker->eventBase->runInEventBaseThread([worker, nowUs]() {
+        worker->lagUs.store(steadyNowUs() - nowUs, memory_order_relaxed);
+        worker->probePostedUs.store(0, memory_order_release);
+      });
+    }
+
+    auto level = worker->level.load(memory_order_relaxed);
+    auto target = step(level,
+                       levelOf(lag, intervalDrops, tunQueueDepth),
+                       now,
+                       worker->calmSince);
+    if (target != level) {
+      worker->level.store(target, memory_order_relaxed);
+      LOG(WARNING) << "worker " << i << " admission " << name(level) << " -> "
+                   << name(target) << " (loop lag " << lag.count()
+                   << "us, dropped datagrams " << intervalDrops
+                   << ", tun queue " << tunQueueDepth << ")";
+    }
+  }
+}
+
+AdmissionController::Level AdmissionController::levelOf(
+    microseconds lag, uint64_t drops, uint64_t tunQueueDepth) const {
+  auto exceeds = [&](const Thresholds &thresholds) {
+    return lag >= thresholds.loopLag || drops >= thresholds.datagramDrops ||
+           tunQueueDepth >= thresholds.tunQueueDepth;
+  };
+  if (exceeds(options.saturated)) {
+    return SATURATED;
+  }
+  if (exceeds(options.elevated)) {
+    return ELEVATED;
+  }
+  return NORMAL;
+}
+
+AdmissionController::Level AdmissionController::step(
+    Level level,
+    Level target,
+    steady_clock::time_point now,
+    steady_clock::time_point &calmSince) const {
+  if (target >= level) {
+    calmSince = now;
+    return target;
+  }
+  if (now - calmSince >= options.coolDown) {
+    calmSince = now;
+    return static_cast<Level>(level - 1);
+  }
+  return level;
+}
+
+AdmissionController::Level AdmissionController::currentLevel() const {
+  if (!started.load(memory_order_acquire)) {
+    return NORMAL;
+  }
+  for (const auto &worker : workers) {
+    if (worker->eventBase->isInEventBaseThread()) {
+      return worker->level.load(memory_order_relaxed);
+    }
+  }
+  return NORMAL;
+}
+
+const char *AdmissionController::name(Level level) {
+  switch (level) {
+    case NORMAL:
+      return "normal";
+    case ELEVATED:
+      return "elevated";
+    case SATURATED:
+      return "saturated";
+  }
+  return "unknown";
+}
+
+} // namespace MasqueService
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <folly/io/async/EventBase.h>
+#include <memory>
+#include <mutex>
+#include <quic/server/QuicServer.h>
+#include <thread>
+#include <vector>
+
+namespace MasqueService {
+
+// Decides per worker how new connections are admitted, from the lag of the
+// worker's event loop, the datagrams dropped by all workers and the packets
+// read from the TUN device that still wait for a worker. Under load new
+// tunnels are refused so that the packets of the established ones keep
+// flowing:
+//  - ELEVATED: Initials without a retry token are answered with a Retry, so
+//    new connections cost a round trip and spoofed ones never get a transport
+//  - SATURATED: Initials are answered with version negotiation, clients give
+//    up or try again later
+// A level is entered as soon as a signal crosses its threshold, and left one
+// step at a time once all signals stayed below it for the cool down.
+class AdmissionController {
+  friend class AdmissionControllerTest;
+
+ public:
+  enum Level : std::uint8_t { NORMAL, ELEVATED, SATURATED };
+
+  struct Thresholds {
+    std::chrono::milliseconds loopLag;
+    // datagrams dropped by all workers per interval
+    std::uint64_t datagramDrops;
+    // packets read from the TUN device not handled by a worker yet
+    std::uint64_t tunQueueDepth;
+  };
+
+  struct Options {
+    std::chrono::milliseconds interval{100};
+    std::chrono::milliseconds coolDown{2000};
+    Thresholds elevated{std::chrono::milliseconds(5), 64, 1024};
+    Thresholds saturated{std::chrono::milliseconds(50), 1024, 16384};
+  };
+
+ private:
+  struct Worker {
+    explicit Worker(folly::EventBase *eventBase) : eventBase(eventBase) {
+    }
+
+    folly::EventBase *eventBase;
+    // steady clock time in microseconds of the pending probe, 0 if none
+    std::atomic<std::int64_t> probePostedUs{0};
+    std::atomic<std::int64_t> lagUs{0};
+    std::atomic<Level> level{NORMAL};
+    // only used by the controller thread
+    std::chrono::steady_clock::time_point calmSince;
+  };
+
+  const Options options;
+  // shared with the probes queued on the workers, which may outlive us
+  std::vector<std::shared_ptr<Worker>> workers;
+  std::atomic<bool> started{false};
+  std::uint64_t lastDrops{0};
+
+  std::mutex stopMutex;
+  std::condition_variable stopCv;
+  bool stopping{false};
+  std::thread thread;
+
+  void run();
+  void update();
+  Level levelOf(std::chrono::microseconds lag,
+                std::uint64_t drops,
+                std::uint64_t tunQueueDepth) const;
+  // next level of a worker at level whose signals ask for target: up at
+  // once, down one level per cool down the signals stayed below level
+  Level step(Level level,
+             Level target,
+             std::chrono::steady_clock::time_point now,
+             std::chrono::steady_clock::time_point &calmSince) const;
+  // level of the worker running the calling thread, NORMAL for other threads
+  Level currentLevel() const;
+
+ public:
+  explicit AdmissionController(Options);
+  ~AdmissionController();
+
+  // installs the admission checks, call before the server is started
+  void install(quic::QuicServer &);
+  // starts watching the workers, call once the server is initialized
+  void start(const std::vector<folly::EventBase *> &workerEventBases);
+  // stops watching the workers and joins the thread posting to their event
+  // bases, call before the server is destroyed
+  void stop();
+
+  static const char *name(Level);
+};
+
+} // namespace MasqueService
@@ -17,6 +17,15 @@ void TransactionHandler::setStreamUDPSocketMap(
   this->streamSocketMap = move(streamSocketMap);
 }
 
+void TransactionHandler::setQuicSocket(const quic::QuicSocket* quicSocket) {
+  this->quicSocket = quicSocket;
+}
+
+void TransactionHandler::setOuterECN(
+    shared_ptr<proxygen::ecn::OuterECN> outerECN) {
+  this->outerECN = move(outerECN);
+}
+
 void TransactionHandler::setTransaction(
     HTTPTransaction* httpTransaction) noexcept {
   this->httpTransaction = httpTransaction;
@@ -51,9 +60,18 @@ void DatagramSessionController::startSession(
 }
 
 HTTPTransactionHandler* DatagramSessionController::getRequestHandler(
-    HTTPTransaction&, HTTPMessage*) {
+    HTTPTransaction& httpTransaction, HTTPMessage*) {
   auto* transactionHandler = (*transactionHandlerGenerator)(eventBase);
   transactionHandler->setStreamUDPSocketMap(streamSocketMap);
+  if (auto* session = dynamic_cast<HQSession*>(
+          httpTransaction.getTransport().getHTTPSessionBase())) {
+    transactionHandler->setQuicSocket(session->getQuicSocket());
+    if (!outerECN) {
+      outerECN =
+          make_shared<proxygen::ecn::OuterECN>(session->getQuicSocket());
+    }
+    transactionHandler->setOuterECN(outerECN);
+  }
   return transactionHandler;
 }
 
@@ -118,15 +136,36 @@ void QuicSetupCallback::onConnectionSetupError(QuicError quicError) noexcept {
   delete this;
 }
 
+PmtuStatsObserver::PmtuStatsObserver()
+    : quic::LegacyObserver([]() {
+        quic::LegacyObserver::EventSet eventSet;
+        eventSet.enable(SocketObserverInterface::Events::pmtuEvents);
+        return eventSet;
+      }()) {
+}
+
+void PmtuStatsObserver::pmtuUpdated(
+    QuicSocket* socket, const SocketObserverInterface::PmtuUpdateEvent& event) {
+  MasqueStats::add(MasqueStats::PMTU_UPDATES);
+  VLOG(2) << "PMTU to " << socket->getPeerAddress().describe()
+          << " raised from " << event.previousPacketLen << " to "
+          << event.packetLen;
+}
+
 DatagramTransportFactory::DatagramTransportFactory(
     function<TransactionHandler*(EventBase*)> transactionHandlerGenerator,
     size_t timeout,
-    optional<string> qlogPath)
+    optional<string> qlogPath,
+    bool binaryQlog)
     : transactionHandlerGenerator(
           make_shared<function<TransactionHandler*(EventBase*)>>(
               move(transactionHandlerGenerator))),
       timeout(timeout),
-      qlogPath(move(qlogPath)) {
+      qlogPath(move(qlogPath)),
+      pmtuStatsObserver(make_shared<PmtuStatsObserver>()) {
+  if (this->qlogPath && binaryQlog) {
+    binaryQLogWriter = make_shared<BinaryQLogWriter>(*this->qlogPath);
+  }
 }
 
 quic::QuicServerTransport::Ptr DatagramTransportFactory::make(
@@ -157,8 +196,13 @@ quic::QuicServerTransport::Ptr DatagramTransportFactory::make(
   auto serverTransport = QuicServerTransport::make(
       eventBase, std::move(socket), setupCallback, nullptr, serverContext);
   setupCallback->quicSocket = serverTransport;
+  // only invoked when path MTU discovery is enabled
+  serverTransport->addObserver(pmtuStatsObserver);
 
-  if (qlogPath) {
+  if (binaryQLogWriter) {
+    serverTransport->setQLogger(
+        make_shared<BinaryQLogger>(VantagePoint::Server, binaryQLogWriter));
+  } else if (qlogPath) {
     serverTransport->setQLogger(std::make_shared<MasqueService::QLogger>(
         eventBase, *qlogPath, VantagePoint::Client));
   }
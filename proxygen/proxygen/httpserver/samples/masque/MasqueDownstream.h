@@ -6,6 +6,8 @@
 #include <memory>
 #include <proxygen/lib/http/session/HQSession.h>
 #include <proxygen/lib/http/session/HTTPTransaction.h>
+#include <proxygen/lib/transport/Ecn.h>
+#include <quic/logging/BinaryQLogger.h>
 #include <quic/server/QuicServer.h>
 
 namespace MasqueService {
@@ -15,6 +17,9 @@ class TransactionHandler : public proxygen::HTTPTransactionHandler {
  protected:
   proxygen::HTTPTransaction* httpTransaction = nullptr;
   std::weak_ptr<StreamSocketMap> streamSocketMap;
+  const quic::QuicSocket* quicSocket = nullptr;
+  // shared by the transactions of the connection
+  std::shared_ptr<proxygen::ecn::OuterECN> outerECN;
 
  public:
   TransactionHandler() = default;
@@ -22,6 +27,8 @@ class TransactionHandler : public proxygen::HTTPTransactionHandler {
 
  public:
   void setStreamUDPSocketMap(std::weak_ptr<StreamSocketMap>);
+  void setQuicSocket(const quic::QuicSocket*);
+  void setOuterECN(std::shared_ptr<proxygen::ecn::OuterECN>);
   // proxygen::HTTPTransactionHandler
   void setTransaction(proxygen::HTTPTransaction*) noexcept override;
   void detachTransaction() noexcept override{};
@@ -47,6 +54,8 @@ class DatagramSessionController
       transactionHandlerGenerator;
   const std::size_t timeout;
   std::shared_ptr<StreamSocketMap> streamSocketMap;
+  // created with the first transaction, see proxygen::ecn::OuterECN
+  std::shared_ptr<proxygen::ecn::OuterECN> outerECN;
 
  public:
   explicit DatagramSessionController(
@@ -93,6 +102,18 @@ class QuicSetupCallback : public quic::QuicSocket::ConnectionSetupCallback {
   void onConnectionSetupError(quic::QuicError) noexcept override;
 };
 
+// Counts and logs the path MTU updates of the server's connections
+class PmtuStatsObserver : public quic::LegacyObserver {
+
+ public:
+  PmtuStatsObserver();
+
+ public:
+  void pmtuUpdated(
+      quic::QuicSocket*,
+      const quic::SocketObserverInterface::PmtuUpdateEvent&) override;
+};
+
 class DatagramTransportFactory : public quic::QuicServerTransportFactory {
 
  private:
@@ -101,12 +122,17 @@ class DatagramTransportFactory : public quic::QuicServerTransportFactory {
       transactionHandlerGenerator;
   const std::size_t timeout;
   const std::optional<std::string> qlogPath;
+  // shared by all connections, set when qlogs are written in binary form
+  std::shared_ptr<quic::BinaryQLogWriter> binaryQLogWriter;
+  // shared by all connections
+  const std::shared_ptr<PmtuStatsObserver> pmtuStatsObserver;
 
  public:
   explicit DatagramTransportFactory(
       std::function<TransactionHandler*(folly::EventBase*)>,
       std::size_t,
-      std::optional<std::string>);
+      std::optional<std::string>,
+      bool binaryQlog = false);
   ~DatagramTransportFactory() override = default;
 
  public:
@@ -3,6 +3,7 @@
 #include "help/MasqueUtils.h"
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/program_options.hpp>
+#include <folly/Random.h>
 #include <folly/String.h>
 #include <folly/init/Init.h>
 #include <folly/ssl/Init.h>
@@ -55,6 +56,7 @@ void DatagramTransactionHandler::onHeadersComplete(
     response.setStatusMessage(errorMessage);
     httpTransaction->sendHeaders(response);
     LOG(INFO) << "got invalid connection: " << errorMessage;
+    MasqueStats::add(MasqueStats::REJECTED_REQUESTS);
   };
   const auto replyWithSuccess = [this]() {
     HTTPMessage response;
@@ -153,6 +155,9 @@ void DatagramTransactionHandler::onHeadersComplete(
   streamSocketMap.lock()->insert(httpTransaction->getID(), move(quicStream));
   replyWithSuccess();
   numberOfStreams++;
+  MasqueStats::add(streamType == QuicStream::UDP
+                       ? MasqueStats::CONNECT_UDP_STREAMS
+                       : MasqueStats::CONNECT_IP_STREAMS);
   if (streamType == QuicStream::IP) {
     // We immediately send a capsule to the client to let it know the IP address
     auto& properties =
@@ -179,6 +184,7 @@ void DatagramTransactionHandler::onBody(unique_ptr<IOBuf> body) noexcept {
   auto capsule = Capsule::parseCapsule(move(body));
   if (!capsule || capsule->type == Capsule::UNKNOWN) {
     // TODO: handle invalid capsule here
+    MasqueStats::add(MasqueStats::CAPSULE_ERRORS);
     return;
   }
   auto stream = getStream(httpTransaction->getID());
@@ -247,6 +253,7 @@ void DatagramTransactionHandler::onDatagram(
   auto parsedContextID =
       MasqueService::parseContextID(datagram->data(), datagram->length());
   if (!parsedContextID || parsedContextID->first != 0x00) {
+    MasqueStats::add(MasqueStats::INVALID_CONTEXT_IDS);
     return;
   }
   // EASY_END_BLOCK;
@@ -274,6 +281,13 @@ void DatagramTransactionHandler::onDatagram(
     // EASY_BLOCK("DatagramTransactionHandler::onDatagram
     // (2.2)");
     // auto serializedPacket = packet.serialize();
+    if (!ecn::decapsulate(datagram->writableData(),
+                          datagram->length(),
+                          outerECN ? outerECN->next(quicSocket)
+                                   : ecn::NOT_ECT)) {
+      MasqueStats::add(MasqueStats::TUN_DROPS_ECN);
+      return;
+    }
     tunDevice->write(datagram->writableData(), datagram->length());
     // EASY_END_BLOCK;
   }
@@ -343,6 +357,7 @@ void ConnectUDPCallback::onDataAvailable(
         auto res = downstreamTransaction->sendDatagram(move(payloadBuffer));
         if (!res) {
           LOG(ERROR) << "Failure to write: " << std::strerror(errno);
+          MasqueStats::add(MasqueStats::DOWNSTREAM_DATAGRAM_WRITE_ERRORS);
         }
       });
 }
@@ -390,13 +405,16 @@ void ConnectIPCallback::onPacket(uint8_t* buffer, size_t len) noexcept {
   payloadBuffer->coalesce();
   // forward to downstream
   auto unwrappedPayloadBuffer = move(*payloadBuffer);
+  MasqueStats::add(MasqueStats::TUN_PACKETS_QUEUED);
   eventBase->runInEventBaseThread(
       [this, unwrappedPayloadBuffer = move(unwrappedPayloadBuffer)]() {
         // EASY_BLOCK("ConnectIPCallback::onPacket lambda");
+        MasqueStats::add(MasqueStats::TUN_PACKETS_DEQUEUED);
         auto payloadBuffer = make_unique<IOBuf>(move(unwrappedPayloadBuffer));
         auto res = downstreamTransaction->sendDatagram(move(payloadBuffer));
         if (!res) {
           LOG(ERROR) << "Failure to write: " << std::strerror(errno);
+          MasqueStats::add(MasqueStats::DOWNSTREAM_DATAGRAM_WRITE_ERRORS);
         }
       });
 }
@@ -416,7 +434,9 @@ DatagramServer::DatagramServer(Options serverOptions)
     sharedTunDevice = std::make_unique<SharedTun>(std::move(tunDevice));
     tunDevicePtr->run();
   }
-  MasqueService::setQUICPacketLenV4(this->serverOptions.UDPSendPacketLen);
+  if (!this->serverOptions.pmtuDiscovery) {
+    MasqueService::setQUICPacketLenV4(this->serverOptions.UDPSendPacketLen);
+  }
   quicServer->setBindV6Only(false);
   quicServer->setCongestionControllerFactory(
       make_shared<ServerCongestionControllerFactory>());
@@ -424,19 +444,55 @@ DatagramServer::DatagramServer(Options serverOptions)
   MasqueService::applyPerformanceSettingsServer(transportSettings);
   transportSettings.datagramConfig.enabled = true;
   transportSettings.idleTimeout = milliseconds(this->serverOptions.timeout);
+  transportSettings.hibernateTimeout = this->serverOptions.hibernateTimeout;
+  // the tunnel controller leaves the pacing to the tunnelled flows
   transportSettings.pacingEnabled =
-      (this->serverOptions.ccAlgorithm != CongestionControlType::None);
+      (this->serverOptions.ccAlgorithm != CongestionControlType::None &&
+       this->serverOptions.ccAlgorithm != CongestionControlType::Tunnel);
+  transportSettings.tunnelCongestionConfig.shapingRateBytesPerSec =
+      this->serverOptions.tunnelShapingRate;
   transportSettings.defaultCongestionController =
       this->serverOptions.ccAlgorithm;
+  transportSettings.edtPacing = this->serverOptions.edtPacing;
+  transportSettings.enableEcnOnEgress = this->serverOptions.ecn;
+  transportSettings.readEcnOnIngress = this->serverOptions.ecn;
   transportSettings.datagramConfig.framePerPacket =
       this->serverOptions.framePerPacket;
-  transportSettings.canIgnorePathMTU = true;
+  transportSettings.datagramConfig.packingWindow =
+      this->serverOptions.datagramPackingWindow;
+  transportSettings.datagramConfig.coalesceMaxSize =
+      this->serverOptions.datagramCoalesceMaxSize;
+  if (this->serverOptions.pmtuDiscovery) {
+    transportSettings.enablePmtuDiscovery = true;
+    transportSettings.maxPmtuProbeSize = this->serverOptions.UDPSendPacketLen;
+  } else {
+    transportSettings.canIgnorePathMTU = true;
+  }
   transportSettings.maxRecvPacketSize = this->serverOptions.maxRecvPacketSize;
+  if (this->serverOptions.ackFrequency) {
+    // announcing min_ack_delay lets the clients thin out our ACKs, the
+    // policy thins out theirs
+    transportSettings.minAckDelay = kDefaultMinAckDelay;
+    transportSettings.ackFrequencyPolicy = AckFrequencyPolicyConfig();
+  }
   if (this->serverOptions.enableMigration) {
     transportSettings.disableMigration = false;
     transportSettings.maxNumMigrationsAllowed =
         std::numeric_limits<uint16_t>::max();
   }
+  if (this->serverOptions.admissionControl) {
+    // Retry is the first pushback of the admission controller
+    std::array<uint8_t, kRetryTokenSecretLength> retryTokenSecret;
+    folly::Random::secureRandom(retryTokenSecret.data(),
+                                retryTokenSecret.size());
+    transportSettings.retryTokenSecret = retryTokenSecret;
+  }
+  if (this->serverOptions.enableEarlyData) {
+    // roaming clients keep their 0-RTT, but are limited until validated
+    transportSettings.zeroRttSourceTokenMatchingPolicy =
+        ZeroRttSourceTokenMatchingPolicy::LIMIT_IF_NO_EXACT_MATCH;
+    transportSettings.issueNewTokens = true;
+  }
   quicServer->setTransportSettings(transportSettings);
   quicServer->setSupportedVersion({QuicVersion::MVFST,
                                    QuicVersion::MVFST_EXPERIMENTAL,
@@ -451,14 +507,47 @@ DatagramServer::DatagramServer(Options serverOptions)
                                                   this->sharedTunDevice.get());
           },
           this->serverOptions.timeout,
-          this->serverOptions.qlogPath));
+          this->serverOptions.qlogPath,
+          this->serverOptions.binaryQlog));
   quicServer->setQuicUDPSocketFactory(
       make_unique<QuicSharedUDPSocketFactory>());
+  quicServer->setTransportStatsCallbackFactory(
+      make_unique<MasqueTransportStatsFactory>());
   {
     samples::HQServerParams serverParams;
     serverParams.txnTimeout = milliseconds(this->serverOptions.timeout);
+    // resumed clients fall back to 1-RTT unless 0-RTT is enabled
+    serverParams.earlyData = this->serverOptions.enableEarlyData;
+    if (this->serverOptions.ticketSeedFile) {
+      serverParams.ticketSeedFilePath = *this->serverOptions.ticketSeedFile;
+    }
+    if (this->serverOptions.handshakeThreads > 0) {
+      // keeps reconnect storms from delaying the tunnels of the workers
+      handshakeExecutor = make_shared<folly::CPUThreadPoolExecutor>(
+          this->serverOptions.handshakeThreads,
+          make_shared<folly::NamedThreadFactory>("MasqueHandshake"));
+      serverParams.handshakeExecutor = handshakeExecutor;
+    }
     quicServer->setFizzContext(samples::createFizzServerContext(serverParams));
   }
+  if (this->serverOptions.maxWorkerHandshakes) {
+    quicServer->setWorkerUnfinishedHandshakeLimit(
+        *this->serverOptions.maxWorkerHandshakes);
+  }
+  if (this->serverOptions.admissionControl) {
+    admissionController = make_unique<AdmissionController>(
+        AdmissionController::Options{});
+    admissionController->install(*quicServer);
+  }
+  if (!this->serverOptions.workerCpus.empty()) {
+    // SO_INCOMING_CPU steers the packets of each NIC queue to the socket of
+    // the worker on its CPU, upstream sockets live on the worker's thread
+    quicServer->setWorkerCpus(this->serverOptions.workerCpus);
+  }
+  if (this->serverOptions.busyPollWorkers > 0) {
+    quicServer->setBusyPollWorkers(this->serverOptions.busyPollWorkers,
+                                   this->serverOptions.busyPoll);
+  }
   if (!this->serverOptions.qlogPath) {
     MasqueService::SignalHandler::install(SIGTERM, [this](int) {
       LOG(INFO) << "received SIGTERM, shutting down";
@@ -475,14 +564,49 @@ DatagramServer::~DatagramServer() {
 void DatagramServer::start() {
   size_t THREADS = std::getenv("THREADS") ? atoi(std::getenv("THREADS"))
                                           : std::thread::hardware_concurrency();
+  if (!serverOptions.workerCpus.empty()) {
+    THREADS = serverOptions.workerCpus.size();
+  }
   SocketAddress localAddress;
   localAddress.setFromLocalPort(serverOptions.port);
   quicServer->start(localAddress, THREADS);
   // blocks
   quicServer->waitUntilInitialized();
+  if (admissionController) {
+    admissionController->start(quicServer->getWorkerEvbs());
+  }
+  if (serverOptions.statsPort) {
+    statsServer = make_unique<StatsServer>(*serverOptions.statsPort);
+    LOG(INFO) << "serving stats on 127.0.0.1:" << *serverOptions.statsPort;
+  }
 }
 
 void DatagramServer::shutdown() {
+  if (admissionController) {
+    admissionController->stop();
+  }
+}
+
+// parses a CPU list like "0-3,8,10-11"
+optional<vector<int>> parseCpuList(const string& cpuList) {
+  vector<StringPiece> ranges;
+  split(',', cpuList, ranges, true);
+  vector<int> cpus;
+  for (auto range : ranges) {
+    StringPiece first, last;
+    if (!split('-', range, first, last)) {
+      first = last = range;
+    }
+    auto from = tryTo<int>(trimWhitespace(first));
+    auto to = tryTo<int>(trimWhitespace(last));
+    if (from.hasError() || to.hasError() || *from < 0 || *from > *to) {
+      return nullopt;
+    }
+    for (int cpu = *from; cpu <= *to; cpu++) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
 }
 
 } // namespace MasqueService
@@ -502,7 +626,7 @@ int main(int argc, char* argv[]) {
       po::value<string>()->default_value("None"),
       "set congestion control algorithm ('None' | 'Cubic' | 'NewReno' | 'Copa' "
       "| 'Copa2' "
-      "| 'BBR' | 'StaticCwnd')")("framePerPacket",
+      "| 'BBR' | 'StaticCwnd' | 'Tunnel')")("framePerPacket",
                                  po::value<bool>()->default_value(false),
                                  "force QUIC to use one frame for each packet")(
       "UDPSendPacketLen",
@@ -510,13 +634,71 @@ int main(int argc, char* argv[]) {
       "set UDPSendPacketLen (kDefaultUDPSendPacketLen)")(
       "maxRecvPacketSize", po::value<uint16_t>(), "set maxRecvPacketSize")(
       "qlog", po::value<string>(), "set qlog path")(
+      "binaryQlog",
+      po::value<bool>()->default_value(false),
+      "write binary qlogs (convert with bqlog2qlog)")(
       "datagramReadBuf",
       po::value<size_t>()->default_value(16384),
       "set datagram read buffer size")(
       "datagramWriteBuf",
       po::value<size_t>()->default_value(16384),
       "set datagram write buffer size")(
-      "tunMTU", po::value<size_t>()->default_value(1500), "set tun MTU");
+      "datagramPackingWindow",
+      po::value<uint32_t>()->default_value(1),
+      "number of queued datagrams a packet is filled from (1: FIFO)")(
+      "datagramCoalesceMaxSize",
+      po::value<uint32_t>()->default_value(0),
+      "with framePerPacket, coalesce datagrams up to this size (0: never)")(
+      "tunMTU", po::value<size_t>()->default_value(1500), "set tun MTU")(
+      "earlyData",
+      po::value<bool>()->default_value(false),
+      "accept 0-RTT CONNECT requests (replays are not detected)")(
+      "ticketSeedFile",
+      po::value<string>(),
+      "persist the session ticket secret (resumption across restarts), "
+      "created with mode 0600")(
+      "edtPacing",
+      po::value<bool>()->default_value(false),
+      "pace with SO_TXTIME departure times (needs fq qdisc)")(
+      "ecn",
+      po::value<bool>()->default_value(false),
+      "mark packets ECT(0) and copy CE marks into the tunnelled packets")(
+      "pmtud",
+      po::value<bool>()->default_value(false),
+      "discover the path MTU, UDPSendPacketLen is the largest size probed")(
+      "ackFrequency",
+      po::value<bool>()->default_value(false),
+      "adapt the ACK frequency of the clients to RTT and congestion window")(
+      "statsPort",
+      po::value<uint16_t>(),
+      "serve stats on this loopback port (/stats json, /metrics prometheus)")(
+      "handshakeThreads",
+      po::value<size_t>()->default_value(0),
+      "sign handshakes on this many threads instead of the workers")(
+      "maxWorkerHandshakes",
+      po::value<uint32_t>(),
+      "drop new connections of a worker with this many handshakes running")(
+      "admissionControl",
+      po::value<bool>()->default_value(false),
+      "push back on new connections (Retry, then version negotiation) while "
+      "workers are overloaded")(
+      "workerCpus",
+      po::value<string>(),
+      "run one worker pinned to each of these CPUs, e.g. the CPUs of the "
+      "NIC's receive queues (0-3,8-11)")(
+      "busyPollWorkers",
+      po::value<size_t>()->default_value(0),
+      "number of workers spinning on their sockets while there is traffic "
+      "(each takes a core)")(
+      "busyPollUs",
+      po::value<uint32_t>()->default_value(50),
+      "SO_BUSY_POLL of the busy poll workers' sockets")(
+      "tunnelShapingRate",
+      po::value<uint64_t>()->default_value(0),
+      "with --cc Tunnel, drop datagrams above this many bytes per second")(
+      "hibernateTimeout",
+      po::value<size_t>()->default_value(0),
+      "free the buffers of connections idle for this many ms (0: never)");
   po::variables_map variablesMap;
   po::store(po::parse_command_line(argc, argv, optionsDescription),
             variablesMap);
@@ -551,7 +733,45 @@ int main(int argc, char* argv[]) {
       .UDPSendPacketLen = variablesMap["UDPSendPacketLen"].as<uint16_t>(),
       .maxRecvPacketSize = variablesMap["maxRecvPacketSize"].as<uint16_t>(),
       .enableMigration = false,
-      .tunMTU = variablesMap["tunMTU"].as<size_t>()};
+      .tunMTU = variablesMap["tunMTU"].as<size_t>(),
+      .enableEarlyData = variablesMap["earlyData"].as<bool>(),
+      .edtPacing = variablesMap["edtPacing"].as<bool>(),
+      .ecn = variablesMap["ecn"].as<bool>()};
+  serverOptions.binaryQlog = variablesMap["binaryQlog"].as<bool>();
+  serverOptions.pmtuDiscovery = variablesMap["pmtud"].as<bool>();
+  serverOptions.ackFrequency = variablesMap["ackFrequency"].as<bool>();
+  serverOptions.tunnelShapingRate =
+      variablesMap["tunnelShapingRate"].as<uint64_t>();
+  serverOptions.datagramPackingWindow =
+      variablesMap["datagramPackingWindow"].as<uint32_t>();
+  serverOptions.datagramCoalesceMaxSize =
+      variablesMap["datagramCoalesceMaxSize"].as<uint32_t>();
+  serverOptions.hibernateTimeout =
+      milliseconds(variablesMap["hibernateTimeout"].as<size_t>());
+  if (variablesMap.count("statsPort")) {
+    serverOptions.statsPort = variablesMap["statsPort"].as<uint16_t>();
+  }
+  serverOptions.handshakeThreads = variablesMap["handshakeThreads"].as<size_t>();
+  serverOptions.admissionControl = variablesMap["admissionControl"].as<bool>();
+  if (variablesMap.count("maxWorkerHandshakes")) {
+    serverOptions.maxWorkerHandshakes =
+        variablesMap["maxWorkerHandshakes"].as<uint32_t>();
+  }
+  serverOptions.busyPollWorkers = variablesMap["busyPollWorkers"].as<size_t>();
+  serverOptions.busyPoll =
+      microseconds(variablesMap["busyPollUs"].as<uint32_t>());
+  if (variablesMap.count("workerCpus")) {
+    auto cpus =
+        MasqueService::parseCpuList(variablesMap["workerCpus"].as<string>());
+    if (!cpus) {
+      cout << "invalid workerCpus" << endl;
+      return 1;
+    }
+    serverOptions.workerCpus = move(*cpus);
+  }
+  if (variablesMap.count("ticketSeedFile")) {
+    serverOptions.ticketSeedFile = variablesMap["ticketSeedFile"].as<string>();
+  }
   if (variablesMap.count("qlog") &&
       !variablesMap["qlog"].as<string>().empty()) {
     serverOptions.qlogPath = variablesMap["qlog"].as<string>();
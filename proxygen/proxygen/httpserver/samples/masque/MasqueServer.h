@@ -1,10 +1,13 @@
 #pragma once
 
+#include "AdmissionController.h"
 #include "Capsule.h"
 #include "MasqueDownstream.h"
+#include "MasqueStats.h"
 #include "MasqueUpstream.h"
 #include "tuntap/TunManager.h"
 #include <boost/program_options.hpp>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <memory>
 #include <quic/server/QuicServer.h>
 
@@ -106,17 +109,58 @@ class DatagramServer {
     std::size_t timeout;
     folly::CIDRNetworkV4 tunNetwork;
     quic::CongestionControlType ccAlgorithm;
+    // bytes per second above which the tunnel congestion controller drops
+    // datagrams, 0 for none
+    std::uint64_t tunnelShapingRate{0};
     bool framePerPacket;
+    // see quic::DatagramConfig
+    std::uint32_t datagramPackingWindow{1};
+    std::uint32_t datagramCoalesceMaxSize{0};
     std::size_t UDPSendPacketLen;
     std::size_t maxRecvPacketSize;
     std::optional<std::string> qlogPath;
+    // write qlogs as binary records from a background thread, see bqlog2qlog
+    bool binaryQlog{false};
     bool enableMigration;
     std::size_t tunMTU;
+    // accept resumed sessions and 0-RTT CONNECT requests
+    bool enableEarlyData{false};
+    std::optional<std::string> ticketSeedFile;
+    // kernel (SO_TXTIME) pacing instead of pacing timer wakeups
+    bool edtPacing{false};
+    // ECT(0) on the outer packets, CE marks copied into the tunnelled ones
+    bool ecn{false};
+    // let both sides thin out each other's ACKs (ACK_FREQUENCY)
+    bool ackFrequency{false};
+    // discover the path MTU, UDPSendPacketLen is the largest size probed
+    bool pmtuDiscovery{false};
+    // loopback port of the stats endpoint, none to disable it
+    std::optional<std::uint16_t> statsPort;
+    // threads signing handshakes off the workers, 0 to sign on the workers
+    std::size_t handshakeThreads{0};
+    // handshakes a worker runs at once, new Initials beyond it are dropped
+    std::optional<std::uint32_t> maxWorkerHandshakes;
+    // refuse new connections while workers are overloaded
+    bool admissionControl{false};
+    // one worker pinned to each CPU, preferably the CPUs handling the NIC's
+    // receive queues, empty to let the scheduler place THREADS workers
+    std::vector<int> workerCpus;
+    // workers spinning on their sockets instead of blocking in epoll while
+    // there is traffic, with this SO_BUSY_POLL
+    std::size_t busyPollWorkers{0};
+    std::chrono::microseconds busyPoll{50};
+    // connections idle for this long free their buffers, 0 to keep them
+    std::chrono::milliseconds hibernateTimeout{0};
   };
 
  private:
+  // outlives the server, whose workers call into it. Its thread posts to the
+  // workers' event bases and is stopped in shutdown().
+  std::unique_ptr<AdmissionController> admissionController;
   std::shared_ptr<quic::QuicServer> quicServer;
+  std::shared_ptr<folly::CPUThreadPoolExecutor> handshakeExecutor;
   std::unique_ptr<SharedTun> sharedTunDevice;
+  std::unique_ptr<StatsServer> statsServer;
   const Options serverOptions;
 
  public:
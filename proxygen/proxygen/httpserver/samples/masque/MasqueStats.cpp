@@ -0,0 +1,459 @@
+#include "MasqueStats.h"
+
+#include <folly/dynamic.h>
+#include <folly/json.h>
+#include <mutex>
+#include <proxygen/httpserver/RequestHandler.h>
+#include <proxygen/httpserver/RequestHandlerFactory.h>
+#include <proxygen/httpserver/ResponseBuilder.h>
+#include <vector>
+
+using namespace proxygen;
+using namespace quic;
+using namespace std;
+
+namespace MasqueService {
+
+namespace {
+
+constexpr array<const char *, MasqueStats::NUM_COUNTERS> COUNTER_NAMES = {
+    "packets_received",
+    "packets_duplicated",
+    "packets_out_of_order",
+    "packets_processed",
+    "packets_sent",
+    "packets_retransmitted",
+    "packets_lost",
+    "packets_spuriously_lost",
+    "packets_dropped",
+    "packets_forwarded",
+    "forwarded_packets_received",
+    "forwarded_packets_processed",
+    "persistent_congestion",
+    "ptos",
+    "pacer_timer_lagged",
+    "padding_bytes",
+    "bytes_read",
+    "bytes_written",
+    "socket_write_errors",
+    "pmtu_updates",
+    "client_initials",
+    "connections_opened",
+    "connections_closed",
+    "connections_closed_zero_bytes_written",
+    "connections_rate_limited",
+    "connections_handshake_limited",
+    "connections_writable_bytes_limited",
+    "unfinished_handshakes",
+    "peer_address_changes",
+    "stateless_resets",
+    "connection_ids_created",
+    "new_tokens_received",
+    "new_tokens_issued",
+    "token_decrypt_failures",
+    "zero_rtt_buffered",
+    "zero_rtt_buffered_pruned",
+    "zero_rtt_accepted",
+    "zero_rtt_rejected",
+    "transport_knobs_applied",
+    "transport_knob_errors",
+    "quic_streams_opened",
+    "quic_streams_closed",
+    "quic_streams_reset",
+    "peer_bidi_streams_limit_saturated",
+    "conn_flow_control_updates",
+    "conn_flow_control_blocked",
+    "stream_flow_control_updates",
+    "stream_flow_control_blocked",
+    "cwnd_blocked",
+    "rtt_samples",
+    "rtt_sum_us",
+    "datagrams_read",
+    "datagram_bytes_read",
+    "datagrams_written",
+    "datagram_bytes_written",
+    "datagrams_dropped_on_read",
+    "datagrams_dropped_on_write",
+    "connect_udp_streams",
+    "connect_ip_streams",
+    "rejected_requests",
+    "capsule_errors",
+    "invalid_context_ids",
+    "tun_drops_unknown_destination",
+    "tun_drops_ecn",
+    "tun_packets_queued",
+    "tun_packets_dequeued",
+    "downstream_datagram_write_errors",
+};
+static_assert(COUNTER_NAMES.back() != nullptr, "every counter needs a name");
+
+// blocks are never freed, so the counts of exited threads are kept
+mutex blocksMutex;
+vector<unique_ptr<array<atomic<uint64_t>, MasqueStats::NUM_COUNTERS>>> blocks;
+
+} // namespace
+
+MasqueStats::Block &MasqueStats::local() {
+  // the mutex is only taken once per thread
+  thread_local Block *block = [] {
+    auto newBlock = make_unique<Block>();
+    for (auto &slot : *newBlock) {
+      slot.store(0, memory_order_relaxed);
+    }
+    lock_guard<mutex> guard(blocksMutex);
+    blocks.push_back(move(newBlock));
+    return blocks.back().get();
+  }();
+  return *block;
+}
+
+MasqueStats::Snapshot MasqueStats::aggregate() {
+  Snapshot snapshot{};
+  lock_guard<mutex> guard(blocksMutex);
+  for (const auto &block : blocks) {
+    for (size_t i = 0; i < NUM_COUNTERS; i++) {
+      snapshot[i] += (*block)[i].load(memory_order_relaxed);
+    }
+  }
+  return snapshot;
+}
+
+const char *MasqueStats::name(Counter counter) {
+  return COUNTER_NAMES[counter];
+}
+
+string MasqueStats::toJson(const Snapshot &snapshot) {
+  folly::dynamic object = folly::dynamic::object;
+  for (size_t i = 0; i < NUM_COUNTERS; i++) {
+    object[COUNTER_NAMES[i]] = snapshot[i];
+  }
+  return folly::toPrettyJson(object);
+}
+
+string MasqueStats::toPrometheus(const Snapshot &snapshot) {
+  string text;
+  for (size_t i = 0; i < NUM_COUNTERS; i++) {
+    string metric = string("masque_") + COUNTER_NAMES[i] + "_total";
+    text += "# TYPE " + metric + " counter\n";
+    text += metric + " " + to_string(snapshot[i]) + "\n";
+  }
+  return text;
+}
+
+/////////////////////
+// transport stats //
+/////////////////////
+
+void MasqueTransportStats::onPacketReceived() {
+  MasqueStats::add(MasqueStats::PACKETS_RECEIVED);
+}
+
+void MasqueTransportStats::onDuplicatedPacketReceived() {
+  MasqueStats::add(MasqueStats::PACKETS_DUPLICATED);
+}
+
+void MasqueTransportStats::onOutOfOrderPacketReceived() {
+  MasqueStats::add(MasqueStats::PACKETS_OUT_OF_ORDER);
+}
+
+void MasqueTransportStats::onPacketProcessed() {
+  MasqueStats::add(MasqueStats::PACKETS_PROCESSED);
+}
+
+void MasqueTransportStats::onPacketSent() {
+  MasqueStats::add(MasqueStats::PACKETS_SENT);
+}
+
+void MasqueTransportStats::onDSRPacketSent(size_t) {
+  MasqueStats::add(MasqueStats::PACKETS_SENT);
+}
+
+void MasqueTransportStats::onPacketRetransmission() {
+  MasqueStats::add(MasqueStats::PACKETS_RETRANSMITTED);
+}
+
+void MasqueTransportStats::onPacketLoss() {
+  MasqueStats::add(MasqueStats::PACKETS_LOST);
+}
+
+void MasqueTransportStats::onPacketSpuriousLoss() {
+  MasqueStats::add(MasqueStats::PACKETS_SPURIOUSLY_LOST);
+}
+
+void MasqueTransportStats::onPersistentCongestion() {
+  MasqueStats::add(MasqueStats::PERSISTENT_CONGESTION);
+}
+
+void MasqueTransportStats::onPacketDropped(PacketDropReason reason) {
+  MasqueStats::add(MasqueStats::PACKETS_DROPPED);
+  if (reason == PacketDropReason::HANDSHAKE_LIMITED) {
+    MasqueStats::add(MasqueStats::CONNECTIONS_HANDSHAKE_LIMITED);
+  }
+}
+
+void MasqueTransportStats::onPacketForwarded() {
+  MasqueStats::add(MasqueStats::PACKETS_FORWARDED);
+}
+
+void MasqueTransportStats::onForwardedPacketReceived() {
+  MasqueStats::add(MasqueStats::FORWARDED_PACKETS_RECEIVED);
+}
+
+void MasqueTransportStats::onForwardedPacketProcessed() {
+  MasqueStats::add(MasqueStats::FORWARDED_PACKETS_PROCESSED);
+}
+
+void MasqueTransportStats::onClientInitialReceived(QuicVersion) {
+  MasqueStats::add(MasqueStats::CLIENT_INITIALS);
+}
+
+void MasqueTransportStats::onConnectionRateLimited() {
+  MasqueStats::add(MasqueStats::CONNECTIONS_RATE_LIMITED);
+}
+
+void MasqueTransportStats::onConnectionWritableBytesLimited() {
+  MasqueStats::add(MasqueStats::CONNECTIONS_WRITABLE_BYTES_LIMITED);
+}
+
+void MasqueTransportStats::onNewTokenReceived() {
+  MasqueStats::add(MasqueStats::NEW_TOKENS_RECEIVED);
+}
+
+void MasqueTransportStats::onNewTokenIssued() {
+  MasqueStats::add(MasqueStats::NEW_TOKENS_ISSUED);
+}
+
+void MasqueTransportStats::onTokenDecryptFailure() {
+  MasqueStats::add(MasqueStats::TOKEN_DECRYPT_FAILURES);
+}
+
+void MasqueTransportStats::onNewConnection() {
+  MasqueStats::add(MasqueStats::CONNECTIONS_OPENED);
+}
+
+void MasqueTransportStats::onConnectionClose(folly::Optional<QuicErrorCode>) {
+  MasqueStats::add(MasqueStats::CONNECTIONS_CLOSED);
+}
+
+void MasqueTransportStats::onConnectionCloseZeroBytesWritten() {
+  MasqueStats::add(MasqueStats::CONNECTIONS_CLOSED_ZERO_BYTES_WRITTEN);
+}
+
+void MasqueTransportStats::onPeerAddressChanged() {
+  MasqueStats::add(MasqueStats::PEER_ADDRESS_CHANGES);
+}
+
+void MasqueTransportStats::onNewQuicStream() {
+  MasqueStats::add(MasqueStats::QUIC_STREAMS_OPENED);
+}
+
+void MasqueTransportStats::onQuicStreamClosed() {
+  MasqueStats::add(MasqueStats::QUIC_STREAMS_CLOSED);
+}
+
+void MasqueTransportStats::onQuicStreamReset(QuicErrorCode) {
+  MasqueStats::add(MasqueStats::QUIC_STREAMS_RESET);
+}
+
+void MasqueTransportStats::onConnFlowControlUpdate() {
+  MasqueStats::add(MasqueStats::CONN_FLOW_CONTROL_UPDATES);
+}
+
+void MasqueTransportStats::onConnFlowControlBlocked() {
+  MasqueStats::add(MasqueStats::CONN_FLOW_CONTROL_BLOCKED);
+}
+
+void MasqueTransportStats::onStatelessReset() {
+  MasqueStats::add(MasqueStats::STATELESS_RESETS);
+}
+
+void MasqueTransportStats::onStreamFlowControlUpdate() {
+  MasqueStats::add(MasqueStats::STREAM_FLOW_CONTROL_UPDATES);
+}
+
+void MasqueTransportStats::onStreamFlowControlBlocked() {
+  MasqueStats::add(MasqueStats::STREAM_FLOW_CONTROL_BLOCKED);
+}
+
+void MasqueTransportStats::onCwndBlocked() {
+  MasqueStats::add(MasqueStats::CWND_BLOCKED);
+}
+
+void MasqueTransportStats::onInflightBytesSample(uint64_t) {
+}
+
+void MasqueTransportStats::onRttSample(uint64_t rtt) {
+  MasqueStats::add(MasqueStats::RTT_SAMPLES);
+  MasqueStats::add(MasqueStats::RTT_SUM_US, rtt);
+}
+
+void MasqueTransportStats::onBandwidthSample(uint64_t) {
+}
+
+void MasqueTransportStats::onNewCongestionController(CongestionControlType) {
+}
+
+void MasqueTransportStats::onPTO() {
+  MasqueStats::add(MasqueStats::PTOS);
+}
+
+void MasqueTransportStats::onRead(size_t bufSize) {
+  MasqueStats::add(MasqueStats::BYTES_READ, bufSize);
+}
+
+void MasqueTransportStats::onWrite(size_t bufSize) {
+  MasqueStats::add(MasqueStats::BYTES_WRITTEN, bufSize);
+}
+
+void MasqueTransportStats::onUDPSocketWriteError(SocketErrorType) {
+  MasqueStats::add(MasqueStats::SOCKET_WRITE_ERRORS);
+}
+
+void MasqueTransportStats::onTransportKnobApplied(TransportKnobParamId) {
+  MasqueStats::add(MasqueStats::TRANSPORT_KNOBS_APPLIED);
+}
+
+void MasqueTransportStats::onTransportKnobError(TransportKnobParamId) {
+  MasqueStats::add(MasqueStats::TRANSPORT_KNOB_ERRORS);
+}
+
+void MasqueTransportStats::onTransportKnobOutOfOrder(TransportKnobParamId) {
+  MasqueStats::add(MasqueStats::TRANSPORT_KNOB_ERRORS);
+}
+
+void MasqueTransportStats::onServerUnfinishedHandshake() {
+  MasqueStats::add(MasqueStats::UNFINISHED_HANDSHAKES);
+}
+
+void MasqueTransportStats::onZeroRttBuffered() {
+  MasqueStats::add(MasqueStats::ZERO_RTT_BUFFERED);
+}
+
+void MasqueTransportStats::onZeroRttBufferedPruned() {
+  MasqueStats::add(MasqueStats::ZERO_RTT_BUFFERED_PRUNED);
+}
+
+void MasqueTransportStats::onZeroRttAccepted() {
+  MasqueStats::add(MasqueStats::ZERO_RTT_ACCEPTED);
+}
+
+void MasqueTransportStats::onZeroRttRejected() {
+  MasqueStats::add(MasqueStats::ZERO_RTT_REJECTED);
+}
+
+void MasqueTransportStats::onDatagramRead(size_t datagramSize) {
+  MasqueStats::add(MasqueStats::DATAGRAMS_READ);
+  MasqueStats::add(MasqueStats::DATAGRAM_BYTES_READ, datagramSize);
+}
+
+void MasqueTransportStats::onDatagramWrite(size_t datagramSize) {
+  MasqueStats::add(MasqueStats::DATAGRAMS_WRITTEN);
+  MasqueStats::add(MasqueStats::DATAGRAM_BYTES_WRITTEN, datagramSize);
+}
+
+void MasqueTransportStats::onDatagramDroppedOnWrite() {
+  MasqueStats::add(MasqueStats::DATAGRAMS_DROPPED_ON_WRITE);
+}
+
+void MasqueTransportStats::onDatagramDroppedOnRead() {
+  MasqueStats::add(MasqueStats::DATAGRAMS_DROPPED_ON_READ);
+}
+
+void MasqueTransportStats::onShortHeaderPadding(size_t padSize) {
+  MasqueStats::add(MasqueStats::PADDING_BYTES, padSize);
+}
+
+void MasqueTransportStats::onPacerTimerLagged() {
+  MasqueStats::add(MasqueStats::PACER_TIMER_LAGGED);
+}
+
+void MasqueTransportStats::onPeerMaxBidiStreamsLimitSaturated() {
+  MasqueStats::add(MasqueStats::PEER_BIDI_STREAMS_LIMIT_SATURATED);
+}
+
+void MasqueTransportStats::onConnectionIdCreated(size_t) {
+  MasqueStats::add(MasqueStats::CONNECTION_IDS_CREATED);
+}
+
+//////////////////
+// stats server //
+//////////////////
+
+namespace {
+
+class StatsHandler : public RequestHandler {
+
+ private:
+  string path;
+
+ public:
+  void onRequest(unique_ptr<HTTPMessage> headers) noexcept override {
+    path = headers->getPath();
+  }
+
+  void onBody(unique_ptr<folly::IOBuf>) noexcept override {
+  }
+
+  void onEOM() noexcept override {
+    if (path != "/stats" && path != "/metrics") {
+      ResponseBuilder(downstream_).status(404, "Not Found").sendWithEOM();
+      return;
+    }
+    auto snapshot = MasqueStats::aggregate();
+    bool json = path == "/stats";
+    ResponseBuilder(downstream_)
+        .status(200, "OK")
+        .header(HTTP_HEADER_CONTENT_TYPE,
+                json ? "application/json" : "text/plain; version=0.0.4")
+        .body(json ? MasqueStats::toJson(snapshot)
+                   : MasqueStats::toPrometheus(snapshot))
+        .sendWithEOM();
+  }
+
+  void onUpgrade(UpgradeProtocol) noexcept override {
+  }
+
+  void requestComplete() noexcept override {
+    delete this;
+  }
+
+  void onError(ProxygenError) noexcept override {
+    delete this;
+  }
+};
+
+class StatsHandlerFactory : public RequestHandlerFactory {
+
+ public:
+  void onServerStart(folly::EventBase *) noexcept override {
+  }
+
+  void onServerStop() noexcept override {
+  }
+
+  RequestHandler *onRequest(RequestHandler *, HTTPMessage *) noexcept override {
+    return new StatsHandler();
+  }
+};
+
+} // namespace
+
+StatsServer::StatsServer(uint16_t port) {
+  HTTPServerOptions options;
+  options.threads = 1;
+  options.idleTimeout = chrono::milliseconds(60000);
+  options.enableContentCompression = false;
+  options.handlerFactories =
+      RequestHandlerChain().addThen<StatsHandlerFactory>().build();
+  httpServer = make_unique<HTTPServer>(move(options));
+  httpServer->bind({{folly::SocketAddress("127.0.0.1", port),
+                     HTTPServer::Protocol::HTTP}});
+  serverThread = thread([this]() { httpServer->start(); });
+}
+
+StatsServer::~StatsServer() {
+  httpServer->stop();
+  serverThread.join();
+}
+
+} // namespace MasqueService
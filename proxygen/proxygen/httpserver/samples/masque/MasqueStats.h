@@ -0,0 +1,206 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <proxygen/httpserver/HTTPServer.h>
+#include <quic/state/QuicTransportStatsCallback.h>
+#include <string>
+#include <thread>
+
+namespace MasqueService {
+
+// Counters of the MASQUE server. Every thread writes into its own block of
+// counters (a relaxed load and store, no locked instruction and no lock), and
+// the blocks are only summed up when the stats are scraped.
+class MasqueStats {
+
+ public:
+  enum Counter : std::size_t {
+    // quic: packets
+    PACKETS_RECEIVED,
+    PACKETS_DUPLICATED,
+    PACKETS_OUT_OF_ORDER,
+    PACKETS_PROCESSED,
+    PACKETS_SENT,
+    PACKETS_RETRANSMITTED,
+    PACKETS_LOST,
+    PACKETS_SPURIOUSLY_LOST,
+    PACKETS_DROPPED,
+    PACKETS_FORWARDED,
+    FORWARDED_PACKETS_RECEIVED,
+    FORWARDED_PACKETS_PROCESSED,
+    PERSISTENT_CONGESTION,
+    PTOS,
+    PACER_TIMER_LAGGED,
+    PADDING_BYTES,
+    BYTES_READ,
+    BYTES_WRITTEN,
+    SOCKET_WRITE_ERRORS,
+    PMTU_UPDATES,
+    // quic: connections
+    CLIENT_INITIALS,
+    CONNECTIONS_OPENED,
+    CONNECTIONS_CLOSED,
+    CONNECTIONS_CLOSED_ZERO_BYTES_WRITTEN,
+    CONNECTIONS_RATE_LIMITED,
+    CONNECTIONS_HANDSHAKE_LIMITED,
+    CONNECTIONS_WRITABLE_BYTES_LIMITED,
+    UNFINISHED_HANDSHAKES,
+    PEER_ADDRESS_CHANGES,
+    STATELESS_RESETS,
+    CONNECTION_IDS_CREATED,
+    NEW_TOKENS_RECEIVED,
+    NEW_TOKENS_ISSUED,
+    TOKEN_DECRYPT_FAILURES,
+    ZERO_RTT_BUFFERED,
+    ZERO_RTT_BUFFERED_PRUNED,
+    ZERO_RTT_ACCEPTED,
+    ZERO_RTT_REJECTED,
+    TRANSPORT_KNOBS_APPLIED,
+    TRANSPORT_KNOB_ERRORS,
+    // quic: streams, flow and congestion control
+    QUIC_STREAMS_OPENED,
+    QUIC_STREAMS_CLOSED,
+    QUIC_STREAMS_RESET,
+    PEER_BIDI_STREAMS_LIMIT_SATURATED,
+    CONN_FLOW_CONTROL_UPDATES,
+    CONN_FLOW_CONTROL_BLOCKED,
+    STREAM_FLOW_CONTROL_UPDATES,
+    STREAM_FLOW_CONTROL_BLOCKED,
+    CWND_BLOCKED,
+    RTT_SAMPLES,
+    RTT_SUM_US,
+    // quic: datagrams
+    DATAGRAMS_READ,
+    DATAGRAM_BYTES_READ,
+    DATAGRAMS_WRITTEN,
+    DATAGRAM_BYTES_WRITTEN,
+    DATAGRAMS_DROPPED_ON_READ,
+    DATAGRAMS_DROPPED_ON_WRITE,
+    // masque
+    CONNECT_UDP_STREAMS,
+    CONNECT_IP_STREAMS,
+    REJECTED_REQUESTS,
+    CAPSULE_ERRORS,
+    INVALID_CONTEXT_IDS,
+    TUN_DROPS_UNKNOWN_DESTINATION,
+    TUN_DROPS_ECN,
+    // the difference is the TUN packets waiting for a worker
+    TUN_PACKETS_QUEUED,
+    TUN_PACKETS_DEQUEUED,
+    DOWNSTREAM_DATAGRAM_WRITE_ERRORS,
+    NUM_COUNTERS
+  };
+
+  using Snapshot = std::array<std::uint64_t, NUM_COUNTERS>;
+
+ private:
+  using Block = std::array<std::atomic<std::uint64_t>, NUM_COUNTERS>;
+
+  static Block &local();
+
+ public:
+  static void add(Counter counter, std::uint64_t value = 1) {
+    // only the owning thread writes to its block
+    auto &slot = local()[counter];
+    slot.store(slot.load(std::memory_order_relaxed) + value,
+               std::memory_order_relaxed);
+  }
+
+  // sums up the blocks of all threads
+  static Snapshot aggregate();
+
+  static const char *name(Counter);
+
+  static std::string toJson(const Snapshot &);
+  // Prometheus text exposition format
+  static std::string toPrometheus(const Snapshot &);
+};
+
+class MasqueTransportStats : public quic::QuicTransportStatsCallback {
+
+ public:
+  void onPacketReceived() override;
+  void onDuplicatedPacketReceived() override;
+  void onOutOfOrderPacketReceived() override;
+  void onPacketProcessed() override;
+  void onPacketSent() override;
+  void onDSRPacketSent(size_t) override;
+  void onPacketRetransmission() override;
+  void onPacketLoss() override;
+  void onPacketSpuriousLoss() override;
+  void onPersistentCongestion() override;
+  void onPacketDropped(quic::PacketDropReason) override;
+  void onPacketForwarded() override;
+  void onForwardedPacketReceived() override;
+  void onForwardedPacketProcessed() override;
+  void onClientInitialReceived(quic::QuicVersion) override;
+  void onConnectionRateLimited() override;
+  void onConnectionWritableBytesLimited() override;
+  void onNewTokenReceived() override;
+  void onNewTokenIssued() override;
+  void onTokenDecryptFailure() override;
+  void onNewConnection() override;
+  void onConnectionClose(folly::Optional<quic::QuicErrorCode>) override;
+  void onConnectionCloseZeroBytesWritten() override;
+  void onPeerAddressChanged() override;
+  void onNewQuicStream() override;
+  void onQuicStreamClosed() override;
+  void onQuicStreamReset(quic::QuicErrorCode) override;
+  void onConnFlowControlUpdate() override;
+  void onConnFlowControlBlocked() override;
+  void onStatelessReset() override;
+  void onStreamFlowControlUpdate() override;
+  void onStreamFlowControlBlocked() override;
+  void onCwndBlocked() override;
+  void onInflightBytesSample(uint64_t) override;
+  void onRttSample(uint64_t) override;
+  void onBandwidthSample(uint64_t) override;
+  void onNewCongestionController(quic::CongestionControlType) override;
+  void onPTO() override;
+  void onRead(size_t) override;
+  void onWrite(size_t) override;
+  void onUDPSocketWriteError(SocketErrorType) override;
+  void onTransportKnobApplied(quic::TransportKnobParamId) override;
+  void onTransportKnobError(quic::TransportKnobParamId) override;
+  void onTransportKnobOutOfOrder(quic::TransportKnobParamId) override;
+  void onServerUnfinishedHandshake() override;
+  void onZeroRttBuffered() override;
+  void onZeroRttBufferedPruned() override;
+  void onZeroRttAccepted() override;
+  void onZeroRttRejected() override;
+  void onDatagramRead(size_t) override;
+  void onDatagramWrite(size_t) override;
+  void onDatagramDroppedOnWrite() override;
+  void onDatagramDroppedOnRead() override;
+  void onShortHeaderPadding(size_t) override;
+  void onPacerTimerLagged() override;
+  void onPeerMaxBidiStreamsLimitSaturated() override;
+  void onConnectionIdCreated(size_t) override;
+};
+
+class MasqueTransportStatsFactory
+    : public quic::QuicTransportStatsCallbackFactory {
+
+ public:
+  std::unique_ptr<quic::QuicTransportStatsCallback> make() override {
+    return std::make_unique<MasqueTransportStats>();
+  }
+};
+
+// Serves the aggregated stats on a loopback port: /stats as JSON, /metrics
+// in the Prometheus text format
+class StatsServer {
+
+ private:
+  std::unique_ptr<proxygen::HTTPServer> httpServer;
+  std::thread serverThread;
+
+ public:
+  explicit StatsServer(std::uint16_t port);
+  ~StatsServer();
+};
+
+} // namespace MasqueService
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "MasqueStats.h"
 #include "help/MasqueUtils.h"
 #include "tuntap/PacketUtils.h"
 #include "tuntap/TunManager.h"
@@ -36,11 +37,13 @@ class SharedTun : public proxygen::TunDevice::ReadCallback {
   void onPacket(std::uint8_t* buf, std::size_t len) noexcept override {
     auto dstIP = MasqueService::PacketTranslator::dstIP(buf, len);
     if (!dstIP) {
+      MasqueStats::add(MasqueStats::TUN_DROPS_UNKNOWN_DESTINATION);
       return;
     }
     if (streamMap.find(*dstIP) == streamMap.end()) {
       auto ip = folly::IPAddressV4::fromLongHBO(*dstIP);
       LOG(WARNING) << __func__ << ": dstIP " << ip << " not found";
+      MasqueStats::add(MasqueStats::TUN_DROPS_UNKNOWN_DESTINATION);
       return;
     }
     auto callback = streamMap.at(*dstIP);
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/io/async/ScopedEventBaseThread.h>
+#include <folly/portability/GTest.h>
+#include <proxygen/httpserver/samples/masque/AdmissionController.h>
+
+using namespace std::chrono;
+
+namespace MasqueService {
+
+class AdmissionControllerTest : public testing::Test {
+ protected:
+  using Level = AdmissionController::Level;
+
+  AdmissionController::Level levelOf(microseconds lag,
+                                     uint64_t drops,
+                                     uint64_t tunQueueDepth) const {
+    return controller_.levelOf(lag, drops, tunQueueDepth);
+  }
+
+  AdmissionController::Level step(Level level,
+                                  Level target,
+                                  steady_clock::time_point now) {
+    return controller_.step(level, target, now, calmSince_);
+  }
+
+  AdmissionController::Options options_;
+  AdmissionController controller_{options_};
+  steady_clock::time_point calmSince_;
+};
+
+TEST_F(AdmissionControllerTest, LevelOf) {
+  // elevated: 5ms lag, 64 drops, 1024 queued; saturated: 50ms, 1024, 16384
+  EXPECT_EQ(levelOf(4ms, 63, 1023), AdmissionController::NORMAL);
+  EXPECT_EQ(levelOf(5ms, 0, 0), AdmissionController::ELEVATED);
+  EXPECT_EQ(levelOf(0ms, 64, 0), AdmissionController::ELEVATED);
+  EXPECT_EQ(levelOf(0ms, 0, 1024), AdmissionController::ELEVATED);
+  EXPECT_EQ(levelOf(49ms, 1023, 16383), AdmissionController::ELEVATED);
+  // a single signal is enough
+  EXPECT_EQ(levelOf(50ms, 0, 0), AdmissionController::SATURATED);
+  EXPECT_EQ(levelOf(0ms, 1024, 0), AdmissionController::SATURATED);
+  EXPECT_EQ(levelOf(0ms, 0, 16384), AdmissionController::SATURATED);
+}
+
+TEST_F(AdmissionControllerTest, CoolDownStepsDown) {
+  auto now = steady_clock::now();
+  calmSince_ = now;
+  // levels are entered at once
+  EXPECT_EQ(step(AdmissionController::NORMAL,
+                 AdmissionController::SATURATED,
+                 now),
+            AdmissionController::SATURATED);
+
+  // and left one level per cool down
+  auto coolDown = options_.coolDown;
+  EXPECT_EQ(step(AdmissionController::SATURATED,
+                 AdmissionController::NORMAL,
+                 now + coolDown - 1ms),
+            AdmissionController::SATURATED);
+  EXPECT_EQ(step(AdmissionController::SATURATED,
+                 AdmissionController::NORMAL,
+                 now + coolDown),
+            AdmissionController::ELEVATED);
+  EXPECT_EQ(step(AdmissionController::ELEVATED,
+                 AdmissionController::NORMAL,
+                 now + coolDown + coolDown / 2),
+            AdmissionController::ELEVATED);
+
+  // a signal at the current level restarts the cool down
+  EXPECT_EQ(step(AdmissionController::ELEVATED,
+                 AdmissionController::ELEVATED,
+                 now + coolDown * 3 / 2),
+            AdmissionController::ELEVATED);
+  EXPECT_EQ(step(AdmissionController::ELEVATED,
+                 AdmissionController::NORMAL,
+                 now + coolDown * 2),
+            AdmissionController::ELEVATED);
+  EXPECT_EQ(step(AdmissionController::ELEVATED,
+                 AdmissionController::NORMAL,
+                 now + coolDown * 5 / 2),
+            AdmissionController::NORMAL);
+}
+
+TEST_F(AdmissionControllerTest, StopBeforeWorkersGoAway) {
+  AdmissionController::Options options;
+  options.interval = 1ms;
+  AdmissionController controller(options);
+  {
+    folly::ScopedEventBaseThread worker;
+    controller.start({worker.getEventBase()});
+    std::this_thread::sleep_for(10ms);
+    // no probe is posted to the worker once stop() returns
+    controller.stop();
+  }
+  // stopping again, e.g. from the destructor, is a no-op
+  controller.stop();
+}
+
+} // namespace MasqueService
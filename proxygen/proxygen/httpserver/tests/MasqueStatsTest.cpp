@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <folly/json.h>
+#include <folly/portability/GTest.h>
+#include <proxygen/httpserver/samples/masque/MasqueStats.h>
+#include <thread>
+
+namespace MasqueService {
+
+TEST(MasqueStats, AggregatesAcrossThreads) {
+  constexpr uint64_t kIterations = 10000;
+  // counters are process wide, so only the change is checked
+  auto before = MasqueStats::aggregate();
+
+  auto bump = [] {
+    for (uint64_t i = 0; i < kIterations; i++) {
+      MasqueStats::add(MasqueStats::PACKETS_RECEIVED);
+      MasqueStats::add(MasqueStats::DATAGRAM_BYTES_READ, 3);
+    }
+  };
+  std::thread first(bump);
+  std::thread second(bump);
+  first.join();
+  second.join();
+
+  // the blocks of exited threads still count
+  auto after = MasqueStats::aggregate();
+  EXPECT_EQ(after[MasqueStats::PACKETS_RECEIVED] -
+                before[MasqueStats::PACKETS_RECEIVED],
+            2 * kIterations);
+  EXPECT_EQ(after[MasqueStats::DATAGRAM_BYTES_READ] -
+                before[MasqueStats::DATAGRAM_BYTES_READ],
+            6 * kIterations);
+  EXPECT_EQ(after[MasqueStats::PACKETS_SENT],
+            before[MasqueStats::PACKETS_SENT]);
+}
+
+TEST(MasqueStats, Json) {
+  MasqueStats::Snapshot snapshot{};
+  snapshot[MasqueStats::PACKETS_RECEIVED] = 20000;
+  snapshot[MasqueStats::DATAGRAM_BYTES_READ] = 60000;
+
+  auto json = folly::parseJson(MasqueStats::toJson(snapshot));
+  ASSERT_TRUE(json.isObject());
+  EXPECT_EQ(json.size(), MasqueStats::NUM_COUNTERS);
+  EXPECT_EQ(json["packets_received"].asInt(), 20000);
+  EXPECT_EQ(json["datagram_bytes_read"].asInt(), 60000);
+  EXPECT_EQ(json["packets_sent"].asInt(), 0);
+  for (size_t i = 0; i < MasqueStats::NUM_COUNTERS; i++) {
+    auto counter = static_cast<MasqueStats::Counter>(i);
+    EXPECT_EQ(json[MasqueStats::name(counter)].asInt(),
+              static_cast<int64_t>(snapshot[i]));
+  }
+}
+
+TEST(MasqueStats, Prometheus) {
+  MasqueStats::Snapshot snapshot{};
+  snapshot[MasqueStats::PACKETS_RECEIVED] = 20000;
+  snapshot[MasqueStats::DATAGRAM_BYTES_READ] = 60000;
+
+  auto text = MasqueStats::toPrometheus(snapshot);
+  EXPECT_NE(text.find("# TYPE masque_packets_received_total counter\n"
+                      "masque_packets_received_total 20000\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE masque_datagram_bytes_read_total counter\n"
+                      "masque_datagram_bytes_read_total 60000\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("\nmasque_packets_sent_total 0\n"), std::string::npos);
+  // one type line and one sample per counter
+  EXPECT_EQ(static_cast<size_t>(std::count(text.begin(), text.end(), '\n')),
+            2 * MasqueStats::NUM_COUNTERS);
+}
+
+} // namespace MasqueService
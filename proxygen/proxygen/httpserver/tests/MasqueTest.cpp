@@ -1,4 +1,5 @@
 #include <folly/portability/GTest.h>
+#include <proxygen/httpclient/samples/H3Datagram/LatencyHistogram.h>
 #include <proxygen/httpserver/samples/masque/Capsule.h>
 
 using namespace MasqueService;
@@ -9,3 +10,26 @@ TEST(Masque, TestCapsules) {
 
 TEST(Masque, TestIPSocket) {
 }
+
+TEST(Masque, TestLatencyHistogram) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.percentile(50), 0);
+  for (uint64_t i = 1; i <= 10000; i++) {
+    histogram.record(i);
+  }
+  EXPECT_EQ(histogram.count(), 10000);
+  EXPECT_EQ(histogram.min(), 1);
+  EXPECT_EQ(histogram.max(), 10000);
+  EXPECT_DOUBLE_EQ(histogram.mean(), 5000.5);
+  // values below 128 are exact, above the error stays below 1/64
+  EXPECT_EQ(histogram.percentile(1), 100);
+  EXPECT_NEAR(histogram.percentile(50), 5000, 5000 / 64);
+  EXPECT_NEAR(histogram.percentile(99), 9900, 9900 / 64);
+  EXPECT_EQ(histogram.percentile(100), 10000);
+
+  LatencyHistogram other;
+  other.record(std::chrono::microseconds(20000));
+  histogram.merge(other);
+  EXPECT_EQ(histogram.count(), 10001);
+  EXPECT_EQ(histogram.max(), 20000);
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <folly/FileUtil.h>
+#include <folly/experimental/TestUtil.h>
+#include <folly/portability/GTest.h>
+#include <proxygen/httpserver/samples/hq/StaticFileCache.h>
+
+using namespace quic::samples;
+
+namespace {
+RangeStatus parse(folly::StringPiece header,
+                  uint64_t size,
+                  uint64_t& offset,
+                  uint64_t& length) {
+  offset = length = 0;
+  return parseRangeHeader(header, size, offset, length);
+}
+} // namespace
+
+TEST(StaticFileCache, ParseRange) {
+  uint64_t offset, length;
+  EXPECT_EQ(parse("bytes=0-99", 1000, offset, length),
+            RangeStatus::Satisfiable);
+  EXPECT_EQ(offset, 0);
+  EXPECT_EQ(length, 100);
+  EXPECT_EQ(parse(" bytes=500-", 1000, offset, length),
+            RangeStatus::Satisfiable);
+  EXPECT_EQ(offset, 500);
+  EXPECT_EQ(length, 500);
+  // the last position is clamped to the size
+  EXPECT_EQ(parse("bytes=900-2000", 1000, offset, length),
+            RangeStatus::Satisfiable);
+  EXPECT_EQ(offset, 900);
+  EXPECT_EQ(length, 100);
+}
+
+TEST(StaticFileCache, ParseSuffixRange) {
+  uint64_t offset, length;
+  EXPECT_EQ(parse("bytes=-100", 1000, offset, length),
+            RangeStatus::Satisfiable);
+  EXPECT_EQ(offset, 900);
+  EXPECT_EQ(length, 100);
+  // longer than the resource, which is then sent whole
+  EXPECT_EQ(parse("bytes=-2000", 1000, offset, length),
+            RangeStatus::Satisfiable);
+  EXPECT_EQ(offset, 0);
+  EXPECT_EQ(length, 1000);
+  EXPECT_EQ(parse("bytes=-0", 1000, offset, length),
+            RangeStatus::Unsatisfiable);
+  EXPECT_EQ(parse("bytes=-5", 0, offset, length), RangeStatus::Unsatisfiable);
+}
+
+TEST(StaticFileCache, ParseOutOfRange) {
+  uint64_t offset, length;
+  EXPECT_EQ(parse("bytes=1000-", 1000, offset, length),
+            RangeStatus::Unsatisfiable);
+  EXPECT_EQ(parse("bytes=1000-1100", 1000, offset, length),
+            RangeStatus::Unsatisfiable);
+  EXPECT_EQ(parse("bytes=0-", 0, offset, length), RangeStatus::Unsatisfiable);
+}
+
+TEST(StaticFileCache, ParseIgnoredRanges) {
+  uint64_t offset, length;
+  // multiple ranges are not supported
+  EXPECT_EQ(parse("bytes=0-1,5-6", 1000, offset, length), RangeStatus::Ignore);
+  EXPECT_EQ(parse("bytes=-1, -2", 1000, offset, length), RangeStatus::Ignore);
+  EXPECT_EQ(parse("bytes=5-1", 1000, offset, length), RangeStatus::Ignore);
+  EXPECT_EQ(parse("items=0-1", 1000, offset, length), RangeStatus::Ignore);
+  EXPECT_EQ(parse("bytes=5", 1000, offset, length), RangeStatus::Ignore);
+  EXPECT_EQ(parse("bytes=a-b", 1000, offset, length), RangeStatus::Ignore);
+}
+
+class StaticFileCacheTest : public testing::Test {
+ protected:
+  // truncates and rewrites an existing file in place
+  std::string writeFile(const std::string& name, size_t size, char c = 'x') {
+    auto path = (dir_.path() / name).string();
+    CHECK(folly::writeFile(std::string(size, c), path.c_str()));
+    return path;
+  }
+
+  folly::test::TemporaryDirectory dir_;
+  StaticFileCache cache_{1000};
+};
+
+TEST_F(StaticFileCacheTest, LoadThenHit) {
+  auto path = writeFile("file", 100);
+  auto lookup = cache_.lookup(path);
+  EXPECT_TRUE(lookup.cacheable);
+  EXPECT_EQ(lookup.file, nullptr);
+
+  auto file = cache_.load(path);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->size(), 100);
+  EXPECT_EQ(cache_.sizeBytes(), 100);
+  EXPECT_EQ(file->slice(90, 10)->computeChainDataLength(), 10);
+
+  lookup = cache_.lookup(path);
+  EXPECT_TRUE(lookup.cacheable);
+  EXPECT_EQ(lookup.file, file);
+}
+
+TEST_F(StaticFileCacheTest, ChangedFileIsDropped) {
+  auto path = writeFile("file", 100);
+  auto file = cache_.load(path);
+  ASSERT_NE(file, nullptr);
+  writeFile("file", 200);
+  auto lookup = cache_.lookup(path);
+  EXPECT_TRUE(lookup.cacheable);
+  EXPECT_EQ(lookup.file, nullptr);
+  EXPECT_EQ(cache_.sizeBytes(), 0);
+
+  auto reloaded = cache_.load(path);
+  ASSERT_NE(reloaded, nullptr);
+  EXPECT_EQ(reloaded->size(), 200);
+  EXPECT_NE(reloaded->etag(), file->etag());
+}
+
+TEST_F(StaticFileCacheTest, TruncatedFileKeepsServedContents) {
+  auto path = writeFile("file", 100);
+  auto file = cache_.load(path);
+  ASSERT_NE(file, nullptr);
+  // the contents are a copy, so a response in flight still sends the bytes
+  // its ETag was computed for
+  writeFile("file", 10, 'y');
+  EXPECT_EQ(file->size(), 100);
+  EXPECT_EQ(file->slice(0, 100)->moveToFbString().toStdString(),
+            std::string(100, 'x'));
+  EXPECT_EQ(file->slice(90, 10)->moveToFbString().toStdString(),
+            std::string(10, 'x'));
+  EXPECT_EQ(cache_.lookup(path).file, nullptr);
+}
+
+TEST_F(StaticFileCacheTest, NotCacheable) {
+  // larger than the cache
+  EXPECT_FALSE(cache_.lookup(writeFile("large", 2000)).cacheable);
+  EXPECT_FALSE(cache_.lookup(dir_.path().string()).cacheable);
+  EXPECT_FALSE(cache_.lookup((dir_.path() / "missing").string()).cacheable);
+  EXPECT_EQ(cache_.load((dir_.path() / "missing").string()), nullptr);
+}
+
+TEST_F(StaticFileCacheTest, EvictsLeastRecentlyUsed) {
+  auto first = writeFile("first", 400);
+  auto second = writeFile("second", 400);
+  ASSERT_NE(cache_.load(first), nullptr);
+  ASSERT_NE(cache_.load(second), nullptr);
+  // makes second the least recently used
+  EXPECT_NE(cache_.lookup(first).file, nullptr);
+  ASSERT_NE(cache_.load(writeFile("third", 400)), nullptr);
+  EXPECT_EQ(cache_.sizeBytes(), 800);
+  EXPECT_NE(cache_.lookup(first).file, nullptr);
+  EXPECT_EQ(cache_.lookup(second).file, nullptr);
+}
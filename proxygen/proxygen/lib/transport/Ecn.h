@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <quic/api/QuicSocket.h>
+#include <quic/state/StateData.h>
+
+namespace proxygen {
+
+// RFC 6040 ECN handling for the IP packets carried over CONNECT-IP: the QUIC
+// connection is the tunnel, and the congestion it experiences (CE marks on
+// the outer packets) is copied into the inner packets leaving the tunnel, so
+// that tunnelled TCP and QUIC flows slow down without losing packets.
+namespace ecn {
+
+constexpr std::uint8_t NOT_ECT = quic::kEcnNotECT;
+constexpr std::uint8_t ECT_1 = quic::kEcnECT1;
+constexpr std::uint8_t ECT_0 = quic::kEcnECT0;
+constexpr std::uint8_t CE = quic::kEcnCE;
+
+namespace detail {
+
+// RFC 1624 incremental update of the checksum at checksum when the 16 bit
+// word oldWord of the covered data changes to newWord
+inline void updateChecksum(std::uint8_t* checksum,
+                           std::uint16_t oldWord,
+                           std::uint16_t newWord) {
+  std::uint32_t sum =
+      static_cast<std::uint16_t>(~((checksum[0] << 8) | checksum[1]));
+  sum += static_cast<std::uint16_t>(~oldWord);
+  sum += newWord;
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  auto result = static_cast<std::uint16_t>(~sum);
+  checksum[0] = result >> 8;
+  checksum[1] = result & 0xff;
+}
+
+} // namespace detail
+
+// ECN field of an IPv4 or IPv6 packet
+inline std::optional<std::uint8_t> getECN(const std::uint8_t* packet,
+                                          std::size_t length) {
+  if (length >= 20 && (packet[0] >> 4) == 4) {
+    return packet[1] & quic::kEcnMask;
+  }
+  if (length >= 40 && (packet[0] >> 4) == 6) {
+    return (packet[1] >> 4) & quic::kEcnMask;
+  }
+  return std::nullopt;
+}
+
+// rewrites the ECN field of an IPv4 or IPv6 packet, fixing up the IPv4 header
+// checksum incrementally
+inline bool setECN(std::uint8_t* packet, std::size_t length, std::uint8_t ecn) {
+  ecn &= quic::kEcnMask;
+  if (length >= 20 && (packet[0] >> 4) == 4) {
+    std::uint16_t oldWord = (packet[0] << 8) | packet[1];
+    packet[1] = (packet[1] & ~quic::kEcnMask) | ecn;
+    std::uint16_t newWord = (packet[0] << 8) | packet[1];
+    detail::updateChecksum(packet + 10, oldWord, newWord);
+    return true;
+  }
+  if (length >= 40 && (packet[0] >> 4) == 6) {
+    // IPv6 has no header checksum
+    packet[1] = (packet[1] & ~(quic::kEcnMask << 4)) | (ecn << 4);
+    return true;
+  }
+  return false;
+}
+
+// RFC 6040 section 4.2 (normal mode): combines the ECN of the outer packet
+// into the inner one. Returns false if the packet has to be dropped, which is
+// the case for CE on the outer packet of a non ECN capable inner packet.
+inline bool decapsulate(std::uint8_t* packet,
+                        std::size_t length,
+                        std::uint8_t outerECN) {
+  auto innerECN = getECN(packet, length);
+  if (!innerECN) {
+    return true;
+  }
+  outerECN &= quic::kEcnMask;
+  if (outerECN == CE) {
+    if (*innerECN == NOT_ECT) {
+      return false;
+    }
+    if (*innerECN != CE) {
+      setECN(packet, length, CE);
+    }
+  } else if (outerECN == ECT_1 && *innerECN == ECT_0) {
+    setECN(packet, length, ECT_1);
+  }
+  return true;
+}
+
+// The connection reports the ECN of its packets as counters only, so this
+// attributes them to the datagrams it delivers: each CE packet counted since
+// the last call marks one datagram CE. Everything else is ECT(0) if the peer
+// marks its packets, not-ECT otherwise. The CE counter is connection wide, so
+// all transactions of a connection must share one OuterECN.
+class OuterECN {
+ public:
+  // Starts after the CE marks the connection counted so far, those belong to
+  // packets that were delivered before
+  explicit OuterECN(const quic::QuicConnectionStateBase* state)
+      : ceMarksUsed_(state ? state->ackStates.appDataAckState.ecnCECountReceived
+                           : 0) {
+  }
+
+  explicit OuterECN(const quic::QuicSocket* quicSocket)
+      : OuterECN(quicSocket ? quicSocket->getState() : nullptr) {
+  }
+
+  std::uint8_t next(const quic::QuicConnectionStateBase* state) {
+    if (!state || !state->transportSettings.readEcnOnIngress) {
+      return NOT_ECT;
+    }
+    const auto& ackState = state->ackStates.appDataAckState;
+    if (ackState.ecnCECountReceived > ceMarksUsed_) {
+      ceMarksUsed_++;
+      return CE;
+    }
+    return ackState.ecnECT0CountReceived ? ECT_0 : NOT_ECT;
+  }
+
+  std::uint8_t next(const quic::QuicSocket* quicSocket) {
+    return next(quicSocket ? quicSocket->getState() : nullptr);
+  }
+
+ private:
+  std::uint64_t ceMarksUsed_{0};
+};
+
+} // namespace ecn
+} // namespace proxygen
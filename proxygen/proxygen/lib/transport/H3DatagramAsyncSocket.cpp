@@ -9,7 +9,13 @@
 #include <proxygen/lib/transport/H3DatagramAsyncSocket.h>
 
 #include "proxygen/httpserver/samples/masque/help/MasqueUtils.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <folly/FileUtil.h>
+#include <folly/hash/Hash.h>
+#include <folly/hash/SpookyHashV2.h>
+#include <folly/io/Cursor.h>
 #include <quic/fizz/client/handshake/FizzClientQuicHandshakeContext.h>
 #include <utility>
 #include <wangle/acceptor/TransportInfo.h>
@@ -46,6 +52,9 @@ void H3DatagramAsyncSocket::TransactionHandler::deliverDatagram(
   }
   datagram->coalesce();
   memcpy(buf, datagram->data(), datagram->length());
+  params.tos = outerECN && upstreamSession
+                   ? outerECN->next(upstreamSession->getQuicSocket())
+                   : ecn::NOT_ECT;
   readCallback->onDataAvailable(httpTransaction->getPeerAddress(),
                                 size_t(datagram->length()),
                                 /*truncated*/ false,
@@ -59,6 +68,26 @@ void H3DatagramAsyncSocket::TransactionHandler::setTransaction(
 
 void H3DatagramAsyncSocket::TransactionHandler::detachTransaction() noexcept {
   httpTransaction = nullptr;
+  releaseBuffers();
+}
+
+void H3DatagramAsyncSocket::TransactionHandler::releaseBuffers() {
+  {
+    unique_lock lock(writeBufMutex);
+    for (auto& datagram : writeBuf) {
+      BufferState::release(bufferState->sndBufBytes,
+                           datagram->computeChainDataLength());
+    }
+    writeBuf.clear();
+  }
+  {
+    unique_lock lock(readBufMutex);
+    for (auto& datagram : readBuf) {
+      BufferState::release(bufferState->rcvBufBytes,
+                           datagram->computeChainDataLength());
+    }
+    readBuf.clear();
+  }
 }
 
 void H3DatagramAsyncSocket::TransactionHandler::onHeadersComplete(
@@ -73,6 +102,8 @@ void H3DatagramAsyncSocket::TransactionHandler::onHeadersComplete(
   {
     unique_lock lock(writeBufMutex);
     for (auto& datagram : writeBuf) {
+      BufferState::release(bufferState->sndBufBytes,
+                           datagram->computeChainDataLength());
       httpTransaction->sendDatagram(std::move(datagram));
     }
     writeBuf.clear();
@@ -85,10 +116,14 @@ void H3DatagramAsyncSocket::TransactionHandler::onDatagram(
     {
       unique_lock lock(readBufMutex);
       if (!readCallback) {
-        if (readBuf.size() < rcvBufPkts_) {
+        if (BufferState::tryReserve(bufferState->rcvBufBytes,
+                                    bufferState->rcvBufPeakBytes,
+                                    bufferState->rcvBufLimit,
+                                    datagram->computeChainDataLength())) {
           // buffer until reads are resumed
           readBuf.emplace_back(std::move(datagram));
         } else {
+          bufferState->rcvDroppedDatagrams++;
           VLOG_EVERY_N(2, 1000) << "Dropped incoming datagram.";
         }
         return;
@@ -144,10 +179,35 @@ void H3DatagramAsyncSocket::TransactionHandler::onEgressPaused() noexcept {
 void H3DatagramAsyncSocket::TransactionHandler::onEgressResumed() noexcept {
 }
 
-// H3DatagramAsyncSocket
+// H3DatagramAsyncSocket::BufferState
+
+bool H3DatagramAsyncSocket::BufferState::tryReserve(
+    std::atomic<size_t>& bytes,
+    std::atomic<size_t>& peakBytes,
+    size_t limit,
+    size_t len) {
+  auto current = bytes.load(std::memory_order_relaxed);
+  do {
+    if (current + len > limit) {
+      return false;
+    }
+  } while (!bytes.compare_exchange_weak(
+      current, current + len, std::memory_order_relaxed));
+  auto peak = peakBytes.load(std::memory_order_relaxed);
+  while (current + len > peak &&
+         !peakBytes.compare_exchange_weak(
+             peak, current + len, std::memory_order_relaxed)) {
+  }
+  return true;
+}
+
+void H3DatagramAsyncSocket::BufferState::release(std::atomic<size_t>& bytes,
+                                                 size_t len) {
+  auto previous = bytes.fetch_sub(len, std::memory_order_relaxed);
+  DCHECK_GE(previous, len);
+}
 
-unsigned int H3DatagramAsyncSocket::rcvBufPkts_;
-unsigned int H3DatagramAsyncSocket::sndBufPkts_;
+// H3DatagramAsyncSocket
 
 H3DatagramAsyncSocket::H3DatagramAsyncSocket(
     folly::EventBase* evb,
@@ -159,8 +219,68 @@ H3DatagramAsyncSocket::H3DatagramAsyncSocket(
       socketGenerator_(std::move(socketGenerator)),
       transportConnected_(false) {
   CHECK(socketGenerator_ != nullptr);
-  rcvBufPkts_ = 100;
-  sndBufPkts_ = 100;
+  bufferState_.rcvBufLimit = options_.rcvBufBytes_;
+  bufferState_.sndBufLimit = options_.sndBufBytes_;
+}
+
+H3DatagramAsyncSocket::BufferStats H3DatagramAsyncSocket::getBufferStats()
+    const {
+  BufferStats stats;
+  stats.rcvBufLimit = bufferState_.rcvBufLimit;
+  stats.sndBufLimit = bufferState_.sndBufLimit;
+  stats.rcvBufBytes = bufferState_.rcvBufBytes;
+  stats.sndBufBytes = bufferState_.sndBufBytes;
+  stats.rcvBufPeakBytes = bufferState_.rcvBufPeakBytes;
+  stats.sndBufPeakBytes = bufferState_.sndBufPeakBytes;
+  stats.rcvDroppedDatagrams = bufferState_.rcvDroppedDatagrams;
+  stats.sndDroppedDatagrams = bufferState_.sndDroppedDatagrams;
+  return stats;
+}
+
+void H3DatagramAsyncSocket::autoSizeBuffers() {
+  if (!options_.autoSizeBuffers_ || !upstreamSession_ ||
+      !upstreamSession_->getQuicSocket()) {
+    return;
+  }
+  auto transportInfo = upstreamSession_->getQuicSocket()->getTransportInfo();
+  if (transportInfo.srtt.count() == 0) {
+    return;
+  }
+  // The congestion window approximates the bandwidth-delay product. Without
+  // congestion control it is unbounded, so fall back to what is in flight.
+  uint64_t bdp = transportInfo.congestionWindow;
+  if (transportInfo.congestionControlType ==
+          quic::CongestionControlType::None ||
+      bdp == std::numeric_limits<uint64_t>::max()) {
+    bdp = transportInfo.bytesInFlight;
+  } else if (transportInfo.congestionControlType ==
+             quic::CongestionControlType::Tunnel) {
+    // the tunnel controller drops what does not fit into the buffers, so
+    // they must not queue more than the actual bandwidth-delay product
+    bdp /= options_.transportSettings.tunnelCongestionConfig.cwndGain;
+  }
+  auto limit = std::clamp<uint64_t>(
+      bdp, options_.minAutoBufBytes_, options_.maxAutoBufBytes_);
+  if (limit != bufferState_.rcvBufLimit || limit != bufferState_.sndBufLimit) {
+    VLOG(4) << "Resizing datagram buffers to " << limit << " bytes (srtt="
+            << transportInfo.srtt.count() << "us, cwnd="
+            << transportInfo.congestionWindow << ")";
+  }
+  bufferState_.rcvBufLimit = limit;
+  bufferState_.sndBufLimit = limit;
+}
+
+void H3DatagramAsyncSocket::scheduleAutoSizeBuffers() {
+  if (!options_.autoSizeBuffers_) {
+    return;
+  }
+  if (!autoSizeTimer_) {
+    autoSizeTimer_ = folly::AsyncTimeout::make(*evb_, [this]() noexcept {
+      autoSizeBuffers();
+      scheduleAutoSizeBuffers();
+    });
+  }
+  autoSizeTimer_->scheduleTimeout(options_.autoSizeInterval_);
 }
 
 const folly::SocketAddress& H3DatagramAsyncSocket::address() const {
@@ -172,54 +292,196 @@ const folly::SocketAddress& H3DatagramAsyncSocket::address() const {
 }
 
 void H3DatagramAsyncSocket::connectSuccess() {
-  if (!options_.httpRequest_) {
-    LOG(ERROR) << "No HTTP Request";
-    return;
-  }
   if (!upstreamSession_) {
     LOG(ERROR) << "ConnectSuccess with invalid session";
     return;
   }
-  {
+  createTransactions(0, upstreamSession_);
+  transportConnected_ = true;
+  autoSizeBuffers();
+  scheduleAutoSizeBuffers();
+}
+
+size_t H3DatagramAsyncSocket::connectionForTransaction(
+    size_t transactionIndex) const {
+  return transactionIndex % std::max<size_t>(options_.connections_, 1);
+}
+
+HTTPCodec::StreamID H3DatagramAsyncSocket::transactionId(
+    size_t connectionIndex, HTTPCodec::StreamID streamID) const {
+  auto connections = std::max<size_t>(options_.connections_, 1);
+  CHECK_LT(connectionIndex, connections);
+  return streamID * connections + connectionIndex;
+}
+
+void H3DatagramAsyncSocket::createTransactions(size_t connectionIndex,
+                                               HQUpstreamSession* session) {
+  if (!options_.httpRequest_) {
+    LOG(ERROR) << "No HTTP Request";
+    return;
+  }
+  if (!options_.pmtuDiscovery_) {
     // weird fix but works
-    auto* client = static_cast<quic::QuicClientTransport*>(
-        upstreamSession_->getQuicSocket());
+    auto* client =
+        static_cast<quic::QuicClientTransport*>(session->getQuicSocket());
     client->getStateNonConst()->udpSendPacketLen = options_.maxSendSize_;
   }
+  // the CE marks counted before the transactions exist are not theirs
+  auto outerECN = make_shared<ecn::OuterECN>(session->getQuicSocket());
   for (size_t i = 0; i < options_.transactions_; i++) {
-    auto handler = make_unique<TransactionHandler>(options_, upstreamSession_);
-    auto* txn = upstreamSession_->newTransaction(handler.get());
+    if (connectionForTransaction(i) != connectionIndex) {
+      continue;
+    }
+    auto handler =
+        make_unique<TransactionHandler>(options_, &bufferState_, session);
+    handler->setOuterECN(outerECN);
+    auto* txn = session->newTransaction(handler.get());
     handler->setTransaction(txn);
     if (!txn || !txn->canSendHeaders()) {
-      LOG(ERROR) << "Transaction Error on i=" << i;
+      LOG(ERROR) << "Transaction Error on i=" << i
+                 << " connection=" << connectionIndex;
       return;
     }
     // send the HTTPMessage
     txn->sendHeaders(*options_.httpRequest_);
-    auto streamID = txn->getID();
-    if (i == 0 && defaultReadCallback_) {
-      handler->setReadCallback(defaultReadCallback_);
-      LOG(INFO) << "Setting default read callback for streamID="
-                << txn->getID();
-    }
+    // stream ids repeat across the connections of the pool
+    auto streamID = transactionId(connectionIndex, txn->getID());
+    CHECK(!transactions_.count(streamID));
     // move to map
     if (!defaultStreamId_) {
       defaultStreamId_ = streamID;
+      if (defaultReadCallback_) {
+        handler->setReadCallback(defaultReadCallback_);
+        LOG(INFO) << "Setting default read callback for streamID="
+                  << streamID;
+      }
       // move write buffer
       handler->writeBuffer() = std::move(writeBuf);
     }
     transactions_[streamID] = std::move(handler);
+    orderedStreamIds_.push_back(streamID);
     if (newTransactionCallback_) {
       (*newTransactionCallback_)(streamID);
     }
-    LOG(INFO) << "Created transaction for streamID=" << streamID;
+    LOG(INFO) << "Created transaction " << streamID << " for streamID="
+              << txn->getID() << " on connection " << connectionIndex;
   }
+  session->closeWhenIdle();
+}
 
-  upstreamSession_->closeWhenIdle();
-  transportConnected_ = true;
+folly::Optional<size_t> H3DatagramAsyncSocket::getDatagramSizeLimit() const {
+  folly::Optional<size_t> limit;
+  for (auto& [_, handler] : transactions_) {
+    if (auto* txn = handler->getTransaction()) {
+      limit = std::min(limit.value_or(txn->getDatagramSizeLimit()),
+                       txn->getDatagramSizeLimit());
+    }
+  }
+  return limit;
+}
+
+void H3DatagramAsyncSocket::onPmtuUpdated(
+    const quic::SocketObserverInterface::PmtuUpdateEvent& event) {
+  auto limit = getDatagramSizeLimit();
+  LOG(INFO) << "PMTU to " << connectAddress_.describe() << " raised from "
+            << event.previousPacketLen << " to " << event.packetLen
+            << ", datagram size limit=" << limit.value_or(0);
+  if (limit && datagramSizeLimitCallback_) {
+    (*datagramSizeLimitCallback_)(*limit);
+  }
+}
+
+folly::Optional<HTTPCodec::StreamID> H3DatagramAsyncSocket::selectTransaction(
+    uint64_t flowHash) const {
+  if (orderedStreamIds_.empty()) {
+    return folly::none;
+  }
+  return orderedStreamIds_[folly::hash::twang_mix64(flowHash) %
+                           orderedStreamIds_.size()];
+}
+
+folly::Optional<uint64_t> H3DatagramAsyncSocket::ipFlowHash(
+    const folly::IOBuf& packet) {
+  constexpr uint8_t kProtocolTCP = 6;
+  constexpr uint8_t kProtocolUDP = 17;
+  // the longest IPv4 header and the ports
+  std::array<uint8_t, 64> header;
+  folly::io::Cursor cursor(&packet);
+  auto length = cursor.pullAtMost(header.data(), header.size());
+  if (length == 0) {
+    return folly::none;
+  }
+  // addresses, protocol and ports
+  std::array<uint8_t, 37> key;
+  size_t keyLength = 0;
+  uint8_t protocol = 0;
+  size_t transportOffset = 0;
+  auto version = header[0] >> 4;
+  if (version == 4 && length >= 20) {
+    protocol = header[9];
+    memcpy(key.data(), header.data() + 12, 8);
+    keyLength = 8;
+    // only the first fragment carries the ports
+    bool fragment = (header[6] & 0x3f) || header[7];
+    if (!fragment) {
+      transportOffset = (header[0] & 0x0f) * 4;
+    }
+  } else if (version == 6 && length >= 40) {
+    // extension headers are not parsed, such packets hash without ports
+    protocol = header[6];
+    memcpy(key.data(), header.data() + 8, 32);
+    keyLength = 32;
+    transportOffset = 40;
+  } else {
+    return folly::none;
+  }
+  key[keyLength++] = protocol;
+  if ((protocol == kProtocolTCP || protocol == kProtocolUDP) &&
+      transportOffset >= 20 && transportOffset + 4 <= length) {
+    memcpy(key.data() + keyLength, header.data() + transportOffset, 4);
+    keyLength += 4;
+  }
+  return folly::hash::SpookyHashV2::Hash64(key.data(), keyLength, 0);
+}
+
+// H3DatagramAsyncSocket::PmtuObserver
+
+H3DatagramAsyncSocket::PmtuObserver::PmtuObserver(
+    H3DatagramAsyncSocket* parent)
+    : quic::QuicSocket::ManagedObserver([]() {
+        quic::QuicSocket::ManagedObserver::EventSet eventSet;
+        eventSet.enable(quic::SocketObserverInterface::Events::pmtuEvents);
+        return eventSet;
+      }()),
+      parent(parent) {
+}
+
+void H3DatagramAsyncSocket::PmtuObserver::pmtuUpdated(
+    quic::QuicSocket*,
+    const quic::SocketObserverInterface::PmtuUpdateEvent& event) {
+  parent->onPmtuUpdated(event);
+}
+
+// H3DatagramAsyncSocket::PoolConnection
+
+void H3DatagramAsyncSocket::PoolConnection::connectSuccess() {
+  if (!upstreamSession) {
+    LOG(ERROR) << "ConnectSuccess with invalid session on connection "
+               << index;
+    return;
+  }
+  parent->createTransactions(index, upstreamSession);
+}
+
+void H3DatagramAsyncSocket::PoolConnection::connectError(
+    quic::QuicError error) {
+  LOG(ERROR) << "ConnectError " << error << " on connection " << index
+             << " address=" << parent->options_.targetAddress_;
 }
 
 void H3DatagramAsyncSocket::onReplaySafe() {
+  VLOG(4) << "Connection to " << connectAddress_.describe()
+          << " is replay safe";
 }
 
 void H3DatagramAsyncSocket::connectError(quic::QuicError error) {
@@ -247,21 +509,26 @@ ssize_t H3DatagramAsyncSocket::write(HTTPCodec::StreamID streamID,
   }
   auto* handler = transactions_[streamID].get();
   auto* txn = handler->getTransaction();
+  if (!txn) {
+    LOG(ERROR) << "HTTP/3 transaction " << streamID
+               << " is closed. Discarding datagram";
+    errno = ECANCELED;
+    return -1;
+  }
   if (!transportConnected_) {
-    if (handler->writeBuffer().size() < sndBufPkts_) {
+    if (BufferState::tryReserve(bufferState_.sndBufBytes,
+                                bufferState_.sndBufPeakBytes,
+                                bufferState_.sndBufLimit,
+                                size)) {
       VLOG(10) << "Socket not connected yet. Buffering datagram";
       handler->writeBuffer().emplace_back(buf->clone());
       return size;
     }
+    bufferState_.sndDroppedDatagrams++;
     LOG(ERROR) << "Socket write buffer is full. Discarding datagram";
     errno = ENOBUFS;
     return -1;
   }
-  if (!transactions_.count(streamID)) {
-    LOG(ERROR) << "Unable to create HTTP/3 transaction. Discarding datagram";
-    errno = ECANCELED;
-    return -1;
-  }
   if (size > txn->getDatagramSizeLimit()) {
     auto datagramSizeLimit = txn->getDatagramSizeLimit();
     LOG(ERROR) << "streamID=" << streamID << ": Datagram too large len=" << size
@@ -298,64 +565,115 @@ void H3DatagramAsyncSocket::resumeRead(
 }
 
 void H3DatagramAsyncSocket::startClient() {
-  MasqueService::ScopeExecutor _([]() {
-    // restore default
-    MasqueService::setQUICPacketLenV4(1472);
+  MasqueService::ScopeExecutor _([pmtuDiscovery = options_.pmtuDiscovery_]() {
+    if (!pmtuDiscovery) {
+      // restore default
+      MasqueService::setQUICPacketLenV4(1472);
+    }
   });
-  MasqueService::setQUICPacketLenV4(options_.maxSendSize_);
+  if (!options_.pmtuDiscovery_) {
+    MasqueService::setQUICPacketLenV4(options_.maxSendSize_);
+  }
+  if (!upstreamSession_) {
+    upstreamSession_ = createUpstreamSession(this, this);
+    // every connection has its own udp socket and connection ids
+    for (size_t i = 1; i < options_.connections_; i++) {
+      auto connection = make_unique<PoolConnection>(this, i);
+      connection->setUpstreamSession(
+          createUpstreamSession(connection.get(), connection.get()));
+      poolConnections_.push_back(std::move(connection));
+    }
+  }
+}
+
+HQUpstreamSession* H3DatagramAsyncSocket::createUpstreamSession(
+    HQSession::ConnectCallback* connectCallback,
+    HTTPSessionBase::InfoCallback* infoCallback) {
   auto transportSettings = options_.transportSettings;
   transportSettings.datagramConfig.enabled = true;
   transportSettings.maxRecvPacketSize = options_.maxRecvPacketSize_;
-  transportSettings.canIgnorePathMTU = true;
+  if (options_.pmtuDiscovery_) {
+    transportSettings.enablePmtuDiscovery = true;
+    transportSettings.maxPmtuProbeSize = options_.maxSendSize_;
+  } else {
+    transportSettings.canIgnorePathMTU = true;
+  }
   transportSettings.defaultCongestionController = options_.defaultCCType;
+  // the tunnel controller leaves the pacing to the tunnelled flows
   transportSettings.pacingEnabled =
-      options_.defaultCCType != quic::CongestionControlType::None;
-  if (!upstreamSession_) {
-    auto sock = (*socketGenerator_)(evb_);
-    auto fizzClientContext =
-        quic::FizzClientQuicHandshakeContext::Builder()
-            .setFizzClientContext(createFizzClientContext())
-            .setCertificateVerifier(options_.certVerifier_)
-            .build();
-    auto client = make_shared<quic::QuicClientTransport>(
-        evb_, std::move(sock), fizzClientContext);
-    CHECK(connectAddress_.isInitialized());
-    client->addNewPeerAddress(connectAddress_);
-    if (bindAddress_.isInitialized()) {
-      client->setLocalAddress(bindAddress_);
-    }
-    client->setCongestionControllerFactory(
-        make_shared<quic::DefaultCongestionControllerFactory>());
-    if (transportSettings.pacingEnabled) {
-      client->setPacingTimer(quic::TimerHighRes::newTimer(
-          evb_, transportSettings.pacingTickInterval));
-    }
-    client->setTransportSettings(transportSettings);
-    client->setSupportedVersions({quic::QuicVersion::QUIC_V1,
-                                  quic::QuicVersion::QUIC_V2,
-                                  quic::QuicVersion::MVFST});
-    if (qlogPath_) {
-      client->setQLogger(std::make_shared<MasqueService::QLogger>(
-          getEventBase(), *qlogPath_, quic::VantagePoint::Client));
+      options_.defaultCCType != quic::CongestionControlType::None &&
+      options_.defaultCCType != quic::CongestionControlType::Tunnel;
+  transportSettings.attemptEarlyData =
+      options_.earlyData_ && options_.pskCache_;
+  auto sock = (*socketGenerator_)(evb_);
+  if (options_.busyPollUs_ > 0) {
+    sock->setBusyPoll(options_.busyPollUs_);
+  }
+  auto fizzClientContext =
+      quic::FizzClientQuicHandshakeContext::Builder()
+          .setFizzClientContext(createFizzClientContext())
+          .setCertificateVerifier(options_.certVerifier_)
+          .setPskCache(options_.pskCache_)
+          .build();
+  auto client = make_shared<quic::QuicClientTransport>(
+      evb_, std::move(sock), fizzClientContext);
+  CHECK(connectAddress_.isInitialized());
+  client->setHostname(options_.hostname_.empty()
+                          ? connectAddress_.getAddressStr()
+                          : options_.hostname_);
+  if (options_.tokenCache_) {
+    // tokens are only valid for the server at that address
+    auto tokenKey = connectAddress_.describe();
+    if (auto token = options_.tokenCache_->getToken(tokenKey)) {
+      client->setNewToken(std::move(*token));
     }
-    wangle::TransportInfo tinfo;
-    upstreamSession_ =
-        new proxygen::HQUpstreamSession(options_.txnTimeout_,
-                                        options_.connectTimeout_,
-                                        nullptr, // controller
-                                        tinfo,
-                                        nullptr); // codecfiltercallback
-    upstreamSession_->setSocket(client);
-    upstreamSession_->setConnectCallback(this);
-    upstreamSession_->setInfoCallback(this);
-    upstreamSession_->setEgressSettings(
-        {{proxygen::SettingsId::_HQ_DATAGRAM, 1}});
-    upstreamSession_->setMaxConcurrentOutgoingStreams(
-        numeric_limits<uint32_t>::max());
-
-    upstreamSession_->startNow();
-    client->start(upstreamSession_, upstreamSession_);
+    client->setNewTokenCallback(
+        [tokenCache = options_.tokenCache_, tokenKey](string token) {
+          tokenCache->putToken(tokenKey, std::move(token));
+        });
+  }
+  client->addNewPeerAddress(connectAddress_);
+  if (bindAddress_.isInitialized()) {
+    client->setLocalAddress(bindAddress_);
+  }
+  client->setCongestionControllerFactory(
+      make_shared<quic::DefaultCongestionControllerFactory>());
+  if (transportSettings.pacingEnabled) {
+    client->setPacingTimer(quic::TimerHighRes::newTimer(
+        evb_, transportSettings.pacingTickInterval));
+  }
+  client->setTransportSettings(transportSettings);
+  if (options_.pmtuDiscovery_) {
+    auto observer = make_unique<PmtuObserver>(this);
+    client->addObserver(observer.get());
+    pmtuObservers_.push_back(std::move(observer));
   }
+  client->setSupportedVersions({quic::QuicVersion::QUIC_V1,
+                                quic::QuicVersion::QUIC_V2,
+                                quic::QuicVersion::MVFST});
+  if (binaryQLogWriter_) {
+    client->setQLogger(std::make_shared<quic::BinaryQLogger>(
+        quic::VantagePoint::Client, binaryQLogWriter_));
+  } else if (qlogPath_) {
+    client->setQLogger(std::make_shared<MasqueService::QLogger>(
+        getEventBase(), *qlogPath_, quic::VantagePoint::Client));
+  }
+  wangle::TransportInfo tinfo;
+  auto* session =
+      new proxygen::HQUpstreamSession(options_.txnTimeout_,
+                                      options_.connectTimeout_,
+                                      nullptr, // controller
+                                      tinfo,
+                                      nullptr); // codecfiltercallback
+  session->setSocket(client);
+  session->setConnectCallback(connectCallback);
+  session->setInfoCallback(infoCallback);
+  session->setEgressSettings({{proxygen::SettingsId::_HQ_DATAGRAM, 1}});
+  session->setMaxConcurrentOutgoingStreams(numeric_limits<uint32_t>::max());
+
+  session->startNow();
+  client->start(session, session);
+  return session;
 }
 
 shared_ptr<fizz::client::FizzClientContext>
@@ -375,7 +693,7 @@ H3DatagramAsyncSocket::createFizzClientContext() {
   ctx->setSupportedAlpns(supportedAlpns);
   ctx->setDefaultShares(
       {fizz::NamedGroup::x25519, fizz::NamedGroup::secp256r1});
-  ctx->setSendEarlyData(false);
+  ctx->setSendEarlyData(options_.earlyData_);
   return ctx;
 }
 
@@ -383,14 +701,33 @@ ssize_t H3DatagramAsyncSocket::write(const folly::SocketAddress& address,
                                      const unique_ptr<folly::IOBuf>& buf) {
   if (!defaultStreamId_) {
     LOG(WARNING) << "No default stream id yet, buffering";
-    if (writeBuf.size() < sndBufPkts_) {
+    auto size = buf->computeChainDataLength();
+    if (BufferState::tryReserve(bufferState_.sndBufBytes,
+                                bufferState_.sndBufPeakBytes,
+                                bufferState_.sndBufLimit,
+                                size)) {
       writeBuf.emplace_back(buf->clone());
-      return buf->computeChainDataLength();
+      return size;
     }
+    bufferState_.sndDroppedDatagrams++;
     LOG(ERROR) << "Socket write buffer is full. Discarding datagram";
+    errno = ENOBUFS;
     return -1;
   }
-  return write(*defaultStreamId_, address, buf);
+  auto streamID = *defaultStreamId_;
+  // CONNECT-IP datagrams carry IP packets: spread the flows over the
+  // transactions, keeping each flow on one so it is not reordered
+  if (orderedStreamIds_.size() > 1 && options_.httpRequest_ &&
+      options_.httpRequest_->getMethod() == HTTPMethod::CONNECT_IP) {
+    if (auto hash = ipFlowHash(*buf)) {
+      auto selected = selectTransaction(*hash);
+      if (selected && transactions_.count(*selected) &&
+          transactions_[*selected]->getTransaction()) {
+        streamID = *selected;
+      }
+    }
+  }
+  return write(streamID, address, buf);
 }
 
 void H3DatagramAsyncSocket::resumeRead(ReadCallback* cob) {
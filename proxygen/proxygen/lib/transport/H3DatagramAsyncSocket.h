@@ -9,12 +9,18 @@
 #pragma once
 #include <fizz/client/FizzClientContext.h>
 #include <folly/io/async/AsyncSocketException.h>
+#include <folly/io/async/AsyncTimeout.h>
 #include <folly/io/async/AsyncUDPSocket.h>
 #include <proxygen/lib/http/session/HQUpstreamSession.h>
 #include <proxygen/lib/http/session/HTTPTransaction.h>
+#include <proxygen/lib/transport/Ecn.h>
 #include <quic/api/QuicSocket.h>
 #include <quic/client/QuicClientTransport.h>
+#include <quic/fizz/client/handshake/QuicPskCache.h>
+#include <quic/fizz/client/handshake/QuicTokenCache.h>
+#include <quic/logging/BinaryQLogger.h>
 
+#include <atomic>
 #include <utility>
 
 namespace proxygen {
@@ -43,6 +49,8 @@ class H3DatagramAsyncSocket
     std::chrono::milliseconds connectTimeout_{3000};
     std::shared_ptr<proxygen::HTTPMessage> httpRequest_;
     folly::SocketAddress targetAddress_;
+    // SNI of the hop, also the key of its psks. The target address if empty.
+    std::string hostname_;
     folly::Optional<std::pair<std::string, std::string>> certAndKey_;
     std::shared_ptr<const fizz::CertificateVerifier> certVerifier_;
     uint16_t maxRecvPacketSize_{1500};
@@ -50,6 +58,62 @@ class H3DatagramAsyncSocket
     quic::CongestionControlType defaultCCType =
         quic::CongestionControlType::None;
     bool framePerPacket = true;
+    // Byte limits for datagrams buffered by this socket (not by the quic
+    // transport) while the transport or the reader is not ready yet
+    std::size_t rcvBufBytes_{150000};
+    std::size_t sndBufBytes_{150000};
+    // Derive both limits from the bandwidth-delay product reported by the
+    // quic transport. An explicit setRcvBuf()/setSndBuf() disables this.
+    bool autoSizeBuffers_{false};
+    std::size_t minAutoBufBytes_{32 * 1500};
+    std::size_t maxAutoBufBytes_{64 * 1024 * 1024};
+    std::chrono::milliseconds autoSizeInterval_{100};
+    // Number of QUIC connections to the same hop. Transaction i is opened on
+    // connection i % connections_; each connection uses its own UDP socket
+    // and connection IDs, so the server can route them to different workers.
+    std::size_t connections_{1};
+    // Session resumption. Psks are cached per hostname_, NEW_TOKEN tokens
+    // per hop address. With earlyData_ and a cached psk the CONNECT request is sent
+    // as 0-RTT data; datagrams stay buffered until the response arrives.
+    std::shared_ptr<quic::QuicPskCache> pskCache_;
+    std::shared_ptr<quic::QuicTokenCache> tokenCache_;
+    bool earlyData_{false};
+    // Path MTU discovery instead of a fixed packet size: maxSendSize_ is only
+    // the upper bound of the search, the packets start at the transport's
+    // default size and grow as probes get through.
+    bool pmtuDiscovery_{false};
+    // SO_BUSY_POLL of the hop's UDP sockets, 0 to leave it unset
+    int busyPollUs_{0};
+  };
+
+  // Per-socket buffer accounting, shared by all transactions of one socket
+  struct BufferState {
+    std::atomic<std::size_t> rcvBufLimit{0};
+    std::atomic<std::size_t> sndBufLimit{0};
+    std::atomic<std::size_t> rcvBufBytes{0};
+    std::atomic<std::size_t> sndBufBytes{0};
+    std::atomic<std::size_t> rcvBufPeakBytes{0};
+    std::atomic<std::size_t> sndBufPeakBytes{0};
+    std::atomic<uint64_t> rcvDroppedDatagrams{0};
+    std::atomic<uint64_t> sndDroppedDatagrams{0};
+
+    // Reserves len bytes if the limit allows it
+    static bool tryReserve(std::atomic<std::size_t>& bytes,
+                           std::atomic<std::size_t>& peakBytes,
+                           std::size_t limit,
+                           std::size_t len);
+    static void release(std::atomic<std::size_t>& bytes, std::size_t len);
+  };
+
+  struct BufferStats {
+    std::size_t rcvBufLimit{0};
+    std::size_t sndBufLimit{0};
+    std::size_t rcvBufBytes{0};
+    std::size_t sndBufBytes{0};
+    std::size_t rcvBufPeakBytes{0};
+    std::size_t sndBufPeakBytes{0};
+    uint64_t rcvDroppedDatagrams{0};
+    uint64_t sndDroppedDatagrams{0};
   };
 
   struct UDPSocketGenerator {
@@ -70,6 +134,7 @@ class H3DatagramAsyncSocket
 
    private:
     const Options options;
+    BufferState* bufferState = nullptr;
     proxygen::HQUpstreamSession* upstreamSession = nullptr;
     proxygen::HTTPTransaction* httpTransaction = nullptr;
     // Buffers Outgoing Datagrams before the transport is ready
@@ -82,18 +147,36 @@ class H3DatagramAsyncSocket
     std::deque<std::unique_ptr<folly::IOBuf>> bodyBuf;
     std::mutex bodyBufMutex;
     ReadCallback* readCallback = nullptr;
+    // ECN of the outer connection, handed out with the delivered datagrams.
+    // Shared by the transactions of the connection.
+    std::shared_ptr<ecn::OuterECN> outerECN;
+
+    // Drops the datagrams that can no longer be sent or delivered and
+    // returns their bytes to the socket's buffer limits
+    void releaseBuffers();
 
    public:
     explicit TransactionHandler(Options options,
+                                BufferState* bufferState,
                                 proxygen::HQUpstreamSession* upstreamSession)
-        : options(std::move(options)), upstreamSession(upstreamSession) {
+        : options(std::move(options)),
+          bufferState(bufferState),
+          upstreamSession(upstreamSession) {
+      CHECK(bufferState);
     }
     TransactionHandler() = delete;
+    ~TransactionHandler() override {
+      releaseBuffers();
+    }
 
     proxygen::HTTPTransaction* getTransaction() {
       return httpTransaction;
     }
 
+    void setOuterECN(std::shared_ptr<ecn::OuterECN> outerECN) {
+      this->outerECN = std::move(outerECN);
+    }
+
     proxygen::HTTPCodec::StreamID getTransactionID() const {
       return httpTransaction->getID();
     }
@@ -115,6 +198,8 @@ class H3DatagramAsyncSocket
       {
         std::unique_lock lock(readBufMutex);
         for (auto& datagram : readBuf) {
+          BufferState::release(bufferState->rcvBufBytes,
+                               datagram->computeChainDataLength());
           deliverDatagram(std::move(datagram));
         }
         readBuf.clear();
@@ -165,7 +250,66 @@ class H3DatagramAsyncSocket
     void onEgressResumed() noexcept override;
   };
 
+  // Called with the id of every transaction once it is opened. The ids are
+  // unique per socket, unlike stream ids which repeat across the connections
+  // of the pool (see transactionId()).
   using NewTransactionCallback = std::function<void(HTTPCodec::StreamID)>;
+  // Called with the new datagram size limit when path MTU discovery changes it
+  using DatagramSizeLimitCallback = std::function<void(std::size_t)>;
+
+  // Reports the path MTU updates of one connection to the socket
+  class PmtuObserver : public quic::QuicSocket::ManagedObserver {
+
+   private:
+    H3DatagramAsyncSocket* parent;
+
+   public:
+    explicit PmtuObserver(H3DatagramAsyncSocket* parent);
+
+    void pmtuUpdated(
+        quic::QuicSocket*,
+        const quic::SocketObserverInterface::PmtuUpdateEvent&) override;
+  };
+
+  // An additional connection of the pool (the first one is handled by the
+  // socket itself)
+  class PoolConnection
+      : public HQSession::ConnectCallback
+      , public HTTPSessionBase::InfoCallback {
+
+   private:
+    H3DatagramAsyncSocket* parent;
+    const std::size_t index;
+    proxygen::HQUpstreamSession* upstreamSession{nullptr};
+
+   public:
+    PoolConnection(H3DatagramAsyncSocket* parent, std::size_t index)
+        : parent(parent), index(index) {
+    }
+    ~PoolConnection() override {
+      if (upstreamSession) {
+        upstreamSession->setConnectCallback(nullptr);
+        upstreamSession->setInfoCallback(nullptr);
+      }
+    }
+
+    proxygen::HQUpstreamSession* getUpstreamSession() const {
+      return upstreamSession;
+    }
+    void setUpstreamSession(proxygen::HQUpstreamSession* session) {
+      upstreamSession = session;
+    }
+
+    // HQSession::ConnectCallback
+    void connectSuccess() override;
+    void onReplaySafe() override {
+    }
+    void connectError(quic::QuicError error) override;
+    // HTTPSessionBase::InfoCallback
+    void onDestroy(const HTTPSessionBase&) override {
+      upstreamSession = nullptr;
+    }
+  };
 
  public:
   H3DatagramAsyncSocket(folly::EventBase* evb,
@@ -174,13 +318,17 @@ class H3DatagramAsyncSocket
 
   ~H3DatagramAsyncSocket() override {
     for (auto& [_, handler] : transactions_) {
-      auto* txn = handler->getTransaction();
-      txn->setHandler(nullptr);
+      if (auto* txn = handler->getTransaction()) {
+        txn->setHandler(nullptr);
+      }
     }
+    // the handlers release their buffers into bufferState_
+    transactions_.clear();
     if (upstreamSession_) {
       upstreamSession_->setConnectCallback(nullptr);
       upstreamSession_->setInfoCallback(nullptr);
     }
+    poolConnections_.clear();
   }
 
   /*
@@ -273,13 +421,18 @@ class H3DatagramAsyncSocket
   void close() override {
     for (auto& [_, handler] : transactions_) {
       auto* txn = handler->getTransaction();
-      if (!txn->isEgressEOMSeen()) {
+      if (txn && !txn->isEgressEOMSeen()) {
         txn->sendEOM();
       }
     }
     if (upstreamSession_) {
       upstreamSession_->closeWhenIdle();
     }
+    for (auto& connection : poolConnections_) {
+      if (auto* session = connection->getUpstreamSession()) {
+        session->closeWhenIdle();
+      }
+    }
   }
 
   folly::NetworkSocket getNetworkSocket() const override {
@@ -305,22 +458,27 @@ class H3DatagramAsyncSocket
 
   void setRcvBuf(int rcvBuf) override {
     if (rcvBuf > 0) {
-      // This is going to be the maximum number of packets buffered here or at
-      // the the quic transport
-      rcvBufPkts_ = rcvBuf / options_.maxRecvPacketSize_;
+      // This is going to be the maximum number of bytes buffered by this
+      // socket. It only affects this hop.
+      bufferState_.rcvBufLimit = rcvBuf;
+      options_.autoSizeBuffers_ = false;
     }
   }
 
   void setSndBuf(int sndBuf) override {
     if (sndBuf > 0) {
-      // This is going to be the maximum number of packets buffered here or at
-      // the the quic transport
-      sndBufPkts_ = sndBuf / options_.maxRecvPacketSize_;
+      // This is going to be the maximum number of bytes buffered by this
+      // socket. It only affects this hop.
+      bufferState_.sndBufLimit = sndBuf;
+      options_.autoSizeBuffers_ = false;
     }
   }
 
-  void setBusyPoll(int /*busyPollUs*/) override {
-    LOG(WARNING) << __func__ << " unsupported";
+  BufferStats getBufferStats() const;
+
+  // Only applies to the connections opened afterwards
+  void setBusyPoll(int busyPollUs) override {
+    options_.busyPollUs_ = busyPollUs;
   }
 
   void dontFragment(bool /*df*/) override {
@@ -401,7 +559,22 @@ class H3DatagramAsyncSocket
 
  private:
   void startClient();
+  proxygen::HQUpstreamSession* createUpstreamSession(
+      HQSession::ConnectCallback* connectCallback,
+      HTTPSessionBase::InfoCallback* infoCallback);
+  // Opens the transactions assigned to the connection with the given index
+  void createTransactions(std::size_t connectionIndex,
+                          proxygen::HQUpstreamSession* session);
+  std::size_t connectionForTransaction(std::size_t transactionIndex) const;
+  // Socket-wide id of the transaction on the given stream of the given
+  // connection, equal to the stream id with a single connection
+  HTTPCodec::StreamID transactionId(std::size_t connectionIndex,
+                                    HTTPCodec::StreamID streamID) const;
   std::shared_ptr<fizz::client::FizzClientContext> createFizzClientContext();
+  // Resizes the buffers to the bandwidth-delay product of the connection
+  void autoSizeBuffers();
+  void scheduleAutoSizeBuffers();
+  void onPmtuUpdated(const quic::SocketObserverInterface::PmtuUpdateEvent&);
 
  public:
   std::vector<proxygen::HTTPCodec::StreamID> getOpenTransactions() const {
@@ -412,6 +585,16 @@ class H3DatagramAsyncSocket
     return streams;
   }
 
+  // Picks a transaction for a flow, so that packets of one flow stay on one
+  // connection
+  folly::Optional<proxygen::HTTPCodec::StreamID> selectTransaction(
+      uint64_t flowHash) const;
+
+  // Hashes the addresses, protocol and TCP/UDP ports of an IP packet. Returns
+  // none if the packet is not IPv4 or IPv6. Fragments of IPv4 datagrams hash
+  // without ports, so all fragments use the same transaction
+  static folly::Optional<uint64_t> ipFlowHash(const folly::IOBuf& packet);
+
   void setNewTransactionCallback(NewTransactionCallback callback) {
     newTransactionCallback_ = std::move(callback);
   }
@@ -420,6 +603,18 @@ class H3DatagramAsyncSocket
     qlogPath_ = std::move(qlogPath);
   }
 
+  // Logs binary qlogs into writer instead of JSON qlogs into the qlog path
+  void setBinaryQLogWriter(std::shared_ptr<quic::BinaryQLogWriter> writer) {
+    binaryQLogWriter_ = std::move(writer);
+  }
+
+  void setDatagramSizeLimitCallback(DatagramSizeLimitCallback callback) {
+    datagramSizeLimitCallback_ = std::move(callback);
+  }
+
+  // Smallest datagram size limit of the open transactions
+  folly::Optional<std::size_t> getDatagramSizeLimit() const;
+
  private:
   folly::EventBase* evb_;
   Options options_;
@@ -428,22 +623,31 @@ class H3DatagramAsyncSocket
   folly::SocketAddress connectAddress_;
   proxygen::HQUpstreamSession* upstreamSession_{nullptr};
   std::optional<NewTransactionCallback> newTransactionCallback_;
+  std::optional<DatagramSizeLimitCallback> datagramSizeLimitCallback_;
   // Buffers Outgoing Datagrams before the transport is ready
   std::deque<std::unique_ptr<folly::IOBuf>> writeBuf;
 
+  // keyed by transactionId()
   std::unordered_map<proxygen::HTTPCodec::StreamID,
                      std::unique_ptr<TransactionHandler>>
       transactions_;
 
   std::optional<std::string> qlogPath_;
+  std::shared_ptr<quic::BinaryQLogWriter> binaryQLogWriter_;
 
   bool transportConnected_ : 1;
 
   std::optional<HTTPCodec::StreamID> defaultStreamId_;
   AsyncUDPSocket::ReadCallback* defaultReadCallback_{nullptr};
 
-  static unsigned int rcvBufPkts_;
-  static unsigned int sndBufPkts_;
+  BufferState bufferState_;
+  std::unique_ptr<folly::AsyncTimeout> autoSizeTimer_;
+
+  std::vector<std::unique_ptr<PoolConnection>> poolConnections_;
+  // transaction ids in creation order, for flow hashing
+  std::vector<proxygen::HTTPCodec::StreamID> orderedStreamIds_;
+  // one per connection, detached from the transports when destroyed
+  std::vector<std::unique_ptr<PmtuObserver>> pmtuObservers_;
 };
 
 } // namespace proxygen
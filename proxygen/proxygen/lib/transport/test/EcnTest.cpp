@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <proxygen/lib/transport/Ecn.h>
+
+#include <array>
+#include <folly/portability/GTest.h>
+
+using namespace proxygen;
+
+namespace {
+
+// Full RFC 791 header checksum, with the checksum field taken as zero
+uint16_t ipv4Checksum(const uint8_t* header, size_t length) {
+  uint32_t sum = 0;
+  for (size_t i = 0; i < length; i += 2) {
+    if (i == 10) {
+      continue;
+    }
+    sum += (header[i] << 8) | header[i + 1];
+  }
+  while (sum >> 16) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+  return static_cast<uint16_t>(~sum);
+}
+
+uint16_t storedChecksum(const uint8_t* header) {
+  return (header[10] << 8) | header[11];
+}
+
+std::array<uint8_t, 20> makeIPv4Header(uint8_t ecn) {
+  std::array<uint8_t, 20> header{0x45, ecn, 0x00, 0x54, 0x12, 0x34, 0x40,
+                                 0x00, 0x40, 0x11, 0x00, 0x00, 10,   0,
+                                 0,    1,    192,  168,  1,    20};
+  auto checksum = ipv4Checksum(header.data(), header.size());
+  header[10] = checksum >> 8;
+  header[11] = checksum & 0xff;
+  return header;
+}
+
+std::array<uint8_t, 40> makeIPv6Header(uint8_t ecn) {
+  std::array<uint8_t, 40> header{};
+  header[0] = 0x60;
+  header[1] = 0xc0 | (ecn << 4);
+  header[6] = 17;
+  header[7] = 64;
+  return header;
+}
+
+} // namespace
+
+TEST(EcnTest, UpdateChecksum) {
+  auto header = makeIPv4Header(ecn::NOT_ECT);
+  // every change of the first word, including carries around the sum
+  for (uint32_t word = 0; word <= 0xffff; word += 0x0101) {
+    uint16_t oldWord = (header[0] << 8) | header[1];
+    header[0] = word >> 8;
+    header[1] = word & 0xff;
+    ecn::detail::updateChecksum(header.data() + 10, oldWord, word);
+    EXPECT_EQ(storedChecksum(header.data()),
+              ipv4Checksum(header.data(), header.size()))
+        << "word=" << word;
+  }
+}
+
+TEST(EcnTest, SetECNKeepsIPv4ChecksumValid) {
+  auto header = makeIPv4Header(ecn::ECT_0);
+  for (auto value : {ecn::CE, ecn::ECT_1, ecn::NOT_ECT, ecn::ECT_0}) {
+    EXPECT_TRUE(ecn::setECN(header.data(), header.size(), value));
+    EXPECT_EQ(ecn::getECN(header.data(), header.size()), value);
+    EXPECT_EQ(storedChecksum(header.data()),
+              ipv4Checksum(header.data(), header.size()));
+    // the DSCP bits are left alone
+    EXPECT_EQ(header[1] & ~quic::kEcnMask, 0);
+  }
+}
+
+TEST(EcnTest, DecapsulateIPv4) {
+  // RFC 6040 section 4.2, rows are the inner ECN, columns the outer one
+  struct Case {
+    uint8_t inner;
+    uint8_t outer;
+    bool forwarded;
+    uint8_t result;
+  };
+  std::vector<Case> cases{
+      {ecn::NOT_ECT, ecn::NOT_ECT, true, ecn::NOT_ECT},
+      {ecn::NOT_ECT, ecn::ECT_0, true, ecn::NOT_ECT},
+      {ecn::NOT_ECT, ecn::ECT_1, true, ecn::NOT_ECT},
+      {ecn::NOT_ECT, ecn::CE, false, ecn::NOT_ECT},
+      {ecn::ECT_0, ecn::NOT_ECT, true, ecn::ECT_0},
+      {ecn::ECT_0, ecn::ECT_0, true, ecn::ECT_0},
+      {ecn::ECT_0, ecn::ECT_1, true, ecn::ECT_1},
+      {ecn::ECT_0, ecn::CE, true, ecn::CE},
+      {ecn::ECT_1, ecn::NOT_ECT, true, ecn::ECT_1},
+      {ecn::ECT_1, ecn::ECT_0, true, ecn::ECT_1},
+      {ecn::ECT_1, ecn::ECT_1, true, ecn::ECT_1},
+      {ecn::ECT_1, ecn::CE, true, ecn::CE},
+      {ecn::CE, ecn::NOT_ECT, true, ecn::CE},
+      {ecn::CE, ecn::ECT_0, true, ecn::CE},
+      {ecn::CE, ecn::ECT_1, true, ecn::CE},
+      {ecn::CE, ecn::CE, true, ecn::CE},
+  };
+  for (const auto& c : cases) {
+    auto header = makeIPv4Header(c.inner);
+    EXPECT_EQ(ecn::decapsulate(header.data(), header.size(), c.outer),
+              c.forwarded)
+        << "inner=" << int(c.inner) << " outer=" << int(c.outer);
+    if (c.forwarded) {
+      EXPECT_EQ(ecn::getECN(header.data(), header.size()), c.result);
+      EXPECT_EQ(storedChecksum(header.data()),
+                ipv4Checksum(header.data(), header.size()));
+    }
+  }
+}
+
+TEST(EcnTest, DecapsulateIPv6) {
+  auto header = makeIPv6Header(ecn::ECT_0);
+  EXPECT_TRUE(ecn::decapsulate(header.data(), header.size(), ecn::CE));
+  EXPECT_EQ(ecn::getECN(header.data(), header.size()), ecn::CE);
+  // the traffic class bits around the ECN field are kept
+  EXPECT_EQ(header[0], 0x60);
+  EXPECT_EQ(header[1] & 0xcf, 0xc0);
+
+  header = makeIPv6Header(ecn::NOT_ECT);
+  EXPECT_FALSE(ecn::decapsulate(header.data(), header.size(), ecn::CE));
+}
+
+TEST(EcnTest, DecapsulateNonIPPassesThrough) {
+  std::array<uint8_t, 10> shortPacket{0x45};
+  EXPECT_TRUE(
+      ecn::decapsulate(shortPacket.data(), shortPacket.size(), ecn::CE));
+  EXPECT_EQ(shortPacket[1], 0);
+}
+
+TEST(EcnTest, OuterECNStartsAtCurrentCECount) {
+  quic::QuicConnectionStateBase conn(quic::QuicNodeType::Client);
+  conn.transportSettings.readEcnOnIngress = true;
+  auto& ackState = conn.ackStates.appDataAckState;
+  ackState.ecnECT0CountReceived = 10;
+  ackState.ecnCECountReceived = 3;
+
+  // a tunnel opened now does not inherit the earlier CE marks
+  auto shared = std::make_shared<ecn::OuterECN>(&conn);
+  EXPECT_EQ(shared->next(&conn), ecn::ECT_0);
+
+  // the transactions of a connection share one counter, so a new mark is
+  // attributed to exactly one datagram
+  auto first = shared;
+  auto second = shared;
+  ackState.ecnCECountReceived++;
+  EXPECT_EQ(first->next(&conn), ecn::CE);
+  EXPECT_EQ(second->next(&conn), ecn::ECT_0);
+  EXPECT_EQ(first->next(&conn), ecn::ECT_0);
+
+  conn.transportSettings.readEcnOnIngress = false;
+  ackState.ecnCECountReceived++;
+  EXPECT_EQ(first->next(&conn), ecn::NOT_ECT);
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <proxygen/lib/transport/H3DatagramAsyncSocket.h>
+
+#include <folly/io/IOBuf.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/portability/GTest.h>
+
+#include <cstring>
+#include <set>
+
+namespace proxygen {
+
+class H3DatagramAsyncSocketTest : public testing::Test {
+ protected:
+  using TransactionHandler = H3DatagramAsyncSocket::TransactionHandler;
+
+  void SetUp() override {
+    bufferState_.rcvBufLimit = 10000;
+    bufferState_.sndBufLimit = 10000;
+  }
+
+  std::unique_ptr<TransactionHandler> makeHandler() {
+    H3DatagramAsyncSocket::Options options;
+    options.mode_ = H3DatagramAsyncSocket::Mode::CLIENT;
+    return std::make_unique<TransactionHandler>(
+        std::move(options), &bufferState_, nullptr);
+  }
+
+  static std::unique_ptr<folly::IOBuf> makeDatagram(std::size_t len) {
+    return folly::IOBuf::copyBuffer(std::string(len, 'x'));
+  }
+
+  // Queues a datagram the way H3DatagramAsyncSocket::write() does before
+  // the transport is connected
+  void queueWrite(TransactionHandler& handler, std::size_t len) {
+    ASSERT_TRUE(
+        H3DatagramAsyncSocket::BufferState::tryReserve(
+            bufferState_.sndBufBytes,
+            bufferState_.sndBufPeakBytes,
+            bufferState_.sndBufLimit,
+            len));
+    handler.writeBuffer().emplace_back(makeDatagram(len));
+  }
+
+  // Receives datagrams with no read callback, so they are queued
+  void queueRead(TransactionHandler& handler, std::size_t len) {
+    handler.onDatagram(makeDatagram(len));
+  }
+
+  struct NoSocketGenerator : public H3DatagramAsyncSocket::UDPSocketGenerator {
+    std::unique_ptr<folly::AsyncUDPSocket> operator()(
+        folly::EventBase*) override {
+      return nullptr;
+    }
+  };
+
+  static void setTransactions(H3DatagramAsyncSocket& socket,
+                              std::vector<HTTPCodec::StreamID> streamIDs) {
+    socket.orderedStreamIds_ = std::move(streamIDs);
+  }
+
+  // An IPv4 UDP packet, optionally fragmented
+  static std::unique_ptr<folly::IOBuf> makeUdpPacket(uint16_t srcPort,
+                                                     uint16_t dstPort,
+                                                     std::size_t payloadLen,
+                                                     uint8_t ttl = 64,
+                                                     uint8_t tos = 0,
+                                                     uint16_t fragment = 0) {
+    std::string packet(28 + payloadLen, 'x');
+    uint8_t header[28] = {0x45, tos, 0, 0, 0, 0, 0, 0, ttl, 17,
+                          0,    0,   10, 0, 0, 1, 10, 0, 0, 2,
+                          0,    0,   0,  0, 0, 0, 0,  0};
+    header[6] = fragment >> 8;
+    header[7] = fragment & 0xff;
+    header[20] = srcPort >> 8;
+    header[21] = srcPort & 0xff;
+    header[22] = dstPort >> 8;
+    header[23] = dstPort & 0xff;
+    memcpy(packet.data(), header, sizeof(header));
+    return folly::IOBuf::copyBuffer(packet);
+  }
+
+  H3DatagramAsyncSocket::BufferState bufferState_;
+};
+
+TEST_F(H3DatagramAsyncSocketTest, DetachReleasesQueuedDatagrams) {
+  auto handler = makeHandler();
+  queueRead(*handler, 100);
+  queueRead(*handler, 200);
+  queueWrite(*handler, 300);
+  EXPECT_EQ(bufferState_.rcvBufBytes.load(), 300);
+  EXPECT_EQ(bufferState_.sndBufBytes.load(), 300);
+
+  handler->detachTransaction();
+  EXPECT_EQ(bufferState_.rcvBufBytes.load(), 0);
+  EXPECT_EQ(bufferState_.sndBufBytes.load(), 0);
+  EXPECT_TRUE(handler->readBuffer().empty());
+  EXPECT_TRUE(handler->writeBuffer().empty());
+  EXPECT_EQ(bufferState_.rcvBufPeakBytes.load(), 300);
+
+  // nothing is released twice
+  handler.reset();
+  EXPECT_EQ(bufferState_.rcvBufBytes.load(), 0);
+  EXPECT_EQ(bufferState_.sndBufBytes.load(), 0);
+}
+
+TEST_F(H3DatagramAsyncSocketTest, DestroyReleasesQueuedDatagrams) {
+  auto handler = makeHandler();
+  auto other = makeHandler();
+  queueRead(*handler, 100);
+  queueWrite(*handler, 400);
+  queueRead(*other, 50);
+  queueWrite(*other, 60);
+  EXPECT_EQ(bufferState_.rcvBufBytes.load(), 150);
+  EXPECT_EQ(bufferState_.sndBufBytes.load(), 460);
+
+  // only the datagrams of the destroyed handler are released
+  handler.reset();
+  EXPECT_EQ(bufferState_.rcvBufBytes.load(), 50);
+  EXPECT_EQ(bufferState_.sndBufBytes.load(), 60);
+
+  other.reset();
+  EXPECT_EQ(bufferState_.rcvBufBytes.load(), 0);
+  EXPECT_EQ(bufferState_.sndBufBytes.load(), 0);
+}
+
+TEST_F(H3DatagramAsyncSocketTest, ReleasedBytesCanBeReused) {
+  bufferState_.rcvBufLimit = 1000;
+  auto handler = makeHandler();
+  queueRead(*handler, 1000);
+  queueRead(*handler, 1);
+  EXPECT_EQ(bufferState_.rcvDroppedDatagrams.load(), 1);
+  handler->detachTransaction();
+
+  auto next = makeHandler();
+  queueRead(*next, 1000);
+  EXPECT_EQ(bufferState_.rcvBufBytes.load(), 1000);
+  EXPECT_EQ(bufferState_.rcvDroppedDatagrams.load(), 1);
+}
+
+TEST_F(H3DatagramAsyncSocketTest, OneFlowUsesOneTransaction) {
+  folly::EventBase evb;
+  H3DatagramAsyncSocket socket(&evb,
+                               H3DatagramAsyncSocket::Options(),
+                               std::make_unique<NoSocketGenerator>());
+  setTransactions(socket, {0, 4, 8, 12, 16, 20, 24, 28});
+
+  auto flowHash =
+      H3DatagramAsyncSocket::ipFlowHash(*makeUdpPacket(1000, 53, 10));
+  ASSERT_TRUE(flowHash.has_value());
+  auto streamID = socket.selectTransaction(*flowHash);
+  ASSERT_TRUE(streamID.has_value());
+  // payload, TTL and ECN do not change the flow
+  std::vector<std::unique_ptr<folly::IOBuf>> packets;
+  packets.push_back(makeUdpPacket(1000, 53, 1200));
+  packets.push_back(makeUdpPacket(1000, 53, 0, 1));
+  packets.push_back(makeUdpPacket(1000, 53, 10, 64, 0x03));
+  for (auto& packet : packets) {
+    auto hash = H3DatagramAsyncSocket::ipFlowHash(*packet);
+    ASSERT_EQ(hash, flowHash);
+    EXPECT_EQ(socket.selectTransaction(*hash), streamID);
+  }
+  // a chained packet hashes like a contiguous one
+  auto chained = makeUdpPacket(1000, 53, 10);
+  auto tail = chained->clone();
+  chained->trimEnd(chained->length() - 12);
+  tail->trimStart(12);
+  chained->appendToChain(std::move(tail));
+  EXPECT_EQ(H3DatagramAsyncSocket::ipFlowHash(*chained), flowHash);
+
+  EXPECT_NE(H3DatagramAsyncSocket::ipFlowHash(*makeUdpPacket(1001, 53, 10)),
+            flowHash);
+  // fragments have no ports and are kept together
+  auto fragmentHash = H3DatagramAsyncSocket::ipFlowHash(
+      *makeUdpPacket(1000, 53, 10, 64, 0, 0x2000));
+  EXPECT_NE(fragmentHash, flowHash);
+  // a later fragment, whose payload is not a UDP header
+  EXPECT_EQ(H3DatagramAsyncSocket::ipFlowHash(
+                *makeUdpPacket(2000, 80, 10, 64, 0, 0x00b9)),
+            fragmentHash);
+
+  // different flows are spread over the transactions
+  std::set<HTTPCodec::StreamID> used;
+  for (uint16_t port = 1000; port < 1064; ++port) {
+    used.insert(*socket.selectTransaction(
+        *H3DatagramAsyncSocket::ipFlowHash(*makeUdpPacket(port, 53, 10))));
+  }
+  EXPECT_GT(used.size(), 1);
+
+  EXPECT_FALSE(
+      H3DatagramAsyncSocket::ipFlowHash(*folly::IOBuf::copyBuffer("xyz")));
+}
+
+} // namespace proxygen